@@ -23,6 +23,22 @@ import geometry_service_pb2_grpc
 import geometry_types_pb2
 
 
+def decode_mesh_arrays(mesh_data) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """Decode a MeshData message (packed or legacy) into (vertices, normals, indices)"""
+    if mesh_data.HasField('packed'):
+        packed = mesh_data.packed
+        dtype = '<f8' if packed.encoding == geometry_types_pb2.MESH_ENCODING_PACKED_FLOAT64 else '<f4'
+        vertices = np.frombuffer(packed.positions, dtype=dtype).reshape(-1, 3).astype(np.float32)
+        normals = np.frombuffer(packed.normals, dtype=dtype).reshape(-1, 3).astype(np.float32)
+        indices = np.frombuffer(packed.indices, dtype='<u4')
+        return vertices, normals, indices
+
+    vertices = np.array([[v.x, v.y, v.z] for v in mesh_data.vertices], dtype=np.float32)
+    normals = np.array([[n.x, n.y, n.z] for n in mesh_data.normals], dtype=np.float32)
+    indices = np.array(mesh_data.indices, dtype=np.uint32)
+    return vertices, normals, indices
+
+
 @dataclass
 class ImportTask:
     """Represents an async import task"""
@@ -165,26 +181,92 @@ class EnhancedGeometryClient:
         else:
             print(f"Clear failed: {response.message}")
             
-    def get_all_meshes(self) -> List[dict]:
-        """Get all meshes using streaming"""
-        request = geometry_service_pb2.EmptyRequest()
+    def get_all_meshes(self, instancing: bool = False) -> List[dict]:
+        """Get all meshes using streaming
+
+        With instancing, shapes repeating a part share its arrays, given in the
+        part's coordinates, and carry 'prototype_id' and a 4x4 'instance_transform'.
+        """
+        request = geometry_service_pb2.MeshRequest(
+            mesh_options=geometry_types_pb2.MeshOptions(
+                encoding=geometry_types_pb2.MESH_ENCODING_PACKED_FLOAT32,
+                instancing=instancing))
         meshes = []
+        prototypes = {}
         
         for mesh_data in self.stub.GetAllMeshes(request, metadata=self.metadata):
-            vertices = np.array([[v.x, v.y, v.z] for v in mesh_data.vertices], dtype=np.float32)
-            normals = np.array([[n.x, n.y, n.z] for n in mesh_data.normals], dtype=np.float32)
-            indices = np.array(mesh_data.indices, dtype=np.uint32)
+            mesh = {'shape_id': mesh_data.shape_id}
+            if mesh_data.prototype_id:
+                key = (mesh_data.prototype_id, mesh_data.lod)
+                if mesh_data.HasField('packed') or len(mesh_data.vertices) > 0:
+                    prototypes[key] = decode_mesh_arrays(mesh_data)
+                vertices, normals, indices = prototypes[key]
+                mesh['prototype_id'] = mesh_data.prototype_id
+                mesh['instance_transform'] = np.array(mesh_data.instance_transform.matrix).reshape(4, 4)
+            else:
+                vertices, normals, indices = decode_mesh_arrays(mesh_data)
             
-            meshes.append({
-                'shape_id': mesh_data.shape_id,
-                'vertices': vertices,
-                'normals': normals,
-                'indices': indices
-            })
+            mesh.update(vertices=vertices, normals=normals, indices=indices)
+            meshes.append(mesh)
             print(f"Received mesh for shape {mesh_data.shape_id}: {len(vertices)} vertices")
                   
         return meshes
         
+    def ray_pick(self, origin: Tuple[float, float, float], direction: Tuple[float, float, float],
+                 max_hits: int = 1, max_distance: float = 0.0) -> List[dict]:
+        """Pick shapes along a ray on the server, closest hit first"""
+        request = geometry_service_pb2.RayPickRequest(
+            origin=geometry_types_pb2.Point3D(x=origin[0], y=origin[1], z=origin[2]),
+            direction=geometry_types_pb2.Vector3D(x=direction[0], y=direction[1], z=direction[2]),
+            max_hits=max_hits,
+            max_distance=max_distance
+        )
+        response = self.stub.RayPick(request, metadata=self.metadata)
+        if not response.success:
+            raise Exception(f"Ray pick failed: {response.message}")
+        return [{
+            'shape_id': hit.shape_id,
+            'distance': hit.distance,
+            'point': (hit.point.x, hit.point.y, hit.point.z),
+            'normal': (hit.normal.x, hit.normal.y, hit.normal.z)
+        } for hit in response.hits]
+        
+    def box_query(self, box_min: Tuple[float, float, float], box_max: Tuple[float, float, float],
+                  fully_inside: bool = False) -> List[str]:
+        """Shapes whose bounds overlap (or lie within) an axis-aligned box"""
+        request = geometry_service_pb2.BoxQueryRequest(
+            box=geometry_types_pb2.BoundingBox(
+                min=geometry_types_pb2.Point3D(x=box_min[0], y=box_min[1], z=box_min[2]),
+                max=geometry_types_pb2.Point3D(x=box_max[0], y=box_max[1], z=box_max[2])),
+            fully_inside=fully_inside
+        )
+        response = self.stub.BoxQuery(request, metadata=self.metadata)
+        if not response.success:
+            raise Exception(f"Box query failed: {response.message}")
+        return list(response.shape_ids)
+        
+    def frustum_cull(self, view_projection) -> List[str]:
+        """Shapes inside the frustum of a 4x4 view-projection matrix (row-major, OpenGL clip space)"""
+        matrix = np.asarray(view_projection, dtype=np.float64).reshape(16)
+        request = geometry_service_pb2.FrustumCullRequest(view_projection=matrix.tolist())
+        response = self.stub.FrustumCull(request, metadata=self.metadata)
+        if not response.success:
+            raise Exception(f"Frustum cull failed: {response.message}")
+        return list(response.shape_ids)
+        
+    def update_camera(self, view, projection, viewport_width: int, viewport_height: int) -> bool:
+        """Set the session camera (4x4 row-major matrices, OpenGL clip space) so the
+        server streams what it sees first; pass None matrices to clear it"""
+        camera = geometry_types_pb2.ViewCamera()
+        if view is not None and projection is not None:
+            camera.view.extend(np.asarray(view, dtype=np.float64).reshape(16).tolist())
+            camera.projection.extend(np.asarray(projection, dtype=np.float64).reshape(16).tolist())
+            camera.viewport_width = viewport_width
+            camera.viewport_height = viewport_height
+        request = geometry_service_pb2.CameraUpdateRequest(camera=camera)
+        response = self.stub.UpdateCamera(request, metadata=self.metadata)
+        return response.success
+        
     def import_model_async(self, file_path: str, options: ModelImportOptions = None, 
                           progress_callback: Callable[[ImportTask], None] = None) -> str:
         """
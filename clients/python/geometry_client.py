@@ -18,6 +18,22 @@ import geometry_service_pb2_grpc
 import geometry_types_pb2
 
 
+def decode_mesh_arrays(mesh_data) -> Tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """Decode a MeshData message (packed or legacy) into (vertices, normals, indices)"""
+    if mesh_data.HasField('packed'):
+        packed = mesh_data.packed
+        dtype = '<f8' if packed.encoding == geometry_types_pb2.MESH_ENCODING_PACKED_FLOAT64 else '<f4'
+        vertices = np.frombuffer(packed.positions, dtype=dtype).reshape(-1, 3).astype(np.float32)
+        normals = np.frombuffer(packed.normals, dtype=dtype).reshape(-1, 3).astype(np.float32)
+        indices = np.frombuffer(packed.indices, dtype='<u4')
+        return vertices, normals, indices
+
+    vertices = np.array([[v.x, v.y, v.z] for v in mesh_data.vertices], dtype=np.float32)
+    normals = np.array([[n.x, n.y, n.z] for n in mesh_data.normals], dtype=np.float32)
+    indices = np.array(mesh_data.indices, dtype=np.uint32)
+    return vertices, normals, indices
+
+
 class GeometryClient:
     """Python client for GeometryServer"""
     
@@ -85,29 +101,28 @@ class GeometryClient:
         Get mesh data for a shape
         Returns: (vertices, normals, indices) as numpy arrays
         """
-        request = geometry_service_pb2.ShapeRequest(shape_id=shape_id)
+        request = geometry_service_pb2.ShapeRequest(
+            shape_id=shape_id,
+            mesh_options=geometry_types_pb2.MeshOptions(
+                encoding=geometry_types_pb2.MESH_ENCODING_PACKED_FLOAT32))
         response = self.stub.GetMeshData(request)
         
         # Convert to numpy arrays for easy use with visualization libraries
-        vertices = np.array([[v.x, v.y, v.z] for v in response.vertices], dtype=np.float32)
-        normals = np.array([[n.x, n.y, n.z] for n in response.normals], dtype=np.float32)
-        indices = np.array(response.indices, dtype=np.uint32)
-        
-        return vertices, normals, indices
+        return decode_mesh_arrays(response)
         
     def get_all_meshes(self) -> List[dict]:
         """
         Get all meshes using streaming
         Returns list of mesh dictionaries
         """
-        request = geometry_service_pb2.EmptyRequest()
+        request = geometry_service_pb2.MeshRequest(
+            mesh_options=geometry_types_pb2.MeshOptions(
+                encoding=geometry_types_pb2.MESH_ENCODING_PACKED_FLOAT32))
         meshes = []
         
         # Server streaming RPC
         for mesh_data in self.stub.GetAllMeshes(request):
-            vertices = np.array([[v.x, v.y, v.z] for v in mesh_data.vertices], dtype=np.float32)
-            normals = np.array([[n.x, n.y, n.z] for n in mesh_data.normals], dtype=np.float32)
-            indices = np.array(mesh_data.indices, dtype=np.uint32)
+            vertices, normals, indices = decode_mesh_arrays(mesh_data)
             
             meshes.append({
                 'shape_id': mesh_data.shape_id,
@@ -1,23 +1,84 @@
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 #include <spdlog/spdlog.h>
 
+#include "../../server/async_geometry_service.h"
 #include "../../server/geometry_service_impl.h"
+#include "../../server/metrics_exporter.h"
+#include "../../server/metrics_http_server.h"
+#include "../../server/rpc_metrics_interceptor.h"
+#include "../../server/stage_trace.h"
 
-void RunServer(const std::string& server_address) {
-    GeometryServiceImpl service;
+// gRPC's message compression algorithms; zstd is not among them
+grpc_compression_algorithm parseCompression(const std::string& name) {
+    if (name == "none") {
+        return GRPC_COMPRESS_NONE;
+    }
+    if (name == "deflate") {
+        return GRPC_COMPRESS_DEFLATE;
+    }
+    if (name == "gzip") {
+        return GRPC_COMPRESS_GZIP;
+    }
+    throw std::invalid_argument("Unknown compression: " + name);
+}
+
+void RunServer(const std::string& server_address, const GeometryServiceOptions& options) {
+    GeometryServiceImpl service(options);
+    std::unique_ptr<AsyncGeometryService> async_service;
 
     grpc::ServerBuilder builder;
     
     // Listen on the given address without any authentication mechanism
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
     
-    // Register "service" as the instance through which we'll communicate with
-    // clients. In this case it corresponds to a *synchronous* service.
-    builder.RegisterService(&service);
+    if (options.grpc_max_threads > 0) {
+        grpc::ResourceQuota quota("geometry_server");
+        quota.SetMaxThreads(options.grpc_max_threads);
+        builder.SetResourceQuota(quota);
+    }
+    
+    if (options.grpc_compression != GRPC_COMPRESS_NONE) {
+        builder.SetDefaultCompressionAlgorithm(options.grpc_compression);
+    }
+    
+    // Every RPC is timed into GrpcPerformanceMonitor
+    std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>> interceptors;
+    interceptors.push_back(std::make_unique<RpcMetricsInterceptorFactory>());
+    builder.experimental().SetInterceptorCreators(std::move(interceptors));
+    
+    // Register the service through which we'll communicate with clients. The
+    // synchronous service runs every RPC on a gRPC thread; the async front end
+    // moves heavy RPCs onto its own worker pool.
+    if (options.async_server) {
+        async_service = std::make_unique<AsyncGeometryService>(service, options);
+        builder.RegisterService(async_service.get());
+        spdlog::info("GeometryService running in async mode");
+    } else {
+        builder.RegisterService(&service);
+    }
+    
+    // Scrape endpoint for the interceptor's RPC metrics, stage timings and service gauges
+    MetricsExporter exporter(service);
+    MetricsHttpServer metrics_server;
+    if (!options.metrics_address.empty()) {
+        StageTrace::instance().setCapacity(options.trace_span_capacity);
+        metrics_server.addRoute("/metrics", "text/plain; version=0.0.4",
+                                [&exporter] { return exporter.prometheusText(); });
+        metrics_server.addRoute("/traces", "application/json",
+                                [] { return StageTrace::instance().chromeTraceJson(); });
+        if (!metrics_server.start(options.metrics_address)) {
+            throw std::runtime_error("Cannot serve metrics on " + options.metrics_address);
+        }
+        spdlog::info("Metrics on http://{}/metrics, stage traces on /traces", options.metrics_address);
+    }
     
     // Finally assemble the server
     std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
@@ -38,16 +99,71 @@ int main(int argc, char** argv) {
     
     // Default server address
     std::string server_address("0.0.0.0:50051");
+    GeometryServiceOptions options;
     
-    // Parse command line arguments
-    if (argc > 1) {
-        server_address = argv[1];
+    // Parse command line arguments: [address] [--mesh-cache-mb=N] [--serial-meshing]
+    // [--async] [--worker-threads=N] [--grpc-threads=N] [--max-meshing=N]
+    // [--max-imports=N] [--max-exports=N] [--max-queued=N] [--model-cache-dir=PATH]
+    // [--model-cache-mb=N] [--import-chunk-triangles=N] [--metrics-address=HOST:PORT]
+    // [--trace-spans=N] [--session-memory-quota-mb=N] [--memory-limit-mb=N]
+    // [--compression=none|deflate|gzip]
+    const std::vector<std::pair<std::string, size_t*>> size_flags = {
+        {"--worker-threads=", &options.worker_threads},
+        {"--max-meshing=", &options.max_concurrent_meshing},
+        {"--max-imports=", &options.max_concurrent_imports},
+        {"--max-exports=", &options.max_concurrent_exports},
+        {"--max-queued=", &options.max_queued_per_rpc},
+        {"--import-chunk-triangles=", &options.import_chunk_triangles},
+        {"--trace-spans=", &options.trace_span_capacity},
+    };
+    const std::string mesh_cache_flag = "--mesh-cache-mb=";
+    const std::string grpc_threads_flag = "--grpc-threads=";
+    const std::string model_cache_dir_flag = "--model-cache-dir=";
+    const std::string model_cache_flag = "--model-cache-mb=";
+    const std::string metrics_address_flag = "--metrics-address=";
+    const std::string session_quota_flag = "--session-memory-quota-mb=";
+    const std::string memory_limit_flag = "--memory-limit-mb=";
+    const std::string compression_flag = "--compression=";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto size_flag = std::find_if(size_flags.begin(), size_flags.end(),
+                                      [&arg](const auto& flag) { return arg.rfind(flag.first, 0) == 0; });
+        try {
+            if (size_flag != size_flags.end()) {
+                *size_flag->second = std::stoull(arg.substr(size_flag->first.size()));
+            } else if (arg.rfind(mesh_cache_flag, 0) == 0) {
+                options.mesh_cache_budget_bytes = std::stoull(arg.substr(mesh_cache_flag.size())) * 1024 * 1024;
+            } else if (arg.rfind(grpc_threads_flag, 0) == 0) {
+                options.grpc_max_threads = std::stoi(arg.substr(grpc_threads_flag.size()));
+            } else if (arg.rfind(model_cache_dir_flag, 0) == 0) {
+                options.model_cache_dir = arg.substr(model_cache_dir_flag.size());
+            } else if (arg.rfind(model_cache_flag, 0) == 0) {
+                options.model_cache_budget_bytes = std::stoull(arg.substr(model_cache_flag.size())) * 1024 * 1024;
+            } else if (arg.rfind(metrics_address_flag, 0) == 0) {
+                options.metrics_address = arg.substr(metrics_address_flag.size());
+            } else if (arg.rfind(session_quota_flag, 0) == 0) {
+                options.session_memory_quota_bytes = std::stoull(arg.substr(session_quota_flag.size())) * 1024 * 1024;
+            } else if (arg.rfind(memory_limit_flag, 0) == 0) {
+                options.memory_limit_bytes = std::stoull(arg.substr(memory_limit_flag.size())) * 1024 * 1024;
+            } else if (arg.rfind(compression_flag, 0) == 0) {
+                options.grpc_compression = parseCompression(arg.substr(compression_flag.size()));
+            } else if (arg == "--serial-meshing") {
+                options.parallel_meshing = false;
+            } else if (arg == "--async") {
+                options.async_server = true;
+            } else {
+                server_address = arg;
+            }
+        } catch (const std::exception&) {
+            spdlog::error("Invalid command line argument: {}", arg);
+            return 1;
+        }
     }
     
     spdlog::info("Server address: {}", server_address);
     
     try {
-        RunServer(server_address);
+        RunServer(server_address, options);
     } catch (const std::exception& e) {
         spdlog::error("Server error: {}", e.what());
         return 1;
@@ -0,0 +1,221 @@
+#include "load_generator.h"
+
+#include <algorithm>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+constexpr auto kStopPollInterval = std::chrono::milliseconds(100);
+
+} // namespace
+
+const char* loadOperationName(LoadOperation operation) {
+    switch (operation) {
+        case LoadOperation::Create: return "Create";
+        case LoadOperation::GetAllMeshes: return "GetAllMeshes";
+        case LoadOperation::Import: return "Import";
+        case LoadOperation::Export: return "Export";
+    }
+    return "Unknown";
+}
+
+LoadGenerator::LoadGenerator(LoadOptions options)
+    : options_(std::move(options))
+    , monitor_(std::make_unique<GeometryClient>(options_.server_address, "load-monitor"))
+    , created_(Clock::now())
+    , interval_(std::make_unique<Counters>())
+    , total_(std::make_unique<Counters>()) {
+    if (options_.import_files.empty()) {
+        options_.mix[static_cast<size_t>(LoadOperation::Import)] = 0;
+    }
+    if (!monitor_->Connect()) {
+        spdlog::warn("LoadGenerator: Monitor cannot connect to {}; server figures will be zero",
+                     options_.server_address);
+    }
+}
+
+LoadGenerator::~LoadGenerator() {
+    if (monitor_->IsConnected()) {
+        monitor_->DisconnectFromServer();
+    }
+}
+
+GeometryClient::SystemInfo LoadGenerator::serverInfo() {
+    if (!monitor_->IsConnected() && !monitor_->Connect()) {
+        return {};
+    }
+    return monitor_->GetSystemInfo();
+}
+
+bool LoadGenerator::runPhase(const std::string& phase, std::chrono::seconds duration,
+                             const std::function<void(const LoadSample&)>& on_sample) {
+    connected_ = 0;
+    const auto start = Clock::now();
+    const auto end = start + duration;
+    std::vector<std::thread> clients;
+    clients.reserve(options_.clients);
+    for (size_t i = 0; i < options_.clients; ++i) {
+        clients.emplace_back(&LoadGenerator::runClient, this, fmt::format("load-{}-{}", phase, i), i, start, end);
+    }
+
+    auto interval_start = start;
+    while (!stopRequested()) {
+        const auto report_at = std::min(interval_start + options_.report_interval, end);
+        while (!stopRequested() && Clock::now() < report_at) {
+            std::this_thread::sleep_for(std::min<Clock::duration>(kStopPollInterval, report_at - Clock::now()));
+        }
+        if (stopRequested() || report_at >= end) {
+            break;
+        }
+        on_sample(takeSample(phase, interval_start));
+        interval_start = report_at;
+    }
+
+    for (auto& client : clients) {
+        client.join();
+    }
+    on_sample(takeSample(phase, interval_start));
+    return connected_ > 0;
+}
+
+void LoadGenerator::runClient(const std::string& client_id, size_t index, Clock::time_point start,
+                              Clock::time_point end) {
+    GeometryClient client(options_.server_address, client_id);
+    if (!client.Connect()) {
+        spdlog::error("LoadGenerator: {} cannot connect to {}", client_id, options_.server_address);
+        return;
+    }
+    ++connected_;
+
+    std::mt19937 rng(static_cast<uint32_t>(std::hash<std::string>{}(client_id)));
+    std::discrete_distribution<size_t> pick(options_.mix.begin(), options_.mix.end());
+    std::vector<std::string> shapes;
+    std::vector<GeometryClient::MeshData> meshes;  // Refilled by every GetAllMeshes, as a viewer would
+
+    // Open-loop pacing: each client owns every clients-th slot of the target rate,
+    // offset so the clients' slots interleave
+    const bool paced = options_.target_rate > 0.0;
+    const auto period = paced ? std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<double>(options_.clients / options_.target_rate))
+                              : Clock::duration::zero();
+    auto due = start + period * static_cast<Clock::rep>(index) /
+                           static_cast<Clock::rep>(std::max<size_t>(options_.clients, 1));
+
+    while (!stopRequested()) {
+        if (paced) {
+            if (due >= end) {
+                break;
+            }
+            std::this_thread::sleep_until(due);
+        } else {
+            due = Clock::now();
+            if (due >= end) {
+                break;
+            }
+        }
+        if (shapes.size() >= options_.max_shapes_per_client) {
+            client.ClearAll();
+            shapes.clear();
+        }
+
+        auto operation = static_cast<LoadOperation>(pick(rng));
+        if (operation == LoadOperation::Export && shapes.empty()) {
+            operation = LoadOperation::Create;  // Nothing to export yet
+        }
+        const bool ok = execute(client, operation, shapes, meshes, rng);
+        record(operation, Clock::now() - due, ok);
+        due += period;
+    }
+
+    client.DisconnectFromServer();
+}
+
+bool LoadGenerator::execute(GeometryClient& client, LoadOperation operation, std::vector<std::string>& shapes,
+                            std::vector<GeometryClient::MeshData>& meshes, std::mt19937& rng) {
+    std::uniform_real_distribution<double> position(-100.0, 100.0);
+    std::uniform_real_distribution<double> size(5.0, 20.0);
+    switch (operation) {
+        case LoadOperation::Create: {
+            const double x = position(rng), y = position(rng), z = position(rng);
+            std::string shape_id;
+            switch (std::uniform_int_distribution<int>(0, 3)(rng)) {
+                case 0: shape_id = client.CreateBox(x, y, z, size(rng), size(rng), size(rng)); break;
+                case 1: shape_id = client.CreateSphere(x, y, z, size(rng)); break;
+                case 2: shape_id = client.CreateCone(x, y, z, size(rng), size(rng) * 0.5, size(rng)); break;
+                default: shape_id = client.CreateCylinder(x, y, z, size(rng), size(rng)); break;
+            }
+            if (shape_id.empty()) {
+                return false;
+            }
+            shapes.push_back(std::move(shape_id));
+            return true;
+        }
+        case LoadOperation::GetAllMeshes: {
+            // An empty result for a non-empty scene is a failed stream
+            return client.GetAllMeshes(meshes) && (!meshes.empty() || shapes.empty());
+        }
+        case LoadOperation::Import: {
+            std::uniform_int_distribution<size_t> file(0, options_.import_files.size() - 1);
+            auto result = client.ImportModelFile(options_.import_files[file(rng)]);
+            shapes.insert(shapes.end(), result.shape_ids.begin(), result.shape_ids.end());
+            return result.success;
+        }
+        case LoadOperation::Export: {
+            const size_t count = std::min(options_.export_shapes, shapes.size());
+            std::vector<std::string> exported(shapes.end() - static_cast<std::ptrdiff_t>(count), shapes.end());
+            return client.ExportModelFile(exported).success;
+        }
+    }
+    return false;
+}
+
+void LoadGenerator::record(LoadOperation operation, Clock::duration latency, bool ok) {
+    const auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(
+        0, std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+    for (Counters* counters : {interval_.get(), total_.get()}) {
+        auto& operation_counters = (*counters)[static_cast<size_t>(operation)];
+        (ok ? operation_counters.ok : operation_counters.failed).fetch_add(1, std::memory_order_relaxed);
+        operation_counters.latency.record(nanoseconds);
+    }
+}
+
+OperationReport LoadGenerator::report(const OperationCounters& counters) {
+    OperationReport report;
+    report.ok = counters.ok.load(std::memory_order_relaxed);
+    report.failed = counters.failed.load(std::memory_order_relaxed);
+    if (report.ok + report.failed > 0) {
+        const auto quantiles = counters.latency.quantiles({0.5, 0.99, 0.999, 1.0});
+        report.p50_ms = quantiles[0] / 1e6;
+        report.p99_ms = quantiles[1] / 1e6;
+        report.p999_ms = quantiles[2] / 1e6;
+        report.max_ms = quantiles[3] / 1e6;
+    }
+    return report;
+}
+
+LoadSample LoadGenerator::takeSample(const std::string& phase, Clock::time_point interval_start) {
+    const auto now = Clock::now();
+    LoadSample sample;
+    sample.phase = phase;
+    sample.elapsed_seconds = std::chrono::duration<double>(now - created_).count();
+    sample.interval_seconds = std::chrono::duration<double>(now - interval_start).count();
+    for (size_t i = 0; i < kLoadOperationCount; ++i) {
+        auto& counters = (*interval_)[i];
+        sample.operations[i] = report(counters);
+        counters.ok.fetch_sub(sample.operations[i].ok, std::memory_order_relaxed);
+        counters.failed.fetch_sub(sample.operations[i].failed, std::memory_order_relaxed);
+        counters.latency.reset();
+    }
+    sample.server = serverInfo();
+    return sample;
+}
+
+std::array<OperationReport, kLoadOperationCount> LoadGenerator::totals() const {
+    std::array<OperationReport, kLoadOperationCount> totals;
+    for (size_t i = 0; i < kLoadOperationCount; ++i) {
+        totals[i] = report((*total_)[i]);
+    }
+    return totals;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "client/grpc/geometry_client.h"
+#include "common/grpc_performance_monitor.h"
+
+enum class LoadOperation { Create, GetAllMeshes, Import, Export };
+constexpr size_t kLoadOperationCount = 4;
+const char* loadOperationName(LoadOperation operation);
+
+struct LoadOptions {
+    std::string server_address{"localhost:50051"};
+    size_t clients{8};
+    // Operations per second across all clients, paced open-loop so a slow server
+    // shows up as latency; 0 runs every client back to back
+    double target_rate{0.0};
+    std::array<unsigned, kLoadOperationCount> mix{50, 30, 10, 10};  // Relative weights, by LoadOperation
+    std::vector<std::string> import_files;  // Paths on the server; none disables Import
+    size_t max_shapes_per_client{200};      // A client clears its scene on reaching this
+    size_t export_shapes{8};                // Most recent shapes per ExportModelFile
+    std::chrono::seconds report_interval{5};
+};
+
+// Counts and latency percentiles of one operation, over an interval or the whole run.
+// Latency runs from when the operation was due, not when it was sent.
+struct OperationReport {
+    uint64_t ok{0};
+    uint64_t failed{0};
+    double p50_ms{0.0};
+    double p99_ms{0.0};
+    double p999_ms{0.0};
+    double max_ms{0.0};
+};
+
+struct LoadSample {
+    std::string phase;
+    double elapsed_seconds{0.0};   // Since the generator was created
+    double interval_seconds{0.0};
+    std::array<OperationReport, kLoadOperationCount> operations;  // This interval
+    GeometryClient::SystemInfo server;                            // Sampled at the end of the interval
+};
+
+// Drives concurrent GeometryClient sessions against one server with a weighted
+// mix of operations, sampling throughput, tail latency and server-wide sessions,
+// shapes and RSS through a monitor session of its own.
+class LoadGenerator {
+public:
+    explicit LoadGenerator(LoadOptions options);
+    ~LoadGenerator();
+
+    // Runs options.clients clients with fresh sessions for duration, calling on_sample
+    // every report interval and once at the end. Clients disconnect their sessions
+    // when the phase ends. Returns false if no client could connect.
+    bool runPhase(const std::string& phase, std::chrono::seconds duration,
+                  const std::function<void(const LoadSample&)>& on_sample);
+
+    // Ends the running phase early; safe to call from a signal handler
+    void requestStop() { stopping_.store(true, std::memory_order_relaxed); }
+    bool stopRequested() const { return stopping_.load(std::memory_order_relaxed); }
+
+    std::array<OperationReport, kLoadOperationCount> totals() const;
+    GeometryClient::SystemInfo serverInfo();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct OperationCounters {
+        std::atomic<uint64_t> ok{0};
+        std::atomic<uint64_t> failed{0};
+        GrpcPerformanceMonitor::LatencyHistogram latency;
+    };
+    using Counters = std::array<OperationCounters, kLoadOperationCount>;
+
+    void runClient(const std::string& client_id, size_t index, Clock::time_point start, Clock::time_point end);
+    bool execute(GeometryClient& client, LoadOperation operation, std::vector<std::string>& shapes,
+                 std::vector<GeometryClient::MeshData>& meshes, std::mt19937& rng);
+    void record(LoadOperation operation, Clock::duration latency, bool ok);
+    static OperationReport report(const OperationCounters& counters);
+    LoadSample takeSample(const std::string& phase, Clock::time_point interval_start);
+
+    LoadOptions options_;
+    std::unique_ptr<GeometryClient> monitor_;
+    Clock::time_point created_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> connected_{0};
+    // Interval counters are drained by each sample; records racing the drain may
+    // land in the next interval
+    std::unique_ptr<Counters> interval_;
+    std::unique_ptr<Counters> total_;
+};
@@ -0,0 +1,277 @@
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <csignal>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "load_generator.h"
+
+namespace {
+
+LoadGenerator* running_generator = nullptr;
+
+void onInterrupt(int) {
+    if (running_generator) {
+        running_generator->requestStop();
+    }
+}
+
+struct SoakOptions {
+    bool enabled{false};
+    std::chrono::seconds cycle{600};
+    std::chrono::seconds settle{5};  // After a cycle, before checking the server
+    size_t warmup_cycles{2};         // Cycles before the RSS reference is taken
+    double max_rss_growth_mb{64.0};  // Allowed RSS growth over the reference
+};
+
+double megabytes(uint64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+// "create:50,meshes:30,import:10,export:10"; operations left out get weight 0
+bool parseMix(const std::string& text, std::array<unsigned, kLoadOperationCount>& mix) {
+    const std::vector<std::pair<std::string, LoadOperation>> names = {
+        {"create", LoadOperation::Create},
+        {"meshes", LoadOperation::GetAllMeshes},
+        {"import", LoadOperation::Import},
+        {"export", LoadOperation::Export},
+    };
+    mix.fill(0);
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        const size_t colon = item.find(':');
+        auto name = std::find_if(names.begin(), names.end(),
+                                 [&](const auto& entry) { return item.substr(0, colon) == entry.first; });
+        if (colon == std::string::npos || name == names.end()) {
+            return false;
+        }
+        mix[static_cast<size_t>(name->second)] = static_cast<unsigned>(std::stoul(item.substr(colon + 1)));
+    }
+    return true;
+}
+
+void printSample(const LoadSample& sample) {
+    uint64_t ok = 0;
+    uint64_t failed = 0;
+    std::string operations;
+    for (size_t i = 0; i < kLoadOperationCount; ++i) {
+        const auto& operation = sample.operations[i];
+        ok += operation.ok;
+        failed += operation.failed;
+        if (operation.ok + operation.failed > 0) {
+            operations += fmt::format(" | {} {:.1f}/s p50 {:.1f} p99 {:.1f} ms",
+                                      loadOperationName(static_cast<LoadOperation>(i)),
+                                      (operation.ok + operation.failed) / sample.interval_seconds, operation.p50_ms,
+                                      operation.p99_ms);
+        }
+    }
+    fmt::print("[{:>6.0f}s {}] {:.1f} ops/s, {} failed{} | server RSS {:.1f} MB, {} sessions, {} shapes\n",
+               sample.elapsed_seconds, sample.phase, (ok + failed) / std::max(sample.interval_seconds, 1e-9),
+               failed, operations, megabytes(sample.server.resident_memory_bytes), sample.server.active_sessions,
+               sample.server.total_shapes);
+}
+
+// One row per operation per sample
+void writeCsv(std::ofstream& csv, const LoadSample& sample) {
+    for (size_t i = 0; i < kLoadOperationCount; ++i) {
+        const auto& operation = sample.operations[i];
+        csv << fmt::format("{:.3f},{},{},{:.3f},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{},{},{}\n",
+                           sample.elapsed_seconds, sample.phase, loadOperationName(static_cast<LoadOperation>(i)),
+                           sample.interval_seconds, operation.ok, operation.failed, operation.p50_ms,
+                           operation.p99_ms, operation.p999_ms, operation.max_ms,
+                           sample.server.resident_memory_bytes, sample.server.active_sessions,
+                           sample.server.total_shapes);
+    }
+    csv.flush();
+}
+
+void printTotals(const LoadGenerator& generator, double seconds) {
+    fmt::print("Totals over {:.0f}s:\n", seconds);
+    const auto totals = generator.totals();
+    for (size_t i = 0; i < kLoadOperationCount; ++i) {
+        const auto& operation = totals[i];
+        if (operation.ok + operation.failed == 0) {
+            continue;
+        }
+        fmt::print("  {:<13} {:>9} ok {:>6} failed {:>9.1f}/s  p50 {:.2f}  p99 {:.2f}  p99.9 {:.2f}  max {:.2f} ms\n",
+                   loadOperationName(static_cast<LoadOperation>(i)), operation.ok, operation.failed,
+                   (operation.ok + operation.failed) / seconds, operation.p50_ms, operation.p99_ms,
+                   operation.p999_ms, operation.max_ms);
+    }
+}
+
+// Cycles fresh sessions through the server and checks after each cycle that
+// they were all cleaned up and that RSS settles instead of growing cycle by cycle
+bool runSoak(LoadGenerator& generator, std::chrono::seconds duration, const SoakOptions& soak,
+             const std::function<void(const LoadSample&)>& on_sample) {
+    const auto baseline = generator.serverInfo();  // The monitor session, plus anyone else's
+    const auto end = std::chrono::steady_clock::now() + duration;
+    uint64_t reference_rss = 0;
+    bool healthy = true;
+    for (size_t cycle = 1; !generator.stopRequested() && std::chrono::steady_clock::now() < end; ++cycle) {
+        if (!generator.runPhase(fmt::format("c{}", cycle), soak.cycle, on_sample)) {
+            spdlog::error("Soak: No client connected in cycle {}", cycle);
+            return false;
+        }
+        std::this_thread::sleep_for(soak.settle);
+
+        const auto info = generator.serverInfo();
+        const int64_t leaked_sessions =
+            static_cast<int64_t>(info.active_sessions) - static_cast<int64_t>(baseline.active_sessions);
+        const int64_t leaked_shapes =
+            static_cast<int64_t>(info.total_shapes) - static_cast<int64_t>(baseline.total_shapes);
+        if (cycle == soak.warmup_cycles) {
+            reference_rss = info.resident_memory_bytes;
+        }
+        const double growth_mb = reference_rss > 0 ? megabytes(info.resident_memory_bytes) - megabytes(reference_rss)
+                                                   : 0.0;
+        fmt::print("Soak cycle {}: server RSS {:.1f} MB ({:+.1f} MB over cycle {}), {} sessions and {} shapes "
+                   "left over\n",
+                   cycle, megabytes(info.resident_memory_bytes), growth_mb, soak.warmup_cycles, leaked_sessions,
+                   leaked_shapes);
+        if (leaked_sessions > 0 || leaked_shapes > 0) {
+            spdlog::error("Soak: Cycle {} left {} sessions and {} shapes behind", cycle, leaked_sessions,
+                          leaked_shapes);
+            healthy = false;
+        }
+        if (growth_mb > soak.max_rss_growth_mb) {
+            spdlog::error("Soak: Server RSS grew {:.1f} MB since cycle {}, over the {:.1f} MB limit", growth_mb,
+                          soak.warmup_cycles, soak.max_rss_growth_mb);
+            healthy = false;
+        }
+    }
+    return healthy;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] %v");
+
+    LoadOptions options;
+    SoakOptions soak;
+    std::chrono::seconds duration{60};
+    std::string csv_path;
+    bool verbose = false;
+
+    // Parse command line arguments: [address] [--clients=N] [--rate=OPS] [--duration=S]
+    // [--report-interval=S] [--mix=create:W,meshes:W,import:W,export:W] [--import-file=PATH]...
+    // [--max-shapes=N] [--export-shapes=N] [--csv=PATH] [--soak] [--cycle=S] [--settle=S]
+    // [--warmup-cycles=N] [--max-rss-growth-mb=N] [--verbose]
+    const std::vector<std::pair<std::string, size_t*>> size_flags = {
+        {"--clients=", &options.clients},
+        {"--max-shapes=", &options.max_shapes_per_client},
+        {"--export-shapes=", &options.export_shapes},
+        {"--warmup-cycles=", &soak.warmup_cycles},
+    };
+    const std::vector<std::pair<std::string, std::chrono::seconds*>> seconds_flags = {
+        {"--duration=", &duration},
+        {"--report-interval=", &options.report_interval},
+        {"--cycle=", &soak.cycle},
+        {"--settle=", &soak.settle},
+    };
+    const std::string rate_flag = "--rate=";
+    const std::string mix_flag = "--mix=";
+    const std::string import_flag = "--import-file=";
+    const std::string csv_flag = "--csv=";
+    const std::string rss_growth_flag = "--max-rss-growth-mb=";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto size_flag = std::find_if(size_flags.begin(), size_flags.end(),
+                                      [&arg](const auto& flag) { return arg.rfind(flag.first, 0) == 0; });
+        auto seconds_flag = std::find_if(seconds_flags.begin(), seconds_flags.end(),
+                                         [&arg](const auto& flag) { return arg.rfind(flag.first, 0) == 0; });
+        try {
+            if (size_flag != size_flags.end()) {
+                *size_flag->second = std::stoull(arg.substr(size_flag->first.size()));
+            } else if (seconds_flag != seconds_flags.end()) {
+                *seconds_flag->second = std::chrono::seconds(std::stoll(arg.substr(seconds_flag->first.size())));
+            } else if (arg.rfind(rate_flag, 0) == 0) {
+                options.target_rate = std::stod(arg.substr(rate_flag.size()));
+            } else if (arg.rfind(mix_flag, 0) == 0) {
+                if (!parseMix(arg.substr(mix_flag.size()), options.mix)) {
+                    throw std::invalid_argument(arg);
+                }
+            } else if (arg.rfind(import_flag, 0) == 0) {
+                options.import_files.push_back(arg.substr(import_flag.size()));
+            } else if (arg.rfind(csv_flag, 0) == 0) {
+                csv_path = arg.substr(csv_flag.size());
+            } else if (arg.rfind(rss_growth_flag, 0) == 0) {
+                soak.max_rss_growth_mb = std::stod(arg.substr(rss_growth_flag.size()));
+            } else if (arg == "--soak") {
+                soak.enabled = true;
+            } else if (arg == "--verbose") {
+                verbose = true;
+            } else if (arg.rfind("--", 0) == 0) {
+                throw std::invalid_argument(arg);
+            } else {
+                options.server_address = arg;
+            }
+        } catch (const std::exception&) {
+            spdlog::error("Invalid command line argument: {}", arg);
+            return 1;
+        }
+    }
+    // Client logging per RPC would swamp the report lines
+    spdlog::set_level(verbose ? spdlog::level::info : spdlog::level::warn);
+
+    unsigned total_weight = 0;
+    for (size_t i = 0; i < kLoadOperationCount; ++i) {
+        const bool runnable = i != static_cast<size_t>(LoadOperation::Import) || !options.import_files.empty();
+        total_weight += runnable ? options.mix[i] : 0;
+    }
+    if (total_weight == 0) {
+        spdlog::error("--mix leaves no operation to run");
+        return 1;
+    }
+
+    if (options.clients == 0 || options.report_interval.count() <= 0) {
+        spdlog::error("--clients and --report-interval must be positive");
+        return 1;
+    }
+    if (options.import_files.empty() && options.mix[static_cast<size_t>(LoadOperation::Import)] > 0) {
+        spdlog::warn("No --import-file given; the mix runs without imports");
+    }
+
+    LoadGenerator generator(options);
+    std::ofstream csv;
+    if (!csv_path.empty()) {
+        csv.open(csv_path);
+        if (!csv) {
+            spdlog::error("Cannot write {}", csv_path);
+            return 1;
+        }
+        csv << "elapsed_s,phase,operation,interval_s,ok,failed,p50_ms,p99_ms,p999_ms,max_ms,"
+               "server_rss_bytes,server_sessions,server_shapes\n";
+    }
+    auto on_sample = [&](const LoadSample& sample) {
+        printSample(sample);
+        if (csv.is_open()) {
+            writeCsv(csv, sample);
+        }
+    };
+
+    running_generator = &generator;
+    std::signal(SIGINT, onInterrupt);
+    std::signal(SIGTERM, onInterrupt);
+
+    const auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    if (soak.enabled) {
+        ok = runSoak(generator, duration, soak, on_sample);
+    } else {
+        ok = generator.runPhase("load", duration, on_sample);
+        if (!ok) {
+            spdlog::error("No client could connect to {}", options.server_address);
+        }
+    }
+    printTotals(generator, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    running_generator = nullptr;
+    return ok ? 0 : 1;
+}
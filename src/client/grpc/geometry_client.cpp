@@ -1,10 +1,93 @@
 #include "geometry_client.h"
 #include "../../common/grpc_performance_monitor.h"
+#include "../../common/mesh_codec.h"
+#include "../../common/utils.h"
 #include <spdlog/spdlog.h>
+#include <algorithm>
 #include <chrono>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// Packed mesh buffers are defined as little-endian on the wire
+static_assert(std::endian::native == std::endian::little,
+              "Packed mesh decoding assumes a little-endian host");
+
+// Decode a packed xyz buffer into float triplets; float32 payloads are a single memcpy
+bool decodePackedVec3(const std::string& bytes, uint32_t count, geometry::MeshEncoding encoding,
+                      std::vector<float>& out) {
+    const size_t scalars = static_cast<size_t>(count) * 3;
+    if (encoding == geometry::MESH_ENCODING_PACKED_FLOAT32) {
+        if (bytes.size() != scalars * sizeof(float)) {
+            return false;
+        }
+        out.resize(scalars);
+        std::memcpy(out.data(), bytes.data(), bytes.size());
+        return true;
+    }
+    if (encoding == geometry::MESH_ENCODING_PACKED_FLOAT64) {
+        if (bytes.size() != scalars * sizeof(double)) {
+            return false;
+        }
+        out.resize(scalars);
+        const char* src = bytes.data();
+        for (size_t i = 0; i < scalars; ++i, src += sizeof(double)) {
+            double value;
+            std::memcpy(&value, src, sizeof(double));
+            out[i] = static_cast<float>(value);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Attempts per chunked transfer before giving up
+constexpr int kMaxTransferAttempts = 3;
+
+void fillImportResult(const geometry::ModelImportResponse& response, GeometryClient::ModelImportResult& result) {
+    result.success = response.success();
+    result.message = response.message();
+    result.detected_format = response.detected_format();
+    result.shape_ids.assign(response.shape_ids().begin(), response.shape_ids().end());
+    if (response.has_file_info()) {
+        const auto& file_info = response.file_info();
+        result.filename = file_info.filename();
+        result.file_size = file_info.file_size();
+        result.shape_count = file_info.shape_count();
+        result.format = file_info.format();
+        result.creation_time = file_info.creation_time();
+    }
+}
+
+// Publishes a streaming call's context so another thread can cancel it, and
+// unregisters it before the context goes away, however the call ends
+class ScopedStreamRegistration {
+public:
+    ScopedStreamRegistration(std::mutex& mutex, grpc::ClientContext*& slot, grpc::ClientContext& context)
+        : mutex_(mutex), slot_(slot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot_ = &context;
+    }
+    ~ScopedStreamRegistration() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slot_ = nullptr;
+    }
+    ScopedStreamRegistration(const ScopedStreamRegistration&) = delete;
+    ScopedStreamRegistration& operator=(const ScopedStreamRegistration&) = delete;
+
+private:
+    std::mutex& mutex_;
+    grpc::ClientContext*& slot_;
+};
+
+} // namespace
 
 GeometryClient::GeometryClient(const std::string& server_address, const std::string& client_id) 
     : server_address_(server_address), client_id_(client_id), connected_(false) {
+    mesh_options_.set_encoding(geometry::MESH_ENCODING_PACKED_FLOAT32);
     spdlog::info("GeometryClient: Initializing client '{}' for server: {}", client_id_, server_address_);
 }
 
@@ -23,7 +106,9 @@ bool GeometryClient::Connect() {
     try {
         spdlog::info("GeometryClient: Connecting to server: {}", server_address_);
         
-        channel_ = grpc::CreateChannel(server_address_, grpc::InsecureChannelCredentials());
+        grpc::ChannelArguments channel_args;
+        channel_args.SetCompressionAlgorithm(channel_compression_);
+        channel_ = grpc::CreateCustomChannel(server_address_, grpc::InsecureChannelCredentials(), channel_args);
         stub_ = geometry::GeometryService::NewStub(channel_);
         
         // Test connection with GetSystemInfo (with timeout)
@@ -79,6 +164,8 @@ void GeometryClient::Disconnect() {
     if (connected_) {
         spdlog::info("GeometryClient: Disconnecting from server");
         try {
+            StopSceneSubscription();
+            
             // Notify server before disconnecting
             DisconnectFromServer();
             
@@ -295,6 +382,15 @@ GeometryClient::SystemInfo GeometryClient::GetSystemInfo() {
             info.version = response.version();
             info.active_shapes = response.active_shapes();
             info.occt_version = response.occt_version();
+            info.active_sessions = response.active_sessions();
+            info.total_shapes = response.total_shapes();
+            info.resident_memory_bytes = response.resident_memory_bytes();
+            info.session_brep_bytes = response.session_brep_bytes();
+            info.session_triangulation_bytes = response.session_triangulation_bytes();
+            info.session_mesh_cache_bytes = response.session_mesh_cache_bytes();
+            info.session_memory_quota_bytes = response.session_memory_quota_bytes();
+            info.accounted_memory_bytes = response.accounted_memory_bytes();
+            info.memory_limit_bytes = response.memory_limit_bytes();
             spdlog::info("GeometryClient::GetSystemInfo: Server version: {}, Active shapes: {}, OCCT: {}", 
                         info.version, info.active_shapes, info.occt_version);
         } else {
@@ -408,47 +504,243 @@ std::string GeometryClient::CreateCylinder(double x, double y, double z, double
 }
 
 bool GeometryClient::DeleteShape(const std::string& shape_id) {
-    spdlog::warn("GeometryClient::DeleteShape: Not implemented yet");
-    return false;
+    GRPC_PERF_TIMER("DeleteShape");
+    
+    if (!connected_) {
+        spdlog::error("GeometryClient::DeleteShape: Not connected to server");
+        return false;
+    }
+    
+    try {
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+        geometry::StatusResponse response;
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        grpc::Status status = stub_->DeleteShape(&context, request, &response);
+        
+        if (status.ok() && response.success()) {
+            spdlog::info("GeometryClient::DeleteShape: Deleted shape: {}", shape_id);
+            return true;
+        } else {
+            spdlog::error("GeometryClient::DeleteShape: Failed - {}", 
+                         status.ok() ? response.message() : status.error_message());
+            return false;
+        }
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::DeleteShape: Exception: {}", e.what());
+        return false;
+    }
 }
 
 bool GeometryClient::SetShapeColor(const std::string& shape_id, double r, double g, double b) {
-    spdlog::warn("GeometryClient::SetShapeColor: Not implemented yet");
-    return false;
+    GRPC_PERF_TIMER("SetShapeColor");
+    
+    if (!connected_) {
+        spdlog::error("GeometryClient::SetShapeColor: Not connected to server");
+        return false;
+    }
+    
+    try {
+        geometry::ColorRequest request;
+        request.set_shape_id(shape_id);
+        *request.mutable_color() = CreateColor(r, g, b);
+        geometry::StatusResponse response;
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        grpc::Status status = stub_->SetShapeColor(&context, request, &response);
+        
+        if (status.ok() && response.success()) {
+            spdlog::info("GeometryClient::SetShapeColor: Updated color of shape: {}", shape_id);
+            return true;
+        } else {
+            spdlog::error("GeometryClient::SetShapeColor: Failed - {}", 
+                         status.ok() ? response.message() : status.error_message());
+            return false;
+        }
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::SetShapeColor: Exception: {}", e.what());
+        return false;
+    }
 }
 
-std::vector<GeometryClient::MeshData> GeometryClient::GetAllMeshes() {
-    auto _perf_timer = GrpcPerformanceMonitor::getInstance().createTimer("GetAllMeshes");
+namespace {
+
+void setPoint(geometry::Point3D* point, double x, double y, double z) {
+    point->set_x(x);
+    point->set_y(y);
+    point->set_z(z);
+}
+
+void setColor(geometry::Color* color, double r, double g, double b, double a = 1.0) {
+    color->set_r(r);
+    color->set_g(g);
+    color->set_b(b);
+    color->set_a(a);
+}
+
+} // namespace
+
+GeometryClient::Batch& GeometryClient::Batch::CreateBox(double x, double y, double z,
+                                                        double width, double height, double depth,
+                                                        double r, double g, double b) {
+    auto* box = request_.add_operations()->mutable_create_box();
+    setPoint(box->mutable_position(), x, y, z);
+    box->set_width(width);
+    box->set_height(height);
+    box->set_depth(depth);
+    setColor(box->mutable_color(), r, g, b);
+    return *this;
+}
+
+GeometryClient::Batch& GeometryClient::Batch::CreateCone(double x, double y, double z,
+                                                         double base_radius, double top_radius, double height,
+                                                         double r, double g, double b) {
+    auto* cone = request_.add_operations()->mutable_create_cone();
+    setPoint(cone->mutable_position(), x, y, z);
+    cone->mutable_axis()->set_z(1.0);  // Default Z-axis
+    cone->set_base_radius(base_radius);
+    cone->set_top_radius(top_radius);
+    cone->set_height(height);
+    setColor(cone->mutable_color(), r, g, b);
+    return *this;
+}
+
+GeometryClient::Batch& GeometryClient::Batch::CreateSphere(double x, double y, double z, double radius,
+                                                           double r, double g, double b) {
+    auto* sphere = request_.add_operations()->mutable_create_sphere();
+    setPoint(sphere->mutable_center(), x, y, z);
+    sphere->set_radius(radius);
+    setColor(sphere->mutable_color(), r, g, b);
+    return *this;
+}
+
+GeometryClient::Batch& GeometryClient::Batch::CreateCylinder(double x, double y, double z,
+                                                             double radius, double height,
+                                                             double r, double g, double b) {
+    auto* cylinder = request_.add_operations()->mutable_create_cylinder();
+    setPoint(cylinder->mutable_position(), x, y, z);
+    cylinder->mutable_axis()->set_z(1.0);
+    cylinder->set_radius(radius);
+    cylinder->set_height(height);
+    setColor(cylinder->mutable_color(), r, g, b);
+    return *this;
+}
+
+GeometryClient::Batch& GeometryClient::Batch::Transform(const std::string& shape_id,
+                                                        const std::array<double, 16>& row_major_matrix) {
+    auto* transform = request_.add_operations()->mutable_transform();
+    transform->set_shape_id(shape_id);
+    auto* matrix = transform->mutable_transform()->mutable_matrix();
+    matrix->Add(row_major_matrix.begin(), row_major_matrix.end());
+    return *this;
+}
+
+GeometryClient::Batch& GeometryClient::Batch::SetColor(const std::string& shape_id,
+                                                       double r, double g, double b, double a) {
+    auto* color = request_.add_operations()->mutable_set_color();
+    color->set_shape_id(shape_id);
+    setColor(color->mutable_color(), r, g, b, a);
+    return *this;
+}
+
+GeometryClient::Batch& GeometryClient::Batch::Delete(const std::string& shape_id) {
+    request_.add_operations()->mutable_delete_shape()->set_shape_id(shape_id);
+    return *this;
+}
+
+GeometryClient::BatchResult GeometryClient::ExecuteBatch(const Batch& batch, bool transactional) {
+    GRPC_PERF_TIMER("ExecuteBatch");
+    
+    BatchResult result;
+    if (!connected_) {
+        result.message = "Not connected to server";
+        spdlog::error("GeometryClient::ExecuteBatch: {}", result.message);
+        return result;
+    }
     
+    try {
+        geometry::BatchRequest request = batch.request_;
+        request.set_transactional(transactional);
+        geometry::BatchResponse response;
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        grpc::Status status = stub_->ExecuteBatch(&context, request, &response);
+        if (!status.ok()) {
+            result.message = FormatGrpcError(status, "ExecuteBatch");
+            spdlog::error("GeometryClient::ExecuteBatch: {}", result.message);
+            return result;
+        }
+        
+        result.success = response.success();
+        result.applied = response.applied();
+        result.message = response.message();
+        result.operations.reserve(response.results_size());
+        for (const auto& op : response.results()) {
+            result.operations.push_back({op.success(), op.message(), op.shape_id()});
+        }
+        
+        if (result.success) {
+            spdlog::info("GeometryClient::ExecuteBatch: {}", result.message);
+        } else {
+            spdlog::warn("GeometryClient::ExecuteBatch: {}", result.message);
+        }
+    } catch (const std::exception& e) {
+        result.message = e.what();
+        spdlog::error("GeometryClient::ExecuteBatch: Exception: {}", e.what());
+    }
+    return result;
+}
+
+std::vector<GeometryClient::MeshData> GeometryClient::GetAllMeshes() {
     std::vector<MeshData> meshes;
+    GetAllMeshes(meshes);
+    return meshes;
+}
+
+bool GeometryClient::GetAllMeshes(std::vector<MeshData>& meshes) {
+    GRPC_PERF_TIMER("GetAllMeshes");
+    
+    size_t received = 0;
     size_t total_bytes_received = 0;
+    bool success = false;
     
     if (!connected_) {
         spdlog::error("GeometryClient::GetAllMeshes: Not connected to server");
-        return meshes;
+        meshes.clear();
+        return false;
     }
     
     try {
-        geometry::EmptyRequest request;
+        geometry::MeshRequest request;
+        *request.mutable_mesh_options() = mesh_options_;
+        request.set_triangle_budget(mesh_triangle_budget_);
         grpc::ClientContext context;
         AddClientMetadata(context);
         
         std::unique_ptr<grpc::ClientReader<geometry::MeshData>> reader = 
             stub_->GetAllMeshes(&context, request);
         
+        // Read() reuses the message's repeated fields and the conversion reuses the
+        // previous call's buffers, so a refresh of an unchanged scene allocates little
         geometry::MeshData proto_mesh;
         while (reader->Read(&proto_mesh)) {
-            // Calculate approximate bytes received for this mesh
-            size_t mesh_bytes = proto_mesh.vertices_size() * sizeof(float) + 
-                               proto_mesh.indices_size() * sizeof(int32_t) + 
-                               proto_mesh.normals_size() * sizeof(float) +
-                               proto_mesh.shape_id().size() + 16; // overhead
+            // Serialized size of this mesh message
+            size_t mesh_bytes = proto_mesh.ByteSizeLong();
             total_bytes_received += mesh_bytes;
             
-            MeshData mesh_data = ConvertProtoMesh(proto_mesh);
+            if (received == meshes.size()) {
+                meshes.emplace_back();
+            }
+            MeshData& mesh_data = meshes[received++];
+            ConvertProtoMesh(proto_mesh, mesh_data);
             spdlog::info("GeometryClient::GetAllMeshes: Received mesh for shape: {} ({} vertices, ~{} bytes)", 
                         mesh_data.shape_id, mesh_data.vertices.size() / 3, mesh_bytes);
-            meshes.push_back(std::move(mesh_data));
         }
         
         grpc::Status status = reader->Finish();
@@ -456,22 +748,203 @@ std::vector<GeometryClient::MeshData> GeometryClient::GetAllMeshes() {
             std::string error_msg = FormatGrpcError(status, "GetAllMeshes");
             spdlog::error("GeometryClient::GetAllMeshes: {}", error_msg);
             // Clear partially received data on error to maintain consistency
-            meshes.clear();
+            received = 0;
         } else {
+            success = true;
             spdlog::info("GeometryClient::GetAllMeshes: Successfully received {} meshes, total ~{} bytes", 
-                        meshes.size(), total_bytes_received);
+                        received, total_bytes_received);
         }
         
     } catch (const std::exception& e) {
         spdlog::error("GeometryClient::GetAllMeshes: Exception: {}", e.what());
+        received = 0;
     }
+    meshes.resize(received);
     
     // Set bytes received for performance monitoring
-    if (_perf_timer) {
-        _perf_timer->setBytesReceived(total_bytes_received);
+    GRPC_PERF_SET_BYTES_RECEIVED(total_bytes_received);
+    
+    return success;
+}
+
+GeometryClient::SceneDelta GeometryClient::SyncScene(uint64_t since_version, uint32_t lod) {
+    SceneDelta delta;
+    delta.success = SyncSceneStream(since_version, lod, [&delta](SceneChangeEvent&& event) {
+        switch (event.type) {
+            case SceneChangeEvent::Type::Reset:
+                delta.reset = true;
+                delta.changed.clear();
+                delta.deleted_shape_ids.clear();
+                break;
+            case SceneChangeEvent::Type::Deleted:
+                delta.deleted_shape_ids.push_back(std::move(event.mesh.shape_id));
+                break;
+            default:
+                delta.changed.push_back(std::move(event.mesh));
+                break;
+        }
+        return true;
+    }, delta.scene_version);
+    
+    if (!delta.success) {
+        // Keep the caller at its previous version so the next sync retries
+        return SceneDelta{false, false, since_version, {}, {}};
     }
+    return delta;
+}
+
+bool GeometryClient::SyncSceneStream(uint64_t since_version, uint32_t lod,
+                                     const std::function<bool(SceneChangeEvent&&)>& on_change,
+                                     uint64_t& scene_version) {
+    GRPC_PERF_TIMER("SyncScene");
     
-    return meshes;
+    size_t total_bytes_received = 0;
+    size_t changed_count = 0;
+    size_t deleted_count = 0;
+    bool reset = false;
+    
+    if (!connected_) {
+        spdlog::error("GeometryClient::SyncScene: Not connected to server");
+        return false;
+    }
+    
+    try {
+        geometry::SceneSyncRequest request;
+        request.set_since_version(since_version);
+        *request.mutable_mesh_options() = mesh_options_;
+        request.mutable_mesh_options()->set_lod(lod);
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        ScopedStreamRegistration registration(scene_stream_mutex_, scene_stream_context_, context);
+        
+        std::unique_ptr<grpc::ClientReader<geometry::SceneChange>> reader = 
+            stub_->SyncScene(&context, request);
+        
+        uint64_t version = since_version;
+        bool stopped = false;
+        geometry::SceneChange change;
+        while (reader->Read(&change)) {
+            total_bytes_received += change.ByteSizeLong();
+            version = change.scene_version();
+            
+            SceneChangeEvent event;
+            switch (change.type()) {
+                case geometry::SCENE_CHANGE_RESET:
+                    event.type = SceneChangeEvent::Type::Reset;
+                    reset = true;
+                    break;
+                case geometry::SCENE_CHANGE_DELETED:
+                    event.type = SceneChangeEvent::Type::Deleted;
+                    event.mesh.shape_id = change.shape_id();
+                    ++deleted_count;
+                    break;
+                default:
+                    event.mesh = ConvertProtoMesh(change.mesh());
+                    ++changed_count;
+                    break;
+            }
+            if (!on_change(std::move(event))) {
+                stopped = true;
+                context.TryCancel();
+                break;
+            }
+        }
+        
+        grpc::Status status = reader->Finish();
+        if (stopped) {
+            return false;
+        }
+        if (!status.ok()) {
+            if (status.error_code() != grpc::StatusCode::CANCELLED) {
+                std::string error_msg = FormatGrpcError(status, "SyncScene");
+                spdlog::error("GeometryClient::SyncScene: {}", error_msg);
+            }
+            return false;
+        }
+        
+        scene_version = version;
+        spdlog::info("GeometryClient::SyncScene: Version {} -> {}{}, {} changed, {} deleted, ~{} bytes",
+                    since_version, version, reset ? " (full resync)" : "",
+                    changed_count, deleted_count, total_bytes_received);
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::SyncScene: Exception: {}", e.what());
+        return false;
+    }
+    
+    GRPC_PERF_SET_BYTES_RECEIVED(total_bytes_received);
+    
+    return true;
+}
+
+bool GeometryClient::StreamMeshLods(const std::vector<LodTarget>& targets,
+                                    const std::function<bool(MeshData&&)>& on_mesh) {
+    GRPC_PERF_TIMER("StreamMeshLods");
+    size_t total_bytes_received = 0;
+    
+    if (!connected_) {
+        spdlog::error("GeometryClient::StreamMeshLods: Not connected to server");
+        return false;
+    }
+    
+    try {
+        geometry::MeshLodRequest request;
+        *request.mutable_mesh_options() = mesh_options_;
+        for (const auto& target : targets) {
+            auto* proto_target = request.add_targets();
+            proto_target->set_shape_id(target.shape_id);
+            proto_target->set_screen_size(target.screen_size);
+            proto_target->set_has_mesh(target.has_mesh);
+            proto_target->set_current_lod(target.current_lod);
+        }
+        
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        ScopedStreamRegistration registration(lod_stream_mutex_, lod_stream_context_, context);
+        
+        std::unique_ptr<grpc::ClientReader<geometry::MeshData>> reader = stub_->StreamMeshLods(&context, request);
+        geometry::MeshData proto_mesh;
+        size_t mesh_count = 0;
+        while (reader->Read(&proto_mesh)) {
+            total_bytes_received += proto_mesh.ByteSizeLong();
+            ++mesh_count;
+            if (!on_mesh(ConvertProtoMesh(proto_mesh))) {
+                context.TryCancel();
+                break;
+            }
+        }
+        grpc::Status status = reader->Finish();
+        
+        GRPC_PERF_SET_BYTES_RECEIVED(total_bytes_received);
+        
+        if (!status.ok()) {
+            if (status.error_code() != grpc::StatusCode::CANCELLED) {
+                spdlog::error("GeometryClient::StreamMeshLods: {}", FormatGrpcError(status, "StreamMeshLods"));
+            }
+            return false;
+        }
+        spdlog::info("GeometryClient::StreamMeshLods: Received {} meshes, ~{} bytes", mesh_count, total_bytes_received);
+        return true;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::StreamMeshLods: Exception: {}", e.what());
+        return false;
+    }
+}
+
+void GeometryClient::CancelSceneSyncStream() {
+    std::lock_guard<std::mutex> lock(scene_stream_mutex_);
+    if (scene_stream_context_) {
+        scene_stream_context_->TryCancel();
+    }
+}
+
+void GeometryClient::CancelMeshLodStream() {
+    std::lock_guard<std::mutex> lock(lod_stream_mutex_);
+    if (lod_stream_context_) {
+        lod_stream_context_->TryCancel();
+    }
 }
 
 GeometryClient::MeshData GeometryClient::GetMeshData(const std::string& shape_id) {
@@ -486,6 +959,7 @@ GeometryClient::MeshData GeometryClient::GetMeshData(const std::string& shape_id
     try {
         geometry::ShapeRequest request;
         request.set_shape_id(shape_id);
+        *request.mutable_mesh_options() = mesh_options_;
         geometry::MeshData response;
         grpc::ClientContext context;
         AddClientMetadata(context);
@@ -509,28 +983,94 @@ GeometryClient::MeshData GeometryClient::GetMeshData(const std::string& shape_id
 
 GeometryClient::MeshData GeometryClient::ConvertProtoMesh(const geometry::MeshData& proto_mesh) {
     MeshData mesh_data;
+    ConvertProtoMesh(proto_mesh, mesh_data);
+    return mesh_data;
+}
+
+void GeometryClient::ConvertProtoMesh(const geometry::MeshData& proto_mesh, MeshData& mesh_data) {
     mesh_data.shape_id = proto_mesh.shape_id();
-    
-    // Convert vertices
-    mesh_data.vertices.reserve(proto_mesh.vertices_size() * 3);
-    for (const auto& vertex : proto_mesh.vertices()) {
-        mesh_data.vertices.push_back(static_cast<float>(vertex.x()));
-        mesh_data.vertices.push_back(static_cast<float>(vertex.y()));
-        mesh_data.vertices.push_back(static_cast<float>(vertex.z()));
-    }
-    
-    // Convert normals
-    mesh_data.normals.reserve(proto_mesh.normals_size() * 3);
-    for (const auto& normal : proto_mesh.normals()) {
-        mesh_data.normals.push_back(static_cast<float>(normal.x()));
-        mesh_data.normals.push_back(static_cast<float>(normal.y()));
-        mesh_data.normals.push_back(static_cast<float>(normal.z()));
+    mesh_data.lod = proto_mesh.lod();
+    mesh_data.prototype_id = proto_mesh.prototype_id();
+    const auto& instance_matrix = proto_mesh.instance_transform().matrix();
+    if (instance_matrix.size() == 16) {
+        std::copy(instance_matrix.begin(), instance_matrix.end(), mesh_data.instance_transform.begin());
+    } else {
+        mesh_data.instance_transform = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
     }
+    // clear() keeps the capacity for the decoding below
+    mesh_data.vertices.clear();
+    mesh_data.normals.clear();
+    mesh_data.indices.clear();
     
-    // Convert indices
-    mesh_data.indices.reserve(proto_mesh.indices_size());
-    for (int index : proto_mesh.indices()) {
-        mesh_data.indices.push_back(index);
+    if (proto_mesh.has_packed() && proto_mesh.packed().encoding() == geometry::MESH_ENCODING_QUANTIZED) {
+        using occt_imgui::common::MeshCodec;
+        const auto& packed = proto_mesh.packed();
+        MeshCodec::QuantizationBox box;
+        box.origin = {packed.quantization_origin().x(), packed.quantization_origin().y(),
+                      packed.quantization_origin().z()};
+        box.extent = {packed.quantization_extent().x(), packed.quantization_extent().y(),
+                      packed.quantization_extent().z()};
+        bool valid = MeshCodec::DecodePositions(packed.positions(), packed.vertex_count(), box, mesh_data.vertices);
+        if (valid && !packed.normals().empty()) {
+            valid = MeshCodec::DecodeNormals(packed.normals(), packed.vertex_count(), mesh_data.normals);
+        }
+        if (valid) {
+            mesh_data.indices.resize(static_cast<size_t>(packed.triangle_count()) * 3);
+            valid = MeshCodec::DecodeIndices(packed.indices(), mesh_data.indices.size(), packed.vertex_count(),
+                                             reinterpret_cast<uint32_t*>(mesh_data.indices.data()));
+        }
+        if (!valid) {
+            spdlog::error("GeometryClient::ConvertProtoMesh: Malformed quantized mesh for shape: {}",
+                         proto_mesh.shape_id());
+            mesh_data.vertices.clear();
+            mesh_data.normals.clear();
+            mesh_data.indices.clear();
+        }
+    } else if (proto_mesh.has_packed()) {
+        // Packed buffers: one memcpy per buffer for float32 payloads
+        const auto& packed = proto_mesh.packed();
+        bool valid = decodePackedVec3(packed.positions(), packed.vertex_count(),
+                                      packed.encoding(), mesh_data.vertices);
+        
+        if (valid && !packed.normals().empty()) {
+            valid = decodePackedVec3(packed.normals(), packed.vertex_count(),
+                                     packed.encoding(), mesh_data.normals);
+        }
+        
+        const size_t index_count = static_cast<size_t>(packed.triangle_count()) * 3;
+        if (valid && packed.indices().size() == index_count * sizeof(uint32_t)) {
+            mesh_data.indices.resize(index_count);
+            std::memcpy(mesh_data.indices.data(), packed.indices().data(), packed.indices().size());
+        } else {
+            valid = false;
+        }
+        
+        if (!valid) {
+            spdlog::error("GeometryClient::ConvertProtoMesh: Malformed packed mesh for shape: {}", 
+                         proto_mesh.shape_id());
+            mesh_data.vertices.clear();
+            mesh_data.normals.clear();
+            mesh_data.indices.clear();
+        }
+    } else {
+        // Convert vertices
+        mesh_data.vertices.reserve(proto_mesh.vertices_size() * 3);
+        for (const auto& vertex : proto_mesh.vertices()) {
+            mesh_data.vertices.push_back(static_cast<float>(vertex.x()));
+            mesh_data.vertices.push_back(static_cast<float>(vertex.y()));
+            mesh_data.vertices.push_back(static_cast<float>(vertex.z()));
+        }
+        
+        // Convert normals
+        mesh_data.normals.reserve(proto_mesh.normals_size() * 3);
+        for (const auto& normal : proto_mesh.normals()) {
+            mesh_data.normals.push_back(static_cast<float>(normal.x()));
+            mesh_data.normals.push_back(static_cast<float>(normal.y()));
+            mesh_data.normals.push_back(static_cast<float>(normal.z()));
+        }
+        
+        // Convert indices
+        mesh_data.indices.assign(proto_mesh.indices().begin(), proto_mesh.indices().end());
     }
     
     // Convert color
@@ -552,14 +1092,292 @@ GeometryClient::MeshData GeometryClient::ConvertProtoMesh(const geometry::MeshDa
     mesh_data.visible = true;
     mesh_data.selected = false;
     mesh_data.highlighted = false;
+}
+
+std::vector<GeometryClient::PickHit> GeometryClient::RayPick(const std::array<double, 3>& origin,
+                                                            const std::array<double, 3>& direction,
+                                                            uint32_t max_hits, double max_distance) {
+    GRPC_PERF_TIMER("RayPick");
     
-    return mesh_data;
+    std::vector<PickHit> hits;
+    if (!connected_) {
+        spdlog::error("GeometryClient::RayPick: Not connected to server");
+        return hits;
+    }
+    
+    try {
+        geometry::RayPickRequest request;
+        request.mutable_origin()->set_x(origin[0]);
+        request.mutable_origin()->set_y(origin[1]);
+        request.mutable_origin()->set_z(origin[2]);
+        request.mutable_direction()->set_x(direction[0]);
+        request.mutable_direction()->set_y(direction[1]);
+        request.mutable_direction()->set_z(direction[2]);
+        request.set_max_hits(max_hits);
+        request.set_max_distance(max_distance);
+        geometry::RayPickResponse response;
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        grpc::Status status = stub_->RayPick(&context, request, &response);
+        if (!status.ok() || !response.success()) {
+            spdlog::error("GeometryClient::RayPick: Failed - {}",
+                         status.ok() ? response.message() : status.error_message());
+            return hits;
+        }
+        
+        for (const auto& proto_hit : response.hits()) {
+            PickHit hit;
+            hit.shape_id = proto_hit.shape_id();
+            hit.distance = proto_hit.distance();
+            hit.point = {proto_hit.point().x(), proto_hit.point().y(), proto_hit.point().z()};
+            hit.normal = {proto_hit.normal().x(), proto_hit.normal().y(), proto_hit.normal().z()};
+            hits.push_back(std::move(hit));
+        }
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::RayPick: Exception: {}", e.what());
+    }
+    return hits;
+}
+
+std::vector<std::string> GeometryClient::BoxQuery(const std::array<double, 3>& min,
+                                                  const std::array<double, 3>& max, bool fully_inside) {
+    GRPC_PERF_TIMER("BoxQuery");
+    
+    std::vector<std::string> shape_ids;
+    if (!connected_) {
+        spdlog::error("GeometryClient::BoxQuery: Not connected to server");
+        return shape_ids;
+    }
+    
+    try {
+        geometry::BoxQueryRequest request;
+        request.mutable_box()->mutable_min()->set_x(min[0]);
+        request.mutable_box()->mutable_min()->set_y(min[1]);
+        request.mutable_box()->mutable_min()->set_z(min[2]);
+        request.mutable_box()->mutable_max()->set_x(max[0]);
+        request.mutable_box()->mutable_max()->set_y(max[1]);
+        request.mutable_box()->mutable_max()->set_z(max[2]);
+        request.set_fully_inside(fully_inside);
+        geometry::ShapeQueryResponse response;
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        grpc::Status status = stub_->BoxQuery(&context, request, &response);
+        if (status.ok() && response.success()) {
+            shape_ids.assign(response.shape_ids().begin(), response.shape_ids().end());
+        } else {
+            spdlog::error("GeometryClient::BoxQuery: Failed - {}",
+                         status.ok() ? response.message() : status.error_message());
+        }
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::BoxQuery: Exception: {}", e.what());
+    }
+    return shape_ids;
+}
+
+std::vector<std::string> GeometryClient::FrustumCull(const std::array<double, 16>& view_projection) {
+    GRPC_PERF_TIMER("FrustumCull");
+    
+    std::vector<std::string> shape_ids;
+    if (!connected_) {
+        spdlog::error("GeometryClient::FrustumCull: Not connected to server");
+        return shape_ids;
+    }
+    
+    try {
+        geometry::FrustumCullRequest request;
+        request.mutable_view_projection()->Add(view_projection.begin(), view_projection.end());
+        geometry::ShapeQueryResponse response;
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        grpc::Status status = stub_->FrustumCull(&context, request, &response);
+        if (status.ok() && response.success()) {
+            shape_ids.assign(response.shape_ids().begin(), response.shape_ids().end());
+        } else {
+            spdlog::error("GeometryClient::FrustumCull: Failed - {}",
+                         status.ok() ? response.message() : status.error_message());
+        }
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::FrustumCull: Exception: {}", e.what());
+    }
+    return shape_ids;
+}
+
+bool GeometryClient::UpdateCamera(const ViewCamera& camera) {
+    if (!connected_) {
+        return false;
+    }
+    geometry::CameraUpdateRequest request;
+    geometry::ViewCamera* proto_camera = request.mutable_camera();
+    proto_camera->mutable_view()->Add(camera.view.begin(), camera.view.end());
+    proto_camera->mutable_projection()->Add(camera.projection.begin(), camera.projection.end());
+    proto_camera->set_viewport_width(camera.viewport_width);
+    proto_camera->set_viewport_height(camera.viewport_height);
+    return SendCameraUpdate(request);
+}
+
+bool GeometryClient::ClearCamera() {
+    if (!connected_) {
+        return false;
+    }
+    return SendCameraUpdate(geometry::CameraUpdateRequest());
+}
+
+bool GeometryClient::SendCameraUpdate(const geometry::CameraUpdateRequest& request) {
+    GRPC_PERF_TIMER("UpdateCamera");
+    
+    geometry::StatusResponse response;
+    grpc::ClientContext context;
+    AddClientMetadata(context);
+    // Camera updates are superseded quickly; never hold up the caller for long
+    context.set_deadline(std::chrono::system_clock::now() + std::chrono::milliseconds(500));
+    
+    grpc::Status status = stub_->UpdateCamera(&context, request, &response);
+    if (status.ok() && response.success()) {
+        return true;
+    }
+    spdlog::warn("GeometryClient::UpdateCamera: Failed - {}",
+                 status.ok() ? response.message() : status.error_message());
+    return false;
+}
+
+void GeometryClient::SetMeshEncoding(geometry::MeshEncoding encoding) {
+    mesh_options_.set_encoding(encoding);
+}
+
+geometry::MeshEncoding GeometryClient::GetMeshEncoding() const {
+    return mesh_options_.encoding();
+}
+
+void GeometryClient::SetChannelCompression(grpc_compression_algorithm algorithm) {
+    channel_compression_ = algorithm;
+}
+
+grpc_compression_algorithm GeometryClient::GetChannelCompression() const {
+    return channel_compression_;
+}
+
+void GeometryClient::SetMeshNormalsEnabled(bool enabled) {
+    mesh_options_.set_omit_normals(!enabled);
+}
+
+bool GeometryClient::GetMeshNormalsEnabled() const {
+    return !mesh_options_.omit_normals();
+}
+
+void GeometryClient::SetMeshQuality(const MeshQuality& quality) {
+    mesh_options_.set_linear_deflection(quality.linear_deflection);
+    mesh_options_.set_angular_deflection(quality.angular_deflection);
+    mesh_options_.set_relative_deflection(quality.relative_deflection);
+}
+
+GeometryClient::MeshQuality GeometryClient::GetMeshQuality() const {
+    return {mesh_options_.linear_deflection(), mesh_options_.angular_deflection(),
+            mesh_options_.relative_deflection()};
+}
+
+void GeometryClient::SetMeshInstancing(bool enabled) {
+    mesh_options_.set_instancing(enabled);
+}
+
+bool GeometryClient::GetMeshInstancing() const {
+    return mesh_options_.instancing();
+}
+
+void GeometryClient::SetMeshTriangleBudget(uint64_t triangles) {
+    mesh_triangle_budget_ = triangles;
+}
+
+uint64_t GeometryClient::GetMeshTriangleBudget() const {
+    return mesh_triangle_budget_;
 }
 
 void GeometryClient::SetShapeUpdateCallback(ShapeUpdateCallback callback) {
+    std::lock_guard<std::mutex> lock(subscription_mutex_);
     update_callback_ = std::move(callback);
 }
 
+bool GeometryClient::StartSceneSubscription(bool include_mesh) {
+    if (!connected_) {
+        spdlog::error("GeometryClient::StartSceneSubscription: Not connected to server");
+        return false;
+    }
+    
+    StopSceneSubscription();
+    
+    {
+        std::lock_guard<std::mutex> lock(subscription_mutex_);
+        subscription_context_ = std::make_unique<grpc::ClientContext>();
+        AddClientMetadata(*subscription_context_);
+    }
+    subscription_active_ = true;
+    subscription_thread_ = std::thread(&GeometryClient::RunSceneSubscription, this, include_mesh);
+    spdlog::info("GeometryClient::StartSceneSubscription: Subscribed to scene changes (inline meshes: {})", include_mesh);
+    return true;
+}
+
+void GeometryClient::StopSceneSubscription() {
+    {
+        std::lock_guard<std::mutex> lock(subscription_mutex_);
+        if (subscription_context_) {
+            subscription_context_->TryCancel();
+        }
+    }
+    if (subscription_thread_.joinable()) {
+        subscription_thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(subscription_mutex_);
+    subscription_context_.reset();
+    subscription_active_ = false;
+}
+
+bool GeometryClient::IsSceneSubscriptionActive() const {
+    return subscription_active_.load();
+}
+
+void GeometryClient::RunSceneSubscription(bool include_mesh) {
+    try {
+        geometry::SceneSubscribeRequest request;
+        request.set_include_mesh(include_mesh);
+        *request.mutable_mesh_options() = mesh_options_;
+        
+        std::unique_ptr<grpc::ClientReader<geometry::SceneChange>> reader =
+            stub_->SubscribeSceneChanges(subscription_context_.get(), request);
+        
+        geometry::SceneChange change;
+        while (reader->Read(&change)) {
+            MeshData mesh_data;
+            if (change.has_mesh()) {
+                mesh_data = ConvertProtoMesh(change.mesh());
+            } else {
+                mesh_data = MeshData{};
+                mesh_data.shape_id = change.shape_id();
+            }
+            
+            std::lock_guard<std::mutex> lock(subscription_mutex_);
+            if (update_callback_) {
+                update_callback_(change.type() == geometry::SCENE_CHANGE_RESET ? std::string() : change.shape_id(),
+                                 mesh_data);
+            }
+        }
+        
+        grpc::Status status = reader->Finish();
+        if (!status.ok() && status.error_code() != grpc::StatusCode::CANCELLED) {
+            spdlog::error("GeometryClient::RunSceneSubscription: {}", FormatGrpcError(status, "SubscribeSceneChanges"));
+        }
+    } catch (const std::exception& e) {
+        spdlog::error("GeometryClient::RunSceneSubscription: Exception: {}", e.what());
+    }
+    
+    subscription_active_ = false;
+    spdlog::info("GeometryClient::RunSceneSubscription: Scene subscription ended");
+}
+
 void GeometryClient::AddClientMetadata(grpc::ClientContext& context) const {
     // Add client ID to metadata so server can identify the client
     context.AddMetadata("client-id", client_id_);
@@ -667,6 +1485,64 @@ GeometryClient::ModelImportResult GeometryClient::ImportModelFile(const std::str
 }
 
 
+GeometryClient::BulkImportResult GeometryClient::ImportModelFiles(const std::vector<std::string>& file_paths,
+                                                                 const ModelImportOptions& options) {
+    BulkImportResult result;
+    
+    if (!connected_) {
+        spdlog::error("GeometryClient::ImportModelFiles: Not connected to server");
+        result.message = "Not connected to server";
+        return result;
+    }
+    
+    try {
+        geometry::ImportModelFilesRequest request;
+        for (const auto& file_path : file_paths) {
+            request.add_file_paths(file_path);
+        }
+        auto* proto_options = request.mutable_options();
+        proto_options->set_auto_detect_format(options.auto_detect_format);
+        proto_options->set_force_format(options.force_format);
+        proto_options->set_import_colors(options.import_colors);
+        proto_options->set_import_names(options.import_names);
+        proto_options->set_precision(options.precision);
+        proto_options->set_merge_shapes(options.merge_shapes);
+        
+        geometry::ImportModelFilesResponse response;
+        grpc::ClientContext context;
+        AddClientMetadata(context);
+        
+        grpc::Status status = stub_->ImportModelFiles(&context, request, &response);
+        if (!status.ok()) {
+            result.message = status.error_message();
+            spdlog::error("GeometryClient::ImportModelFiles: Failed - {}", result.message);
+            return result;
+        }
+        
+        result.success = response.success();
+        result.message = response.message();
+        result.imported_files = static_cast<int>(response.imported_files());
+        for (const auto& file : response.results()) {
+            ModelImportResult file_result{};
+            file_result.success = file.success();
+            file_result.message = file.message();
+            file_result.filename = file.file_path();
+            file_result.detected_format = file.detected_format();
+            file_result.shape_ids.assign(file.shape_ids().begin(), file.shape_ids().end());
+            file_result.shape_count = file.shape_ids_size();
+            result.files.push_back(std::move(file_result));
+        }
+        spdlog::info("GeometryClient::ImportModelFiles: {}", result.message);
+        
+    } catch (const std::exception& e) {
+        result.message = std::string("Exception: ") + e.what();
+        spdlog::error("GeometryClient::ImportModelFiles: Exception: {}", e.what());
+    }
+    
+    return result;
+}
+
+
 GeometryClient::ModelExportResult GeometryClient::ExportModelFile(const std::vector<std::string>& shape_ids, const ModelExportOptions& options) {
     ModelExportResult result;
     result.success = false;
@@ -739,4 +1615,254 @@ GeometryClient::ModelExportResult GeometryClient::ExportModelFile(const std::vec
     }
     
     return result;
-}
\ No newline at end of file
+}
+
+GeometryClient::ModelImportResult GeometryClient::UploadModelFile(const std::string& file_path,
+                                                                 const ModelImportOptions& options,
+                                                                 size_t chunk_size) {
+    using occt_imgui::common::Utils;
+    
+    ModelImportResult result;
+    result.success = false;
+    
+    if (!connected_) {
+        spdlog::error("GeometryClient::UploadModelFile: Not connected to server");
+        result.message = "Not connected to server";
+        return result;
+    }
+    
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file) {
+        result.message = "Cannot open file: " + file_path;
+        spdlog::error("GeometryClient::UploadModelFile: {}", result.message);
+        return result;
+    }
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    std::string buffer(chunk_size, '\0');
+    
+    // Whole-file CRC up front so the server can verify the assembled file
+    uint64_t total_size = 0;
+    uint32_t file_crc = 0;
+    while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0) {
+        size_t size = static_cast<size_t>(file.gcount());
+        file_crc = Utils::Crc32(buffer.data(), size, file_crc);
+        total_size += size;
+    }
+    
+    std::string transfer_id;
+    uint64_t offset = 0;
+    bool offset_known = true;
+    
+    try {
+        for (int attempt = 1; attempt <= kMaxTransferAttempts; ++attempt) {
+            // After a broken stream ask the server how much it kept
+            if (!offset_known) {
+                if (transfer_id.empty()) {
+                    offset = 0;
+                } else if (!QueryUploadOffset(transfer_id, offset)) {
+                    result.message = "Cannot query upload state of " + transfer_id;
+                    continue;
+                }
+            }
+            
+            geometry::UploadModelResponse response;
+            grpc::ClientContext context;
+            AddClientMetadata(context);
+            auto writer = stub_->UploadModel(&context, &response);
+            
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offset));
+            bool first = true;
+            do {
+                file.read(buffer.data(), static_cast<std::streamsize>(std::min<uint64_t>(chunk_size, total_size - offset)));
+                size_t size = static_cast<size_t>(file.gcount());
+                
+                geometry::ModelChunk chunk;
+                if (first) {
+                    if (transfer_id.empty()) {
+                        chunk.set_filename(std::filesystem::path(file_path).filename().string());
+                        chunk.set_total_size(total_size);
+                        auto* proto_options = chunk.mutable_import_options();
+                        proto_options->set_auto_detect_format(options.auto_detect_format);
+                        proto_options->set_force_format(options.force_format);
+                        proto_options->set_import_colors(options.import_colors);
+                        proto_options->set_import_names(options.import_names);
+                        proto_options->set_precision(options.precision);
+                        proto_options->set_merge_shapes(options.merge_shapes);
+                    } else {
+                        chunk.set_transfer_id(transfer_id);
+                    }
+                    first = false;
+                }
+                chunk.set_offset(offset);
+                chunk.set_data(buffer.data(), size);
+                chunk.set_crc32(Utils::Crc32(buffer.data(), size));
+                offset += size;
+                if (offset >= total_size) {
+                    chunk.set_last(true);
+                    chunk.set_file_crc32(file_crc);
+                }
+                if (!writer->Write(chunk)) {
+                    break;  // Server closed the stream; Finish() reports why
+                }
+            } while (offset < total_size);
+            
+            writer->WritesDone();
+            grpc::Status status = writer->Finish();
+            
+            if (!response.transfer_id().empty()) {
+                transfer_id = response.transfer_id();
+            }
+            if (status.ok() && response.complete()) {
+                fillImportResult(response.import_result(), result);
+                if (!result.success) {
+                    spdlog::error("GeometryClient::UploadModelFile: Import failed - {}", result.message);
+                } else {
+                    spdlog::info("GeometryClient::UploadModelFile: Uploaded {} bytes, imported {} shapes (format: {})",
+                                total_size, result.shape_ids.size(), result.detected_format);
+                }
+                return result;
+            }
+            
+            result.message = status.ok() ? response.message() : status.error_message();
+            offset_known = status.ok();
+            if (offset_known) {
+                offset = response.committed_offset();
+            }
+            spdlog::warn("GeometryClient::UploadModelFile: Attempt {} of {} failed - {}", attempt,
+                        kMaxTransferAttempts, result.message);
+        }
+    } catch (const std::exception& e) {
+        result.message = std::string("Exception: ") + e.what();
+        spdlog::error("GeometryClient::UploadModelFile: Exception: {}", e.what());
+    }
+    
+    return result;
+}
+
+bool GeometryClient::QueryUploadOffset(const std::string& transfer_id, uint64_t& committed_offset) {
+    geometry::UploadModelResponse response;
+    grpc::ClientContext context;
+    AddClientMetadata(context);
+    auto writer = stub_->UploadModel(&context, &response);
+    
+    geometry::ModelChunk header;
+    header.set_transfer_id(transfer_id);
+    writer->Write(header);
+    writer->WritesDone();
+    grpc::Status status = writer->Finish();
+    if (!status.ok() || !response.success()) {
+        return false;
+    }
+    committed_offset = response.committed_offset();
+    return true;
+}
+
+GeometryClient::ModelExportResult GeometryClient::DownloadModelFile(const std::vector<std::string>& shape_ids,
+                                                                   const std::string& output_path,
+                                                                   const ModelExportOptions& options,
+                                                                   size_t chunk_size) {
+    using occt_imgui::common::Utils;
+    
+    ModelExportResult result;
+    result.success = false;
+    
+    if (!connected_) {
+        spdlog::error("GeometryClient::DownloadModelFile: Not connected to server");
+        result.message = "Not connected to server";
+        return result;
+    }
+    
+    if (shape_ids.empty()) {
+        spdlog::error("GeometryClient::DownloadModelFile: No shape IDs provided");
+        result.message = "No shape IDs provided";
+        return result;
+    }
+    
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        result.message = "Cannot create file: " + output_path;
+        spdlog::error("GeometryClient::DownloadModelFile: {}", result.message);
+        return result;
+    }
+    
+    try {
+        geometry::DownloadModelRequest request;
+        for (const auto& shape_id : shape_ids) {
+            request.add_shape_ids(shape_id);
+        }
+        auto* proto_options = request.mutable_options();
+        proto_options->set_format(options.format);
+        proto_options->set_export_colors(options.export_colors);
+        proto_options->set_export_names(options.export_names);
+        proto_options->set_units(options.units);
+        proto_options->set_binary_mode(options.binary_mode);
+        request.set_chunk_size(static_cast<uint32_t>(chunk_size));
+        
+        uint64_t offset = 0;
+        uint64_t total_size = 0;
+        uint32_t crc = 0;
+        uint32_t expected_crc = 0;
+        
+        for (int attempt = 1; attempt <= kMaxTransferAttempts; ++attempt) {
+            grpc::ClientContext context;
+            AddClientMetadata(context);
+            auto reader = stub_->DownloadModel(&context, request);
+            
+            geometry::ModelChunk chunk;
+            bool complete = false;
+            while (reader->Read(&chunk)) {
+                if (!chunk.filename().empty()) {
+                    result.filename = chunk.filename();
+                    total_size = chunk.total_size();
+                    expected_crc = chunk.file_crc32();
+                }
+                request.set_transfer_id(chunk.transfer_id());
+                
+                const std::string& data = chunk.data();
+                if (chunk.offset() != offset || Utils::Crc32(data.data(), data.size()) != chunk.crc32()) {
+                    result.message = "Corrupt chunk at offset " + std::to_string(chunk.offset());
+                    context.TryCancel();
+                    break;
+                }
+                out.write(data.data(), static_cast<std::streamsize>(data.size()));
+                crc = Utils::Crc32(data.data(), data.size(), crc);
+                offset += data.size();
+                complete = chunk.last();
+            }
+            grpc::Status status = reader->Finish();
+            
+            if (complete) {
+                out.close();
+                if (!out || offset != total_size || crc != expected_crc) {
+                    result.message = "Downloaded file failed verification";
+                    spdlog::error("GeometryClient::DownloadModelFile: {}", result.message);
+                    return result;
+                }
+                result.success = true;
+                result.message = "Model file downloaded successfully";
+                result.file_size = static_cast<int64_t>(total_size);
+                result.shape_count = static_cast<int32_t>(shape_ids.size());
+                result.format = options.format;
+                spdlog::info("GeometryClient::DownloadModelFile: Downloaded {} bytes to {}", total_size, output_path);
+                return result;
+            }
+            
+            if (!status.ok()) {
+                result.message = status.error_message();
+            }
+            if (request.transfer_id().empty() || status.error_code() == grpc::StatusCode::NOT_FOUND) {
+                break;  // Nothing to resume
+            }
+            request.set_offset(offset);
+            spdlog::warn("GeometryClient::DownloadModelFile: Attempt {} of {} failed at offset {} - {}", attempt,
+                        kMaxTransferAttempts, offset, result.message);
+        }
+    } catch (const std::exception& e) {
+        result.message = std::string("Exception: ") + e.what();
+        spdlog::error("GeometryClient::DownloadModelFile: Exception: {}", e.what());
+    }
+    
+    spdlog::error("GeometryClient::DownloadModelFile: Failed - {}", result.message);
+    return result;
+}
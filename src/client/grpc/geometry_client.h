@@ -1,10 +1,14 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
 #include <functional>
 #include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 // gRPC includes
 #include <grpcpp/grpcpp.h>
@@ -45,6 +49,44 @@ public:
     bool DeleteShape(const std::string& shape_id);
     bool SetShapeColor(const std::string& shape_id, double r, double g, double b);
     
+    // Operations collected client-side and sent in one ExecuteBatch round trip
+    class Batch {
+    public:
+        Batch& CreateBox(double x, double y, double z, double width, double height, double depth,
+                         double r = 0.8, double g = 0.8, double b = 0.8);
+        Batch& CreateCone(double x, double y, double z, double base_radius, double top_radius, double height,
+                          double r = 0.7, double g = 0.9, double b = 0.7);
+        Batch& CreateSphere(double x, double y, double z, double radius,
+                            double r = 0.9, double g = 0.7, double b = 0.7);
+        Batch& CreateCylinder(double x, double y, double z, double radius, double height,
+                              double r = 0.7, double g = 0.7, double b = 0.9);
+        Batch& Transform(const std::string& shape_id, const std::array<double, 16>& row_major_matrix);
+        Batch& SetColor(const std::string& shape_id, double r, double g, double b, double a = 1.0);
+        Batch& Delete(const std::string& shape_id);
+        
+        size_t size() const { return static_cast<size_t>(request_.operations_size()); }
+        bool empty() const { return request_.operations_size() == 0; }
+        void clear() { request_.clear_operations(); }
+        
+    private:
+        friend class GeometryClient;
+        geometry::BatchRequest request_;
+    };
+    
+    struct BatchResult {
+        struct Operation {
+            bool success{false};
+            std::string message;
+            std::string shape_id;     // Created or affected shape
+        };
+        bool success{false};          // Every operation succeeded
+        bool applied{false};          // False when a transactional batch was rolled back
+        std::string message;
+        std::vector<Operation> operations;  // In batch order
+    };
+    // transactional: all-or-nothing, the server stops at the first failing operation
+    BatchResult ExecuteBatch(const Batch& batch, bool transactional = false);
+    
     // Scene operations
     bool CreateDemoScene();
     bool ClearAll();
@@ -56,19 +98,139 @@ public:
         std::vector<float> normals;     // nx,ny,nz triplets
         std::vector<int> indices;       // Triangle indices
         float color[4];                 // RGBA
+        uint32_t lod{0};                // Level of detail, 0 = full quality
+        // Shapes repeating a part, with instancing enabled: the geometry is the part's
+        // in its own coordinates, placed by the row-major instance_transform, and is
+        // empty when this stream already delivered the prototype at this lod
+        std::string prototype_id;
+        std::array<double, 16> instance_transform{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
         bool visible;
         bool selected;
         bool highlighted;
     };
     
     std::vector<MeshData> GetAllMeshes();
+    // Refreshing form of GetAllMeshes: refills meshes in place, reusing the elements'
+    // buffers from the previous call, so a scene polled every frame does not
+    // reallocate. meshes is left empty when the stream fails.
+    bool GetAllMeshes(std::vector<MeshData>& meshes);
     MeshData GetMeshData(const std::string& shape_id);
     
+    // Decodes a received mesh message (any encoding) into MeshData
+    static MeshData ConvertProtoMesh(const geometry::MeshData& proto_mesh);
+    // Same, overwriting mesh_data and reusing its vectors' capacity
+    static void ConvertProtoMesh(const geometry::MeshData& proto_mesh, MeshData& mesh_data);
+    
+    // Incremental scene sync: changes since the given scene version (0 = full scene)
+    struct SceneDelta {
+        bool success{false};
+        bool reset{false};                        // Drop all local shapes before applying
+        uint64_t scene_version{0};                // Pass to the next SyncScene call
+        std::vector<MeshData> changed;            // Added or updated shapes
+        std::vector<std::string> deleted_shape_ids;
+    };
+    // lod > 0 asks for coarse meshes, to be refined later with StreamMeshLods
+    SceneDelta SyncScene(uint64_t since_version, uint32_t lod = 0);
+    
+    // Streaming form of SyncScene for large scenes: on_change runs on the calling
+    // thread for each change as it arrives and returns false to stop. Returns true
+    // and the new scene version only when the whole delta was received.
+    // CancelSceneSyncStream() ends a call blocked waiting for the server.
+    struct SceneChangeEvent {
+        enum class Type { Reset, Changed, Deleted };
+        Type type{Type::Changed};
+        MeshData mesh;                            // Only shape_id is set for Deleted
+    };
+    bool SyncSceneStream(uint64_t since_version, uint32_t lod,
+                         const std::function<bool(SceneChangeEvent&&)>& on_change, uint64_t& scene_version);
+    void CancelSceneSyncStream();
+    
+    // Progressive level-of-detail streaming. Blocks until every target reached full
+    // quality, on_mesh returned false or CancelMeshLodStream() was called. on_mesh
+    // runs on the calling thread.
+    struct LodTarget {
+        std::string shape_id;
+        float screen_size{0.0f};      // Projected size in pixels, 0 if unknown
+        bool has_mesh{false};
+        uint32_t current_lod{0};      // Level currently shown when has_mesh is set
+    };
+    bool StreamMeshLods(const std::vector<LodTarget>& targets, const std::function<bool(MeshData&&)>& on_mesh);
+    void CancelMeshLodStream();
+    
+    // Server-side spatial queries over the session's shapes; no meshes are downloaded
+    struct PickHit {
+        std::string shape_id;
+        double distance{0.0};
+        std::array<double, 3> point{};
+        std::array<double, 3> normal{};
+    };
+    // Closest hit first; max_distance 0 = unbounded. Empty when nothing is hit or the call fails.
+    std::vector<PickHit> RayPick(const std::array<double, 3>& origin, const std::array<double, 3>& direction,
+                                 uint32_t max_hits = 1, double max_distance = 0.0);
+    std::vector<std::string> BoxQuery(const std::array<double, 3>& min, const std::array<double, 3>& max,
+                                      bool fully_inside = false);
+    // Shapes at least partly inside a row-major view-projection matrix's frustum (OpenGL clip space)
+    std::vector<std::string> FrustumCull(const std::array<double, 16>& view_projection);
+    
+    // Camera of the client's view in server model units, so scene syncs and mesh
+    // streams send what it sees first. Row-major matrices mapping to OpenGL clip space.
+    struct ViewCamera {
+        std::array<double, 16> view{};
+        std::array<double, 16> projection{};
+        uint32_t viewport_width{0};
+        uint32_t viewport_height{0};
+    };
+    // Streams already running reorder what they have left to send
+    bool UpdateCamera(const ViewCamera& camera);
+    bool ClearCamera();
+    
+    // Wire encoding requested for mesh retrieval (packed float32 by default);
+    // MESH_ENCODING_QUANTIZED trades exact floats for several times fewer bytes
+    void SetMeshEncoding(geometry::MeshEncoding encoding);
+    geometry::MeshEncoding GetMeshEncoding() const;
+    
+    // Message compression for calls on the channel, e.g. GRPC_COMPRESS_GZIP for slow
+    // links; set before Connect. The server compresses responses when configured to.
+    void SetChannelCompression(grpc_compression_algorithm algorithm);
+    grpc_compression_algorithm GetChannelCompression() const;
+    
+    // Server-computed normals; disable when the renderer derives its own
+    void SetMeshNormalsEnabled(bool enabled);
+    bool GetMeshNormalsEnabled() const;
+    
+    // Tessellation quality; 0 keeps the shape default (import precision or server default)
+    struct MeshQuality {
+        double linear_deflection{0.0};    // Model units
+        double angular_deflection{0.0};   // Radians
+        double relative_deflection{0.0};  // Fraction of the bounding box diagonal, used without linear_deflection
+    };
+    void SetMeshQuality(const MeshQuality& quality);
+    MeshQuality GetMeshQuality() const;
+    
+    // Repeated parts as one prototype mesh plus per-shape transforms (see MeshData)
+    void SetMeshInstancing(bool enabled);
+    bool GetMeshInstancing() const;
+    
+    // Total triangles GetAllMeshes may return; the server coarsens shapes to fit, 0 = unlimited
+    void SetMeshTriangleBudget(uint64_t triangles);
+    uint64_t GetMeshTriangleBudget() const;
+    
     // System info
     struct SystemInfo {
         std::string version;
-        int active_shapes;
+        int active_shapes;                  // In this client's session
         std::string occt_version;
+        uint64_t active_sessions{0};        // Server-wide
+        uint64_t total_shapes{0};
+        uint64_t resident_memory_bytes{0};  // Server process RSS, 0 if unknown
+        // Estimated memory of this session and its quota, and of all sessions and
+        // the server limit; limits are 0 when unlimited
+        uint64_t session_brep_bytes{0};
+        uint64_t session_triangulation_bytes{0};
+        uint64_t session_mesh_cache_bytes{0};
+        uint64_t session_memory_quota_bytes{0};
+        uint64_t accounted_memory_bytes{0};
+        uint64_t memory_limit_bytes{0};
     };
     
     SystemInfo GetSystemInfo();
@@ -119,7 +281,7 @@ public:
         bool import_colors = true;
         bool import_names = true;
         bool import_materials = true;
-        double precision = 0.01;
+        double precision = 0.1;         // Default mesh linear deflection of the imported shapes
         bool merge_shapes = false;
         bool validate_shapes = true;
         bool heal_shapes = false;
@@ -168,11 +330,36 @@ public:
     };
 
     ModelImportResult ImportModelFile(const std::string& file_path, const ModelImportOptions& options = {});
+    
+    // Bulk import of server-side files, read concurrently by the server
+    struct BulkImportResult {
+        bool success{false};                  // Every file imported
+        std::string message;
+        int imported_files{0};
+        std::vector<ModelImportResult> files;  // In request order; filename is the requested path
+    };
+    BulkImportResult ImportModelFiles(const std::vector<std::string>& file_paths, const ModelImportOptions& options = {});
     ModelExportResult ExportModelFile(const std::vector<std::string>& shape_ids, const ModelExportOptions& options = {});
+    
+    // Chunked transfer for files beyond the gRPC message size limit. Interrupted
+    // transfers are resumed from the last committed offset a few times before failing.
+    ModelImportResult UploadModelFile(const std::string& file_path, const ModelImportOptions& options = {},
+                                      size_t chunk_size = 1 << 20);
+    // Streams the export straight into output_path; model_data stays empty
+    ModelExportResult DownloadModelFile(const std::vector<std::string>& shape_ids, const std::string& output_path,
+                                        const ModelExportOptions& options = {}, size_t chunk_size = 0);
 
-    // Event handling (for future real-time updates)
+    // Event handling for server-pushed scene changes. Invoked on the subscription
+    // thread. An empty shape_id means the local scene is stale (call SyncScene);
+    // empty mesh_data.vertices means the shape was deleted or the mesh was not requested,
+    // unless prototype_id is set and the geometry was delivered before.
     using ShapeUpdateCallback = std::function<void(const std::string& shape_id, const MeshData& mesh_data)>;
     void SetShapeUpdateCallback(ShapeUpdateCallback callback);
+    
+    // Start/stop the SubscribeSceneChanges stream feeding the ShapeUpdateCallback
+    bool StartSceneSubscription(bool include_mesh = false);
+    void StopSceneSubscription();
+    bool IsSceneSubscriptionActive() const;
 
 private:
     std::string server_address_;
@@ -180,15 +367,31 @@ private:
     std::shared_ptr<grpc::Channel> channel_;
     std::unique_ptr<geometry::GeometryService::Stub> stub_;
     bool connected_;
+    grpc_compression_algorithm channel_compression_{GRPC_COMPRESS_NONE};
+    geometry::MeshOptions mesh_options_;  // Sent with every mesh request
+    uint64_t mesh_triangle_budget_{0};
     
     ShapeUpdateCallback update_callback_;
     
+    // Scene subscription stream
+    std::thread subscription_thread_;
+    std::unique_ptr<grpc::ClientContext> subscription_context_;
+    std::atomic<bool> subscription_active_{false};
+    mutable std::mutex subscription_mutex_;  // Guards subscription_context_ and update_callback_
+    void RunSceneSubscription(bool include_mesh);
+    
+    // Active StreamMeshLods and SyncSceneStream calls, cancellable from other threads
+    grpc::ClientContext* lod_stream_context_{nullptr};
+    std::mutex lod_stream_mutex_;
+    grpc::ClientContext* scene_stream_context_{nullptr};
+    std::mutex scene_stream_mutex_;
+    
     // Helper methods
     void AddClientMetadata(grpc::ClientContext& context) const;
+    bool SendCameraUpdate(const geometry::CameraUpdateRequest& request);
     std::string FormatGrpcError(const grpc::Status& status, const std::string& operation) const;
+    bool QueryUploadOffset(const std::string& transfer_id, uint64_t& committed_offset);
     geometry::Point3D CreatePoint3D(double x, double y, double z);
     geometry::Vector3D CreateVector3D(double x, double y, double z);
     geometry::Color CreateColor(double r, double g, double b, double a = 1.0);
-    
-    MeshData ConvertProtoMesh(const geometry::MeshData& proto_mesh);
 };
\ No newline at end of file
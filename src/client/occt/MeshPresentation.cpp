@@ -0,0 +1,118 @@
+#include "MeshPresentation.h"
+
+#include <AIS_DisplayMode.hxx>
+#include <AIS_Shape.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Graphic3d_Vec3.hxx>
+#include <Prs3d_Drawer.hxx>
+#include <Prs3d_ShadingAspect.hxx>
+#include <Select3D_SensitivePrimitiveArray.hxx>
+#include <SelectMgr_EntityOwner.hxx>
+#include <SelectMgr_Selection.hxx>
+#include <TopLoc_Location.hxx>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Area-weighted vertex normals, +Z for vertices of degenerate triangles only
+std::vector<float> computeNormals(const float* thePositions, size_t theNbVertices, const int* theIndices,
+                                  size_t theNbIndices) {
+  std::vector<Graphic3d_Vec3> aSums(theNbVertices, Graphic3d_Vec3(0.0f));
+  for (size_t t = 0; t + 2 < theNbIndices; t += 3) {
+    const Graphic3d_Vec3 aP0(thePositions[3 * theIndices[t]], thePositions[3 * theIndices[t] + 1],
+                             thePositions[3 * theIndices[t] + 2]);
+    const Graphic3d_Vec3 aP1(thePositions[3 * theIndices[t + 1]], thePositions[3 * theIndices[t + 1] + 1],
+                             thePositions[3 * theIndices[t + 1] + 2]);
+    const Graphic3d_Vec3 aP2(thePositions[3 * theIndices[t + 2]], thePositions[3 * theIndices[t + 2] + 1],
+                             thePositions[3 * theIndices[t + 2] + 2]);
+    const Graphic3d_Vec3 aCross = Graphic3d_Vec3::Cross(aP1 - aP0, aP2 - aP0);
+    for (size_t k = 0; k < 3; ++k) {
+      aSums[theIndices[t + k]] += aCross;
+    }
+  }
+  std::vector<float> aNormals(theNbVertices * 3);
+  for (size_t v = 0; v < theNbVertices; ++v) {
+    const float aLength = aSums[v].Modulus();
+    const Graphic3d_Vec3 aNormal = aLength > 0.0f ? aSums[v] / aLength : Graphic3d_Vec3(0.0f, 0.0f, 1.0f);
+    aNormals[3 * v] = aNormal.x();
+    aNormals[3 * v + 1] = aNormal.y();
+    aNormals[3 * v + 2] = aNormal.z();
+  }
+  return aNormals;
+}
+
+} // namespace
+
+MeshPresentation::MeshPresentation(const float* thePositions, const float* theNormals, size_t theNbVertices,
+                                   const int* theIndices, size_t theNbIndices) {
+  std::vector<float> aComputedNormals;
+  if (theNormals == nullptr) {
+    aComputedNormals = computeNormals(thePositions, theNbVertices, theIndices, theNbIndices);
+    theNormals = aComputedNormals.data();
+  }
+
+  // Interleaved float position and normal per vertex; indices are 16-bit below 65535 vertices
+  myTriangles = new Graphic3d_ArrayOfTriangles(static_cast<Standard_Integer>(theNbVertices),
+                                               static_cast<Standard_Integer>(theNbIndices),
+                                               Graphic3d_ArrayFlags_VertexNormal);
+  for (size_t v = 0; v < theNbVertices; ++v) {
+    myTriangles->AddVertex(thePositions[3 * v], thePositions[3 * v + 1], thePositions[3 * v + 2],
+                           theNormals[3 * v], theNormals[3 * v + 1], theNormals[3 * v + 2]);
+  }
+  for (size_t t = 0; t + 2 < theNbIndices; t += 3) {
+    myTriangles->AddEdges(theIndices[t] + 1, theIndices[t + 1] + 1, theIndices[t + 2] + 1);
+  }
+  SetDisplayMode(AIS_Shaded);
+}
+
+Standard_Boolean MeshPresentation::AcceptDisplayMode(const Standard_Integer theMode) const {
+  return theMode == AIS_Shaded;
+}
+
+void MeshPresentation::SetColor(const Quantity_Color& theColor) {
+  hasOwnColor = Standard_True;
+  myDrawer->SetColor(theColor);
+  if (!myDrawer->HasOwnShadingAspect()) {
+    myDrawer->SetShadingAspect(new Prs3d_ShadingAspect());
+    if (myDrawer->HasLink()) {
+      *myDrawer->ShadingAspect()->Aspect() = *myDrawer->Link()->ShadingAspect()->Aspect();
+    }
+  }
+  myDrawer->ShadingAspect()->SetColor(theColor, myCurrentFacingModel);
+  SynchronizeAspects();
+}
+
+void MeshPresentation::UnsetColor() {
+  hasOwnColor = Standard_False;
+  if (myDrawer->HasOwnShadingAspect() && myDrawer->HasLink()) {
+    myDrawer->ShadingAspect()->SetColor(myDrawer->Link()->ShadingAspect()->Color(myCurrentFacingModel),
+                                        myCurrentFacingModel);
+  }
+  SynchronizeAspects();
+}
+
+void MeshPresentation::Compute(const Handle(PrsMgr_PresentationManager)&,
+                               const Handle(Prs3d_Presentation)& thePrs,
+                               const Standard_Integer theMode) {
+  if (theMode != AIS_Shaded || myTriangles->VertexNumber() == 0) {
+    return;
+  }
+  Handle(Graphic3d_Group) aGroup = thePrs->NewGroup();
+  aGroup->SetGroupPrimitivesAspect(myDrawer->ShadingAspect()->Aspect());
+  aGroup->AddPrimitiveArray(myTriangles);
+}
+
+void MeshPresentation::ComputeSelection(const Handle(SelectMgr_Selection)& theSel,
+                                        const Standard_Integer theMode) {
+  if (theMode != 0 && theMode != AIS_Shape::SelectionMode(TopAbs_FACE) &&
+      theMode != AIS_Shape::SelectionMode(TopAbs_COMPOUND)) {
+    return;
+  }
+  Handle(SelectMgr_EntityOwner) anOwner = new SelectMgr_EntityOwner(this);
+  Handle(Select3D_SensitivePrimitiveArray) aSensitive = new Select3D_SensitivePrimitiveArray(anOwner);
+  if (aSensitive->InitTriangulation(myTriangles->Attributes(), myTriangles->Indices(), TopLoc_Location())) {
+    theSel->Add(aSensitive);
+  }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <AIS_InteractiveObject.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Quantity_Color.hxx>
+
+#include <cstddef>
+
+//! Server mesh displayed straight from its vertex and index buffers. The buffers
+//! are copied once into a Graphic3d_ArrayOfTriangles that the shaded presentation
+//! and the selection share, so no Poly_Triangulation, TopoDS_Face or BRep-derived
+//! presentation is built. The OpenGL driver uploads the array to static VBOs.
+class MeshPresentation : public AIS_InteractiveObject {
+  DEFINE_STANDARD_RTTI_INLINE(MeshPresentation, AIS_InteractiveObject)
+public:
+  //! Indices are 0-based and must be checked against theNbVertices by the caller.
+  //! Without normals, area-weighted vertex normals are computed from the triangles.
+  MeshPresentation(const float* thePositions, const float* theNormals, size_t theNbVertices,
+                   const int* theIndices, size_t theNbIndices);
+
+  const Handle(Graphic3d_ArrayOfTriangles)& Triangles() const { return myTriangles; }
+
+  //! Only the shaded mode is supported
+  Standard_Boolean AcceptDisplayMode(const Standard_Integer theMode) const override;
+
+  void SetColor(const Quantity_Color& theColor) override;
+  void UnsetColor() override;
+
+protected:
+  void Compute(const Handle(PrsMgr_PresentationManager)& thePrsMgr,
+               const Handle(Prs3d_Presentation)& thePrs,
+               const Standard_Integer theMode) override;
+
+  //! The whole mesh is one sensitive entity, picked in the shape, face and compound modes
+  void ComputeSelection(const Handle(SelectMgr_Selection)& theSel,
+                        const Standard_Integer theMode) override;
+
+private:
+  Handle(Graphic3d_ArrayOfTriangles) myTriangles;
+};
@@ -34,6 +34,7 @@
 
 // OCCT
 #include <AIS_AnimationCamera.hxx>
+#include <AIS_ConnectedInteractive.hxx>
 #include <AIS_DisplayMode.hxx>
 #include <AIS_InteractiveContext.hxx>
 #include <AIS_Shape.hxx>
@@ -41,11 +42,13 @@
 #include <AIS_ViewCube.hxx>
 #include <Aspect_DisplayConnection.hxx>
 #include <Aspect_Handle.hxx>
+#include <Bnd_Box.hxx>
 #include <BRepPrimAPI_MakeBox.hxx>
 #include <BRepPrimAPI_MakeCone.hxx>
 #include <ElSLib.hxx>
 #include <GeomAbs_Shape.hxx>
 #include <Graphic3d_AspectFillArea3d.hxx>
+#include <Graphic3d_Camera.hxx>
 #include <Graphic3d_MaterialAspect.hxx>
 #include <OpenGl_Context.hxx>
 #include <OpenGl_FrameBuffer.hxx>
@@ -75,9 +78,13 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <future>
 #include <cmath>
 #include <algorithm>
+#include <unordered_map>
+#include <deque>
+#include <limits>
 #include <cctype>
 
 // Platform specific includes for Aspect_Window
@@ -96,6 +103,88 @@
 #endif
 #include <GLFW/glfw3native.h> // For native access
 
+namespace {
+
+//! Blocking FIFO with a fixed capacity, connecting the scene loading threads.
+//! Producers pass an abort predicate so a stale producer never stays blocked on
+//! a full queue; call wakeAll() after changing what the predicate reads.
+template<typename T>
+class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t theCapacity) : capacity(theCapacity) {}
+
+  //! Blocks while full; returns false without queuing once closed or aborted
+  template<typename Abort>
+  bool push(T&& theItem, Abort theAbort) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [&] { return closed || theAbort() || items.size() < capacity; });
+    if (closed || theAbort()) {
+      return false;
+    }
+    items.push_back(std::move(theItem));
+    notEmpty.notify_one();
+    return true;
+  }
+
+  //! Blocks until an item is available; returns false once closed
+  bool pop(T& theItem) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [&] { return closed || !items.empty(); });
+    if (closed) {
+      return false;
+    }
+    theItem = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+
+  bool tryPop(T& theItem) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed || items.empty()) {
+      return false;
+    }
+    theItem = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+
+  bool empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return items.empty();
+  }
+
+  //! Drop queued items and release every blocked producer and consumer
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    items.clear();
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+
+  void reopen() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = false;
+  }
+
+  void wakeAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    notFull.notify_all();
+  }
+
+private:
+  const size_t capacity;
+  mutable std::mutex mutex;
+  std::condition_variable notFull;
+  std::condition_variable notEmpty;
+  std::deque<T> items;
+  bool closed{false};
+};
+
+} // namespace
+
 // Definition of the PIMPL struct
 struct OcctRenderClient::ViewInternal {
   //! GLFW window
@@ -164,6 +253,54 @@ struct OcctRenderClient::ViewInternal {
   bool showConsole{false};
   bool autoRefreshMeshes{false};
   float lastRefreshTime{0.0f};
+  static constexpr float AUTO_REFRESH_INTERVAL{1.0f}; // Delta sync is cheap when nothing changed
+  
+  // Scene mirrored from the server, updated incrementally via SyncScene
+  std::unordered_map<std::string, Handle(AIS_InteractiveObject)> serverShapes;
+  uint64_t sceneVersion{0};
+  std::atomic<bool> sceneChangesPending{false}; // Set by the scene subscription thread
+  
+  // Progressive level of detail: new shapes arrive coarse and are refined in the background
+  static constexpr uint32_t COARSE_SYNC_LOD{2};       // Clamped by the server
+  std::unordered_map<std::string, uint32_t> serverShapeLods; // Level each server shape is shown at
+  std::thread lodThread;
+  std::atomic<uint64_t> lodGeneration{0};              // Bumped to cancel a refinement stream
+  
+  // Pipelined scene loading: the load/LOD threads receive and decode, the build
+  // worker creates AIS shapes, the render thread only displays them
+  struct SceneUpdate {
+    enum class Kind { Reset, Upsert, Delete, Refine, Done };
+    Kind kind{Kind::Upsert};
+    uint64_t generation{0};                  // sceneGeneration, or lodGeneration for Refine
+    GeometryClient::MeshData mesh;           // Geometry is released once built
+    Handle(AIS_InteractiveObject) aisObject; // Built by the worker, null for empty meshes
+    bool success{false};                     // Done only
+    uint64_t sceneVersion{0};                // Done only
+  };
+  static constexpr size_t SCENE_QUEUE_CAPACITY{32};    // Per stage; bounds decoded meshes in flight
+  static constexpr double COMMIT_BUDGET_MS{8.0};       // Render thread time per frame for displaying
+  static constexpr size_t SCENE_PROGRESS_MIN_SHAPES{8}; // Smaller loads show no progress bar
+  BoundedQueue<SceneUpdate> buildQueue{SCENE_QUEUE_CAPACITY};
+  BoundedQueue<SceneUpdate> commitQueue{SCENE_QUEUE_CAPACITY};
+  std::thread buildThread;
+  std::thread sceneLoadThread;
+  std::atomic<uint64_t> sceneGeneration{0};            // Bumped to cancel a load
+  bool sceneLoadActive{false};
+  bool sceneResyncRequested{false};                    // syncScene() called during a load
+  bool sceneLoadChangedScene{false};
+  bool sceneLoadFitView{false};
+  std::atomic<size_t> sceneLoadReceived{0};
+  size_t sceneLoadCommitted{0};
+  
+  // Camera mirrored to the server session, so scene loads send what is on screen first
+  static constexpr float CAMERA_UPDATE_INTERVAL{0.15f}; // At most one update per interval while moving
+  Graphic3d_WorldViewProjState serverCameraState;       // State of the last camera sent or due
+  int serverCameraWidth{0};
+  int serverCameraHeight{0};
+  bool serverCameraDirty{false};
+  bool serverCameraConnected{false};
+  float lastCameraUpdateTime{0.0f};
+  std::future<bool> cameraUpdateFuture;
   
   // UI panels
   std::unique_ptr<GrpcPerformancePanel> performancePanel;
@@ -228,6 +365,7 @@ struct OcctRenderClient::ViewInternal {
   
   std::vector<std::shared_ptr<ImportTask>> importTasks;
   std::mutex importTasksMutex;
+  std::shared_ptr<ImportTask> sceneLoadTask;  // Progress entry of a large scene load
   
   // Legacy single import dialog (kept for compatibility)
   bool showModelProgressDialog{false};
@@ -950,6 +1088,12 @@ void OcctRenderClient::renderGui() {
         
         // Server statistics with caching to avoid excessive network calls
         float current_time = static_cast<float>(glfwGetTime());
+        
+        if (internal_->autoRefreshMeshes &&
+            (current_time - internal_->lastRefreshTime) >= internal_->AUTO_REFRESH_INTERVAL) {
+          internal_->lastRefreshTime = current_time;
+          syncScene();
+        }
         bool should_update = !internal_->hasValidSystemInfo || 
                             (current_time - internal_->lastSystemInfoUpdateTime) >= internal_->SYSTEM_INFO_UPDATE_INTERVAL;
         
@@ -1378,7 +1522,7 @@ void OcctRenderClient::mainloop() {
                   task->isActive.store(false);
                   spdlog::info("Model import completed successfully for {}. {} shapes imported.", 
                               task->fileName, result.shape_ids.size());
-                  refreshMeshes();
+                  syncScene();
                 } else {
                   task->progress.store(1.0f);
                   task->statusMessage = "Import failed: " + result.message;
@@ -1396,6 +1540,14 @@ void OcctRenderClient::mainloop() {
         }
       }
       
+      updateServerCamera();
+      
+      // Apply server-pushed scene changes on the render thread
+      if (internal_->sceneChangesPending.exchange(false)) {
+        syncScene();
+      }
+      commitSceneUpdates();
+      
       renderGui();
     }
   }
@@ -1713,6 +1865,7 @@ bool OcctRenderClient::initGeometryClient() {
     // Create geometry client if not exists
     if (!internal_->geometryClient) {
       internal_->geometryClient = std::make_unique<GeometryClient>("localhost:50051");
+      internal_->geometryClient->SetMeshInstancing(true); // Repeated parts share one presentation
     }
     
     // Create performance panel if not exists
@@ -1747,6 +1900,7 @@ bool OcctRenderClient::initGeometryClient() {
     
     if (connected) {
       spdlog::info("OcctRenderClient: Successfully connected to geometry server");
+      subscribeToSceneChanges();
       internal_->connectionStatus = ViewInternal::ConnectionStatus::Connected;
       internal_->connectionErrorMessage.clear();
       internal_->lastConnectionAttemptTime = static_cast<float>(glfwGetTime());
@@ -1773,6 +1927,15 @@ bool OcctRenderClient::initGeometryClient() {
   }
 }
 
+void OcctRenderClient::subscribeToSceneChanges() {
+  // Events arrive on the subscription thread; the render thread applies them via syncScene()
+  internal_->geometryClient->SetShapeUpdateCallback(
+      [this](const std::string&, const GeometryClient::MeshData&) {
+        internal_->sceneChangesPending.store(true);
+      });
+  internal_->geometryClient->StartSceneSubscription(false);
+}
+
 void OcctRenderClient::startAsyncConnection() {
   // Check if already connecting or connected
   if (internal_->isConnecting.load() || 
@@ -1792,6 +1955,7 @@ void OcctRenderClient::startAsyncConnection() {
       // Create client if needed
       if (!internal_->geometryClient) {
         internal_->geometryClient = std::make_unique<GeometryClient>("localhost:50051");
+        internal_->geometryClient->SetMeshInstancing(true); // Repeated parts share one presentation
       }
       
       // Create performance panel if not exists
@@ -1814,6 +1978,7 @@ void OcctRenderClient::startAsyncConnection() {
       result = internal_->geometryClient->Connect();
       
       if (result) {
+        subscribeToSceneChanges();
         internal_->connectionStatus = ViewInternal::ConnectionStatus::Connected;
         internal_->connectionErrorMessage.clear();
         spdlog::info("OcctRenderClient: Async connection succeeded");
@@ -1850,6 +2015,13 @@ void OcctRenderClient::shutdownGeometryClient() {
   spdlog::info("OcctRenderClient: Shutting down gRPC geometry client safely...");
   
   try {
+    cancelSceneLoad();
+    stopLodRefinement();
+    stopBuildWorker();
+    if (internal_->cameraUpdateFuture.valid()) {
+      internal_->cameraUpdateFuture.wait();
+    }
+    
     // Save current OpenGL context
     GLFWwindow* currentContext = glfwGetCurrentContext();
     
@@ -1898,11 +2070,7 @@ void OcctRenderClient::createRandomBox() {
     std::string shape_id = internal_->geometryClient->CreateBox(x, y, z, size, size, size);
     if (!shape_id.empty()) {
       spdlog::info("OcctRenderClient: Created box with ID: {}", shape_id);
-      // Get mesh data and convert to OCCT shape for display
-      auto mesh_data = internal_->geometryClient->GetMeshData(shape_id);
-      if (!mesh_data.vertices.empty()) {
-        addMeshAsAisShape(mesh_data);
-      }
+      syncScene();
     }
   } catch (const std::exception& e) {
     spdlog::error("OcctRenderClient::createRandomBox(): Error: {}", e.what());
@@ -1926,11 +2094,7 @@ void OcctRenderClient::createRandomCone() {
     std::string shape_id = internal_->geometryClient->CreateCone(x, y, z, base_radius, top_radius, height);
     if (!shape_id.empty()) {
       spdlog::info("OcctRenderClient: Created cone with ID: {}", shape_id);
-      // Get mesh data and convert to OCCT shape for display
-      auto mesh_data = internal_->geometryClient->GetMeshData(shape_id);
-      if (!mesh_data.vertices.empty()) {
-        addMeshAsAisShape(mesh_data);
-      }
+      syncScene();
     }
   } catch (const std::exception& e) {
     spdlog::error("OcctRenderClient::createRandomCone(): Error: {}", e.what());
@@ -1946,55 +2110,479 @@ void OcctRenderClient::createDemoScene() {
   try {
     internal_->geometryClient->CreateDemoScene();
     spdlog::info("OcctRenderClient: Created demo scene on server");
-    refreshMeshes();
+    syncScene();
   } catch (const std::exception& e) {
     spdlog::error("OcctRenderClient::createDemoScene(): Error: {}", e.what());
   }
 }
 
 void OcctRenderClient::refreshMeshes() {
+  // Force a full resync from the server
+  cancelSceneLoad();
+  internal_->sceneVersion = 0;
+  syncScene();
+}
+
+void OcctRenderClient::syncScene() {
   if (!internal_->geometryClient || !internal_->geometryClient->IsConnected()) {
-    spdlog::warn("OcctRenderClient::refreshMeshes(): Geometry client not connected");
+    spdlog::warn("OcctRenderClient::syncScene(): Geometry client not connected");
     return;
   }
   
-  try {
-    spdlog::info("OcctRenderClient: Refreshing meshes from server...");
+  if (internal_->sceneLoadActive) {
+    // Coalesce: one more delta is fetched once the running load is displayed
+    internal_->sceneResyncRequested = true;
+    return;
+  }
+  startSceneLoad();
+}
+
+void OcctRenderClient::startSceneLoad() {
+  ensureBuildWorker();
+  if (internal_->sceneLoadThread.joinable()) {
+    internal_->sceneLoadThread.join();
+  }
+  
+  const uint64_t generation = ++internal_->sceneGeneration;
+  internal_->sceneLoadActive = true;
+  internal_->sceneResyncRequested = false;
+  internal_->sceneLoadChangedScene = false;
+  internal_->sceneLoadFitView = false;
+  internal_->sceneLoadReceived.store(0);
+  internal_->sceneLoadCommitted = 0;
+  internal_->sceneLoadTask.reset();
+  
+  // New and changed shapes arrive coarse; startLodRefinement() streams the finer levels
+  GeometryClient* client = internal_->geometryClient.get();
+  const uint64_t since_version = internal_->sceneVersion;
+  internal_->sceneLoadThread = std::thread([this, client, generation, since_version] {
+    auto stale = [this, generation] { return internal_->sceneGeneration.load() != generation; };
+    auto forward = [&](ViewInternal::SceneUpdate&& update) {
+      update.generation = generation;
+      return internal_->buildQueue.push(std::move(update), stale);
+    };
+    
+    uint64_t scene_version = since_version;
+    bool success = client->SyncSceneStream(since_version, ViewInternal::COARSE_SYNC_LOD,
+        [&](GeometryClient::SceneChangeEvent&& event) {
+          ViewInternal::SceneUpdate update;
+          switch (event.type) {
+            case GeometryClient::SceneChangeEvent::Type::Reset:
+              update.kind = ViewInternal::SceneUpdate::Kind::Reset;
+              break;
+            case GeometryClient::SceneChangeEvent::Type::Deleted:
+              update.kind = ViewInternal::SceneUpdate::Kind::Delete;
+              break;
+            default:
+              update.kind = ViewInternal::SceneUpdate::Kind::Upsert;
+              internal_->sceneLoadReceived.fetch_add(1);
+              break;
+          }
+          update.mesh = std::move(event.mesh);
+          return forward(std::move(update));
+        }, scene_version);
     
-    // Clear existing objects
+    ViewInternal::SceneUpdate done;
+    done.kind = ViewInternal::SceneUpdate::Kind::Done;
+    done.success = success;
+    done.sceneVersion = scene_version;
+    forward(std::move(done));
+  });
+}
+
+void OcctRenderClient::cancelSceneLoad() {
+  // Never wait on a thread blocked in push: stale producers give up after wakeAll()
+  ++internal_->sceneGeneration;
+  internal_->buildQueue.wakeAll();
+  internal_->commitQueue.wakeAll();
+  if (internal_->geometryClient) {
+    internal_->geometryClient->CancelSceneSyncStream();
+  }
+  if (internal_->sceneLoadThread.joinable()) {
+    internal_->sceneLoadThread.join();
+  }
+  
+  if (internal_->sceneLoadActive) {
+    spdlog::info("OcctRenderClient: Scene load cancelled, {} of {} shapes displayed",
+                 internal_->sceneLoadCommitted, internal_->sceneLoadReceived.load());
+  }
+  internal_->sceneLoadActive = false;
+  internal_->sceneResyncRequested = false;
+  if (internal_->sceneLoadTask) {
+    std::lock_guard<std::mutex> lock(internal_->importTasksMutex);
+    if (internal_->sceneLoadTask->isActive.load()) {
+      internal_->sceneLoadTask->statusMessage = "Cancelled";
+    }
+    internal_->sceneLoadTask->progress.store(1.0f);
+    internal_->sceneLoadTask->isActive.store(false);
+    internal_->sceneLoadTask.reset();
+  }
+}
+
+void OcctRenderClient::startLodRefinement() {
+  stopLodRefinement();
+  if (!internal_->geometryClient || !internal_->geometryClient->IsConnected()) {
+    return;
+  }
+  
+  std::vector<GeometryClient::LodTarget> targets;
+  for (const auto& [shape_id, lod] : internal_->serverShapeLods) {
+    auto it = internal_->serverShapes.find(shape_id);
+    if (lod > 0 && it != internal_->serverShapes.end()) {
+      targets.push_back({shape_id, screenSizeOf(it->second), true, lod});
+    }
+  }
+  if (targets.empty()) {
+    return;
+  }
+  
+  // Refinements take the same build worker path as scene loads
+  ensureBuildWorker();
+  const uint64_t generation = internal_->lodGeneration.load();
+  GeometryClient* client = internal_->geometryClient.get();
+  internal_->lodThread = std::thread([this, client, generation, targets = std::move(targets)] {
+    auto stale = [this, generation] { return internal_->lodGeneration.load() != generation; };
+    client->StreamMeshLods(targets, [&](GeometryClient::MeshData&& mesh_data) {
+      ViewInternal::SceneUpdate update;
+      update.kind = ViewInternal::SceneUpdate::Kind::Refine;
+      update.generation = generation;
+      update.mesh = std::move(mesh_data);
+      return internal_->buildQueue.push(std::move(update), stale);
+    });
+  });
+}
+
+void OcctRenderClient::stopLodRefinement() {
+  // Also invalidates refinements already queued for building or display
+  ++internal_->lodGeneration;
+  internal_->buildQueue.wakeAll();
+  internal_->commitQueue.wakeAll();
+  if (internal_->lodThread.joinable()) {
+    if (internal_->geometryClient) {
+      internal_->geometryClient->CancelMeshLodStream();
+    }
+    internal_->lodThread.join();
+  }
+}
+
+void OcctRenderClient::ensureBuildWorker() {
+  if (internal_->buildThread.joinable()) {
+    return;
+  }
+  
+  internal_->buildQueue.reopen();
+  internal_->commitQueue.reopen();
+  internal_->buildThread = std::thread([this] {
+    // Presentations of repeated parts by prototype and level, shared by their instances
+    std::unordered_map<std::string, Handle(MeshPresentation)> prototypes;
+    ViewInternal::SceneUpdate update;
+    while (internal_->buildQueue.pop(update)) {
+      const auto& generation = update.kind == ViewInternal::SceneUpdate::Kind::Refine
+                                   ? internal_->lodGeneration : internal_->sceneGeneration;
+      auto stale = [&generation, expected = update.generation] { return generation.load() != expected; };
+      if (update.kind == ViewInternal::SceneUpdate::Kind::Reset) {
+        prototypes.clear();
+      }
+      if (stale()) {
+        continue;
+      }
+      
+      const bool has_geometry = update.kind == ViewInternal::SceneUpdate::Kind::Upsert ||
+                                update.kind == ViewInternal::SceneUpdate::Kind::Refine;
+      try {
+        if (has_geometry && !update.mesh.prototype_id.empty()) {
+          const std::string key = update.mesh.prototype_id + "@" + std::to_string(update.mesh.lod);
+          if (!update.mesh.vertices.empty()) {
+            Handle(MeshPresentation) prototype = buildMeshPresentation(update.mesh);
+            if (!prototype.IsNull()) {
+              prototype->SetLocalTransformation(gp_Trsf()); // Instances carry the display scale
+              prototypes[key] = prototype;
+            }
+          }
+          auto prototype_it = prototypes.find(key);
+          if (prototype_it != prototypes.end()) {
+            const auto& m = update.mesh.instance_transform;
+            gp_Trsf placement;
+            placement.SetValues(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11]);
+            gp_Trsf location;
+            location.SetScaleFactor(SERVER_SHAPE_SCALE);
+            location.Multiply(placement);
+            Handle(AIS_ConnectedInteractive) instance = new AIS_ConnectedInteractive();
+            instance->Connect(prototype_it->second, location);
+            update.aisObject = instance;
+          } else {
+            spdlog::warn("OcctRenderClient: No geometry received for prototype {} of {}",
+                         update.mesh.prototype_id, update.mesh.shape_id);
+          }
+        } else if (has_geometry && !update.mesh.vertices.empty()) {
+          update.aisObject = buildMeshPresentation(update.mesh);
+        }
+      } catch (...) {
+        spdlog::warn("OcctRenderClient: Failed to build mesh presentation for {}", update.mesh.shape_id);
+      }
+      // The commit step only needs the id and level
+      update.mesh.vertices = {};
+      update.mesh.normals = {};
+      update.mesh.indices = {};
+      
+      if (internal_->commitQueue.push(std::move(update), stale)) {
+        glfwPostEmptyEvent(); // Wake the render loop
+      }
+      update = ViewInternal::SceneUpdate();
+    }
+  });
+}
+
+void OcctRenderClient::stopBuildWorker() {
+  internal_->buildQueue.close();
+  internal_->commitQueue.close();
+  if (internal_->buildThread.joinable()) {
+    internal_->buildThread.join();
+  }
+}
+
+void OcctRenderClient::removeServerShape(const std::string& theShapeId) {
+  auto it = internal_->serverShapes.find(theShapeId);
+  if (it != internal_->serverShapes.end()) {
     if (!internal_->context.IsNull()) {
-      internal_->context->RemoveAll(false);
+      internal_->context->Remove(it->second, false);
     }
-    
-    // Get all meshes from server
-    auto all_meshes = internal_->geometryClient->GetAllMeshes();
-    
-    for (const auto& mesh_data : all_meshes) {
-      if (!mesh_data.vertices.empty()) {
-        try {
-          addMeshAsAisShape(mesh_data);
-        } catch (const std::exception& e) {
-          spdlog::warn("OcctRenderClient::refreshMeshes(): Failed to add mesh as AIS shape: {}", e.what());
-        } catch (...) {
-          spdlog::warn("OcctRenderClient::refreshMeshes(): Unknown exception when adding mesh");
+    internal_->serverShapes.erase(it);
+  }
+  internal_->serverShapeLods.erase(theShapeId);
+}
+
+void OcctRenderClient::commitSceneUpdates() {
+  if (internal_->sceneLoadTask && !internal_->sceneLoadTask->isActive.load()) {
+    cancelSceneLoad(); // Cancel button in the import progress list
+  }
+  
+  using Kind = ViewInternal::SceneUpdate::Kind;
+  const auto start = std::chrono::steady_clock::now();
+  const auto budget = std::chrono::duration<double, std::milli>(ViewInternal::COMMIT_BUDGET_MS);
+  const size_t committed_before = internal_->sceneLoadCommitted;
+  bool redraw = false;
+  bool load_finished = false;
+  bool load_succeeded = false;
+  
+  // Always at least one item, so progress is made even when a frame runs over budget
+  ViewInternal::SceneUpdate update;
+  while (internal_->commitQueue.tryPop(update)) {
+    if (update.kind == Kind::Refine) {
+      auto lod_it = internal_->serverShapeLods.find(update.mesh.shape_id);
+      auto shape_it = internal_->serverShapes.find(update.mesh.shape_id);
+      if (update.generation == internal_->lodGeneration.load() && !update.aisObject.IsNull() &&
+          lod_it != internal_->serverShapeLods.end() && shape_it != internal_->serverShapes.end() &&
+          update.mesh.lod < lod_it->second && !internal_->context.IsNull()) {
+        // Display the finer mesh before removing the coarse one so the shape never disappears
+        update.aisObject->SetAttributes(getDefaultAISDrawer());
+        internal_->context->Display(update.aisObject, AIS_Shaded, 0, false);
+        internal_->context->Remove(shape_it->second, false);
+        shape_it->second = update.aisObject;
+        lod_it->second = update.mesh.lod;
+        redraw = true;
+      }
+    } else if (update.generation == internal_->sceneGeneration.load()) {
+      if (update.kind != Kind::Done && !internal_->sceneLoadChangedScene) {
+        // Queued refinements may belong to replaced geometry
+        internal_->sceneLoadChangedScene = true;
+        stopLodRefinement();
+      }
+      
+      switch (update.kind) {
+        case Kind::Reset:
+          if (!internal_->context.IsNull()) {
+            for (const auto& [shape_id, ais_object] : internal_->serverShapes) {
+              internal_->context->Remove(ais_object, false);
+            }
+          }
+          internal_->serverShapes.clear();
+          internal_->serverShapeLods.clear();
+          internal_->sceneLoadFitView = true;
+          redraw = true;
+          break;
+        case Kind::Delete:
+          removeServerShape(update.mesh.shape_id);
+          redraw = true;
+          break;
+        case Kind::Upsert: {
+          ++internal_->sceneLoadCommitted;
+          internal_->sceneLoadFitView |= internal_->serverShapes.count(update.mesh.shape_id) == 0;
+          if (!update.aisObject.IsNull() && !internal_->context.IsNull()) {
+            update.aisObject->SetAttributes(getDefaultAISDrawer());
+            internal_->context->Display(update.aisObject, AIS_Shaded, 0, false);
+          }
+          removeServerShape(update.mesh.shape_id);
+          if (!update.aisObject.IsNull()) {
+            internal_->serverShapes[update.mesh.shape_id] = update.aisObject;
+            internal_->serverShapeLods[update.mesh.shape_id] = update.mesh.lod;
+          }
+          redraw = true;
+          break;
         }
+        case Kind::Done:
+          load_finished = true;
+          load_succeeded = update.success;
+          if (update.success) {
+            internal_->sceneVersion = update.sceneVersion;
+          }
+          break;
+        default:
+          break;
       }
     }
     
-    // Update view
-    if (!internal_->view.IsNull()) {
-      internal_->view->FitAll();
-      internal_->view->Redraw();
+    update = ViewInternal::SceneUpdate();
+    if (load_finished || std::chrono::steady_clock::now() - start >= budget) {
+      break;
     }
+  }
+  
+  // Large loads report into the import progress list; counts are of received shapes,
+  // the total is not known up front
+  const size_t received = internal_->sceneLoadReceived.load();
+  if (internal_->sceneLoadActive && !internal_->sceneLoadTask && !load_finished &&
+      received > ViewInternal::SCENE_PROGRESS_MIN_SHAPES) {
+    auto task = std::make_shared<ViewInternal::ImportTask>("Scene sync");
+    task->format = "SCENE";
+    std::lock_guard<std::mutex> lock(internal_->importTasksMutex);
+    internal_->importTasks.push_back(task);
+    internal_->sceneLoadTask = task;
+  }
+  if (internal_->sceneLoadTask) {
+    std::lock_guard<std::mutex> lock(internal_->importTasksMutex);
+    internal_->sceneLoadTask->progress.store(
+        load_finished ? 1.0f : static_cast<float>(internal_->sceneLoadCommitted) / std::max<size_t>(received, 1));
+    internal_->sceneLoadTask->statusMessage = "Displayed " + std::to_string(internal_->sceneLoadCommitted) +
+                                              " of " + std::to_string(received) + " shapes";
+    if (load_finished) {
+      if (!load_succeeded) {
+        internal_->sceneLoadTask->statusMessage += " (sync failed)";
+      }
+      internal_->sceneLoadTask->isActive.store(false);
+    }
+  }
+  
+  // Frame the first shapes of a load right away and the whole scene once it is complete
+  if (internal_->sceneLoadFitView && !internal_->view.IsNull() &&
+      committed_before == 0 && internal_->sceneLoadCommitted > 0 && !load_finished) {
+    internal_->view->FitAll();
+  }
+  
+  if (load_finished) {
+    if (internal_->sceneLoadThread.joinable()) {
+      internal_->sceneLoadThread.join();
+    }
+    internal_->sceneLoadActive = false;
+    internal_->sceneLoadTask.reset();
     
-    spdlog::info("OcctRenderClient: Refreshed {} meshes", all_meshes.size());
-  } catch (const std::exception& e) {
-    spdlog::error("OcctRenderClient::refreshMeshes(): Error: {}", e.what());
+    if (internal_->sceneLoadFitView && !internal_->view.IsNull()) {
+      internal_->view->FitAll();
+      redraw = true;
+    }
+    if (internal_->sceneLoadChangedScene) {
+      spdlog::info("OcctRenderClient: Synced scene to version {}: {} changed, {} shapes displayed",
+                   internal_->sceneVersion, internal_->sceneLoadCommitted, internal_->serverShapes.size());
+      startLodRefinement();
+    }
+    if (load_succeeded && internal_->sceneResyncRequested) {
+      syncScene();
+    }
+  }
+  
+  if (redraw && !internal_->view.IsNull()) {
+    internal_->view->Redraw();
+  }
+  if (!internal_->commitQueue.empty()) {
+    glfwPostEmptyEvent(); // Continue next frame
   }
 }
 
+void OcctRenderClient::updateServerCamera() {
+  const bool connected = internal_->geometryClient && internal_->geometryClient->IsConnected();
+  if (connected != internal_->serverCameraConnected) {
+    internal_->serverCameraConnected = connected;
+    internal_->serverCameraDirty = connected; // A new session knows no camera yet
+  }
+  if (!connected || internal_->view.IsNull()) {
+    return;
+  }
+  
+  const Handle(Graphic3d_Camera)& camera = internal_->view->Camera();
+  if (camera->WorldViewProjState().IsChanged(internal_->serverCameraState)
+      || internal_->renderWidth != internal_->serverCameraWidth
+      || internal_->renderHeight != internal_->serverCameraHeight) {
+    internal_->serverCameraState = camera->WorldViewProjState();
+    internal_->serverCameraWidth = internal_->renderWidth;
+    internal_->serverCameraHeight = internal_->renderHeight;
+    internal_->serverCameraDirty = true;
+  }
+  if (!internal_->serverCameraDirty) {
+    return;
+  }
+  
+  // Debounce: one update in flight and at most one per interval; the last position is always sent
+  auto& pending = internal_->cameraUpdateFuture;
+  const float now = static_cast<float>(glfwGetTime());
+  const bool busy = pending.valid() && pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+  if (busy || now - internal_->lastCameraUpdateTime < ViewInternal::CAMERA_UPDATE_INTERVAL) {
+    glfwPostEmptyEvent(); // Check again next frame
+    return;
+  }
+  if (pending.valid()) {
+    pending.get();
+  }
+  
+  // Server shapes are displayed scaled up, so the scale is folded into the view matrix
+  GeometryClient::ViewCamera update;
+  const Graphic3d_Mat4d& orientation = camera->OrientationMatrix();
+  const Graphic3d_Mat4d& projection = camera->ProjectionMatrix();
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 4; ++col) {
+      update.view[4 * row + col] = orientation.GetValue(row, col) * (col < 3 ? SERVER_SHAPE_SCALE : 1.0);
+      update.projection[4 * row + col] = projection.GetValue(row, col);
+    }
+  }
+  update.viewport_width = static_cast<uint32_t>(internal_->renderWidth);
+  update.viewport_height = static_cast<uint32_t>(internal_->renderHeight);
+  
+  internal_->serverCameraDirty = false;
+  internal_->lastCameraUpdateTime = now;
+  GeometryClient* client = internal_->geometryClient.get();
+  pending = std::async(std::launch::async, [client, update] { return client->UpdateCamera(update); });
+}
+
+float OcctRenderClient::screenSizeOf(const Handle(AIS_InteractiveObject) & theObject) const {
+  if (internal_->view.IsNull() || theObject.IsNull()) {
+    return 0.0f;
+  }
+  Bnd_Box box;
+  theObject->BoundingBox(box);
+  if (box.IsVoid()) {
+    return 0.0f;
+  }
+  box = box.Transformed(theObject->LocalTransformation()); // Server meshes carry their display scale
+  
+  double xmin, ymin, zmin, xmax, ymax, zmax;
+  box.Get(xmin, ymin, zmin, xmax, ymax, zmax);
+  int pxMin = std::numeric_limits<int>::max(), pyMin = std::numeric_limits<int>::max();
+  int pxMax = std::numeric_limits<int>::min(), pyMax = std::numeric_limits<int>::min();
+  for (int corner = 0; corner < 8; ++corner) {
+    int px = 0, py = 0;
+    internal_->view->Convert(corner & 1 ? xmax : xmin, corner & 2 ? ymax : ymin, corner & 4 ? zmax : zmin, px, py);
+    pxMin = std::min(pxMin, px);
+    pyMin = std::min(pyMin, py);
+    pxMax = std::max(pxMax, px);
+    pyMax = std::max(pyMax, py);
+  }
+  return static_cast<float>(std::max(pxMax - pxMin, pyMax - pyMin));
+}
+
 void OcctRenderClient::clearAllShapes() {
   try {
+    cancelSceneLoad();
+    stopLodRefinement();
+    
     if (internal_->geometryClient && internal_->geometryClient->IsConnected()) {
       internal_->geometryClient->ClearAll();
     }
@@ -2002,6 +2590,9 @@ void OcctRenderClient::clearAllShapes() {
     if (!internal_->context.IsNull()) {
       internal_->context->RemoveAll(false);
     }
+    internal_->serverShapes.clear();
+    internal_->serverShapeLods.clear();
+    internal_->sceneVersion = 0;
     
     if (!internal_->view.IsNull()) {
       internal_->view->Redraw();
@@ -2261,4 +2852,4 @@ void OcctRenderClient::importModelFile() {
   NFD_Quit();
 }
 
-// Template method addMeshAsAisShape is now implemented in the header file
+// Template method addMeshPresentation is now implemented in the header file
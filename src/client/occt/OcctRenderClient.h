@@ -25,20 +25,17 @@
 
 #include <AIS_InteractiveObject.hxx>
 #include <AIS_ViewController.hxx> // Base class
-#include <AIS_Shape.hxx>         // For AIS_Shape (recommended over AIS_Triangulation)
 #include <Quantity_Color.hxx>     // For Quantity_Color
 #include <gp_Pnt.hxx>
 #include <gp_Dir.hxx>
-#include <Poly_Triangulation.hxx>
-#include <Poly_Triangle.hxx>
 #include <Standard_Failure.hxx>
-#include <Bnd_Box.hxx>           // For bounding box calculation
 #include <Prs3d_Drawer.hxx>      // For presentation attributes
 #include <Prs3d_ShadingAspect.hxx> // For shading configuration
 #include <Graphic3d_AspectFillArea3d.hxx> // For fill area aspect
-#include <TopoDS_Face.hxx>       // For creating TopoDS_Face from triangulation
-#include <BRep_Builder.hxx>      // For building topology
-#include <BRepBuilderAPI_MakeFace.hxx> // For creating faces from triangulation
+#include <gp_Trsf.hxx>           // Scale applied as a local transformation
+#include "MeshPresentation.h"    // Server meshes drawn straight from their buffers
+#include <algorithm>
+#include <cstring>
 #include <memory> // For std::unique_ptr
 #include <spdlog/spdlog.h> // For logging
 #include <nfd.h> // Native File Dialog for file selection
@@ -71,6 +68,11 @@ public:
   //! Add an ais object to the ais context.
   void addAisObject(const Handle(AIS_InteractiveObject) & theAisObject);
 
+  //! Convert mesh data to a MeshPresentation without displaying it; returns null on failure.
+  //! Touches no viewer state, so it may run off the render thread.
+  template<typename MeshDataType>
+  static Handle(MeshPresentation) buildMeshPresentation(const MeshDataType& mesh_data);
+
   //! Connect to geometry server and initialize gRPC client (synchronous)
   bool initGeometryClient();
   
@@ -79,12 +81,16 @@ public:
 
   //! Safely disconnect gRPC client
   void shutdownGeometryClient();
+  
+  //! Subscribe to server-pushed scene changes (triggers syncScene on the render thread)
+  void subscribeToSceneChanges();
 
   //! Create geometry via gRPC and add to viewer
   void createRandomBox();
   void createRandomCone();
   void createDemoScene();
   void refreshMeshes();
+  void syncScene();
   void clearAllShapes();
   
   //! STEP file import
@@ -191,183 +197,130 @@ private:
   //! Get the default AIS drawer for nice shape display (shaded with edges)
   Handle(Prs3d_Drawer) getDefaultAISDrawer();
 
-  //! Convert mesh data to AIS_Triangulation and display it
+  //! Receive a scene delta on a network thread; shapes are built by the build
+  //! worker and committed by commitSceneUpdates() on the render thread
+  void startSceneLoad();
+  void cancelSceneLoad();
+
+  //! Stream finer levels of detail for displayed coarse shapes in the background
+  void startLodRefinement();
+  void stopLodRefinement();
+
+  //! Worker thread turning received meshes into AIS objects; instanced parts become
+  //! AIS_ConnectedInteractive objects sharing one prototype presentation
+  void ensureBuildWorker();
+  void stopBuildWorker();
+
+  //! Display built shapes within a per-frame time budget
+  void commitSceneUpdates();
+
+  //! Remove a server shape from the view and the local scene mirror
+  void removeServerShape(const std::string& theShapeId);
+
+  //! Send the view camera to the server when it changed, debounced and off the render thread
+  void updateServerCamera();
+
+  //! Projected size of an object's bounding box in pixels, 0 if unknown
+  float screenSizeOf(const Handle(AIS_InteractiveObject) & theObject) const;
+
+  //! Convert mesh data to a MeshPresentation and display it; returns null on failure
   template<typename MeshDataType>
-  void addMeshAsAisShape(const MeshDataType& mesh_data);
+  Handle(MeshPresentation) addMeshPresentation(const MeshDataType& mesh_data);
 
 private:
+  //! Server shapes are displayed scaled up by this factor
+  static constexpr double SERVER_SHAPE_SCALE = 10.0;
+
   struct ViewInternal;
   std::unique_ptr<ViewInternal> internal_;
 };
 
-// Template method implementation - Using TopoDS_Face + AIS_Shape (OCCT recommended approach)
 template<typename MeshDataType>
-void OcctRenderClient::addMeshAsAisShape(const MeshDataType& mesh_data) {
+Handle(MeshPresentation) OcctRenderClient::addMeshPresentation(const MeshDataType& mesh_data) {
+  Handle(MeshPresentation) presentation = buildMeshPresentation(mesh_data);
+  if (!presentation.IsNull()) {
+    spdlog::debug("OcctRenderClient::addMeshPresentation(): About to add MeshPresentation to display");
+    addAisObject(presentation);
+  }
+  return presentation;
+}
+
+// Template method implementation - buffers go straight into a MeshPresentation
+template<typename MeshDataType>
+Handle(MeshPresentation) OcctRenderClient::buildMeshPresentation(const MeshDataType& mesh_data) {
   if (mesh_data.vertices.empty() || mesh_data.indices.empty()) {
-    spdlog::error("OcctRenderClient::addMeshAsAisShape(): Empty mesh data");
-    return;
+    spdlog::error("OcctRenderClient::buildMeshPresentation(): Empty mesh data");
+    return Handle(MeshPresentation)();
   }
   
   // Validate mesh data integrity
   if (mesh_data.vertices.size() % 3 != 0) {
-    spdlog::error("OcctRenderClient::addMeshAsAisShape(): Invalid vertices size: {}", mesh_data.vertices.size());
-    return;
+    spdlog::error("OcctRenderClient::buildMeshPresentation(): Invalid vertices size: {}", mesh_data.vertices.size());
+    return Handle(MeshPresentation)();
   }
   
   if (mesh_data.indices.size() % 3 != 0) {
-    spdlog::error("OcctRenderClient::addMeshAsAisShape(): Invalid indices size: {}", mesh_data.indices.size());
-    return;
+    spdlog::error("OcctRenderClient::buildMeshPresentation(): Invalid indices size: {}", mesh_data.indices.size());
+    return Handle(MeshPresentation)();
   }
   
-  const int numVertices = static_cast<int>(mesh_data.vertices.size() / 3);
-  const int numTriangles = static_cast<int>(mesh_data.indices.size() / 3);
+  const size_t numVertices = mesh_data.vertices.size() / 3;
+  const bool hasNormals = mesh_data.normals.size() == mesh_data.vertices.size();
   
-  // Check for index bounds
-  for (size_t i = 0; i < mesh_data.indices.size(); ++i) {
-    if (mesh_data.indices[i] >= numVertices || mesh_data.indices[i] < 0) {
-      spdlog::error("OcctRenderClient::addMeshAsAisShape(): Index out of bounds: {} (max: {})", 
-                   mesh_data.indices[i], numVertices - 1);
-      return;
-    }
+  // Single branch-free range check; negative indices wrap to large unsigned values
+  const auto* indices = mesh_data.indices.data();
+  const size_t numIndices = mesh_data.indices.size();
+  uint32_t maxIndex = 0;
+  for (size_t i = 0; i < numIndices; ++i) {
+    maxIndex = std::max(maxIndex, static_cast<uint32_t>(indices[i]));
+  }
+  if (maxIndex >= numVertices) {
+    spdlog::error("OcctRenderClient::buildMeshPresentation(): Index out of bounds: {} (max: {})", 
+                 static_cast<int32_t>(maxIndex), numVertices - 1);
+    return Handle(MeshPresentation)();
   }
   
   try {
-    const double scaleFactor = 10.0; // Scale up server shapes for visibility
-    spdlog::debug("OcctRenderClient::addMeshAsAisShape(): Creating TopoDS_Face from triangulation with {} vertices, {} triangles ({}x scaling)", 
-                  numVertices, numTriangles, scaleFactor);
+#ifdef OCCT_CLIENT_VERBOSE_MESH_LOG
+    spdlog::debug("OcctRenderClient::buildMeshPresentation(): {} vertices, {} triangles ({}x scaling)", 
+                  numVertices, numIndices / 3, SERVER_SHAPE_SCALE);
+    spdlog::debug("  First vertex: ({:.3f}, {:.3f}, {:.3f})", 
+                  mesh_data.vertices[0], mesh_data.vertices[1], mesh_data.vertices[2]);
+    spdlog::debug("  First triangle indices: [{}, {}, {}]", 
+                  mesh_data.indices[0], mesh_data.indices[1], mesh_data.indices[2]);
+#endif
     
-    // Log first few vertices for debugging (original and scaled)
-    if (numVertices > 0) {
-      spdlog::debug("  First vertex: ({:.3f}, {:.3f}, {:.3f}) -> scaled: ({:.3f}, {:.3f}, {:.3f})", 
-                    mesh_data.vertices[0], mesh_data.vertices[1], mesh_data.vertices[2],
-                    mesh_data.vertices[0] * scaleFactor, mesh_data.vertices[1] * scaleFactor, mesh_data.vertices[2] * scaleFactor);
-      if (numVertices > 1) {
-        spdlog::debug("  Second vertex: ({:.3f}, {:.3f}, {:.3f}) -> scaled: ({:.3f}, {:.3f}, {:.3f})", 
-                      mesh_data.vertices[3], mesh_data.vertices[4], mesh_data.vertices[5],
-                      mesh_data.vertices[3] * scaleFactor, mesh_data.vertices[4] * scaleFactor, mesh_data.vertices[5] * scaleFactor);
-      }
-    }
-    
-    // Log first few indices for debugging
-    if (numTriangles > 0) {
-      spdlog::debug("  First triangle indices: [{}, {}, {}]", 
-                    mesh_data.indices[0], mesh_data.indices[1], mesh_data.indices[2]);
-    }
-    
-    // Create triangulation from mesh data with validation
-    Handle(Poly_Triangulation) triangulation = new Poly_Triangulation(
-        numVertices, numTriangles, Standard_True);
-    
-    // Add vertices with bounds checking and scaling
-    for (int v = 0; v < numVertices; ++v) {
-      int idx = v * 3;
-      if (idx + 2 < static_cast<int>(mesh_data.vertices.size())) {
-        gp_Pnt point(mesh_data.vertices[idx] * scaleFactor, 
-                     mesh_data.vertices[idx+1] * scaleFactor, 
-                     mesh_data.vertices[idx+2] * scaleFactor);
-        triangulation->SetNode(v + 1, point); // OCCT uses 1-based indexing
-      }
-    }
-    
-    // Add normals if available with bounds checking
-    if (mesh_data.normals.size() == mesh_data.vertices.size()) {
-      for (int v = 0; v < numVertices; ++v) {
-        int idx = v * 3;
-        if (idx + 2 < static_cast<int>(mesh_data.normals.size())) {
-          try {
-            gp_Dir normal(mesh_data.normals[idx], mesh_data.normals[idx+1], mesh_data.normals[idx+2]);
-            triangulation->SetNormal(v + 1, normal); // OCCT uses 1-based indexing
-          } catch (...) {
-            // Skip invalid normals
-          }
-        }
-      }
-    }
-    
-    // Add triangles with bounds checking
-    for (int t = 0; t < numTriangles; ++t) {
-      int idx = t * 3;
-      if (idx + 2 < static_cast<int>(mesh_data.indices.size())) {
-        // Convert from 0-based to 1-based indexing for OCCT
-        int v1 = mesh_data.indices[idx] + 1;
-        int v2 = mesh_data.indices[idx + 1] + 1;
-        int v3 = mesh_data.indices[idx + 2] + 1;
-        
-        // Ensure indices are within valid range
-        if (v1 > 0 && v1 <= numVertices && 
-            v2 > 0 && v2 <= numVertices && 
-            v3 > 0 && v3 <= numVertices) {
-          Poly_Triangle triangle(v1, v2, v3);
-          triangulation->SetTriangle(t + 1, triangle); // OCCT uses 1-based indexing
-        }
-      }
-    }
-    
-    // Validate triangulation creation
-    if (triangulation.IsNull()) {
-      spdlog::error("OcctRenderClient::addMeshAsAisShape(): Failed to create triangulation");
-      return;
-    }
-    
-    // Log triangulation bounding box
-    Bnd_Box bbox;
-    for (int i = 1; i <= triangulation->NbNodes(); ++i) {
-      bbox.Add(triangulation->Node(i));
-    }
-    if (!bbox.IsVoid()) {
-      double xmin, ymin, zmin, xmax, ymax, zmax;
-      bbox.Get(xmin, ymin, zmin, xmax, ymax, zmax);
-      spdlog::debug("  Triangulation bounding box: ({:.3f},{:.3f},{:.3f}) to ({:.3f},{:.3f},{:.3f})",
-                    xmin, ymin, zmin, xmax, ymax, zmax);
-    }
-    
-    // OCCT recommended approach: Create TopoDS_Face from triangulation then use AIS_Shape
-    spdlog::debug("OcctRenderClient::addMeshAsAisShape(): Creating TopoDS_Face from triangulation (OCCT recommended)");
-    
-    // Create a face from the triangulation using BRepBuilderAPI_MakeFace
-    TopoDS_Face face;
-    BRep_Builder builder;
-    builder.MakeFace(face);
-    builder.UpdateFace(face, triangulation);
-    
-    if (face.IsNull()) {
-      spdlog::error("OcctRenderClient::addMeshAsAisShape(): Failed to create TopoDS_Face from triangulation");
-      return;
-    }
-    
-    // Create AIS_Shape from the face (much more flexible and efficient than AIS_Triangulation)
-    Handle(AIS_Shape) ais_shape = new AIS_Shape(face);
-    
-    if (ais_shape.IsNull()) {
-      spdlog::error("OcctRenderClient::addMeshAsAisShape(): Failed to create AIS_Shape");
-      return;
-    }
+    Handle(MeshPresentation) presentation = new MeshPresentation(
+        mesh_data.vertices.data(), hasNormals ? mesh_data.normals.data() : nullptr, numVertices,
+        indices, numIndices);
     
-    // Set display mode to shaded
-    ais_shape->SetDisplayMode(1);  // 1 = Shaded mode
+    // The scale is applied as a local transformation, not per vertex
+    gp_Trsf scale;
+    scale.SetScaleFactor(SERVER_SHAPE_SCALE);
+    presentation->SetLocalTransformation(scale);
     
     // Set color - use bright red for visibility testing
     if (sizeof(mesh_data.color) >= 4 * sizeof(float)) {
       // Force bright red color for debugging visibility
       Quantity_Color color(1.0, 0.0, 0.0, Quantity_TOC_RGB);  // Bright red
-      ais_shape->SetColor(color);
-      ais_shape->SetTransparency(0.0);  // Fully opaque
-      spdlog::debug("  Set color: FORCED BRIGHT RED (1.0, 0.0, 0.0) for AIS_Shape visibility test");
+      presentation->SetColor(color);
+      presentation->SetTransparency(0.0);  // Fully opaque
+#ifdef OCCT_CLIENT_VERBOSE_MESH_LOG
       spdlog::debug("  Original color would be: ({:.3f}, {:.3f}, {:.3f}, {:.3f})", 
                     mesh_data.color[0], mesh_data.color[1], mesh_data.color[2], mesh_data.color[3]);
+#endif
     }
     
-    // Display the shape using AIS_Shape (should work much better than AIS_Triangulation)
-    spdlog::debug("OcctRenderClient::addMeshAsAisShape(): About to add AIS_Shape to display");
-    addAisObject(ais_shape);
+    return presentation;
     
   } catch (const std::exception& e) {
-    spdlog::error("OcctRenderClient::addMeshAsAisShape(): Standard exception: {}", e.what());
+    spdlog::error("OcctRenderClient::buildMeshPresentation(): Standard exception: {}", e.what());
   } catch (const Standard_Failure& e) {
-    spdlog::error("OcctRenderClient::addMeshAsAisShape(): OCCT exception: {}", e.GetMessageString());
+    spdlog::error("OcctRenderClient::buildMeshPresentation(): OCCT exception: {}", e.GetMessageString());
   } catch (...) {
-    spdlog::error("OcctRenderClient::addMeshAsAisShape(): Unknown exception caught");
+    spdlog::error("OcctRenderClient::buildMeshPresentation(): Unknown exception caught");
   }
+  return Handle(MeshPresentation)();
 }
 
 #endif // _OcctRenderClient_Header
@@ -7,24 +7,34 @@
 #include <unordered_map>
 #include <mutex>
 #include <atomic>
+#include <array>
 #include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <numeric>
 
 /**
  * @brief Modern C++ performance monitoring for gRPC operations
- * 
+ *
  * Features:
- * - RAII-based timing with scope guards
- * - Thread-safe statistics collection
- * - Real-time performance metrics calculation
+ * - RAII-based timing with scope guards, no allocation per call
+ * - Lock-free recording: relaxed atomic counters per operation
+ * - Log-linear (HDR-style) latency histograms for p50/p90/p99/p999
+ * - Fixed-size ring of recent samples for detailed analysis
  * - Network latency and throughput measurement
- * - Memory usage tracking for large mesh data
+ *
+ * Operations are registered on first use and never removed, so a recording
+ * site can resolve its operation once and keep the reference.
  */
 class GrpcPerformanceMonitor {
 public:
-    using TimePoint = std::chrono::high_resolution_clock::time_point;
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
     using Duration = std::chrono::duration<double, std::milli>;
-    
+
+    // Snapshot of one operation, taken by getOperationStats / getAllStats
     struct OperationStats {
         std::string operation_name;
         size_t call_count = 0;
@@ -32,189 +42,413 @@ public:
         double min_time_ms = std::numeric_limits<double>::max();
         double max_time_ms = 0.0;
         double avg_time_ms = 0.0;
+        double p50_time_ms = 0.0;
+        double p90_time_ms = 0.0;
+        double p99_time_ms = 0.0;
+        double p999_time_ms = 0.0;
         size_t total_bytes_sent = 0;
         size_t total_bytes_received = 0;
         size_t success_count = 0;
         size_t error_count = 0;
-        std::vector<double> recent_times; // Keep last 100 measurements for detailed analysis
-        
-        void updateStats(double time_ms, size_t bytes_sent = 0, size_t bytes_received = 0, bool success = true) {
-            ++call_count;
-            total_time_ms += time_ms;
-            min_time_ms = std::min(min_time_ms, time_ms);
-            max_time_ms = std::max(max_time_ms, time_ms);
-            avg_time_ms = total_time_ms / call_count;
-            total_bytes_sent += bytes_sent;
-            total_bytes_received += bytes_received;
-            
-            if (success) {
-                ++success_count;
-            } else {
-                ++error_count;
-            }
-            
-            // Keep only recent measurements (sliding window)
-            recent_times.push_back(time_ms);
-            if (recent_times.size() > 100) {
-                recent_times.erase(recent_times.begin());
-            }
-        }
-        
+        std::vector<double> recent_times; // Last kRecentSamples measurements, oldest first
+
         double getSuccessRate() const {
             return call_count > 0 ? (static_cast<double>(success_count) / call_count) * 100.0 : 0.0;
         }
-        
+
         double getThroughputMBps() const {
-            return total_time_ms > 0 ? 
+            return total_time_ms > 0 ?
                 ((total_bytes_sent + total_bytes_received) / (1024.0 * 1024.0)) / (total_time_ms / 1000.0) : 0.0;
         }
-        
+
         double getStandardDeviation() const {
             if (recent_times.size() < 2) return 0.0;
-            
+
             double mean = std::accumulate(recent_times.begin(), recent_times.end(), 0.0) / recent_times.size();
-            double sq_sum = std::inner_product(recent_times.begin(), recent_times.end(), 
+            double sq_sum = std::inner_product(recent_times.begin(), recent_times.end(),
                                              recent_times.begin(), 0.0,
                                              [](double const& x, double const& y) { return x + y; },
                                              [mean](double const& x, double const& y) { return (x - mean) * (y - mean); });
             return std::sqrt(sq_sum / recent_times.size());
         }
     };
-    
+
+    /**
+     * @brief Latency histogram with buckets of constant relative width
+     *
+     * Values below 2^kSubBucketBits ns get a bucket each; above that every
+     * power of two is split into 2^kSubBucketBits buckets, so a percentile
+     * read from the bucket midpoint is within ~1.6% of the true value.
+     * Values beyond 2^(kMaxExponent + 1) ns (~2.4 hours) land in the last bucket.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr int kSubBucketBits = 5;
+        static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+        static constexpr int kMaxExponent = 42;
+        static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+        static size_t bucketIndex(uint64_t value_ns) {
+            if (value_ns < kSubBuckets) {
+                return static_cast<size_t>(value_ns);
+            }
+            const int exponent = std::min(static_cast<int>(std::bit_width(value_ns)) - 1, kMaxExponent);
+            const int shift = exponent - kSubBucketBits;
+            const uint64_t sub_bucket = std::min(value_ns >> shift, 2 * kSubBuckets - 1) - kSubBuckets;
+            return static_cast<size_t>((shift + 1) * kSubBuckets + sub_bucket);
+        }
+
+        // Midpoint of the values that fall into bucket index
+        static double bucketMidpoint(size_t index) {
+            if (index < kSubBuckets) {
+                return static_cast<double>(index);
+            }
+            const int shift = static_cast<int>(index / kSubBuckets) - 1;
+            const uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+            return static_cast<double>(lower) + static_cast<double>(uint64_t{1} << shift) * 0.5;
+        }
+
+        void record(uint64_t value_ns) {
+            counts_[bucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Values at each quantile (0..1) in ns, from one pass over a copy of the counts
+        std::vector<double> quantiles(const std::vector<double>& qs) const {
+            std::array<uint64_t, kBucketCount> counts;
+            uint64_t total = 0;
+            for (size_t i = 0; i < kBucketCount; ++i) {
+                counts[i] = counts_[i].load(std::memory_order_relaxed);
+                total += counts[i];
+            }
+            std::vector<double> values(qs.size(), 0.0);
+            if (total == 0) {
+                return values;
+            }
+            for (size_t q = 0; q < qs.size(); ++q) {
+                const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(qs[q] * total)));
+                uint64_t seen = 0;
+                for (size_t i = 0; i < kBucketCount; ++i) {
+                    seen += counts[i];
+                    if (seen >= rank) {
+                        values[q] = bucketMidpoint(i);
+                        break;
+                    }
+                }
+            }
+            return values;
+        }
+
+        // Samples at or below each of the ascending bounds (ns), attributing every
+        // bucket by its midpoint; the last entry is the total. For exposition formats
+        // with fixed bucket boundaries, such as Prometheus histograms.
+        std::vector<uint64_t> cumulativeCounts(const std::vector<double>& upper_bounds_ns) const {
+            std::vector<uint64_t> cumulative(upper_bounds_ns.size() + 1, 0);
+            size_t bound = 0;
+            for (size_t i = 0; i < kBucketCount; ++i) {
+                const uint64_t count = counts_[i].load(std::memory_order_relaxed);
+                if (count == 0) {
+                    continue;
+                }
+                const double midpoint = bucketMidpoint(i);
+                while (bound < upper_bounds_ns.size() && midpoint > upper_bounds_ns[bound]) {
+                    ++bound;
+                }
+                cumulative[bound] += count;
+            }
+            for (size_t i = 1; i < cumulative.size(); ++i) {
+                cumulative[i] += cumulative[i - 1];
+            }
+            return cumulative;
+        }
+
+        void reset() {
+            for (auto& count : counts_) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    };
+
+    static constexpr size_t kRecentSamples = 128;
+
+    /**
+     * @brief Live counters of one operation; every update is a relaxed atomic
+     *
+     * Readers may see a sample half applied (counted but not yet in the
+     * histogram); snapshots are for monitoring, not accounting.
+     */
+    class OperationMetrics {
+    public:
+        explicit OperationMetrics(std::string name) : name_(std::move(name)) {}
+
+        const std::string& name() const { return name_; }
+
+        void record(uint64_t duration_ns, size_t bytes_sent, size_t bytes_received, bool success) {
+            call_count_.fetch_add(1, std::memory_order_relaxed);
+            (success ? success_count_ : error_count_).fetch_add(1, std::memory_order_relaxed);
+            total_ns_.fetch_add(duration_ns, std::memory_order_relaxed);
+            if (bytes_sent) bytes_sent_.fetch_add(bytes_sent, std::memory_order_relaxed);
+            if (bytes_received) bytes_received_.fetch_add(bytes_received, std::memory_order_relaxed);
+
+            uint64_t current = min_ns_.load(std::memory_order_relaxed);
+            while (duration_ns < current &&
+                   !min_ns_.compare_exchange_weak(current, duration_ns, std::memory_order_relaxed)) {}
+            current = max_ns_.load(std::memory_order_relaxed);
+            while (duration_ns > current &&
+                   !max_ns_.compare_exchange_weak(current, duration_ns, std::memory_order_relaxed)) {}
+
+            histogram_.record(duration_ns);
+            const uint64_t slot = recent_next_.fetch_add(1, std::memory_order_relaxed) % kRecentSamples;
+            recent_ns_[slot].store(duration_ns, std::memory_order_relaxed);
+        }
+
+        OperationStats snapshot() const {
+            constexpr double kNsPerMs = 1e6;
+            OperationStats stats;
+            stats.operation_name = name_;
+            stats.call_count = call_count_.load(std::memory_order_relaxed);
+            stats.success_count = success_count_.load(std::memory_order_relaxed);
+            stats.error_count = error_count_.load(std::memory_order_relaxed);
+            stats.total_time_ms = total_ns_.load(std::memory_order_relaxed) / kNsPerMs;
+            stats.total_bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+            stats.total_bytes_received = bytes_received_.load(std::memory_order_relaxed);
+            if (stats.call_count == 0) {
+                return stats;
+            }
+            stats.min_time_ms = min_ns_.load(std::memory_order_relaxed) / kNsPerMs;
+            stats.max_time_ms = max_ns_.load(std::memory_order_relaxed) / kNsPerMs;
+            stats.avg_time_ms = stats.total_time_ms / stats.call_count;
+
+            // Bucket midpoints can overshoot the extremes; keep percentiles within them
+            auto quantiles = histogram_.quantiles({0.5, 0.9, 0.99, 0.999});
+            for (double& value : quantiles) {
+                value = std::clamp(value / kNsPerMs, stats.min_time_ms, stats.max_time_ms);
+            }
+            stats.p50_time_ms = quantiles[0];
+            stats.p90_time_ms = quantiles[1];
+            stats.p99_time_ms = quantiles[2];
+            stats.p999_time_ms = quantiles[3];
+
+            const uint64_t next = recent_next_.load(std::memory_order_relaxed);
+            const uint64_t count = std::min<uint64_t>(next, kRecentSamples);
+            stats.recent_times.reserve(count);
+            for (uint64_t i = next - count; i < next; ++i) {
+                stats.recent_times.push_back(recent_ns_[i % kRecentSamples].load(std::memory_order_relaxed) / kNsPerMs);
+            }
+            return stats;
+        }
+
+        bool empty() const { return call_count_.load(std::memory_order_relaxed) == 0; }
+        const LatencyHistogram& histogram() const { return histogram_; }
+
+        void reset() {
+            call_count_.store(0, std::memory_order_relaxed);
+            success_count_.store(0, std::memory_order_relaxed);
+            error_count_.store(0, std::memory_order_relaxed);
+            total_ns_.store(0, std::memory_order_relaxed);
+            bytes_sent_.store(0, std::memory_order_relaxed);
+            bytes_received_.store(0, std::memory_order_relaxed);
+            min_ns_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+            max_ns_.store(0, std::memory_order_relaxed);
+            histogram_.reset();
+            recent_next_.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        const std::string name_;
+        std::atomic<uint64_t> call_count_{0};
+        std::atomic<uint64_t> success_count_{0};
+        std::atomic<uint64_t> error_count_{0};
+        std::atomic<uint64_t> total_ns_{0};
+        std::atomic<uint64_t> bytes_sent_{0};
+        std::atomic<uint64_t> bytes_received_{0};
+        std::atomic<uint64_t> min_ns_{std::numeric_limits<uint64_t>::max()};
+        std::atomic<uint64_t> max_ns_{0};
+        LatencyHistogram histogram_;
+        std::array<std::atomic<uint64_t>, kRecentSamples> recent_ns_{};
+        std::atomic<uint64_t> recent_next_{0};
+    };
+
     /**
      * @brief RAII scope guard for automatic timing
      */
     class ScopedTimer {
     public:
-        ScopedTimer(GrpcPerformanceMonitor& monitor, const std::string& operation_name, 
+        ScopedTimer(GrpcPerformanceMonitor& monitor, OperationMetrics& operation,
                    size_t bytes_sent = 0, size_t bytes_received = 0)
             : monitor_(monitor)
-            , operation_name_(operation_name)
+            , operation_(operation)
             , bytes_sent_(bytes_sent)
             , bytes_received_(bytes_received)
-            , start_time_(std::chrono::high_resolution_clock::now())
+            , start_time_(Clock::now())
             , success_(true) {}
-        
+
         ~ScopedTimer() {
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<Duration>(end_time - start_time_);
-            monitor_.recordOperation(operation_name_, duration.count(), bytes_sent_, bytes_received_, success_);
+            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_time_);
+            monitor_.record(operation_, static_cast<uint64_t>(duration.count()), bytes_sent_, bytes_received_, success_);
         }
-        
+
         void setSuccess(bool success) { success_ = success; }
         void setBytesReceived(size_t bytes) { bytes_received_ = bytes; }
         void setBytesSent(size_t bytes) { bytes_sent_ = bytes; }
-        
+
         // Disable copy and move to prevent double recording
         ScopedTimer(const ScopedTimer&) = delete;
         ScopedTimer& operator=(const ScopedTimer&) = delete;
         ScopedTimer(ScopedTimer&&) = delete;
         ScopedTimer& operator=(ScopedTimer&&) = delete;
-        
+
     private:
         GrpcPerformanceMonitor& monitor_;
-        std::string operation_name_;
+        OperationMetrics& operation_;
         size_t bytes_sent_;
         size_t bytes_received_;
         TimePoint start_time_;
         bool success_;
     };
-    
+
     static GrpcPerformanceMonitor& getInstance() {
         static GrpcPerformanceMonitor instance;
         return instance;
     }
-    
-    // Create scoped timer for automatic measurement
-    std::unique_ptr<ScopedTimer> createTimer(const std::string& operation_name, 
-                                           size_t bytes_sent = 0, size_t bytes_received = 0) {
-        return std::make_unique<ScopedTimer>(*this, operation_name, bytes_sent, bytes_received);
+
+    // The operation's counters, registered on first use; the reference stays valid
+    OperationMetrics& operation(const std::string& operation_name) {
+        // Per-thread cache, so steady-state lookups never touch the registry lock
+        thread_local std::unordered_map<std::string, OperationMetrics*> cache;
+        auto cached = cache.find(operation_name);
+        if (cached != cache.end()) {
+            return *cached->second;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& slot = operations_[operation_name];
+        if (!slot) {
+            slot = std::make_unique<OperationMetrics>(operation_name);
+        }
+        cache.emplace(operation_name, slot.get());
+        return *slot;
+    }
+
+    // Create scoped timer for automatic measurement; returned by value, nothing is allocated
+    ScopedTimer createTimer(const std::string& operation_name,
+                            size_t bytes_sent = 0, size_t bytes_received = 0) {
+        return ScopedTimer(*this, operation(operation_name), bytes_sent, bytes_received);
     }
-    
+
     // Manual recording for cases where RAII is not suitable
-    void recordOperation(const std::string& operation_name, double duration_ms, 
+    void recordOperation(const std::string& operation_name, double duration_ms,
                         size_t bytes_sent = 0, size_t bytes_received = 0, bool success = true) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        stats_[operation_name].updateStats(duration_ms, bytes_sent, bytes_received, success);
-        total_operations_.fetch_add(1);
+        record(operation(operation_name), static_cast<uint64_t>(std::max(duration_ms, 0.0) * 1e6),
+               bytes_sent, bytes_received, success);
+    }
+
+    void record(OperationMetrics& operation, uint64_t duration_ns,
+                size_t bytes_sent = 0, size_t bytes_received = 0, bool success = true) {
+        operation.record(duration_ns, bytes_sent, bytes_received, success);
+        total_operations_.fetch_add(1, std::memory_order_relaxed);
     }
-    
+
     // Get statistics for specific operation
     OperationStats getOperationStats(const std::string& operation_name) const {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = stats_.find(operation_name);
-        return (it != stats_.end()) ? it->second : OperationStats{};
+        auto it = operations_.find(operation_name);
+        return (it != operations_.end()) ? it->second->snapshot() : OperationStats{};
     }
-    
-    // Get all operations statistics
+
+    // Get all operations statistics; operations without calls since the last reset are left out
     std::unordered_map<std::string, OperationStats> getAllStats() const {
         std::lock_guard<std::mutex> lock(mutex_);
-        return stats_;
+        std::unordered_map<std::string, OperationStats> stats;
+        for (const auto& [name, operation] : operations_) {
+            if (!operation->empty()) {
+                stats.emplace(name, operation->snapshot());
+            }
+        }
+        return stats;
+    }
+
+    // Visits every registered operation, including idle ones, for exporters
+    template<typename Visitor>
+    void forEachOperation(Visitor&& visit) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, operation] : operations_) {
+            visit(*operation);
+        }
     }
-    
-    // Reset all statistics
+
+    // Reset all statistics; registered operations stay, zeroed
     void reset() {
         std::lock_guard<std::mutex> lock(mutex_);
-        stats_.clear();
+        for (auto& [name, operation] : operations_) {
+            operation->reset();
+        }
         total_operations_.store(0);
-        start_time_ = std::chrono::high_resolution_clock::now();
+        start_time_ = Clock::now();
     }
-    
+
     // Get overall metrics
-    size_t getTotalOperations() const { return total_operations_.load(); }
-    
+    size_t getTotalOperations() const { return total_operations_.load(std::memory_order_relaxed); }
+
     double getUptimeSeconds() const {
-        auto now = std::chrono::high_resolution_clock::now();
+        auto now = Clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::duration<double>>(now - start_time_);
         return duration.count();
     }
-    
+
     double getOverallSuccessRate() const {
-        std::lock_guard<std::mutex> lock(mutex_);
         size_t total_success = 0, total_calls = 0;
-        for (const auto& [name, stats] : stats_) {
+        for (const auto& [name, stats] : getAllStats()) {
             total_success += stats.success_count;
             total_calls += stats.call_count;
         }
         return total_calls > 0 ? (static_cast<double>(total_success) / total_calls) * 100.0 : 0.0;
     }
-    
+
     // Get the most expensive operations
     std::vector<std::pair<std::string, double>> getTopSlowOperations(size_t top_n = 5) const {
-        std::lock_guard<std::mutex> lock(mutex_);
         std::vector<std::pair<std::string, double>> operations;
-        
-        for (const auto& [name, stats] : stats_) {
+        for (const auto& [name, stats] : getAllStats()) {
             operations.emplace_back(name, stats.avg_time_ms);
         }
-        
-        std::partial_sort(operations.begin(), 
-                         operations.begin() + std::min(top_n, operations.size()), 
+
+        std::partial_sort(operations.begin(),
+                         operations.begin() + std::min(top_n, operations.size()),
                          operations.end(),
                          [](const auto& a, const auto& b) { return a.second > b.second; });
-        
+
         operations.resize(std::min(top_n, operations.size()));
         return operations;
     }
-    
+
 private:
-    GrpcPerformanceMonitor() : start_time_(std::chrono::high_resolution_clock::now()) {}
-    
+    GrpcPerformanceMonitor() : start_time_(Clock::now()) {}
+
+    // Guards registration and snapshots only; recording never takes it
     mutable std::mutex mutex_;
-    std::unordered_map<std::string, OperationStats> stats_;
+    std::unordered_map<std::string, std::unique_ptr<OperationMetrics>> operations_;
     std::atomic<size_t> total_operations_{0};
     TimePoint start_time_;
 };
 
-// Convenient macros for performance monitoring
+// Convenient macros for performance monitoring. The operation is resolved once
+// per call site, so operation_name must be the same on every pass through it.
 #define GRPC_PERF_TIMER(operation_name) \
-    auto _perf_timer = GrpcPerformanceMonitor::getInstance().createTimer(operation_name)
+    static auto& _perf_operation = GrpcPerformanceMonitor::getInstance().operation(operation_name); \
+    GrpcPerformanceMonitor::ScopedTimer _perf_timer(GrpcPerformanceMonitor::getInstance(), _perf_operation)
 
 #define GRPC_PERF_TIMER_WITH_DATA(operation_name, bytes_sent, bytes_received) \
-    auto _perf_timer = GrpcPerformanceMonitor::getInstance().createTimer(operation_name, bytes_sent, bytes_received)
+    static auto& _perf_operation = GrpcPerformanceMonitor::getInstance().operation(operation_name); \
+    GrpcPerformanceMonitor::ScopedTimer _perf_timer(GrpcPerformanceMonitor::getInstance(), _perf_operation, \
+                                                    bytes_sent, bytes_received)
 
 #define GRPC_PERF_SET_SUCCESS(success) \
-    if (_perf_timer) _perf_timer->setSuccess(success)
+    _perf_timer.setSuccess(success)
 
 #define GRPC_PERF_SET_BYTES_RECEIVED(bytes) \
-    if (_perf_timer) _perf_timer->setBytesReceived(bytes)
\ No newline at end of file
+    _perf_timer.setBytesReceived(bytes)
+
+#define GRPC_PERF_SET_BYTES_SENT(bytes) \
+    _perf_timer.setBytesSent(bytes)
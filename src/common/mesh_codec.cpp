@@ -0,0 +1,216 @@
+#include "common/mesh_codec.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace occt_imgui {
+namespace common {
+
+namespace {
+
+constexpr double kPositionSteps = 65535.0;
+constexpr double kNormalSteps = 32767.0;
+
+void putVarint(uint32_t value, std::string& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+bool getVarint(const char*& in, const char* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (in == end) {
+            return false;
+        }
+        const uint32_t byte = static_cast<unsigned char>(*in++);
+        if (shift == 28 && (byte & 0x70) != 0) {
+            return false;  // Does not fit in 32 bits
+        }
+        value |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t zigzag(uint32_t delta, int bits) {
+    const uint32_t sign = (delta >> (bits - 1)) & 1;
+    const uint32_t mask = bits == 32 ? ~0u : (1u << bits) - 1;
+    return ((delta << 1) ^ (0u - sign)) & mask;
+}
+
+uint32_t unzigzag(uint32_t value) {
+    return (value >> 1) ^ (0u - (value & 1));
+}
+
+// Each component is coded as the difference to the same component of the previous
+// vertex, wrapping at 16 bits, so neighbouring vertices cost one or two bytes
+void encodeDeltas(const std::vector<uint16_t>& values, size_t components, std::string& out) {
+    out.clear();
+    out.reserve(values.size() * 2);
+    std::array<uint16_t, 3> previous{};
+    for (size_t i = 0; i < values.size(); ++i) {
+        uint16_t& last = previous[i % components];
+        putVarint(zigzag(static_cast<uint16_t>(values[i] - last), 16), out);
+        last = values[i];
+    }
+}
+
+bool decodeDeltas(const std::string& bytes, size_t count, size_t components, std::vector<uint16_t>& values) {
+    values.resize(count);
+    std::array<uint16_t, 3> previous{};
+    const char* in = bytes.data();
+    const char* end = in + bytes.size();
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t coded;
+        if (!getVarint(in, end, coded) || coded > 0xffff) {
+            return false;
+        }
+        uint16_t& last = previous[i % components];
+        last = static_cast<uint16_t>(last + unzigzag(coded));
+        values[i] = last;
+    }
+    return in == end;
+}
+
+uint16_t encodeOctahedral(double value) {
+    return static_cast<uint16_t>(static_cast<int16_t>(std::lround(std::clamp(value, -1.0, 1.0) * kNormalSteps)));
+}
+
+double decodeOctahedral(uint16_t value) {
+    return std::max(static_cast<int16_t>(value) / kNormalSteps, -1.0);
+}
+
+double signNotZero(double value) {
+    return value >= 0.0 ? 1.0 : -1.0;
+}
+
+} // namespace
+
+MeshCodec::QuantizationBox MeshCodec::Bounds(const float* positions, size_t vertex_count) {
+    QuantizationBox box;
+    if (vertex_count == 0) {
+        return box;
+    }
+    std::array<double, 3> max_corner{};
+    for (int axis = 0; axis < 3; ++axis) {
+        box.origin[axis] = max_corner[axis] = positions[axis];
+    }
+    for (size_t i = 1; i < vertex_count; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            const double value = positions[i * 3 + axis];
+            box.origin[axis] = std::min(box.origin[axis], value);
+            max_corner[axis] = std::max(max_corner[axis], value);
+        }
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        box.extent[axis] = max_corner[axis] - box.origin[axis];
+    }
+    return box;
+}
+
+void MeshCodec::EncodePositions(const float* positions, size_t vertex_count, const QuantizationBox& box,
+                                std::string& out) {
+    std::vector<uint16_t> quantized(vertex_count * 3);
+    for (size_t i = 0; i < quantized.size(); ++i) {
+        const int axis = static_cast<int>(i % 3);
+        const double extent = box.extent[axis];
+        const double unit = extent > 0.0 ? (positions[i] - box.origin[axis]) / extent : 0.0;
+        quantized[i] = static_cast<uint16_t>(std::lround(std::clamp(unit, 0.0, 1.0) * kPositionSteps));
+    }
+    encodeDeltas(quantized, 3, out);
+}
+
+bool MeshCodec::DecodePositions(const std::string& bytes, size_t vertex_count, const QuantizationBox& box,
+                                std::vector<float>& out) {
+    std::vector<uint16_t> quantized;
+    if (!decodeDeltas(bytes, vertex_count * 3, 3, quantized)) {
+        return false;
+    }
+    out.resize(quantized.size());
+    for (size_t i = 0; i < quantized.size(); ++i) {
+        const int axis = static_cast<int>(i % 3);
+        out[i] = static_cast<float>(box.origin[axis] + quantized[i] / kPositionSteps * box.extent[axis]);
+    }
+    return true;
+}
+
+void MeshCodec::EncodeNormals(const float* normals, size_t vertex_count, std::string& out) {
+    std::vector<uint16_t> octahedral(vertex_count * 2);
+    for (size_t i = 0; i < vertex_count; ++i) {
+        const double x = normals[i * 3];
+        const double y = normals[i * 3 + 1];
+        const double z = normals[i * 3 + 2];
+        const double l1 = std::abs(x) + std::abs(y) + std::abs(z);
+        double u = l1 > 0.0 ? x / l1 : 0.0;
+        double v = l1 > 0.0 ? y / l1 : 0.0;
+        if (z < 0.0) {
+            // Fold the lower hemisphere over the diagonals of the square
+            const double folded_u = (1.0 - std::abs(v)) * signNotZero(u);
+            v = (1.0 - std::abs(u)) * signNotZero(v);
+            u = folded_u;
+        }
+        octahedral[i * 2] = encodeOctahedral(u);
+        octahedral[i * 2 + 1] = encodeOctahedral(v);
+    }
+    encodeDeltas(octahedral, 2, out);
+}
+
+bool MeshCodec::DecodeNormals(const std::string& bytes, size_t vertex_count, std::vector<float>& out) {
+    std::vector<uint16_t> octahedral;
+    if (!decodeDeltas(bytes, vertex_count * 2, 2, octahedral)) {
+        return false;
+    }
+    out.resize(vertex_count * 3);
+    for (size_t i = 0; i < vertex_count; ++i) {
+        double x = decodeOctahedral(octahedral[i * 2]);
+        double y = decodeOctahedral(octahedral[i * 2 + 1]);
+        const double z = 1.0 - std::abs(x) - std::abs(y);
+        const double fold = std::max(-z, 0.0);
+        x += x >= 0.0 ? -fold : fold;
+        y += y >= 0.0 ? -fold : fold;
+        const double length = std::sqrt(x * x + y * y + z * z);
+        out[i * 3] = static_cast<float>(x / length);
+        out[i * 3 + 1] = static_cast<float>(y / length);
+        out[i * 3 + 2] = static_cast<float>(z / length);
+    }
+    return true;
+}
+
+// Coded as the distance below the next unseen index: fresh vertices, which
+// tessellations emit in order, are 0 and recently used ones stay small
+void MeshCodec::EncodeIndices(const uint32_t* indices, size_t index_count, std::string& out) {
+    out.clear();
+    out.reserve(index_count * 2);
+    uint32_t next = 0;
+    for (size_t i = 0; i < index_count; ++i) {
+        putVarint(zigzag(next - indices[i], 32), out);
+        next = std::max(next, indices[i] + 1);
+    }
+}
+
+bool MeshCodec::DecodeIndices(const std::string& bytes, size_t index_count, size_t vertex_count, uint32_t* out) {
+    const char* in = bytes.data();
+    const char* end = in + bytes.size();
+    uint32_t next = 0;
+    for (size_t i = 0; i < index_count; ++i) {
+        uint32_t coded;
+        if (!getVarint(in, end, coded)) {
+            return false;
+        }
+        const uint32_t index = next - unzigzag(coded);
+        if (index >= vertex_count) {
+            return false;
+        }
+        out[i] = index;
+        next = std::max(next, index + 1);
+    }
+    return in == end;
+}
+
+} // namespace common
+} // namespace occt_imgui
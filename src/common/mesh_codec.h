@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace occt_imgui {
+namespace common {
+
+// Compact mesh buffers for low-bandwidth links. Positions are quantized to 16 bits
+// per component inside the mesh's bounding box, unit normals are octahedral-mapped
+// to two 16-bit components, and every stream is delta coded against the previous
+// vertex (indices against the highest index so far) and written as zigzag varints.
+// Decoders reject truncated, oversized or out-of-range input.
+class MeshCodec {
+public:
+    // Positions decode as origin + q / 65535 * extent, q in [0, 65535] per axis
+    struct QuantizationBox {
+        std::array<double, 3> origin{0.0, 0.0, 0.0};
+        std::array<double, 3> extent{0.0, 0.0, 0.0};
+    };
+
+    // Smallest box around vertex_count xyz triplets
+    static QuantizationBox Bounds(const float* positions, size_t vertex_count);
+
+    static void EncodePositions(const float* positions, size_t vertex_count, const QuantizationBox& box,
+                                std::string& out);
+    static bool DecodePositions(const std::string& bytes, size_t vertex_count, const QuantizationBox& box,
+                                std::vector<float>& out);
+
+    // Normals need not be normalized; zero vectors decode as +Z
+    static void EncodeNormals(const float* normals, size_t vertex_count, std::string& out);
+    static bool DecodeNormals(const std::string& bytes, size_t vertex_count, std::vector<float>& out);
+
+    // Decoded indices must all be below vertex_count; out holds index_count of them
+    static void EncodeIndices(const uint32_t* indices, size_t index_count, std::string& out);
+    static bool DecodeIndices(const std::string& bytes, size_t index_count, size_t vertex_count, uint32_t* out);
+};
+
+} // namespace common
+} // namespace occt_imgui
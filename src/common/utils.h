@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,6 +14,13 @@ public:
     static std::string GetTimestamp();
     static bool FileExists(const std::string& path);
     static std::vector<std::string> SplitString(const std::string& str, char delimiter);
+    
+    // CRC-32 (IEEE, as in zlib). Pass the previous result to checksum data in pieces.
+    static uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+    
+    // 64-bit FNV-1a. Pass the previous result to hash data in pieces.
+    static constexpr uint64_t kFnv1a64Offset = 0xcbf29ce484222325ull;
+    static uint64_t Fnv1a64(const void* data, size_t size, uint64_t hash = kFnv1a64Offset);
 };
 
 } // namespace common
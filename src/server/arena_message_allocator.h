@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <google/protobuf/arena.h>
+#include <grpcpp/support/message_allocator.h>
+
+// Puts the request and response of a callback RPC on a protobuf arena, so their
+// submessages (a legacy mesh's per-vertex points, an import's shape list) are
+// bump allocated and released together when the call is done. Holders are
+// pooled with their first arena block, so steady traffic reuses the same memory.
+template<typename Request, typename Response>
+class ArenaMessageAllocator final : public grpc::MessageAllocator<Request, Response> {
+public:
+    // Idle holders keep initial_block_bytes each; at most max_pooled of them are kept
+    explicit ArenaMessageAllocator(size_t initial_block_bytes = 16u << 10, size_t max_pooled = 32)
+        : initial_block_bytes_(initial_block_bytes)
+        , max_pooled_(max_pooled) {}
+
+    grpc::MessageHolder<Request, Response>* AllocateMessages() override {
+        std::unique_ptr<Holder> holder;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+                holder = std::move(idle_.back());
+                idle_.pop_back();
+            }
+        }
+        if (!holder) {
+            holder = std::make_unique<Holder>(*this);
+        }
+        holder->createMessages();
+        return holder.release();
+    }
+
+private:
+    // Blocks past the first grow up to this size, so a large mesh response takes few of them
+    static constexpr size_t kMaxBlockBytes = 1u << 20;
+
+    class Holder final : public grpc::MessageHolder<Request, Response> {
+    public:
+        explicit Holder(ArenaMessageAllocator& allocator)
+            : allocator_(allocator)
+            , initial_block_(new char[allocator.initial_block_bytes_])
+            , arena_(arenaOptions(initial_block_.get(), allocator.initial_block_bytes_)) {}
+
+        void createMessages() {
+            this->set_request(google::protobuf::Arena::CreateMessage<Request>(&arena_));
+            this->set_response(google::protobuf::Arena::CreateMessage<Response>(&arena_));
+        }
+
+        // Called by gRPC once the call no longer uses either message
+        void Release() override {
+            arena_.Reset();  // Frees every block but the first, which stays with the holder
+            allocator_.recycle(std::unique_ptr<Holder>(this));
+        }
+
+    private:
+        static google::protobuf::ArenaOptions arenaOptions(char* block, size_t block_bytes) {
+            google::protobuf::ArenaOptions options;
+            options.initial_block = block;
+            options.initial_block_size = block_bytes;
+            options.start_block_size = block_bytes;
+            options.max_block_size = kMaxBlockBytes;
+            return options;
+        }
+
+        ArenaMessageAllocator& allocator_;
+        std::unique_ptr<char[]> initial_block_;  // Outlives arena_, which only borrows it
+        google::protobuf::Arena arena_;
+    };
+
+    void recycle(std::unique_ptr<Holder> holder) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() < max_pooled_) {
+            idle_.push_back(std::move(holder));
+        }
+    }
+
+    const size_t initial_block_bytes_;
+    const size_t max_pooled_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Holder>> idle_;
+};
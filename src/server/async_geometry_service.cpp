@@ -0,0 +1,322 @@
+#include "async_geometry_service.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+std::vector<WorkerPool::LaneLimits> makeLaneLimits(const GeometryServiceOptions& options, size_t worker_threads) {
+    std::vector<WorkerPool::LaneLimits> lanes(static_cast<size_t>(RpcLane::Count));
+    auto& mesh = lanes[static_cast<size_t>(RpcLane::Mesh)];
+    mesh.max_running = options.max_concurrent_meshing ? options.max_concurrent_meshing : worker_threads;
+    mesh.max_queued = options.max_queued_per_rpc;
+
+    auto& import = lanes[static_cast<size_t>(RpcLane::Import)];
+    import.max_running = options.max_concurrent_imports;
+    import.max_queued = options.max_queued_per_rpc;
+
+    auto& exporter = lanes[static_cast<size_t>(RpcLane::Export)];
+    exporter.max_running = options.max_concurrent_exports;
+    exporter.max_queued = options.max_queued_per_rpc;
+    return lanes;
+}
+
+size_t resolveWorkerThreads(const GeometryServiceOptions& options) {
+    if (options.worker_threads > 0) {
+        return options.worker_threads;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+// Shared by the Import lane jobs of one ImportModelFiles call; the last reader finishes the call
+struct AsyncGeometryService::BulkImportCall {
+    explicit BulkImportCall(const geometry::ImportModelFilesRequest& request) : bulk(request) {}
+    
+    GeometryServiceImpl::BulkImport bulk;
+    grpc::ServerUnaryReactor* reactor{nullptr};
+    grpc::CallbackServerContext* context{nullptr};
+    geometry::ImportModelFilesResponse* response{nullptr};
+    std::string client_id;
+    std::atomic<size_t> readers{0};
+};
+
+AsyncGeometryService::AsyncGeometryService(GeometryServiceImpl& impl, const GeometryServiceOptions& options)
+    : impl_(impl)
+    , pool_(resolveWorkerThreads(options), makeLaneLimits(options, resolveWorkerThreads(options))) {
+    SetMessageAllocatorFor_GetMeshData(&mesh_allocator_);
+    SetMessageAllocatorFor_ImportModelFile(&import_allocator_);
+    SetMessageAllocatorFor_ExportModelFile(&export_allocator_);
+    SetMessageAllocatorFor_ImportModelFiles(&bulk_import_allocator_);
+    SetMessageAllocatorFor_ExecuteBatch(&batch_allocator_);
+    impl_.setWorkGates(
+        [this](const std::function<void()>& work) { pool_.runInline(static_cast<size_t>(RpcLane::Mesh), work); },
+        [this](const std::function<void()>& work) { pool_.runInline(static_cast<size_t>(RpcLane::Import), work); });
+    spdlog::info("AsyncGeometryService: {} worker threads, concurrent imports={} exports={}, max queued per RPC={}",
+                pool_.threadCount(), options.max_concurrent_imports, options.max_concurrent_exports,
+                options.max_queued_per_rpc);
+}
+
+AsyncGeometryService::~AsyncGeometryService() {
+    shutdown();
+    impl_.setWorkGates(nullptr, nullptr);
+}
+
+void AsyncGeometryService::shutdown() {
+    pool_.shutdown();
+}
+
+WorkerPool::LaneStats AsyncGeometryService::getLaneStats(RpcLane lane) const {
+    return pool_.laneStats(static_cast<size_t>(lane));
+}
+
+grpc::ServerUnaryReactor* AsyncGeometryService::dispatch(
+    RpcLane lane, const char* method, grpc::CallbackServerContext* context,
+    std::function<grpc::Status(const std::string& client_id)> work) {
+
+    auto* reactor = context->DefaultReactor();
+    std::string client_id = GeometryServiceImpl::getClientId(context);
+
+    bool queued = pool_.submit(static_cast<size_t>(lane),
+        [reactor, context, method, client_id, work = std::move(work)] {
+            if (context->IsCancelled()) {
+                spdlog::info("[{}] {}: Cancelled while queued", client_id, method);
+                reactor->Finish(grpc::Status(grpc::StatusCode::CANCELLED, "Request cancelled"));
+                return;
+            }
+            grpc::Status status;
+            try {
+                status = work(client_id);
+            } catch (const std::exception& e) {
+                spdlog::error("{}: Exception occurred: {}", method, e.what());
+                status = grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+            }
+            reactor->Finish(status);
+        });
+
+    if (!queued) {
+        spdlog::warn("[{}] {}: Rejected, too many pending requests", client_id, method);
+        reactor->Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                     std::string("Server busy: too many pending ") + method + " requests"));
+    }
+    return reactor;
+}
+
+// Heavy RPCs
+grpc::ServerUnaryReactor* AsyncGeometryService::GetMeshData(grpc::CallbackServerContext* context,
+                                                           const geometry::ShapeRequest* request,
+                                                           geometry::MeshData* response) {
+    return dispatch(RpcLane::Mesh, "GetMeshData", context, [this, request, response](const std::string& client_id) {
+        return impl_.handleGetMeshData(client_id, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* AsyncGeometryService::ImportModelFile(grpc::CallbackServerContext* context,
+                                                               const geometry::ModelFileRequest* request,
+                                                               geometry::ModelImportResponse* response) {
+    return dispatch(RpcLane::Import, "ImportModelFile", context, [this, request, response](const std::string& client_id) {
+        return impl_.handleImportModelFile(client_id, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* AsyncGeometryService::ExportModelFile(grpc::CallbackServerContext* context,
+                                                               const geometry::ModelExportRequest* request,
+                                                               geometry::ModelFileResponse* response) {
+    return dispatch(RpcLane::Export, "ExportModelFile", context, [this, request, response](const std::string& client_id) {
+        return impl_.handleExportModelFile(client_id, request, response);
+    });
+}
+
+grpc::ServerUnaryReactor* AsyncGeometryService::ImportModelFiles(grpc::CallbackServerContext* context,
+                                                                const geometry::ImportModelFilesRequest* request,
+                                                                geometry::ImportModelFilesResponse* response) {
+    auto call = std::make_shared<BulkImportCall>(*request);
+    call->reactor = context->DefaultReactor();
+    call->context = context;
+    call->response = response;
+    call->client_id = GeometryServiceImpl::getClientId(context);
+    
+    size_t readers = std::min(static_cast<size_t>(request->file_paths_size()), impl_.maxConcurrentImports());
+    if (readers == 0) {
+        call->reactor->Finish(impl_.finishBulkImport(call->client_id, call->bulk, response, false));
+        return call->reactor;
+    }
+    
+    call->readers = readers;
+    size_t queued = 0;
+    while (queued < readers &&
+           pool_.submit(static_cast<size_t>(RpcLane::Import), [this, call] { runBulkImportReader(call); })) {
+        ++queued;
+    }
+    if (queued == 0) {
+        spdlog::warn("[{}] ImportModelFiles: Rejected, too many pending requests", call->client_id);
+        call->reactor->Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                           "Server busy: too many pending ImportModelFiles requests"));
+    } else if (queued < readers && call->readers.fetch_sub(readers - queued) == readers - queued) {
+        finishBulkImport(*call);  // The queued readers already got through every file
+    }
+    return call->reactor;
+}
+
+void AsyncGeometryService::runBulkImportReader(std::shared_ptr<BulkImportCall> call) {
+    // One file per job, so single-file imports queued meanwhile get their turn on the lane
+    while (impl_.importNextBulkFile(call->bulk, call->context->IsCancelled())) {
+        if (pool_.submit(static_cast<size_t>(RpcLane::Import), [this, call] { runBulkImportReader(call); })) {
+            return;
+        }
+        // Lane full or shutting down: keep reading on this worker
+    }
+    if (--call->readers == 0) {
+        finishBulkImport(*call);
+    }
+}
+
+void AsyncGeometryService::finishBulkImport(BulkImportCall& call) {
+    grpc::Status status;
+    try {
+        status = impl_.finishBulkImport(call.client_id, call.bulk, call.response, call.context->IsCancelled());
+    } catch (const std::exception& e) {
+        spdlog::error("ImportModelFiles: Exception occurred: {}", e.what());
+        status = grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+    }
+    call.reactor->Finish(status);
+}
+
+grpc::ServerUnaryReactor* AsyncGeometryService::ExecuteBatch(grpc::CallbackServerContext* context,
+                                                            const geometry::BatchRequest* request,
+                                                            geometry::BatchResponse* response) {
+    return dispatch(RpcLane::Mesh, "ExecuteBatch", context, [this, request, response](const std::string& client_id) {
+        return impl_.handleExecuteBatch(client_id, request, response);
+    });
+}
+
+// Light RPCs
+grpc::Status AsyncGeometryService::CreateBox(grpc::ServerContext* context,
+                                            const geometry::BoxRequest* request,
+                                            geometry::ShapeResponse* response) {
+    return impl_.CreateBox(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::CreateCone(grpc::ServerContext* context,
+                                             const geometry::ConeRequest* request,
+                                             geometry::ShapeResponse* response) {
+    return impl_.CreateCone(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::CreateSphere(grpc::ServerContext* context,
+                                               const geometry::SphereRequest* request,
+                                               geometry::ShapeResponse* response) {
+    return impl_.CreateSphere(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::CreateCylinder(grpc::ServerContext* context,
+                                                 const geometry::CylinderRequest* request,
+                                                 geometry::ShapeResponse* response) {
+    return impl_.CreateCylinder(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::DeleteShape(grpc::ServerContext* context,
+                                              const geometry::ShapeRequest* request,
+                                              geometry::StatusResponse* response) {
+    return impl_.DeleteShape(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::TransformShape(grpc::ServerContext* context,
+                                                 const geometry::TransformRequest* request,
+                                                 geometry::ShapeResponse* response) {
+    return impl_.TransformShape(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::SetShapeColor(grpc::ServerContext* context,
+                                                const geometry::ColorRequest* request,
+                                                geometry::StatusResponse* response) {
+    return impl_.SetShapeColor(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::GetAllMeshes(grpc::ServerContext* context,
+                                               const geometry::MeshRequest* request,
+                                               grpc::ServerWriter<geometry::MeshData>* writer) {
+    return impl_.GetAllMeshes(context, request, writer);
+}
+
+grpc::Status AsyncGeometryService::StreamMeshLods(grpc::ServerContext* context,
+                                                 const geometry::MeshLodRequest* request,
+                                                 grpc::ServerWriter<geometry::MeshData>* writer) {
+    return impl_.StreamMeshLods(context, request, writer);
+}
+
+grpc::Status AsyncGeometryService::SyncScene(grpc::ServerContext* context,
+                                            const geometry::SceneSyncRequest* request,
+                                            grpc::ServerWriter<geometry::SceneChange>* writer) {
+    return impl_.SyncScene(context, request, writer);
+}
+
+grpc::Status AsyncGeometryService::SubscribeSceneChanges(grpc::ServerContext* context,
+                                                        const geometry::SceneSubscribeRequest* request,
+                                                        grpc::ServerWriter<geometry::SceneChange>* writer) {
+    return impl_.SubscribeSceneChanges(context, request, writer);
+}
+
+grpc::Status AsyncGeometryService::RayPick(grpc::ServerContext* context,
+                                          const geometry::RayPickRequest* request,
+                                          geometry::RayPickResponse* response) {
+    return impl_.RayPick(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::BoxQuery(grpc::ServerContext* context,
+                                           const geometry::BoxQueryRequest* request,
+                                           geometry::ShapeQueryResponse* response) {
+    return impl_.BoxQuery(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::FrustumCull(grpc::ServerContext* context,
+                                              const geometry::FrustumCullRequest* request,
+                                              geometry::ShapeQueryResponse* response) {
+    return impl_.FrustumCull(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::UpdateCamera(grpc::ServerContext* context,
+                                               const geometry::CameraUpdateRequest* request,
+                                               geometry::StatusResponse* response) {
+    return impl_.UpdateCamera(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::ClearAll(grpc::ServerContext* context,
+                                           const geometry::EmptyRequest* request,
+                                           geometry::StatusResponse* response) {
+    return impl_.ClearAll(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::GetSystemInfo(grpc::ServerContext* context,
+                                                const geometry::EmptyRequest* request,
+                                                geometry::SystemInfoResponse* response) {
+    return impl_.GetSystemInfo(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::CreateDemoScene(grpc::ServerContext* context,
+                                                  const geometry::EmptyRequest* request,
+                                                  geometry::StatusResponse* response) {
+    return impl_.CreateDemoScene(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::DisconnectClient(grpc::ServerContext* context,
+                                                   const geometry::EmptyRequest* request,
+                                                   geometry::StatusResponse* response) {
+    return impl_.DisconnectClient(context, request, response);
+}
+
+grpc::Status AsyncGeometryService::UploadModel(grpc::ServerContext* context,
+                                              grpc::ServerReader<geometry::ModelChunk>* reader,
+                                              geometry::UploadModelResponse* response) {
+    return impl_.UploadModel(context, reader, response);
+}
+
+grpc::Status AsyncGeometryService::DownloadModel(grpc::ServerContext* context,
+                                                const geometry::DownloadModelRequest* request,
+                                                grpc::ServerWriter<geometry::ModelChunk>* writer) {
+    return impl_.DownloadModel(context, request, writer);
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <grpcpp/grpcpp.h>
+
+#include "arena_message_allocator.h"
+#include "geometry_service.grpc.pb.h"
+#include "geometry_service_impl.h"
+#include "worker_pool.h"
+
+// Lanes of the worker pool, one per heavy RPC type
+enum class RpcLane : size_t {
+    Mesh = 0,
+    Import,
+    Export,
+    Count
+};
+
+// Heavy unary RPCs use the callback API and are executed on the worker pool,
+// so a long STEP/IGES read or tessellation never holds a gRPC thread. Their
+// request and response messages live on pooled protobuf arenas.
+using AsyncGeometryServiceBase =
+    geometry::GeometryService::WithCallbackMethod_GetMeshData<
+    geometry::GeometryService::WithCallbackMethod_ImportModelFile<
+    geometry::GeometryService::WithCallbackMethod_ExportModelFile<
+    geometry::GeometryService::WithCallbackMethod_ImportModelFiles<
+    geometry::GeometryService::WithCallbackMethod_ExecuteBatch<
+    geometry::GeometryService::Service>>>>>;
+
+// Async server front end over GeometryServiceImpl. Heavy unary calls are queued
+// per RpcLane with their own concurrency limits and fail with RESOURCE_EXHAUSTED
+// when full. Cheap calls (primitive creation, picking, GetSystemInfo, ...) are
+// forwarded as-is. The streaming calls that mesh or translate (GetAllMeshes,
+// StreamMeshLods, SyncScene, SubscribeSceneChanges, UploadModel) stay on gRPC's
+// sync threads, but each mesh they generate takes a Mesh lane slot and an
+// upload's translation an Import lane slot, waiting while the lane is full.
+class AsyncGeometryService final : public AsyncGeometryServiceBase {
+public:
+    AsyncGeometryService(GeometryServiceImpl& impl, const GeometryServiceOptions& options);
+    ~AsyncGeometryService() override;
+
+    // Heavy RPCs (callback API, run on the worker pool)
+    grpc::ServerUnaryReactor* GetMeshData(grpc::CallbackServerContext* context,
+                                         const geometry::ShapeRequest* request,
+                                         geometry::MeshData* response) override;
+
+    grpc::ServerUnaryReactor* ImportModelFile(grpc::CallbackServerContext* context,
+                                             const geometry::ModelFileRequest* request,
+                                             geometry::ModelImportResponse* response) override;
+
+    grpc::ServerUnaryReactor* ExportModelFile(grpc::CallbackServerContext* context,
+                                             const geometry::ModelExportRequest* request,
+                                             geometry::ModelFileResponse* response) override;
+
+    // Files are read on the Import lane one job per file, by at most
+    // max_concurrent_imports jobs at a time
+    grpc::ServerUnaryReactor* ImportModelFiles(grpc::CallbackServerContext* context,
+                                              const geometry::ImportModelFilesRequest* request,
+                                              geometry::ImportModelFilesResponse* response) override;
+
+    // Runs on the Mesh lane: its transforms rebuild geometry like meshing does
+    grpc::ServerUnaryReactor* ExecuteBatch(grpc::CallbackServerContext* context,
+                                          const geometry::BatchRequest* request,
+                                          geometry::BatchResponse* response) override;
+
+    // Light RPCs and streams (sync, forwarded to GeometryServiceImpl)
+    grpc::Status CreateBox(grpc::ServerContext* context,
+                          const geometry::BoxRequest* request,
+                          geometry::ShapeResponse* response) override;
+
+    grpc::Status CreateCone(grpc::ServerContext* context,
+                           const geometry::ConeRequest* request,
+                           geometry::ShapeResponse* response) override;
+
+    grpc::Status CreateSphere(grpc::ServerContext* context,
+                             const geometry::SphereRequest* request,
+                             geometry::ShapeResponse* response) override;
+
+    grpc::Status CreateCylinder(grpc::ServerContext* context,
+                               const geometry::CylinderRequest* request,
+                               geometry::ShapeResponse* response) override;
+
+    grpc::Status DeleteShape(grpc::ServerContext* context,
+                            const geometry::ShapeRequest* request,
+                            geometry::StatusResponse* response) override;
+
+    grpc::Status TransformShape(grpc::ServerContext* context,
+                               const geometry::TransformRequest* request,
+                               geometry::ShapeResponse* response) override;
+
+    grpc::Status SetShapeColor(grpc::ServerContext* context,
+                              const geometry::ColorRequest* request,
+                              geometry::StatusResponse* response) override;
+
+    grpc::Status GetAllMeshes(grpc::ServerContext* context,
+                             const geometry::MeshRequest* request,
+                             grpc::ServerWriter<geometry::MeshData>* writer) override;
+
+    grpc::Status StreamMeshLods(grpc::ServerContext* context,
+                               const geometry::MeshLodRequest* request,
+                               grpc::ServerWriter<geometry::MeshData>* writer) override;
+
+    grpc::Status SyncScene(grpc::ServerContext* context,
+                          const geometry::SceneSyncRequest* request,
+                          grpc::ServerWriter<geometry::SceneChange>* writer) override;
+
+    grpc::Status SubscribeSceneChanges(grpc::ServerContext* context,
+                                      const geometry::SceneSubscribeRequest* request,
+                                      grpc::ServerWriter<geometry::SceneChange>* writer) override;
+
+    grpc::Status RayPick(grpc::ServerContext* context,
+                        const geometry::RayPickRequest* request,
+                        geometry::RayPickResponse* response) override;
+
+    grpc::Status BoxQuery(grpc::ServerContext* context,
+                         const geometry::BoxQueryRequest* request,
+                         geometry::ShapeQueryResponse* response) override;
+
+    grpc::Status FrustumCull(grpc::ServerContext* context,
+                            const geometry::FrustumCullRequest* request,
+                            geometry::ShapeQueryResponse* response) override;
+
+    grpc::Status UpdateCamera(grpc::ServerContext* context,
+                             const geometry::CameraUpdateRequest* request,
+                             geometry::StatusResponse* response) override;
+
+    grpc::Status ClearAll(grpc::ServerContext* context,
+                         const geometry::EmptyRequest* request,
+                         geometry::StatusResponse* response) override;
+
+    grpc::Status GetSystemInfo(grpc::ServerContext* context,
+                              const geometry::EmptyRequest* request,
+                              geometry::SystemInfoResponse* response) override;
+
+    grpc::Status CreateDemoScene(grpc::ServerContext* context,
+                               const geometry::EmptyRequest* request,
+                               geometry::StatusResponse* response) override;
+
+    grpc::Status DisconnectClient(grpc::ServerContext* context,
+                                 const geometry::EmptyRequest* request,
+                                 geometry::StatusResponse* response) override;
+
+    grpc::Status UploadModel(grpc::ServerContext* context,
+                            grpc::ServerReader<geometry::ModelChunk>* reader,
+                            geometry::UploadModelResponse* response) override;
+
+    grpc::Status DownloadModel(grpc::ServerContext* context,
+                              const geometry::DownloadModelRequest* request,
+                              grpc::ServerWriter<geometry::ModelChunk>* writer) override;
+
+    WorkerPool::LaneStats getLaneStats(RpcLane lane) const;
+
+    // Stops accepting heavy work and waits for queued jobs; call after grpc::Server::Shutdown
+    void shutdown();
+
+private:
+    // Queues work on a lane and finishes the reactor with its status. Requests
+    // cancelled while queued are finished with CANCELLED without running.
+    grpc::ServerUnaryReactor* dispatch(RpcLane lane, const char* method,
+                                       grpc::CallbackServerContext* context,
+                                       std::function<grpc::Status(const std::string& client_id)> work);
+
+    struct BulkImportCall;
+    void runBulkImportReader(std::shared_ptr<BulkImportCall> call);
+    void finishBulkImport(BulkImportCall& call);
+
+    GeometryServiceImpl& impl_;
+    // Registered with the callback methods; declared before pool_ so they outlive its jobs
+    ArenaMessageAllocator<geometry::ShapeRequest, geometry::MeshData> mesh_allocator_;
+    ArenaMessageAllocator<geometry::ModelFileRequest, geometry::ModelImportResponse> import_allocator_;
+    ArenaMessageAllocator<geometry::ModelExportRequest, geometry::ModelFileResponse> export_allocator_;
+    ArenaMessageAllocator<geometry::ImportModelFilesRequest, geometry::ImportModelFilesResponse>
+        bulk_import_allocator_;
+    ArenaMessageAllocator<geometry::BatchRequest, geometry::BatchResponse> batch_allocator_;
+    WorkerPool pool_;
+};
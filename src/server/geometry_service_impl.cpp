@@ -1,4 +1,9 @@
 #include "geometry_service_impl.h"
+#include "scoped_temp_file.h"
+#include "process_memory.h"
+#include "stage_trace.h"
+#include "common/mesh_codec.h"
+#include "common/utils.h"
 
 // OCCT includes
 #include <BRepPrimAPI_MakeBox.hxx>
@@ -10,16 +15,17 @@
 #include <TopoDS.hxx>
 #include <TopoDS_Face.hxx>
 #include <Poly_Triangulation.hxx>
-#include <AIS_DisplayMode.hxx>
-#include <Aspect_DisplayConnection.hxx>
-#include <OpenGl_GraphicDriver.hxx>
 #include <BRep_Tool.hxx>
 #include <TopLoc_Location.hxx>
 #include <TColgp_Array1OfPnt.hxx>
 #include <Poly_Array1OfTriangle.hxx>
 #include <gp_Pnt.hxx>
 #include <gp_Vec.hxx>
+#include <gp_Trsf.hxx>
+#include <TopoDS_TShape.hxx>
 #include <Poly_Triangle.hxx>
+#include <OSD_Parallel.hxx>
+#include <BRepLib_ToolTriangulatedShape.hxx>
 
 // STEP file includes
 #include <STEPCAFControl_Reader.hxx>
@@ -41,16 +47,22 @@
 #include <TopoDS_Compound.hxx>
 #include <TopoDS_Face.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <Standard_Failure.hxx>
 
 // Unified model import/export includes
 #include <DE_Wrapper.hxx>
+#include <Standard_Version.hxx>
 // Fallback includes for cases where DE_Wrapper is not available
+#include <STEPControl_Controller.hxx>
 #include <STEPControl_Reader.hxx>
 #include <STEPControl_Writer.hxx>
 #include <IGESControl_Reader.hxx>
 #include <IGESControl_Writer.hxx>
 #include <IGESControl_Controller.hxx>
-#include <RWStl.hxx>
 #include <RWObj_CafReader.hxx>
 #include <RWObj_CafWriter.hxx>
 #include <RWGltf_CafReader.hxx>
@@ -59,38 +71,595 @@
 #include <filesystem>
 #include <algorithm>
 #include <cctype>
+#include <cmath>
+#include <bit>
+#include <cstring>
+#include <map>
+#include <queue>
+#include <numeric>
+#include <unordered_set>
 
 // Standard includes
 #include <sstream>
+#include <string_view>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
 #include <ctime>
+#include <cstddef>
+#include <google/protobuf/arena.h>
 #include <spdlog/spdlog.h>
 
-GeometryServiceImpl::GeometryServiceImpl() {
-    spdlog::info("GeometryService: Initializing OCCT context...");
-    
-    // Initialize OCCT viewer (headless)
-    Handle(Aspect_DisplayConnection) display_connection = new Aspect_DisplayConnection();
-    Handle(OpenGl_GraphicDriver) graphic_driver = new OpenGl_GraphicDriver(display_connection, Standard_False);
-    graphic_driver->ChangeOptions().buffersNoSwap = Standard_True;
-    
-    viewer_ = new V3d_Viewer(graphic_driver);
-    viewer_->SetDefaultLights();
-    viewer_->SetLightOn();
-    
-    context_ = new AIS_InteractiveContext(viewer_);
-    context_->SetDisplayMode(AIS_Shaded, Standard_False);
+namespace {
+
+// Default tessellation parameters for full-quality meshes (LOD 0)
+constexpr double kLinearDeflection = 0.1;
+constexpr double kAngularDeflection = 0.5;
+
+// Requested linear deflections are clamped to this range of the shape diagonal,
+// so a tiny value cannot explode the triangle count of a large part
+constexpr double kMinRelativeDeflection = 1e-4;
+constexpr double kMaxRelativeDeflection = 0.05;
+constexpr double kMinAngularDeflection = 0.05;
+
+// Each coarser level of detail multiplies the linear deflection by this step,
+// capped at a fraction of the shape size so small parts stay recognisable
+constexpr double kLodDeflectionStep = 4.0;
+constexpr double kMaxLodDeflectionRatio = 0.02;
+constexpr double kMaxLodAngularDeflection = 1.2;
+
+// Coarsening passes GetAllMeshes makes to fit a triangle budget
+constexpr int kTriangleBudgetPasses = 4;
+
+// Mesh arenas start with one block sized for the whole mesh, within these bounds
+constexpr size_t kMinMeshArenaBlockBytes = 4u << 10;
+constexpr size_t kMaxMeshArenaBlockBytes = 16u << 20;
+
+// Per-thread tessellation scratch past this many vertices is freed after use
+constexpr size_t kMaxRetainedScratchVertices = 1u << 18;
+
+// The STEP/IGES controllers register global static parameters on first use;
+// do that once up front so concurrent readers never race on it
+void initDataExchangeControllers() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        STEPControl_Controller::Init();
+        IGESControl_Controller::Init();
+    });
+}
+
+double shapeDiagonal(const TopoDS_Shape& shape) {
+    Bnd_Box box;
+    BRepBndLib::Add(shape, box, Standard_False);
+    return box.IsVoid() ? 0.0 : std::sqrt(box.SquareExtent());
+}
+
+Aabb shapeBounds(const TopoDS_Shape& shape) {
+    Aabb bounds;
+    Bnd_Box box;
+    BRepBndLib::Add(shape, box);
+    if (!box.IsVoid()) {
+        double x_min, y_min, z_min, x_max, y_max, z_max;
+        box.Get(x_min, y_min, z_min, x_max, y_max, z_max);
+        bounds.add(Vec3{x_min, y_min, z_min});
+        bounds.add(Vec3{x_max, y_max, z_max});
+    }
+    return bounds;
+}
+
+Vec3 toVec3(const geometry::Point3D& point) {
+    return {point.x(), point.y(), point.z()};
+}
+
+Vec3 toVec3(const geometry::Vector3D& vector) {
+    return {vector.x(), vector.y(), vector.z()};
+}
+
+double clampDeflection(double deflection, double diagonal) {
+    if (diagonal <= 0.0) {
+        return deflection;
+    }
+    return std::clamp(deflection, diagonal * kMinRelativeDeflection, diagonal * kMaxRelativeDeflection);
+}
+
+// Material libraries are declared before the geometry, so the head of the file tells
+bool objUsesMaterials(const std::string& file_path) {
+    std::ifstream file(file_path, std::ios::binary);
+    std::string head(64 * 1024, '\0');
+    file.read(head.data(), static_cast<std::streamsize>(head.size()));
+    head.resize(static_cast<size_t>(file.gcount()));
+    return head.find("mtllib") != std::string::npos;
+}
+
+// XDE document for one import, freed with its last handle. Documents from
+// XCAFApp_Application::NewDocument stay in the process-wide application until closed,
+// and its document list is not safe to change from concurrent imports.
+Handle(TDocStd_Document) newXcafDocument() {
+    static const Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
+    Handle(TDocStd_Document) doc = new TDocStd_Document("MDTV-XCAF");
+    app->InitDocument(doc);  // Only attaches the XCAF tools to doc
+    return doc;
+}
+
+double lodLinearDeflection(double base, double diagonal, uint32_t lod) {
+    if (lod == 0) {
+        return base;
+    }
+    double deflection = base * std::pow(kLodDeflectionStep, lod);
+    return std::max(base, std::min(deflection, diagonal * kMaxLodDeflectionRatio));
+}
+
+double lodAngularDeflection(double base, uint32_t lod) {
+    return std::max(base, std::min(base * std::pow(2.0, lod), kMaxLodAngularDeflection));
+}
+
+// Finest level at or below lod that is still coarser than the next finer one;
+// levels collapsed by the size cap are skipped instead of sent twice
+uint32_t distinctLod(double base, double diagonal, uint32_t lod) {
+    while (lod > 0 && lodLinearDeflection(base, diagonal, lod) <= lodLinearDeflection(base, diagonal, lod - 1)) {
+        --lod;
+    }
+    return lod;
+}
+
+// Packed mesh buffers are defined as little-endian on the wire
+static_assert(std::endian::native == std::endian::little,
+              "Packed mesh encoding assumes a little-endian host");
+
+template<typename Scalar, typename Vec3>
+void packVec3(const std::vector<Vec3>& values, std::string& out) {
+    out.resize(values.size() * 3 * sizeof(Scalar));
+    char* dst = out.data();
+    for (const Vec3& value : values) {
+        const Scalar xyz[3] = {static_cast<Scalar>(value.X()),
+                               static_cast<Scalar>(value.Y()),
+                               static_cast<Scalar>(value.Z())};
+        std::memcpy(dst, xyz, sizeof(xyz));
+        dst += sizeof(xyz);
+    }
+}
+
+void packIndices(const std::vector<int>& indices, std::string& out) {
+    static_assert(sizeof(int) == sizeof(uint32_t), "Index buffer expects 32-bit int");
+    out.resize(indices.size() * sizeof(uint32_t));
+    std::memcpy(out.data(), indices.data(), out.size());
+}
+
+using occt_imgui::common::MeshCodec;
+
+template<typename Vec3>
+std::vector<float> toFloats(const std::vector<Vec3>& values) {
+    std::vector<float> xyz;
+    xyz.reserve(values.size() * 3);
+    for (const Vec3& value : values) {
+        xyz.push_back(static_cast<float>(value.X()));
+        xyz.push_back(static_cast<float>(value.Y()));
+        xyz.push_back(static_cast<float>(value.Z()));
+    }
+    return xyz;
+}
+
+// MESH_ENCODING_QUANTIZED positions, quantized across their own box, and normals
+void packQuantizedVertices(const std::vector<float>& positions, const std::vector<float>& normals,
+                           geometry::PackedMeshBuffers& packed) {
+    const size_t vertex_count = positions.size() / 3;
+    const MeshCodec::QuantizationBox box = MeshCodec::Bounds(positions.data(), vertex_count);
+    packed.mutable_quantization_origin()->set_x(box.origin[0]);
+    packed.mutable_quantization_origin()->set_y(box.origin[1]);
+    packed.mutable_quantization_origin()->set_z(box.origin[2]);
+    packed.mutable_quantization_extent()->set_x(box.extent[0]);
+    packed.mutable_quantization_extent()->set_y(box.extent[1]);
+    packed.mutable_quantization_extent()->set_z(box.extent[2]);
+    MeshCodec::EncodePositions(positions.data(), vertex_count, box, *packed.mutable_positions());
+    if (normals.empty()) {
+        packed.clear_normals();
+    } else {
+        MeshCodec::EncodeNormals(normals.data(), vertex_count, *packed.mutable_normals());
+    }
+}
+
+MeshCodec::QuantizationBox quantizationBox(const geometry::PackedMeshBuffers& packed) {
+    MeshCodec::QuantizationBox box;
+    box.origin = {packed.quantization_origin().x(), packed.quantization_origin().y(),
+                  packed.quantization_origin().z()};
+    box.extent = {packed.quantization_extent().x(), packed.quantization_extent().y(),
+                  packed.quantization_extent().z()};
+    return box;
+}
+
+// Cached meshes are built once and only read afterwards, so each one lives on an
+// arena of its own: the legacy per-vertex Point3D messages are bump allocated and
+// the whole mesh is released in one go when the last reference drops it
+std::shared_ptr<geometry::MeshData> newArenaMeshData(size_t expected_bytes) {
+    google::protobuf::ArenaOptions arena_options;
+    arena_options.start_block_size = std::clamp(expected_bytes, kMinMeshArenaBlockBytes, kMaxMeshArenaBlockBytes);
+    arena_options.max_block_size = kMaxMeshArenaBlockBytes;
+    auto arena = std::make_shared<google::protobuf::Arena>(arena_options);
+    auto* mesh_data = google::protobuf::Arena::CreateMessage<geometry::MeshData>(arena.get());
+    return std::shared_ptr<geometry::MeshData>(std::move(arena), mesh_data);
+}
+
+// Arena bytes a legacy-encoded mesh's submessages and repeated fields take;
+// packed buffers are single strings and need next to nothing
+size_t legacyMeshArenaBytes(size_t vertex_count, size_t normal_count, size_t index_count) {
+    constexpr size_t kPerVector = sizeof(geometry::Point3D) + alignof(std::max_align_t) + sizeof(void*);
+    return (vertex_count + normal_count) * kPerVector + index_count * sizeof(int32_t);
+}
+
+int meshVertexCount(const geometry::MeshData& mesh_data) {
+    return mesh_data.has_packed() ? static_cast<int>(mesh_data.packed().vertex_count())
+                                  : mesh_data.vertices_size();
+}
+
+int meshTriangleCount(const geometry::MeshData& mesh_data) {
+    return mesh_data.has_packed() ? static_cast<int>(mesh_data.packed().triangle_count())
+                                  : mesh_data.indices_size() / 3;
+}
+
+// writer->Write timed as the "StreamWrite" stage; serialization, inside it, is also
+// timed on its own by the RPC metrics interceptor when that is installed
+template<typename Writer, typename Message>
+bool tracedWrite(Writer* writer, const Message& message) {
+    STAGE_SPAN(write_span, "StreamWrite");
+    return writer->Write(message);
+}
+
+// Row-major 4x4, as TransformRequest takes it
+void toProtoTransform(const gp_Trsf& trsf, geometry::Transform& transform) {
+    transform.clear_matrix();
+    for (int row = 1; row <= 3; ++row) {
+        for (int col = 1; col <= 4; ++col) {
+            transform.add_matrix(trsf.Value(row, col));
+        }
+    }
+    for (double value : {0.0, 0.0, 0.0, 1.0}) {
+        transform.add_matrix(value);
+    }
+}
+
+// Box around the eight placed corners of box
+void placeBoundingBox(const geometry::BoundingBox& box, const gp_Trsf& placement, geometry::BoundingBox& placed) {
+    Bnd_Box bounds;
+    for (int i = 0; i < 8; ++i) {
+        gp_Pnt corner(i & 1 ? box.max().x() : box.min().x(), i & 2 ? box.max().y() : box.min().y(),
+                      i & 4 ? box.max().z() : box.min().z());
+        bounds.Add(corner.Transformed(placement));
+    }
+    double x_min, y_min, z_min, x_max, y_max, z_max;
+    bounds.Get(x_min, y_min, z_min, x_max, y_max, z_max);
+    placed.mutable_min()->set_x(x_min);
+    placed.mutable_min()->set_y(y_min);
+    placed.mutable_min()->set_z(z_min);
+    placed.mutable_max()->set_x(x_max);
+    placed.mutable_max()->set_y(y_max);
+    placed.mutable_max()->set_z(z_max);
+}
+
+// Transforms packed coordinates in place; directions are rotated and renormalized
+template<typename Scalar>
+void placePackedVec3(std::string& buffer, const gp_Trsf& placement, bool directions) {
+    for (size_t offset = 0; offset + 3 * sizeof(Scalar) <= buffer.size(); offset += 3 * sizeof(Scalar)) {
+        Scalar xyz[3];
+        std::memcpy(xyz, buffer.data() + offset, sizeof(xyz));
+        gp_XYZ value(xyz[0], xyz[1], xyz[2]);
+        if (directions) {
+            value.Multiply(placement.HVectorialPart());
+            const double length = value.Modulus();
+            if (length > 0.0) {
+                value /= length;
+            }
+        } else {
+            placement.Transforms(value);
+        }
+        xyz[0] = static_cast<Scalar>(value.X());
+        xyz[1] = static_cast<Scalar>(value.Y());
+        xyz[2] = static_cast<Scalar>(value.Z());
+        std::memcpy(buffer.data() + offset, xyz, sizeof(xyz));
+    }
+}
+
+// A prototype mesh moved into model coordinates, for clients that do not instance
+geometry::MeshData placeMesh(const geometry::MeshData& prototype, const gp_Trsf& placement) {
+    geometry::MeshData placed = prototype;
+    placed.clear_prototype_id();
+    if (placed.has_packed()) {
+        geometry::PackedMeshBuffers* packed = placed.mutable_packed();
+        if (packed->encoding() == geometry::MESH_ENCODING_QUANTIZED) {
+            // Requantized across the placed box; indices are unchanged
+            const size_t vertex_count = packed->vertex_count();
+            std::vector<float> positions, normals;
+            MeshCodec::DecodePositions(packed->positions(), vertex_count, quantizationBox(*packed), positions);
+            if (!packed->normals().empty()) {
+                MeshCodec::DecodeNormals(packed->normals(), vertex_count, normals);
+            }
+            for (size_t i = 0; i < positions.size(); i += 3) {
+                gp_XYZ point(positions[i], positions[i + 1], positions[i + 2]);
+                placement.Transforms(point);
+                positions[i] = static_cast<float>(point.X());
+                positions[i + 1] = static_cast<float>(point.Y());
+                positions[i + 2] = static_cast<float>(point.Z());
+            }
+            for (size_t i = 0; i < normals.size(); i += 3) {
+                gp_XYZ direction(normals[i], normals[i + 1], normals[i + 2]);
+                direction.Multiply(placement.HVectorialPart());
+                normals[i] = static_cast<float>(direction.X());
+                normals[i + 1] = static_cast<float>(direction.Y());
+                normals[i + 2] = static_cast<float>(direction.Z());
+            }
+            packQuantizedVertices(positions, normals, *packed);
+        } else if (packed->encoding() == geometry::MESH_ENCODING_PACKED_FLOAT64) {
+            placePackedVec3<double>(*packed->mutable_positions(), placement, false);
+            placePackedVec3<double>(*packed->mutable_normals(), placement, true);
+        } else {
+            placePackedVec3<float>(*packed->mutable_positions(), placement, false);
+            placePackedVec3<float>(*packed->mutable_normals(), placement, true);
+        }
+    } else {
+        for (geometry::Point3D& vertex : *placed.mutable_vertices()) {
+            gp_XYZ point(vertex.x(), vertex.y(), vertex.z());
+            placement.Transforms(point);
+            vertex.set_x(point.X());
+            vertex.set_y(point.Y());
+            vertex.set_z(point.Z());
+        }
+        for (geometry::Vector3D& normal : *placed.mutable_normals()) {
+            gp_XYZ direction(normal.x(), normal.y(), normal.z());
+            direction.Multiply(placement.HVectorialPart());
+            const double length = direction.Modulus();
+            if (length > 0.0) {
+                direction /= length;
+            }
+            normal.set_x(direction.X());
+            normal.set_y(direction.Y());
+            normal.set_z(direction.Z());
+        }
+    }
+    if (prototype.has_bounding_box()) {
+        placeBoundingBox(prototype.bounding_box(), placement, *placed.mutable_bounding_box());
+    }
+    return placed;
+}
+
+} // namespace
+
+GeometryServiceImpl::GeometryServiceImpl(const GeometryServiceOptions& options)
+    : session_idle_timeout_(options.session_idle_timeout)
+    , session_sweep_interval_(options.session_sweep_interval)
+    , parallel_meshing_(options.parallel_meshing)
+    , max_concurrent_imports_(std::max<size_t>(1, options.max_concurrent_imports))
+    , session_memory_quota_bytes_(options.session_memory_quota_bytes)
+    , memory_limit_bytes_(options.memory_limit_bytes)
+    , mesh_cache_(options.mesh_cache_budget_bytes) {
+    // Headless: shapes are kept as TopoDS_Shape and tessellated on request, so no
+    // graphic driver, viewer or interactive context is created
+    mesh_import_options_.max_chunk_triangles = options.import_chunk_triangles;
+    if (!options.model_cache_dir.empty()) {
+        model_disk_cache_ = std::make_unique<ModelDiskCache>(options.model_cache_dir, options.model_cache_budget_bytes);
+    }
     
-    // Initialize session management
-    last_cleanup_ = std::chrono::steady_clock::now();
+    // Idle sessions are evicted off the request path
+    session_sweeper_ = std::thread(&GeometryServiceImpl::runSessionSweeper, this);
     
-    spdlog::info("GeometryService: OCCT context initialized successfully");
+    spdlog::info("GeometryService: Initialized (headless)");
+    spdlog::info("GeometryService: Mesh cache budget: {} MB, parallel meshing: {}",
+                options.mesh_cache_budget_bytes / (1024 * 1024), parallel_meshing_);
+    if (session_memory_quota_bytes_ > 0 || memory_limit_bytes_ > 0) {
+        spdlog::info("GeometryService: Session memory quota: {} MB, memory limit: {} MB (0 = unlimited)",
+                    session_memory_quota_bytes_ / (1024 * 1024), memory_limit_bytes_ / (1024 * 1024));
+    }
 }
 
 GeometryServiceImpl::~GeometryServiceImpl() {
     spdlog::info("GeometryService: Shutting down...");
+    {
+        std::lock_guard<std::mutex> lock(sweeper_mutex_);
+        stopping_ = true;
+    }
+    sweeper_cv_.notify_all();
+    if (session_sweeper_.joinable()) {
+        session_sweeper_.join();
+    }
+}
+
+uint64_t GeometryServiceImpl::nextShapeGeneration() {
+    // Server-wide so a reused shape ID never matches a stale cache entry
+    static std::atomic<uint64_t> generation_counter{0};
+    return generation_counter.fetch_add(1) + 1;
+}
+
+uint64_t GeometryServiceImpl::nextSceneVersion() {
+    static std::atomic<uint64_t> version_counter{0};
+    return version_counter.fetch_add(1) + 1;
+}
+
+void GeometryServiceImpl::assignPrototypes(std::vector<ShapeData>& shapes) {
+    // Server-wide, so prototypes of different imports never share an ID
+    static std::atomic<uint64_t> prototype_counter{0};
+    
+    std::map<std::pair<const TopoDS_TShape*, TopAbs_Orientation>, std::vector<size_t>> parts;
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        const TopoDS_Shape& shape = shapes[i].topo_shape;
+        if (!shape.IsNull()) {
+            parts[{shape.TShape().get(), shape.Orientation()}].push_back(i);
+        }
+    }
+    for (const auto& [part, occurrences] : parts) {
+        if (occurrences.size() < 2) {
+            continue;  // Nothing to share
+        }
+        std::string prototype_id = "prototype_" + std::to_string(prototype_counter.fetch_add(1));
+        for (size_t i : occurrences) {
+            shapes[i].prototype_id = prototype_id;
+            shapes[i].prototype_shape = shapes[i].topo_shape.Located(TopLoc_Location());
+        }
+    }
+}
+
+MeshCache::Stats GeometryServiceImpl::getMeshCacheStats() const {
+    return mesh_cache_.stats();
+}
+
+ModelDiskCache::Stats GeometryServiceImpl::getModelDiskCacheStats() const {
+    return model_disk_cache_ ? model_disk_cache_->stats() : ModelDiskCache::Stats();
+}
+
+size_t GeometryServiceImpl::getSessionCount() const {
+    size_t count = 0;
+    for (const auto& shard : session_shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        count += shard.sessions.size();
+    }
+    return count;
+}
+
+size_t GeometryServiceImpl::getShapeCount() const {
+    size_t count = 0;
+    for (const auto& shard : session_shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (const auto& [client_id, session] : shard.sessions) {
+            count += session->shapeCount();
+        }
+    }
+    return count;
+}
+
+uint64_t GeometryServiceImpl::totalShapeBytes() const {
+    return shape_bytes_.load(std::memory_order_relaxed);
+}
+
+GeometryServiceImpl::MemoryUsage GeometryServiceImpl::getMemoryUsage() const {
+    MemoryUsage usage;
+    for (const auto& shard : session_shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (const auto& [client_id, session] : shard.sessions) {
+            usage.brep_bytes += session->brep_bytes.load(std::memory_order_relaxed);
+            usage.triangulation_bytes += session->triangulation_bytes.load(std::memory_order_relaxed);
+        }
+    }
+    usage.mesh_cache_bytes = mesh_cache_.stats().bytes;
+    return usage;
+}
+
+GeometryServiceImpl::MemoryUsage GeometryServiceImpl::getSessionMemoryUsage(const std::string& client_id) const {
+    MemoryUsage usage;
+    if (auto session = findSession(client_id)) {
+        usage.brep_bytes = session->brep_bytes.load(std::memory_order_relaxed);
+        usage.triangulation_bytes = session->triangulation_bytes.load(std::memory_order_relaxed);
+    }
+    usage.mesh_cache_bytes = mesh_cache_.clientBytes(client_id);
+    return usage;
+}
+
+void GeometryServiceImpl::measureShape(ShapeData& shape_data, TopTools_MapOfShape* counted) {
+    ShapeMemory memory = estimateShapeMemory(shape_data.topo_shape, counted);
+    shape_data.brep_bytes = memory.brep_bytes;
+    shape_data.triangulation_bytes = memory.triangulation_bytes;
+}
+
+std::string GeometryServiceImpl::reserveShapeMemory(const ClientSession& session, uint64_t additional_bytes,
+                                                    uint64_t session_pending_bytes) {
+    // Cached meshes can always be evicted, so only shapes count here
+    if (session_memory_quota_bytes_ > 0) {
+        uint64_t used = session.shapeBytes() + session.upload_bytes.load(std::memory_order_relaxed) +
+                        session_pending_bytes;
+        if (used + additional_bytes > session_memory_quota_bytes_) {
+            return "Session memory quota exceeded: " + std::to_string(used) + " bytes in use, " +
+                   std::to_string(additional_bytes) + " more requested, quota " +
+                   std::to_string(session_memory_quota_bytes_) + " bytes";
+        }
+    }
+    // Other sessions add shapes concurrently, so the check and the reservation are one step
+    uint64_t used = shape_bytes_.load(std::memory_order_relaxed);
+    do {
+        if (memory_limit_bytes_ > 0 && used + additional_bytes > memory_limit_bytes_) {
+            return "Server memory limit exceeded: " + std::to_string(used) + " bytes in use, " +
+                   std::to_string(additional_bytes) + " more requested, limit " +
+                   std::to_string(memory_limit_bytes_) + " bytes";
+        }
+    } while (!shape_bytes_.compare_exchange_weak(used, used + additional_bytes, std::memory_order_relaxed));
+    return std::string();
+}
+
+void GeometryServiceImpl::releaseShapeMemory(uint64_t bytes) {
+    shape_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+std::string GeometryServiceImpl::addShapesWithinLimits(ClientSession& session,
+                                                       std::vector<std::pair<std::string, ShapeData>> shapes) {
+    uint64_t bytes = 0;
+    for (const auto& [shape_id, shape_data] : shapes) {
+        bytes += shape_data.memoryBytes();
+    }
+    std::lock_guard<std::mutex> lock(session.shapes_mutex);
+    std::string memory_error = reserveShapeMemory(session, bytes);
+    if (!memory_error.empty()) {
+        return memory_error;
+    }
+    for (auto& [shape_id, shape_data] : shapes) {
+        session.putShapeLocked(shape_id, std::move(shape_data));
+    }
+    // The shapes are accounted now; until this point they were briefly counted twice
+    releaseShapeMemory(bytes);
+    return std::string();
+}
+
+void GeometryServiceImpl::enforceMemoryLimits(const std::string& client_id) {
+    if (session_memory_quota_bytes_ > 0) {
+        if (auto session = findSession(client_id)) {
+            uint64_t shape_bytes = session->shapeBytes();
+            size_t target = shape_bytes < session_memory_quota_bytes_ ? session_memory_quota_bytes_ - shape_bytes : 0;
+            if (size_t freed = mesh_cache_.evictClient(client_id, target)) {
+                spdlog::debug("[{}] Evicted {} bytes of cached meshes for the session memory quota", client_id, freed);
+            }
+        }
+    }
+    if (memory_limit_bytes_ > 0) {
+        uint64_t shape_bytes = totalShapeBytes();
+        size_t target = shape_bytes < memory_limit_bytes_ ? memory_limit_bytes_ - shape_bytes : 0;
+        if (size_t freed = mesh_cache_.shrinkTo(target)) {
+            spdlog::debug("Evicted {} bytes of cached meshes for the server memory limit", freed);
+        }
+    }
+}
+
+void GeometryServiceImpl::setWorkGates(WorkGate meshing, WorkGate import) {
+    meshing_gate_ = std::move(meshing);
+    import_gate_ = std::move(import);
+}
+
+void GeometryServiceImpl::runGated(const WorkGate& gate, const std::function<void()>& work) {
+    if (gate) {
+        gate(work);
+    } else {
+        work();
+    }
+}
+
+void GeometryServiceImpl::cacheMesh(const MeshCacheKey& key, std::shared_ptr<const geometry::MeshData> mesh) {
+    mesh_cache_.insert(key, std::move(mesh));
+    enforceMemoryLimits(key.client_id);
+}
+
+std::mutex& GeometryServiceImpl::meshingMutexFor(const TopoDS_Shape& shape) {
+    const size_t hash = std::hash<const void*>()(shape.TShape().get());
+    return meshing_mutexes_[(hash >> 4) % kMeshingLockStripes];
+}
+
+void GeometryServiceImpl::recordTriangulation(const std::string& client_id, const ShapeData& shape_data) {
+    if (shape_data.brep_bytes == 0) {
+        return;  // Geometry accounted on another shape
+    }
+    uint64_t bytes = estimateTriangulationBytes(shape_data.topo_shape);
+    if (bytes == shape_data.triangulation_bytes) {
+        return;
+    }
+    if (auto session = findSession(client_id)) {
+        std::lock_guard<std::mutex> lock(session->shapes_mutex);
+        auto it = session->shapes.find(shape_data.shape_id);
+        if (it != session->shapes.end() && it->second.generation == shape_data.generation) {
+            session->setTriangulationBytesLocked(it->second, bytes);
+        }
+    }
 }
 
 std::string GeometryServiceImpl::generateShapeId() {
@@ -99,47 +668,103 @@ std::string GeometryServiceImpl::generateShapeId() {
     return "shape_" + std::to_string(shape_counter_.fetch_add(1));
 }
 
+void GeometryServiceImpl::stageShape(const std::string& shape_id, ShapeData shape_data) {
+    std::lock_guard<std::mutex> lock(staging_mutex_);
+    shapes_[shape_id] = std::move(shape_data);
+}
+
+GeometryServiceImpl::SessionShard& GeometryServiceImpl::shardFor(const std::string& client_id) {
+    return session_shards_[std::hash<std::string>{}(client_id) % kSessionShards];
+}
+
+const GeometryServiceImpl::SessionShard& GeometryServiceImpl::shardFor(const std::string& client_id) const {
+    return session_shards_[std::hash<std::string>{}(client_id) % kSessionShards];
+}
+
+std::shared_ptr<GeometryServiceImpl::ClientSession> GeometryServiceImpl::findSession(
+    const std::string& client_id) const {
+    const SessionShard& shard = shardFor(client_id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(client_id);
+    return it == shard.sessions.end() ? nullptr : it->second;
+}
+
 std::shared_ptr<GeometryServiceImpl::ClientSession> GeometryServiceImpl::getOrCreateSession(const std::string& client_id) {
-    std::lock_guard<std::mutex> lock(sessions_mutex_);
+    SessionShard& shard = shardFor(client_id);
     
-    // Clean up inactive sessions periodically (every 5 minutes)
-    auto now = std::chrono::steady_clock::now();
-    if (std::chrono::duration_cast<std::chrono::minutes>(now - last_cleanup_).count() >= 5) {
-        cleanupInactiveSessions();
-        last_cleanup_ = now;
+    // Fast path: existing session under a shared lock
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(client_id);
+        if (it != shard.sessions.end()) {
+            it->second->updateActivity();
+            return it->second;
+        }
     }
     
-    // Find or create session
-    auto it = client_sessions_.find(client_id);
-    if (it != client_sessions_.end()) {
-        it->second->updateActivity();
-        return it->second;
+    // Create new session (another thread may have won the race)
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto [it, inserted] = shard.sessions.try_emplace(client_id);
+    if (inserted) {
+        it->second = std::make_shared<ClientSession>(client_id, shape_bytes_);
+        spdlog::info("GeometryService: Created new session for client: {}", client_id);
     }
-    
-    // Create new session
-    auto session = std::make_shared<ClientSession>(client_id);
-    client_sessions_[client_id] = session;
-    spdlog::info("GeometryService: Created new session for client: {}", client_id);
+    it->second->updateActivity();
+    return it->second;
+}
+
+std::shared_ptr<GeometryServiceImpl::ClientSession> GeometryServiceImpl::removeSession(const std::string& client_id) {
+    SessionShard& shard = shardFor(client_id);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(client_id);
+    if (it == shard.sessions.end()) {
+        return nullptr;
+    }
+    auto session = std::move(it->second);
+    shard.sessions.erase(it);
     return session;
 }
 
-void GeometryServiceImpl::cleanupInactiveSessions(std::chrono::minutes timeout) {
-    // Note: Must be called with sessions_mutex_ locked
+void GeometryServiceImpl::retireSession(ClientSession& session) {
+    session.closeSubscribers();
+    mesh_cache_.invalidateClient(session.client_id);
+}
+
+void GeometryServiceImpl::evictIdleSessions() {
     auto now = std::chrono::steady_clock::now();
-    auto it = client_sessions_.begin();
-    while (it != client_sessions_.end()) {
-        auto duration = std::chrono::duration_cast<std::chrono::minutes>(now - it->second->last_activity);
-        if (duration >= timeout) {
-            spdlog::info("GeometryService: Removing inactive session for client: {} (inactive for {} minutes)", 
-                        it->first, duration.count());
-            it = client_sessions_.erase(it);
-        } else {
-            ++it;
+    std::vector<std::shared_ptr<ClientSession>> evicted;
+    for (auto& shard : session_shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+            auto idle = now - it->second->last_activity.load(std::memory_order_relaxed);
+            if (idle >= session_idle_timeout_ && !it->second->hasSubscribers()) {
+                evicted.push_back(std::move(it->second));
+                it = shard.sessions.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
+    
+    // Retire outside the shard locks
+    for (const auto& session : evicted) {
+        auto idle = std::chrono::duration_cast<std::chrono::minutes>(now - session->last_activity.load());
+        spdlog::info("GeometryService: Removing inactive session for client: {} (inactive for {} minutes)", 
+                    session->client_id, idle.count());
+        retireSession(*session);
+    }
+}
+
+void GeometryServiceImpl::runSessionSweeper() {
+    std::unique_lock<std::mutex> lock(sweeper_mutex_);
+    while (!sweeper_cv_.wait_for(lock, session_sweep_interval_, [this] { return stopping_; })) {
+        lock.unlock();
+        evictIdleSessions();
+        lock.lock();
+    }
 }
 
-std::string GeometryServiceImpl::getClientId(grpc::ServerContext* context) const {
+std::string GeometryServiceImpl::getClientId(const grpc::ServerContextBase* context) {
     if (!context) {
         spdlog::warn("getClientId: null context provided");
         return "Unknown";
@@ -167,9 +792,9 @@ grpc::Status GeometryServiceImpl::CreateBox(grpc::ServerContext* context,
         auto session = getOrCreateSession(client_id);
         
         std::string shape_id = session->generateShapeId();
-        Handle(AIS_Shape) ais_shape = createBoxShape(*request);
+        TopoDS_Shape shape = createBoxShape(*request);
         
-        if (ais_shape.IsNull()) {
+        if (shape.IsNull()) {
             response->set_success(false);
             response->set_message("Failed to create box shape");
             return grpc::Status::OK;
@@ -177,12 +802,22 @@ grpc::Status GeometryServiceImpl::CreateBox(grpc::ServerContext* context,
         
         // Store shape data in session
         ShapeData shape_data;
-        shape_data.ais_shape = ais_shape;
-        shape_data.topo_shape = ais_shape->Shape();
+        shape_data.topo_shape = shape;
         shape_data.color = request->color();
         shape_data.shape_id = shape_id;
+        measureShape(shape_data);
         
-        session->shapes[shape_id] = std::move(shape_data);
+        std::vector<std::pair<std::string, ShapeData>> created;
+        created.emplace_back(shape_id, std::move(shape_data));
+        std::string memory_error = addShapesWithinLimits(*session, std::move(created));
+        if (!memory_error.empty()) {
+            spdlog::warn("[{}] CreateBox: {}", client_id, memory_error);
+            response->set_success(false);
+            response->set_message(memory_error);
+            return grpc::Status::OK;
+        }
+        enforceMemoryLimits(client_id);
+        session->recordChange(shape_id, geometry::SCENE_CHANGE_ADDED);
         
         // Set response
         response->set_shape_id(shape_id);
@@ -198,7 +833,7 @@ grpc::Status GeometryServiceImpl::CreateBox(grpc::ServerContext* context,
         properties->mutable_color()->CopyFrom(request->color());
         
         spdlog::info("[{}] CreateBox: Successfully created box with ID: {} (session has {} shapes)", 
-                    client_id, shape_id, session->shapes.size());
+                    client_id, shape_id, session->shapeCount());
         return grpc::Status::OK;
         
     } catch (const std::exception& e) {
@@ -221,9 +856,9 @@ grpc::Status GeometryServiceImpl::CreateCone(grpc::ServerContext* context,
         auto session = getOrCreateSession(client_id);
         
         std::string shape_id = session->generateShapeId();
-        Handle(AIS_Shape) ais_shape = createConeShape(*request);
+        TopoDS_Shape shape = createConeShape(*request);
         
-        if (ais_shape.IsNull()) {
+        if (shape.IsNull()) {
             response->set_success(false);
             response->set_message("Failed to create cone shape");
             return grpc::Status::OK;
@@ -231,12 +866,22 @@ grpc::Status GeometryServiceImpl::CreateCone(grpc::ServerContext* context,
         
         // Store shape data in session
         ShapeData shape_data;
-        shape_data.ais_shape = ais_shape;
-        shape_data.topo_shape = ais_shape->Shape();
+        shape_data.topo_shape = shape;
         shape_data.color = request->color();
         shape_data.shape_id = shape_id;
+        measureShape(shape_data);
         
-        session->shapes[shape_id] = std::move(shape_data);
+        std::vector<std::pair<std::string, ShapeData>> created;
+        created.emplace_back(shape_id, std::move(shape_data));
+        std::string memory_error = addShapesWithinLimits(*session, std::move(created));
+        if (!memory_error.empty()) {
+            spdlog::warn("[{}] CreateCone: {}", client_id, memory_error);
+            response->set_success(false);
+            response->set_message(memory_error);
+            return grpc::Status::OK;
+        }
+        enforceMemoryLimits(client_id);
+        session->recordChange(shape_id, geometry::SCENE_CHANGE_ADDED);
         
         // Set response
         response->set_shape_id(shape_id);
@@ -252,7 +897,7 @@ grpc::Status GeometryServiceImpl::CreateCone(grpc::ServerContext* context,
         properties->mutable_color()->CopyFrom(request->color());
         
         spdlog::info("[{}] CreateCone: Successfully created cone with ID: {} (session has {} shapes)", 
-                    client_id, shape_id, session->shapes.size());
+                    client_id, shape_id, session->shapeCount());
         return grpc::Status::OK;
         
     } catch (const std::exception& e) {
@@ -263,34 +908,22 @@ grpc::Status GeometryServiceImpl::CreateCone(grpc::ServerContext* context,
     }
 }
 
-Handle(AIS_Shape) GeometryServiceImpl::createBoxShape(const geometry::BoxRequest& request) {
+TopoDS_Shape GeometryServiceImpl::createBoxShape(const geometry::BoxRequest& request) {
     gp_Pnt position = fromProtoPoint(request.position());
     gp_Ax2 axes(position, gp_Dir(0, 0, 1));
     
     TopoDS_Shape box = BRepPrimAPI_MakeBox(axes, request.width(), request.height(), request.depth()).Shape();
-    Handle(AIS_Shape) ais_shape = new AIS_Shape(box);
-    
-    // Set color
-    Quantity_Color occt_color = fromProtoColor(request.color());
-    ais_shape->SetColor(occt_color);
-    
-    return ais_shape;
+    return box;
 }
 
-Handle(AIS_Shape) GeometryServiceImpl::createConeShape(const geometry::ConeRequest& request) {
+TopoDS_Shape GeometryServiceImpl::createConeShape(const geometry::ConeRequest& request) {
     gp_Pnt position = fromProtoPoint(request.position());
     gp_Vec axis_vec = fromProtoVector(request.axis());
     gp_Ax2 axes(position, gp_Dir(axis_vec));
     
     TopoDS_Shape cone = BRepPrimAPI_MakeCone(axes, request.base_radius(), 
                                             request.top_radius(), request.height()).Shape();
-    Handle(AIS_Shape) ais_shape = new AIS_Shape(cone);
-    
-    // Set color
-    Quantity_Color occt_color = fromProtoColor(request.color());
-    ais_shape->SetColor(occt_color);
-    
-    return ais_shape;
+    return cone;
 }
 
 // Conversion helper methods
@@ -338,7 +971,8 @@ grpc::Status GeometryServiceImpl::GetSystemInfo(grpc::ServerContext* context,
     auto session = getOrCreateSession(client_id);
     
     response->set_version("1.0.0");
-    response->set_active_shapes(static_cast<int32_t>(session->shapes.size()));
+    size_t session_shape_count = session->shapeCount();
+    response->set_active_shapes(static_cast<int32_t>(session_shape_count));
     
     // Use OCCT version from CMake compile definition
 #ifdef OCCT_VERSION
@@ -347,13 +981,19 @@ grpc::Status GeometryServiceImpl::GetSystemInfo(grpc::ServerContext* context,
     response->set_occt_version("Unknown");
 #endif
     
-    // Add session info to log - capture session shape count safely
-    size_t total_sessions = 0;
-    size_t session_shape_count = session->shapes.size();
-    {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        total_sessions = client_sessions_.size();
-    }
+    // Server-wide figures for capacity planning
+    size_t total_sessions = getSessionCount();
+    response->set_active_sessions(total_sessions);
+    response->set_total_shapes(getShapeCount());
+    response->set_resident_memory_bytes(residentMemoryBytes());
+    
+    MemoryUsage session_usage = getSessionMemoryUsage(client_id);
+    response->set_session_brep_bytes(session_usage.brep_bytes);
+    response->set_session_triangulation_bytes(session_usage.triangulation_bytes);
+    response->set_session_mesh_cache_bytes(session_usage.mesh_cache_bytes);
+    response->set_session_memory_quota_bytes(session_memory_quota_bytes_);
+    response->set_accounted_memory_bytes(getMemoryUsage().total());
+    response->set_memory_limit_bytes(memory_limit_bytes_);
     
     spdlog::info("[{}] GetSystemInfo: Session has {} shapes, total {} active sessions", 
                 client_id, session_shape_count, total_sessions);
@@ -373,9 +1013,9 @@ grpc::Status GeometryServiceImpl::CreateSphere(grpc::ServerContext* context,
         auto session = getOrCreateSession(client_id);
         
         std::string shape_id = session->generateShapeId();
-        Handle(AIS_Shape) ais_shape = createSphereShape(*request);
+        TopoDS_Shape shape = createSphereShape(*request);
         
-        if (ais_shape.IsNull()) {
+        if (shape.IsNull()) {
             response->set_success(false);
             response->set_message("Failed to create sphere shape");
             return grpc::Status::OK;
@@ -383,12 +1023,22 @@ grpc::Status GeometryServiceImpl::CreateSphere(grpc::ServerContext* context,
         
         // Store shape data in session
         ShapeData shape_data;
-        shape_data.ais_shape = ais_shape;
-        shape_data.topo_shape = ais_shape->Shape();
+        shape_data.topo_shape = shape;
         shape_data.color = request->color();
         shape_data.shape_id = shape_id;
+        measureShape(shape_data);
         
-        session->shapes[shape_id] = std::move(shape_data);
+        std::vector<std::pair<std::string, ShapeData>> created;
+        created.emplace_back(shape_id, std::move(shape_data));
+        std::string memory_error = addShapesWithinLimits(*session, std::move(created));
+        if (!memory_error.empty()) {
+            spdlog::warn("[{}] CreateSphere: {}", client_id, memory_error);
+            response->set_success(false);
+            response->set_message(memory_error);
+            return grpc::Status::OK;
+        }
+        enforceMemoryLimits(client_id);
+        session->recordChange(shape_id, geometry::SCENE_CHANGE_ADDED);
         
         // Build response
         response->set_success(true);
@@ -396,7 +1046,7 @@ grpc::Status GeometryServiceImpl::CreateSphere(grpc::ServerContext* context,
         response->set_message("Sphere created successfully");
         
         spdlog::info("[{}] CreateSphere: Successfully created sphere with ID: {} (session has {} shapes)", 
-                    client_id, shape_id, session->shapes.size());
+                    client_id, shape_id, session->shapeCount());
         return grpc::Status::OK;
         
     } catch (const std::exception& e) {
@@ -418,9 +1068,9 @@ grpc::Status GeometryServiceImpl::CreateCylinder(grpc::ServerContext* context,
         auto session = getOrCreateSession(client_id);
         
         std::string shape_id = session->generateShapeId();
-        Handle(AIS_Shape) ais_shape = createCylinderShape(*request);
+        TopoDS_Shape shape = createCylinderShape(*request);
         
-        if (ais_shape.IsNull()) {
+        if (shape.IsNull()) {
             response->set_success(false);
             response->set_message("Failed to create cylinder shape");
             return grpc::Status::OK;
@@ -428,12 +1078,22 @@ grpc::Status GeometryServiceImpl::CreateCylinder(grpc::ServerContext* context,
         
         // Store shape data in session
         ShapeData shape_data;
-        shape_data.ais_shape = ais_shape;
-        shape_data.topo_shape = ais_shape->Shape();
+        shape_data.topo_shape = shape;
         shape_data.color = request->color();
         shape_data.shape_id = shape_id;
+        measureShape(shape_data);
         
-        session->shapes[shape_id] = std::move(shape_data);
+        std::vector<std::pair<std::string, ShapeData>> created;
+        created.emplace_back(shape_id, std::move(shape_data));
+        std::string memory_error = addShapesWithinLimits(*session, std::move(created));
+        if (!memory_error.empty()) {
+            spdlog::warn("[{}] CreateCylinder: {}", client_id, memory_error);
+            response->set_success(false);
+            response->set_message(memory_error);
+            return grpc::Status::OK;
+        }
+        enforceMemoryLimits(client_id);
+        session->recordChange(shape_id, geometry::SCENE_CHANGE_ADDED);
         
         // Build response
         response->set_success(true);
@@ -441,7 +1101,7 @@ grpc::Status GeometryServiceImpl::CreateCylinder(grpc::ServerContext* context,
         response->set_message("Cylinder created successfully");
         
         spdlog::info("[{}] CreateCylinder: Successfully created cylinder with ID: {} (session has {} shapes)", 
-                    client_id, shape_id, session->shapes.size());
+                    client_id, shape_id, session->shapeCount());
         return grpc::Status::OK;
         
     } catch (const std::exception& e) {
@@ -459,86 +1119,491 @@ grpc::Status GeometryServiceImpl::DeleteShape(grpc::ServerContext* context,
     auto session = getOrCreateSession(client_id);
     
     std::string shape_id = request->shape_id();
-    auto it = session->shapes.find(shape_id);
-    if (it == session->shapes.end()) {
-        response->set_success(false);
-        response->set_message("Shape not found in your session: " + shape_id);
-        return grpc::Status::OK;
+    size_t remaining = 0;
+    {
+        std::lock_guard<std::mutex> lock(session->shapes_mutex);
+        auto it = session->shapes.find(shape_id);
+        if (it == session->shapes.end()) {
+            response->set_success(false);
+            response->set_message("Shape not found in your session: " + shape_id);
+            return grpc::Status::OK;
+        }
+        session->eraseShapeLocked(it);
+        remaining = session->shapes.size();
     }
     
-    session->shapes.erase(it);
+    session->recordChange(shape_id, geometry::SCENE_CHANGE_DELETED);
+    mesh_cache_.invalidateShape(client_id, shape_id);
     response->set_success(true);
     response->set_message("Shape deleted successfully: " + shape_id);
     
     spdlog::info("[{}] DeleteShape: Deleted shape {} (session now has {} shapes)", 
-                client_id, shape_id, session->shapes.size());
+                client_id, shape_id, remaining);
     return grpc::Status::OK;
 }
 
 grpc::Status GeometryServiceImpl::TransformShape(grpc::ServerContext* context,
                                                 const geometry::TransformRequest* request,
                                                 geometry::ShapeResponse* response) {
-    response->set_success(false);
-    response->set_message("TransformShape not implemented yet");
-    return grpc::Status::OK;
-}
-
-grpc::Status GeometryServiceImpl::SetShapeColor(grpc::ServerContext* context,
-                                               const geometry::ColorRequest* request,
-                                               geometry::StatusResponse* response) {
-    response->set_success(false);
-    response->set_message("SetShapeColor not implemented yet");
-    return grpc::Status::OK;
-}
-
-grpc::Status GeometryServiceImpl::GetMeshData(grpc::ServerContext* context,
-                                             const geometry::ShapeRequest* request,
-                                             geometry::MeshData* response) {
-    if (!connected_) {
-        return grpc::Status(grpc::StatusCode::UNAVAILABLE, "Service not connected");
-    }
-    
     std::string client_id = getClientId(context);
     auto session = getOrCreateSession(client_id);
     
     std::string shape_id = request->shape_id();
+    std::lock_guard<std::mutex> lock(session->shapes_mutex);
     auto it = session->shapes.find(shape_id);
     if (it == session->shapes.end()) {
-        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Shape not found in your session: " + shape_id);
+        response->set_success(false);
+        response->set_message("Shape not found in your session: " + shape_id);
+        return grpc::Status::OK;
     }
     
     try {
-        spdlog::info("[{}] GetMeshData: Extracting mesh for shape: {}", client_id, shape_id);
-        *response = extractMeshData(shape_id);
-        spdlog::info("[{}] GetMeshData: Successfully extracted mesh with {} vertices, {} indices", client_id, 
-                    response->vertices_size(), response->indices_size());
-        return grpc::Status::OK;
+        TopoDS_Shape transformed;
+        std::string error;
+        if (!transformTopoShape(it->second.topo_shape, request->transform(), transformed, error)) {
+            response->set_success(false);
+            response->set_message(error + ": " + shape_id);
+            return grpc::Status::OK;
+        }
         
-    } catch (const std::exception& e) {
-        spdlog::error("GetMeshData: Exception occurred: {}", e.what());
-        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to extract mesh data: " + std::string(e.what()));
-    }
-}
+        ShapeData& shape_data = it->second;
+        if (transformed.TShape() != shape_data.topo_shape.TShape()) {
+            // Scaling or mirroring copied the geometry, without its triangulation;
+            // any growth has to fit the memory limits like a new shape
+            ShapeMemory memory = estimateShapeMemory(transformed);
+            const uint64_t growth = memory.total() > shape_data.memoryBytes()
+                                        ? memory.total() - shape_data.memoryBytes() : 0;
+            std::string memory_error = growth > 0 ? reserveShapeMemory(*session, growth) : std::string();
+            if (!memory_error.empty()) {
+                spdlog::warn("[{}] TransformShape: {}", client_id, memory_error);
+                response->set_success(false);
+                response->set_message(memory_error);
+                return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, memory_error);
+            }
+            session->account(shape_data, false);
+            shape_data.brep_bytes = memory.brep_bytes;
+            shape_data.triangulation_bytes = memory.triangulation_bytes;
+            session->account(shape_data, true);
+            releaseShapeMemory(growth);
+        }
+        shape_data.topo_shape = transformed;
+        shape_data.generation = nextShapeGeneration();
+        session->recordChange(shape_id, geometry::SCENE_CHANGE_UPDATED);
+        mesh_cache_.invalidateShape(client_id, shape_id);
+        
+        response->set_shape_id(shape_id);
+        response->set_success(true);
+        response->set_message("Shape transformed successfully");
+        
+        auto* properties = response->mutable_properties();
+        properties->set_shape_id(shape_id);
+        properties->mutable_transform()->CopyFrom(request->transform());
+        properties->mutable_color()->CopyFrom(shape_data.color);
+        properties->set_visible(shape_data.visible);
+        
+        spdlog::info("[{}] TransformShape: Transformed shape {}", client_id, shape_id);
+        return grpc::Status::OK;
+        
+    } catch (const Standard_Failure& e) {
+        spdlog::error("TransformShape: OCCT exception: {}", e.GetMessageString());
+        response->set_success(false);
+        response->set_message("Invalid transform: " + std::string(e.GetMessageString()));
+        return grpc::Status::OK;
+    } catch (const std::exception& e) {
+        spdlog::error("TransformShape: Exception occurred: {}", e.what());
+        response->set_success(false);
+        response->set_message("Internal server error: " + std::string(e.what()));
+        return grpc::Status::OK;
+    }
+}
+
+bool GeometryServiceImpl::transformTopoShape(const TopoDS_Shape& shape, const geometry::Transform& transform,
+                                             TopoDS_Shape& result, std::string& error) {
+    const auto& matrix = transform.matrix();
+    if (matrix.size() != 16) {
+        error = "Transform matrix must have 16 elements, got " + std::to_string(matrix.size());
+        return false;
+    }
+    
+    // Row-major 4x4; the last row is assumed to be (0, 0, 0, 1). Throws Standard_Failure
+    // for a singular matrix.
+    gp_Trsf trsf;
+    trsf.SetValues(matrix[0], matrix[1], matrix[2],  matrix[3],
+                   matrix[4], matrix[5], matrix[6],  matrix[7],
+                   matrix[8], matrix[9], matrix[10], matrix[11]);
+    
+    // Without a copy, rigid motions only change the location, so moved instances
+    // keep sharing their prototype; scaling and mirroring still rebuild the geometry
+    BRepBuilderAPI_Transform transformer(shape, trsf, Standard_False);
+    if (!transformer.IsDone()) {
+        error = "Failed to transform shape";
+        return false;
+    }
+    result = transformer.Shape();
+    return true;
+}
+
+grpc::Status GeometryServiceImpl::SetShapeColor(grpc::ServerContext* context,
+                                               const geometry::ColorRequest* request,
+                                               geometry::StatusResponse* response) {
+    std::string client_id = getClientId(context);
+    auto session = getOrCreateSession(client_id);
+    
+    std::string shape_id = request->shape_id();
+    std::lock_guard<std::mutex> lock(session->shapes_mutex);
+    auto it = session->shapes.find(shape_id);
+    if (it == session->shapes.end()) {
+        response->set_success(false);
+        response->set_message("Shape not found in your session: " + shape_id);
+        return grpc::Status::OK;
+    }
+    
+    ShapeData& shape_data = it->second;
+    shape_data.color = request->color();
+    shape_data.generation = nextShapeGeneration();
+    session->recordChange(shape_id, geometry::SCENE_CHANGE_UPDATED);
+    mesh_cache_.invalidateShape(client_id, shape_id);
+    
+    response->set_success(true);
+    response->set_message("Shape color updated: " + shape_id);
+    
+    spdlog::info("[{}] SetShapeColor: Updated color of shape {}", client_id, shape_id);
+    return grpc::Status::OK;
+}
+
+grpc::Status GeometryServiceImpl::ExecuteBatch(grpc::ServerContext* context,
+                                              const geometry::BatchRequest* request,
+                                              geometry::BatchResponse* response) {
+    return handleExecuteBatch(getClientId(context), request, response);
+}
+
+grpc::Status GeometryServiceImpl::handleExecuteBatch(const std::string& client_id,
+                                                    const geometry::BatchRequest* request,
+                                                    geometry::BatchResponse* response) {
+    STAGE_SPAN(rpc_span, "ExecuteBatch");
+    auto session = getOrCreateSession(client_id);
+    const int op_count = request->operations_size();
+    const bool transactional = request->transactional();
+    spdlog::info("[{}] ExecuteBatch: {} operations{}", client_id, op_count, transactional ? " (transactional)" : "");
+    
+    // Shapes touched by the batch. Changes go to these copies and reach the
+    // session only at the end, so a failed transactional batch is simply dropped.
+    struct StagedShape {
+        std::optional<ShapeData> data;   // Empty once deleted
+        bool existed{false};             // In the session before the batch
+        bool geometry_changed{false};
+        bool color_changed{false};
+    };
+    std::unordered_map<std::string, StagedShape> staged;
+    std::vector<std::string> touched;    // First-touch order, so change records follow the request
+    std::vector<std::pair<std::string, geometry::SceneChangeType>> changes;
+    std::vector<std::string> invalidated;
+    uint32_t succeeded = 0;
+    int failed_index = -1;
+    std::string failure;
+    
+    {
+        std::lock_guard<std::mutex> lock(session->shapes_mutex);
+        
+        // Null when the shape is unknown or was deleted earlier in the batch
+        auto stage = [&](const std::string& shape_id) -> StagedShape* {
+            auto it = staged.find(shape_id);
+            if (it == staged.end()) {
+                auto existing = session->shapes.find(shape_id);
+                if (existing == session->shapes.end()) {
+                    return nullptr;
+                }
+                it = staged.emplace(shape_id, StagedShape{existing->second, true}).first;
+                touched.push_back(shape_id);
+            }
+            return it->second.data ? &it->second : nullptr;
+        };
+        
+        // New shapes and grown geometry count against the memory quota together, reserved until committed
+        uint64_t created_bytes = 0;
+        auto create = [&](const TopoDS_Shape& shape, const geometry::Color& color,
+                          geometry::BatchOperationResult& result) {
+            if (shape.IsNull()) {
+                result.set_message("Failed to create shape");
+                return;
+            }
+            ShapeData shape_data;
+            shape_data.topo_shape = shape;
+            shape_data.color = color;
+            measureShape(shape_data);
+            std::string memory_error = reserveShapeMemory(*session, shape_data.memoryBytes(), created_bytes);
+            if (!memory_error.empty()) {
+                result.set_message(memory_error);
+                return;
+            }
+            created_bytes += shape_data.memoryBytes();
+            shape_data.shape_id = session->generateShapeId();
+            result.set_shape_id(shape_data.shape_id);
+            touched.push_back(shape_data.shape_id);
+            staged.emplace(shape_data.shape_id, StagedShape{std::move(shape_data), false});
+            result.set_success(true);
+        };
+        
+        for (int i = 0; i < op_count; ++i) {
+            const auto& op = request->operations(i);
+            auto* result = response->add_results();
+            if (failed_index >= 0) {
+                result->set_message("Skipped: operation " + std::to_string(failed_index) + " failed");
+                continue;
+            }
+            
+            try {
+                switch (op.op_case()) {
+                    case geometry::BatchOperation::kCreateBox:
+                        create(createBoxShape(op.create_box()), op.create_box().color(), *result);
+                        break;
+                    case geometry::BatchOperation::kCreateCone:
+                        create(createConeShape(op.create_cone()), op.create_cone().color(), *result);
+                        break;
+                    case geometry::BatchOperation::kCreateSphere:
+                        create(createSphereShape(op.create_sphere()), op.create_sphere().color(), *result);
+                        break;
+                    case geometry::BatchOperation::kCreateCylinder:
+                        create(createCylinderShape(op.create_cylinder()), op.create_cylinder().color(), *result);
+                        break;
+                    case geometry::BatchOperation::kTransform: {
+                        const auto& transform = op.transform();
+                        result->set_shape_id(transform.shape_id());
+                        StagedShape* entry = stage(transform.shape_id());
+                        if (!entry) {
+                            result->set_message("Shape not found in your session: " + transform.shape_id());
+                            break;
+                        }
+                        TopoDS_Shape transformed;
+                        std::string error;
+                        if (!transformTopoShape(entry->data->topo_shape, transform.transform(), transformed, error)) {
+                            result->set_message(error);
+                            break;
+                        }
+                        if (transformed.TShape() != entry->data->topo_shape.TShape()) {
+                            // Growth of rebuilt geometry is reserved like a creation
+                            ShapeMemory memory = estimateShapeMemory(transformed);
+                            const uint64_t growth = memory.total() > entry->data->memoryBytes()
+                                                        ? memory.total() - entry->data->memoryBytes() : 0;
+                            if (growth > 0) {
+                                std::string memory_error = reserveShapeMemory(*session, growth, created_bytes);
+                                if (!memory_error.empty()) {
+                                    result->set_message(memory_error);
+                                    break;
+                                }
+                                created_bytes += growth;
+                            }
+                            entry->data->brep_bytes = memory.brep_bytes;
+                            entry->data->triangulation_bytes = memory.triangulation_bytes;
+                        }
+                        entry->data->topo_shape = transformed;
+                        entry->geometry_changed = true;
+                        result->set_success(true);
+                        break;
+                    }
+                    case geometry::BatchOperation::kSetColor: {
+                        const auto& color = op.set_color();
+                        result->set_shape_id(color.shape_id());
+                        StagedShape* entry = stage(color.shape_id());
+                        if (!entry) {
+                            result->set_message("Shape not found in your session: " + color.shape_id());
+                            break;
+                        }
+                        entry->data->color = color.color();
+                        entry->color_changed = true;
+                        result->set_success(true);
+                        break;
+                    }
+                    case geometry::BatchOperation::kDeleteShape: {
+                        const std::string& shape_id = op.delete_shape().shape_id();
+                        result->set_shape_id(shape_id);
+                        StagedShape* entry = stage(shape_id);
+                        if (!entry) {
+                            result->set_message("Shape not found in your session: " + shape_id);
+                            break;
+                        }
+                        entry->data.reset();
+                        result->set_success(true);
+                        break;
+                    }
+                    default:
+                        result->set_message("Empty batch operation");
+                        break;
+                }
+            } catch (const Standard_Failure& e) {
+                result->set_success(false);
+                result->set_message("OCCT exception: " + std::string(e.GetMessageString()));
+            } catch (const std::exception& e) {
+                result->set_success(false);
+                result->set_message("Internal server error: " + std::string(e.what()));
+            }
+            
+            if (result->success()) {
+                ++succeeded;
+            } else if (transactional) {
+                failed_index = i;
+                failure = result->message();
+            }
+        }
+        
+        if (failed_index < 0) {
+            for (const auto& shape_id : touched) {
+                StagedShape& entry = staged[shape_id];
+                if (!entry.data) {
+                    if (entry.existed) {
+                        session->eraseShapeLocked(session->shapes.find(shape_id));
+                        changes.emplace_back(shape_id, geometry::SCENE_CHANGE_DELETED);
+                        invalidated.push_back(shape_id);
+                    }
+                    continue;
+                }
+                if (entry.existed && !entry.geometry_changed && !entry.color_changed) {
+                    continue;
+                }
+                
+                ShapeData& shape_data = *entry.data;
+                if (entry.existed) {
+                    shape_data.generation = nextShapeGeneration();
+                    changes.emplace_back(shape_id, geometry::SCENE_CHANGE_UPDATED);
+                    invalidated.push_back(shape_id);
+                } else {
+                    changes.emplace_back(shape_id, geometry::SCENE_CHANGE_ADDED);
+                }
+                session->putShapeLocked(shape_id, std::move(shape_data));
+            }
+        }
+        releaseShapeMemory(created_bytes);
+    }
+    
+    if (failed_index >= 0) {
+        // Rolled back: nothing was created, so no shape IDs are reported for creations
+        for (int i = 0; i < failed_index; ++i) {
+            switch (request->operations(i).op_case()) {
+                case geometry::BatchOperation::kCreateBox:
+                case geometry::BatchOperation::kCreateCone:
+                case geometry::BatchOperation::kCreateSphere:
+                case geometry::BatchOperation::kCreateCylinder:
+                    response->mutable_results(i)->clear_shape_id();
+                    break;
+                default:
+                    break;
+            }
+        }
+        response->set_success(false);
+        response->set_applied(false);
+        response->set_message("Rolled back: operation " + std::to_string(failed_index) + " failed: " + failure);
+        spdlog::warn("[{}] ExecuteBatch: {}", client_id, response->message());
+        return grpc::Status::OK;
+    }
+    
+    if (!changes.empty()) {
+        session->recordChanges(changes);
+    }
+    mesh_cache_.invalidateShapes(client_id, invalidated);
+    enforceMemoryLimits(client_id);
+    
+    response->set_success(succeeded == static_cast<uint32_t>(op_count));
+    response->set_applied(true);
+    response->set_succeeded_count(succeeded);
+    response->set_message(std::to_string(succeeded) + " of " + std::to_string(op_count) + " operations succeeded");
+    spdlog::info("[{}] ExecuteBatch: {} (session has {} shapes)", client_id, response->message(), session->shapeCount());
+    return grpc::Status::OK;
+}
+
+grpc::Status GeometryServiceImpl::GetMeshData(grpc::ServerContext* context,
+                                             const geometry::ShapeRequest* request,
+                                             geometry::MeshData* response) {
+    return handleGetMeshData(getClientId(context), request, response);
+}
+
+grpc::Status GeometryServiceImpl::handleGetMeshData(const std::string& client_id,
+                                                   const geometry::ShapeRequest* request,
+                                                   geometry::MeshData* response) {
+    STAGE_SPAN(rpc_span, "GetMeshData");
+    if (!connected_) {
+        return grpc::Status(grpc::StatusCode::UNAVAILABLE, "Service not connected");
+    }
+    
+    auto session = getOrCreateSession(client_id);
+    
+    std::string shape_id = request->shape_id();
+    auto shape_data = session->findShape(shape_id);
+    if (!shape_data) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Shape not found in your session: " + shape_id);
+    }
+    
+    try {
+        spdlog::info("[{}] GetMeshData: Extracting mesh for shape: {}", client_id, shape_id);
+        geometry::MeshData scratch;
+        *response = shapeMeshMessage(*shape_data, getCachedMeshData(client_id, *shape_data, request->mesh_options()),
+                                     nullptr, scratch);
+        spdlog::info("[{}] GetMeshData: Successfully extracted mesh with {} vertices, {} triangles", client_id, 
+                    meshVertexCount(*response), meshTriangleCount(*response));
+        return grpc::Status::OK;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("GetMeshData: Exception occurred: {}", e.what());
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to extract mesh data: " + std::string(e.what()));
+    }
+}
 
 grpc::Status GeometryServiceImpl::GetAllMeshes(grpc::ServerContext* context,
-                                              const geometry::EmptyRequest* request,
+                                              const geometry::MeshRequest* request,
                                               grpc::ServerWriter<geometry::MeshData>* writer) {
+    STAGE_SPAN(rpc_span, "GetAllMeshes");
     try {
         std::string client_id = getClientId(context);
         auto session = getOrCreateSession(client_id);
         
-        spdlog::info("[{}] GetAllMeshes: Streaming {} shapes from client session", client_id, session->shapes.size());
+        auto shapes = session->snapshotShapes();
         
-        for (const auto& [shape_id, shape_data] : session->shapes) {
-            geometry::MeshData mesh_data = extractMeshData(shape_id);
-            if (!writer->Write(mesh_data)) {
-                spdlog::error("GetAllMeshes: Failed to write mesh data for shape: {}", shape_id);
-                break;
+        std::optional<ViewCamera> camera;
+        if (request->has_camera()) {
+            camera = fromProtoCamera(request->camera());
+            if (!camera) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                    "Camera needs 16-element view and projection matrices and a viewport size");
+            }
+        }
+        if (request->skip_culled()) {
+            if (auto view = camera ? camera : session->currentCamera()) {
+                auto boxes = spatialBounds(*session, shapes);
+                std::vector<ShapeData> in_view;
+                for (size_t i = 0; i < shapes.size(); ++i) {
+                    if (view->screenArea(boxes[i]) > 0.0) {
+                        in_view.push_back(std::move(shapes[i]));
+                    }
+                }
+                shapes.swap(in_view);
+            }
+        }
+        spdlog::info("[{}] GetAllMeshes: Streaming {} shapes from client session", client_id, shapes.size());
+        
+        // A triangle budget needs every mesh before the first one can be sent
+        std::unordered_map<std::string, std::shared_ptr<const geometry::MeshData>> budgeted;
+        if (request->triangle_budget() > 0) {
+            auto meshes = getMeshesWithinBudget(client_id, shapes, request->mesh_options(), request->triangle_budget());
+            for (size_t i = 0; i < shapes.size(); ++i) {
+                budgeted.emplace(shapes[i].shape_id, std::move(meshes[i]));
             }
-            spdlog::info("[{}] GetAllMeshes: Sent mesh for shape: {} ({} vertices)", client_id, 
-                        shape_id, mesh_data.vertices_size());
         }
         
+        SentPrototypes sent;
+        geometry::MeshData scratch;
+        streamInViewOrder(client_id, *session, std::move(shapes), camera, [&](const ShapeData& shape_data) {
+            const std::string& shape_id = shape_data.shape_id;
+            auto mesh = budgeted.empty() ? getCachedMeshData(client_id, shape_data, request->mesh_options())
+                                         : budgeted.at(shape_id);
+            const geometry::MeshData& mesh_data = shapeMeshMessage(shape_data, mesh, &sent, scratch);
+            if (!tracedWrite(writer, mesh_data)) {
+                spdlog::error("GetAllMeshes: Failed to write mesh data for shape: {}", shape_id);
+                return false;
+            }
+            spdlog::info("[{}] GetAllMeshes: Sent mesh for shape: {} ({} vertices, {} bytes)", client_id, 
+                        shape_id, meshVertexCount(mesh_data), mesh_data.ByteSizeLong());
+            return true;
+        });
+        
         spdlog::info("[{}] GetAllMeshes: Completed streaming all meshes for session", client_id);
         return grpc::Status::OK;
         
@@ -548,6 +1613,622 @@ grpc::Status GeometryServiceImpl::GetAllMeshes(grpc::ServerContext* context,
     }
 }
 
+grpc::Status GeometryServiceImpl::StreamMeshLods(grpc::ServerContext* context,
+                                                const geometry::MeshLodRequest* request,
+                                                grpc::ServerWriter<geometry::MeshData>* writer) {
+    STAGE_SPAN(rpc_span, "StreamMeshLods");
+    try {
+        std::string client_id = getClientId(context);
+        auto session = getOrCreateSession(client_id);
+        
+        struct Refinement {
+            ShapeData shape;
+            double diagonal{0.0};
+            double base_deflection{0.0};  // Linear deflection of LOD 0
+            float screen_size{0.0f};
+            bool has_mesh{false};
+            uint32_t shown_lod{0};  // Valid when has_mesh is set
+            uint32_t next_lod{0};
+        };
+        std::vector<Refinement> work;
+        constexpr uint32_t kCoarsestLod = kMeshLodCount - 1;
+        
+        if (request->targets().empty()) {
+            for (auto& shape_data : session->snapshotShapes()) {
+                work.push_back({std::move(shape_data), 0.0, 0.0, 0.0f, false, 0, kCoarsestLod});
+            }
+        } else {
+            for (const auto& target : request->targets()) {
+                auto shape_data = session->findShape(target.shape_id());
+                if (!shape_data || (target.has_mesh() && target.current_lod() == 0)) {
+                    continue;  // Unknown or already at full quality
+                }
+                uint32_t shown = std::min(target.current_lod(), kMeshLodCount);
+                work.push_back({std::move(*shape_data), 0.0, 0.0, target.screen_size(), target.has_mesh(),
+                                shown, target.has_mesh() ? shown - 1 : kCoarsestLod});
+            }
+        }
+        
+        bool use_screen_size = false;
+        for (auto& item : work) {
+            item.diagonal = shapeDiagonal(item.shape.topo_shape);
+            item.base_deflection = resolveMeshDeflection(item.shape, request->mesh_options()).linear;
+            item.next_lod = distinctLod(item.base_deflection, item.diagonal, item.next_lod);
+            use_screen_size |= item.screen_size > 0.0f;
+        }
+        
+        // Error still visible for a shape: pixels when the client reported sizes, model units otherwise
+        auto visibleError = [&](const Refinement& item) {
+            double deflection = lodLinearDeflection(item.base_deflection, item.diagonal, item.shown_lod);
+            if (!use_screen_size) {
+                return deflection;
+            }
+            return item.diagonal > 0.0 ? item.screen_size * deflection / item.diagonal : 0.0;
+        };
+        
+        // Shapes without a mesh go first, largest first; refinements follow by visible error
+        std::vector<size_t> first_pass;
+        std::priority_queue<std::pair<double, size_t>> refinements;
+        for (size_t i = 0; i < work.size(); ++i) {
+            if (work[i].has_mesh) {
+                refinements.emplace(visibleError(work[i]), i);
+            } else {
+                first_pass.push_back(i);
+            }
+        }
+        std::stable_sort(first_pass.begin(), first_pass.end(), [&](size_t a, size_t b) {
+            return use_screen_size ? work[a].screen_size > work[b].screen_size
+                                   : work[a].diagonal > work[b].diagonal;
+        });
+        
+        size_t sent = 0;
+        SentPrototypes sent_prototypes;
+        geometry::MeshData scratch;
+        auto send = [&](size_t index) {
+            Refinement& item = work[index];
+            geometry::MeshOptions options = request->mesh_options();
+            options.set_lod(item.next_lod);
+            auto mesh = getCachedMeshData(client_id, item.shape, options);
+            if (context->IsCancelled() ||
+                !tracedWrite(writer, shapeMeshMessage(item.shape, mesh, &sent_prototypes, scratch))) {
+                return false;
+            }
+            ++sent;
+            item.has_mesh = true;
+            item.shown_lod = item.next_lod;
+            if (item.shown_lod > 0) {
+                item.next_lod = distinctLod(item.base_deflection, item.diagonal, item.shown_lod - 1);
+                refinements.emplace(visibleError(item), index);
+            }
+            return true;
+        };
+        
+        for (size_t index : first_pass) {
+            if (!send(index)) {
+                spdlog::info("[{}] StreamMeshLods: Client went away after {} meshes", client_id, sent);
+                return grpc::Status::OK;
+            }
+        }
+        while (!refinements.empty()) {
+            size_t index = refinements.top().second;
+            refinements.pop();
+            if (!send(index)) {
+                spdlog::info("[{}] StreamMeshLods: Client went away after {} meshes", client_id, sent);
+                return grpc::Status::OK;
+            }
+        }
+        
+        spdlog::info("[{}] StreamMeshLods: Streamed {} meshes for {} shapes", client_id, sent, work.size());
+        return grpc::Status::OK;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("StreamMeshLods: Exception occurred: {}", e.what());
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to stream mesh levels: " + std::string(e.what()));
+    }
+}
+
+grpc::Status GeometryServiceImpl::SyncScene(grpc::ServerContext* context,
+                                           const geometry::SceneSyncRequest* request,
+                                           grpc::ServerWriter<geometry::SceneChange>* writer) {
+    STAGE_SPAN(rpc_span, "SyncScene");
+    try {
+        std::string client_id = getClientId(context);
+        auto session = getOrCreateSession(client_id);
+        
+        std::optional<ViewCamera> camera;
+        if (request->has_camera()) {
+            camera = fromProtoCamera(request->camera());
+            if (!camera) {
+                return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                    "Camera needs 16-element view and projection matrices and a viewport size");
+            }
+        }
+        
+        // Snapshot the change log, then extract meshes without holding the lock
+        const uint64_t since_version = request->since_version();
+        uint64_t scene_version = 0;
+        bool full_resync = false;
+        std::vector<std::pair<std::string, geometry::SceneChangeType>> changes;
+        {
+            std::lock_guard<std::mutex> lock(session->change_log_mutex);
+            scene_version = session->scene_version;
+            full_resync = since_version == 0 || since_version < session->change_log_floor ||
+                          since_version > scene_version;
+            if (!full_resync) {
+                for (const auto& [shape_id, change] : session->change_log) {
+                    if (change.version > since_version) {
+                        changes.emplace_back(shape_id, change.type);
+                    }
+                }
+            }
+        }
+        
+        if (full_resync) {
+            for (const auto& shape_data : session->snapshotShapes()) {
+                changes.emplace_back(shape_data.shape_id, geometry::SCENE_CHANGE_ADDED);
+            }
+        } else if (changes.empty()) {
+            spdlog::debug("[{}] SyncScene: Client is up to date at version {}", client_id, since_version);
+            return grpc::Status::OK;
+        }
+        
+        spdlog::info("[{}] SyncScene: {} from version {} to {}, {} changes", client_id,
+                    full_resync ? "Full resync" : "Delta", since_version, scene_version, changes.size());
+        
+        if (full_resync) {
+            geometry::SceneChange reset;
+            reset.set_type(geometry::SCENE_CHANGE_RESET);
+            reset.set_scene_version(scene_version);
+            if (!tracedWrite(writer, reset)) {
+                return grpc::Status::OK;
+            }
+        }
+        
+        // Deletions are cheap and go first; meshes follow in view order
+        geometry::SceneChange change;
+        std::vector<ShapeData> live_shapes;
+        std::unordered_map<std::string, geometry::SceneChangeType> live_types;
+        for (const auto& [shape_id, type] : changes) {
+            auto shape_data = type == geometry::SCENE_CHANGE_DELETED ? std::optional<ShapeData>() : session->findShape(shape_id);
+            if (shape_data) {
+                live_types.emplace(shape_id, type);
+                live_shapes.push_back(std::move(*shape_data));
+                continue;
+            }
+            change.Clear();
+            change.set_shape_id(shape_id);
+            change.set_scene_version(scene_version);
+            change.set_type(geometry::SCENE_CHANGE_DELETED);
+            if (!tracedWrite(writer, change)) {
+                spdlog::error("SyncScene: Failed to write change for shape: {}", shape_id);
+                return grpc::Status::OK;
+            }
+        }
+        
+        SentPrototypes sent;
+        geometry::MeshData scratch;
+        streamInViewOrder(client_id, *session, std::move(live_shapes), camera, [&](const ShapeData& shape_data) {
+            change.Clear();
+            change.set_shape_id(shape_data.shape_id);
+            change.set_scene_version(scene_version);
+            change.set_type(live_types.at(shape_data.shape_id));
+            *change.mutable_mesh() = shapeMeshMessage(
+                shape_data, getCachedMeshData(client_id, shape_data, request->mesh_options()), &sent, scratch);
+            if (!tracedWrite(writer, change)) {
+                spdlog::error("SyncScene: Failed to write change for shape: {}", shape_data.shape_id);
+                return false;
+            }
+            return true;
+        });
+        
+        return grpc::Status::OK;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("SyncScene: Exception occurred: {}", e.what());
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to sync scene: " + std::string(e.what()));
+    }
+}
+
+grpc::Status GeometryServiceImpl::SubscribeSceneChanges(grpc::ServerContext* context,
+                                                       const geometry::SceneSubscribeRequest* request,
+                                                       grpc::ServerWriter<geometry::SceneChange>* writer) {
+    try {
+        std::string client_id = getClientId(context);
+        auto session = getOrCreateSession(client_id);
+        
+        auto subscriber = std::make_shared<SceneSubscriber>();
+        session->addSubscriber(subscriber);
+        spdlog::info("[{}] SubscribeSceneChanges: Subscription started (inline meshes: {})",
+                    client_id, request->include_mesh());
+        
+        size_t events_sent = 0;
+        bool stream_open = true;
+        SentPrototypes sent;
+        geometry::MeshData scratch;
+        while (stream_open && !context->IsCancelled()) {
+            std::deque<geometry::SceneChange> events;
+            {
+                // Wake up periodically to notice client cancellation
+                std::unique_lock<std::mutex> lock(subscriber->mutex);
+                subscriber->cv.wait_for(lock, std::chrono::milliseconds(250), [&subscriber] {
+                    return subscriber->closed || !subscriber->pending.empty();
+                });
+                if (subscriber->closed && subscriber->pending.empty()) {
+                    break;
+                }
+                events.swap(subscriber->pending);
+            }
+            
+            for (auto& event : events) {
+                const bool has_mesh = event.type() == geometry::SCENE_CHANGE_ADDED ||
+                                      event.type() == geometry::SCENE_CHANGE_UPDATED;
+                if (has_mesh && request->include_mesh()) {
+                    if (auto shape_data = session->findShape(event.shape_id())) {
+                        *event.mutable_mesh() = shapeMeshMessage(
+                            *shape_data, getCachedMeshData(client_id, *shape_data, request->mesh_options()),
+                            &sent, scratch);
+                    }
+                }
+                if (!tracedWrite(writer, event)) {
+                    stream_open = false;
+                    break;
+                }
+                events_sent++;
+            }
+        }
+        
+        spdlog::info("[{}] SubscribeSceneChanges: Subscription ended after {} events", client_id, events_sent);
+        return grpc::Status::OK;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("SubscribeSceneChanges: Exception occurred: {}", e.what());
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Subscription failed: " + std::string(e.what()));
+    }
+}
+
+void GeometryServiceImpl::syncSpatialIndex(ClientSession& session) {
+    std::vector<std::string> changed_ids;
+    bool rebuild = false;
+    {
+        std::lock_guard<std::mutex> lock(session.change_log_mutex);
+        if (session.spatial_version == session.scene_version) {
+            return;
+        }
+        rebuild = session.spatial_version < session.change_log_floor;
+        if (!rebuild) {
+            for (const auto& [shape_id, change] : session.change_log) {
+                if (change.version > session.spatial_version) {
+                    changed_ids.push_back(shape_id);
+                }
+            }
+        }
+        session.spatial_version = session.scene_version;
+    }
+    
+    // Shapes changed after the log was read are picked up again by the next sync
+    if (rebuild) {
+        session.spatial_index.clear();
+        for (const auto& shape_data : session.snapshotShapes()) {
+            session.spatial_index.upsert(shape_data.shape_id, shapeBounds(shape_data.topo_shape),
+                                         shape_data.generation, shape_data.visible);
+        }
+        return;
+    }
+    for (const auto& shape_id : changed_ids) {
+        if (auto shape_data = session.findShape(shape_id)) {
+            session.spatial_index.upsert(shape_id, shapeBounds(shape_data->topo_shape),
+                                         shape_data->generation, shape_data->visible);
+        } else {
+            session.spatial_index.remove(shape_id);
+        }
+    }
+}
+
+// Triangles come from the full-quality mesh clients are served, so picks match what they draw
+SceneSpatialIndex::MeshLoader GeometryServiceImpl::spatialMeshLoader(const std::string& client_id,
+                                                                     ClientSession& session) {
+    return [this, &client_id, &session](const std::string& shape_id, std::vector<float>& positions,
+                                        std::vector<uint32_t>& indices) {
+        auto shape_data = session.findShape(shape_id);
+        if (!shape_data) {
+            return false;
+        }
+        geometry::MeshOptions options;
+        options.set_encoding(geometry::MESH_ENCODING_PACKED_FLOAT32);
+        options.set_omit_normals(true);
+        auto mesh = getCachedMeshData(client_id, *shape_data, options);
+        const geometry::PackedMeshBuffers& packed = mesh->packed();
+        if (packed.triangle_count() == 0) {
+            return false;
+        }
+        positions.resize(packed.positions().size() / sizeof(float));
+        std::memcpy(positions.data(), packed.positions().data(), positions.size() * sizeof(float));
+        indices.resize(packed.indices().size() / sizeof(uint32_t));
+        std::memcpy(indices.data(), packed.indices().data(), indices.size() * sizeof(uint32_t));
+        return true;
+    };
+}
+
+grpc::Status GeometryServiceImpl::RayPick(grpc::ServerContext* context,
+                                         const geometry::RayPickRequest* request,
+                                         geometry::RayPickResponse* response) {
+    std::string client_id = getClientId(context);
+    try {
+        const Vec3 direction = toVec3(request->direction());
+        if (direction[0] == 0.0 && direction[1] == 0.0 && direction[2] == 0.0) {
+            response->set_success(false);
+            response->set_message("Ray direction must be non-zero");
+            return grpc::Status::OK;
+        }
+        if (request->max_distance() < 0.0) {
+            response->set_success(false);
+            response->set_message("max_distance must not be negative");
+            return grpc::Status::OK;
+        }
+        
+        auto session = getOrCreateSession(client_id);
+        std::vector<SceneSpatialIndex::Hit> hits;
+        {
+            std::lock_guard<std::mutex> lock(session->spatial_mutex);
+            syncSpatialIndex(*session);
+            hits = session->spatial_index.rayPick(toVec3(request->origin()), direction, request->max_distance(),
+                                                  request->max_hits(), request->include_hidden(),
+                                                  spatialMeshLoader(client_id, *session));
+        }
+        
+        for (const auto& hit : hits) {
+            geometry::PickHit* proto_hit = response->add_hits();
+            proto_hit->set_shape_id(hit.shape_id);
+            proto_hit->set_distance(hit.distance);
+            proto_hit->mutable_point()->set_x(hit.point[0]);
+            proto_hit->mutable_point()->set_y(hit.point[1]);
+            proto_hit->mutable_point()->set_z(hit.point[2]);
+            proto_hit->mutable_normal()->set_x(hit.normal[0]);
+            proto_hit->mutable_normal()->set_y(hit.normal[1]);
+            proto_hit->mutable_normal()->set_z(hit.normal[2]);
+            proto_hit->set_triangle_index(hit.triangle);
+        }
+        response->set_success(true);
+        response->set_message(hits.empty() ? "No hit" : "Hit " + hits.front().shape_id);
+        spdlog::info("[{}] RayPick: {} hits", client_id, hits.size());
+        return grpc::Status::OK;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("[{}] RayPick: Exception occurred: {}", client_id, e.what());
+        response->set_success(false);
+        response->set_message("Ray pick failed: " + std::string(e.what()));
+        return grpc::Status::OK;
+    }
+}
+
+grpc::Status GeometryServiceImpl::BoxQuery(grpc::ServerContext* context,
+                                          const geometry::BoxQueryRequest* request,
+                                          geometry::ShapeQueryResponse* response) {
+    std::string client_id = getClientId(context);
+    try {
+        Aabb box;
+        box.add(toVec3(request->box().min()));
+        box.add(toVec3(request->box().max()));
+        
+        auto session = getOrCreateSession(client_id);
+        std::vector<std::string> shape_ids;
+        {
+            std::lock_guard<std::mutex> lock(session->spatial_mutex);
+            syncSpatialIndex(*session);
+            shape_ids = session->spatial_index.boxQuery(box, request->fully_inside(), request->include_hidden());
+        }
+        
+        response->mutable_shape_ids()->Add(shape_ids.begin(), shape_ids.end());
+        response->set_success(true);
+        response->set_message("Found " + std::to_string(shape_ids.size()) + " shapes");
+        spdlog::info("[{}] BoxQuery: {} shapes", client_id, shape_ids.size());
+        return grpc::Status::OK;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("[{}] BoxQuery: Exception occurred: {}", client_id, e.what());
+        response->set_success(false);
+        response->set_message("Box query failed: " + std::string(e.what()));
+        return grpc::Status::OK;
+    }
+}
+
+grpc::Status GeometryServiceImpl::FrustumCull(grpc::ServerContext* context,
+                                             const geometry::FrustumCullRequest* request,
+                                             geometry::ShapeQueryResponse* response) {
+    std::string client_id = getClientId(context);
+    try {
+        std::vector<Plane> planes;
+        if (request->planes_size() > 0) {
+            for (const auto& proto_plane : request->planes()) {
+                planes.push_back(Plane{toVec3(proto_plane.normal()), proto_plane.offset()});
+            }
+        } else if (request->view_projection_size() == 16) {
+            std::array<double, 16> matrix{};
+            std::copy(request->view_projection().begin(), request->view_projection().end(), matrix.begin());
+            planes = SceneSpatialIndex::frustumPlanes(matrix);
+        } else {
+            response->set_success(false);
+            response->set_message("Expected frustum planes or a 16-element view_projection matrix");
+            return grpc::Status::OK;
+        }
+        
+        auto session = getOrCreateSession(client_id);
+        std::vector<std::string> shape_ids;
+        {
+            std::lock_guard<std::mutex> lock(session->spatial_mutex);
+            syncSpatialIndex(*session);
+            shape_ids = session->spatial_index.frustumCull(planes, request->include_hidden());
+        }
+        
+        response->mutable_shape_ids()->Add(shape_ids.begin(), shape_ids.end());
+        response->set_success(true);
+        response->set_message(std::to_string(shape_ids.size()) + " shapes in view");
+        spdlog::info("[{}] FrustumCull: {} shapes in view", client_id, shape_ids.size());
+        return grpc::Status::OK;
+        
+    } catch (const std::exception& e) {
+        spdlog::error("[{}] FrustumCull: Exception occurred: {}", client_id, e.what());
+        response->set_success(false);
+        response->set_message("Frustum cull failed: " + std::string(e.what()));
+        return grpc::Status::OK;
+    }
+}
+
+grpc::Status GeometryServiceImpl::UpdateCamera(grpc::ServerContext* context,
+                                              const geometry::CameraUpdateRequest* request,
+                                              geometry::StatusResponse* response) {
+    std::string client_id = getClientId(context);
+    auto session = getOrCreateSession(client_id);
+    
+    // An empty camera clears it, so streams fall back to their natural order
+    std::optional<ViewCamera> camera;
+    const bool clear = request->camera().view().empty() && request->camera().projection().empty();
+    if (!clear) {
+        camera = fromProtoCamera(request->camera());
+        if (!camera) {
+            response->set_success(false);
+            response->set_message("Camera needs 16-element view and projection matrices and a viewport size");
+            return grpc::Status::OK;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(session->camera_mutex);
+        session->camera = std::move(camera);
+    }
+    session->camera_version.fetch_add(1);
+    
+    response->set_success(true);
+    response->set_message(clear ? "Camera cleared" : "Camera updated");
+    spdlog::debug("[{}] UpdateCamera: {}", client_id, response->message());
+    return grpc::Status::OK;
+}
+
+std::optional<ViewCamera> GeometryServiceImpl::fromProtoCamera(const geometry::ViewCamera& camera) {
+    if (camera.view_size() != 16 || camera.projection_size() != 16) {
+        return std::nullopt;
+    }
+    std::array<double, 16> view{}, projection{};
+    std::copy(camera.view().begin(), camera.view().end(), view.begin());
+    std::copy(camera.projection().begin(), camera.projection().end(), projection.begin());
+    return ViewCamera::create(view, projection, camera.viewport_width(), camera.viewport_height());
+}
+
+std::vector<Aabb> GeometryServiceImpl::spatialBounds(ClientSession& session, const std::vector<ShapeData>& shapes) {
+    std::vector<Aabb> boxes;
+    boxes.reserve(shapes.size());
+    std::lock_guard<std::mutex> lock(session.spatial_mutex);
+    syncSpatialIndex(session);
+    for (const auto& shape_data : shapes) {
+        const Aabb* box = session.spatial_index.bounds(shape_data.shape_id);
+        boxes.push_back(box ? *box : shapeBounds(shape_data.topo_shape));
+    }
+    return boxes;
+}
+
+// Occluded means the lines of sight to the box centre and to points halfway to
+// each corner all meet another shape first. Only the streaming order depends on
+// it, so a wrong guess costs latency, never content.
+bool GeometryServiceImpl::occludedInView(const std::string& client_id, ClientSession& session,
+                                         const ViewCamera& camera, const std::string& shape_id, const Aabb& box) {
+    if (box.empty()) {
+        return false;
+    }
+    const Vec3 centre{(box.min[0] + box.max[0]) * 0.5, (box.min[1] + box.max[1]) * 0.5,
+                      (box.min[2] + box.max[2]) * 0.5};
+    std::vector<Vec3> samples{centre};
+    for (int corner = 0; corner < 8; ++corner) {
+        samples.push_back({(centre[0] + (corner & 1 ? box.max[0] : box.min[0])) * 0.5,
+                           (centre[1] + (corner & 2 ? box.max[1] : box.min[1])) * 0.5,
+                           (centre[2] + (corner & 4 ? box.max[2] : box.min[2])) * 0.5});
+    }
+    
+    std::lock_guard<std::mutex> lock(session.spatial_mutex);
+    syncSpatialIndex(session);
+    auto loader = spatialMeshLoader(client_id, session);
+    for (const Vec3& sample : samples) {
+        Vec3 origin, direction;
+        double length = 0.0;
+        if (!camera.sightLine(sample, origin, direction, length)) {
+            return false;
+        }
+        auto hits = session.spatial_index.rayPick(origin, direction, length, 1, false, loader);
+        if (hits.empty() || hits.front().shape_id == shape_id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GeometryServiceImpl::streamInViewOrder(const std::string& client_id, ClientSession& session,
+                                            std::vector<ShapeData> shapes, std::optional<ViewCamera> camera,
+                                            const std::function<bool(const ShapeData&)>& send) {
+    uint64_t camera_version = session.camera_version.load();
+    if (!camera) {
+        camera = session.currentCamera();
+    }
+    
+    std::deque<size_t> pending(shapes.size());
+    std::iota(pending.begin(), pending.end(), size_t{0});
+    std::vector<Aabb> boxes;
+    std::vector<size_t> occluded;  // In view but behind other shapes, sent after the rest in view
+    size_t in_view = 0;            // Leading entries of pending inside the view
+    
+    auto reorder = [&] {
+        if (boxes.empty()) {
+            boxes = spatialBounds(session, shapes);
+        }
+        pending.insert(pending.end(), occluded.begin(), occluded.end());
+        occluded.clear();
+        std::vector<Aabb> pending_boxes;
+        pending_boxes.reserve(pending.size());
+        for (size_t index : pending) {
+            pending_boxes.push_back(boxes[index]);
+        }
+        std::deque<size_t> reordered;
+        for (size_t position : camera->streamOrder(pending_boxes, in_view)) {
+            reordered.push_back(pending[position]);
+        }
+        pending.swap(reordered);
+    };
+    if (camera && shapes.size() > 1) {
+        reorder();
+    }
+    
+    size_t deferred = 0;
+    while (!pending.empty() || !occluded.empty()) {
+        // Camera updates arriving mid-stream reorder what is left
+        const uint64_t latest_version = session.camera_version.load();
+        if (latest_version != camera_version) {
+            camera_version = latest_version;
+            if (auto latest = session.currentCamera()) {
+                camera = std::move(latest);
+                reorder();
+            }
+        }
+        if (in_view == 0 && !occluded.empty()) {
+            pending.insert(pending.begin(), occluded.begin(), occluded.end());
+            occluded.clear();
+        }
+        
+        const size_t index = pending.front();
+        pending.pop_front();
+        if (in_view > 0) {
+            in_view--;
+            if (occludedInView(client_id, session, *camera, shapes[index].shape_id, boxes[index])) {
+                occluded.push_back(index);
+                deferred++;
+                continue;
+            }
+        }
+        if (!send(shapes[index])) {
+            return;
+        }
+    }
+    if (deferred > 0) {
+        spdlog::debug("[{}] Deferred {} occluded shapes behind the visible ones", client_id, deferred);
+    }
+}
+
 grpc::Status GeometryServiceImpl::ClearAll(grpc::ServerContext* context,
                                           const geometry::EmptyRequest* request,
                                           geometry::StatusResponse* response) {
@@ -557,8 +2238,14 @@ grpc::Status GeometryServiceImpl::ClearAll(grpc::ServerContext* context,
     auto session = getOrCreateSession(client_id);
     
     // Clear only this client's shapes
-    size_t shapes_cleared = session->shapes.size();
-    session->shapes.clear();
+    size_t shapes_cleared = 0;
+    {
+        std::lock_guard<std::mutex> lock(session->shapes_mutex);
+        shapes_cleared = session->shapes.size();
+        session->clearShapesLocked();
+    }
+    session->recordReset();
+    mesh_cache_.invalidateClient(client_id);
     
     response->set_success(true);
     response->set_message("Cleared " + std::to_string(shapes_cleared) + " shapes for this session");
@@ -646,58 +2333,317 @@ grpc::Status GeometryServiceImpl::CreateDemoScene(grpc::ServerContext* context,
     }
 }
 
-geometry::MeshData GeometryServiceImpl::extractMeshData(const std::string& shape_id) {
-    geometry::MeshData mesh_data;
-    mesh_data.set_shape_id(shape_id);
-    // mesh_data.set_version(1); // Field removed in simplified proto
+GeometryServiceImpl::MeshDeflection GeometryServiceImpl::resolveMeshDeflection(
+    const ShapeData& shape_data, const geometry::MeshOptions& options) {
+    MeshDeflection deflection;
+    deflection.linear = shape_data.default_deflection > 0.0 ? shape_data.default_deflection : kLinearDeflection;
+    deflection.angular = kAngularDeflection;
+    
+    if (options.linear_deflection() > 0.0 || options.relative_deflection() > 0.0) {
+        double diagonal = shapeDiagonal(shape_data.topo_shape);
+        double requested = options.linear_deflection() > 0.0 ? options.linear_deflection()
+                                                             : options.relative_deflection() * diagonal;
+        if (requested > 0.0) {
+            deflection.linear = clampDeflection(requested, diagonal);
+        }
+    }
+    if (options.angular_deflection() > 0.0) {
+        deflection.angular = std::clamp(options.angular_deflection(), kMinAngularDeflection, kMaxLodAngularDeflection);
+    }
+    return deflection;
+}
+
+std::shared_ptr<const geometry::MeshData> GeometryServiceImpl::getCachedMeshData(
+    const std::string& client_id, const ShapeData& shape_data, const geometry::MeshOptions& options) {
+    // Coarser levels derive from the LOD 0 deflections and the shape size,
+    // which the generation already pins down
+    MeshDeflection deflection = resolveMeshDeflection(shape_data, options);
+    MeshCacheKey key;
+    key.client_id = client_id;
+    key.shape_id = shape_data.shape_id;
+    key.generation = shape_data.generation;
+    key.linear_deflection = deflection.linear;
+    key.angular_deflection = deflection.angular;
+    key.lod = std::min(options.lod(), kMeshLodCount - 1);
+    key.encoding = options.encoding();
+    key.include_normals = !options.omit_normals();
+    
+    std::shared_ptr<const geometry::MeshData> prototype;
+    if (shape_data.isInstance()) {
+        prototype = getPrototypeMeshData(client_id, shape_data, options);
+        if (options.instancing()) {
+            return prototype;
+        }
+    }
+    
+    if (auto cached = mesh_cache_.find(key)) {
+        spdlog::debug("[{}] getCachedMeshData: Cache hit for shape {}", client_id, shape_data.shape_id);
+        return cached;
+    }
+    
+    if (prototype) {
+        // Placed copy of the shared tessellation, in model coordinates
+        auto placed = std::make_shared<geometry::MeshData>(
+            placeMesh(*prototype, shape_data.topo_shape.Location().Transformation()));
+        placed->set_shape_id(shape_data.shape_id);
+        placed->mutable_color()->CopyFrom(shape_data.color);
+        cacheMesh(key, placed);
+        return placed;
+    }
+    
+    // Full-quality meshes of unchanged imported shapes also live in the model disk cache
+    bool on_disk = false;
+    if (model_disk_cache_ && !shape_data.disk_cache_key.empty() &&
+        shape_data.disk_cache_generation == shape_data.generation && key.lod == 0) {
+        MeshDeflection shape_default = resolveMeshDeflection(shape_data, geometry::MeshOptions());
+        on_disk = deflection.linear == shape_default.linear && deflection.angular == shape_default.angular;
+    }
+    if (on_disk) {
+        auto mesh = newArenaMeshData(0);
+        if (model_disk_cache_->loadMesh(shape_data.disk_cache_key, shape_data.disk_cache_index,
+                                        key.encoding, key.include_normals, *mesh)) {
+            spdlog::debug("[{}] getCachedMeshData: Disk cache hit for shape {}", client_id, shape_data.shape_id);
+            mesh->set_shape_id(shape_data.shape_id);
+            cacheMesh(key, mesh);
+            return mesh;
+        }
+    }
+    
+    std::shared_ptr<const geometry::MeshData> mesh;
+    runGated(meshing_gate_, [&] { mesh = extractMeshData(shape_data, options, deflection); });
+    if (key.lod == 0) {
+        MeshDeflection shape_default = resolveMeshDeflection(shape_data, geometry::MeshOptions());
+        if (deflection.linear == shape_default.linear && deflection.angular == shape_default.angular) {
+            recordTriangulation(client_id, shape_data);
+        }
+    }
+    cacheMesh(key, mesh);
+    if (on_disk) {
+        model_disk_cache_->storeMesh(shape_data.disk_cache_key, shape_data.disk_cache_index,
+                                     key.encoding, key.include_normals, *mesh);
+    }
+    return mesh;
+}
+
+std::shared_ptr<const geometry::MeshData> GeometryServiceImpl::getPrototypeMeshData(
+    const std::string& client_id, const ShapeData& shape_data, const geometry::MeshOptions& options) {
+    // Instances are placed rigidly, so every one of them resolves the same deflections
+    MeshDeflection deflection = resolveMeshDeflection(shape_data, options);
+    MeshCacheKey key;
+    key.client_id = client_id;
+    key.shape_id = shape_data.prototype_id;
+    key.linear_deflection = deflection.linear;
+    key.angular_deflection = deflection.angular;
+    key.lod = std::min(options.lod(), kMeshLodCount - 1);
+    key.encoding = options.encoding();
+    key.include_normals = !options.omit_normals();
+    
+    if (auto cached = mesh_cache_.find(key)) {
+        return cached;
+    }
+    
+    ShapeData prototype = shape_data;
+    prototype.shape_id = shape_data.prototype_id;
+    prototype.topo_shape = shape_data.prototype_shape;
+    std::shared_ptr<geometry::MeshData> mesh;
+    runGated(meshing_gate_, [&] { mesh = extractMeshData(prototype, options, deflection); });
+    mesh->set_prototype_id(shape_data.prototype_id);
+    cacheMesh(key, mesh);
+    return mesh;
+}
+
+const geometry::MeshData& GeometryServiceImpl::shapeMeshMessage(const ShapeData& shape_data,
+                                                                const std::shared_ptr<const geometry::MeshData>& mesh,
+                                                                SentPrototypes* sent, geometry::MeshData& scratch) {
+    if (mesh->prototype_id().empty()) {
+        return *mesh;
+    }
+    
+    bool with_geometry = true;
+    if (sent) {
+        auto [it, inserted] = sent->try_emplace(mesh->prototype_id() + "@" + std::to_string(mesh->lod()), mesh);
+        with_geometry = inserted || it->second != mesh;
+        it->second = mesh;
+    }
+    if (with_geometry) {
+        scratch = *mesh;
+    } else {
+        scratch.Clear();
+        scratch.set_prototype_id(mesh->prototype_id());
+        scratch.set_lod(mesh->lod());
+        scratch.set_linear_deflection(mesh->linear_deflection());
+        scratch.set_angular_deflection(mesh->angular_deflection());
+    }
+    
+    const gp_Trsf placement = shape_data.topo_shape.Location().Transformation();
+    scratch.set_shape_id(shape_data.shape_id);
+    scratch.mutable_color()->CopyFrom(shape_data.color);
+    if (mesh->has_bounding_box()) {
+        placeBoundingBox(mesh->bounding_box(), placement, *scratch.mutable_bounding_box());
+    }
+    toProtoTransform(placement, *scratch.mutable_instance_transform());
+    return scratch;
+}
+
+std::vector<std::shared_ptr<const geometry::MeshData>> GeometryServiceImpl::getMeshesWithinBudget(
+    const std::string& client_id, const std::vector<ShapeData>& shapes,
+    const geometry::MeshOptions& options, uint64_t triangle_budget) {
+    std::vector<std::shared_ptr<const geometry::MeshData>> meshes;
+    std::vector<MeshDeflection> deflections;
+    std::vector<bool> reducible(shapes.size(), true);
+    meshes.reserve(shapes.size());
+    deflections.reserve(shapes.size());
+    for (const auto& shape_data : shapes) {
+        deflections.push_back(resolveMeshDeflection(shape_data, options));
+        meshes.push_back(getCachedMeshData(client_id, shape_data, options));
+    }
+    
+    uint64_t total = 0;
+    for (int pass = 0; pass < kTriangleBudgetPasses; ++pass) {
+        total = 0;
+        uint64_t fixed = 0;
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            uint64_t triangles = static_cast<uint64_t>(meshTriangleCount(*meshes[i]));
+            total += triangles;
+            if (!reducible[i]) {
+                fixed += triangles;
+            }
+        }
+        if (total <= triangle_budget || fixed == total) {
+            break;
+        }
+        
+        // Curved faces need roughly 1 / deflection triangles, so every shape that can
+        // still coarsen gets the same factor and keeps its share of the budget
+        double target = triangle_budget > fixed ? static_cast<double>(triangle_budget - fixed) : 1.0;
+        double scale = static_cast<double>(total - fixed) / target;
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            if (!reducible[i]) {
+                continue;
+            }
+            geometry::MeshOptions coarser_options = options;
+            coarser_options.clear_relative_deflection();
+            coarser_options.set_linear_deflection(deflections[i].linear * scale);
+            coarser_options.set_angular_deflection(
+                std::min(deflections[i].angular * std::sqrt(scale), kMaxLodAngularDeflection));
+            MeshDeflection coarser = resolveMeshDeflection(shapes[i], coarser_options);
+            
+            auto mesh = getCachedMeshData(client_id, shapes[i], coarser_options);
+            if (meshTriangleCount(*mesh) < meshTriangleCount(*meshes[i])) {
+                meshes[i] = std::move(mesh);
+                deflections[i] = coarser;
+            } else {
+                reducible[i] = false;  // Planar, or already at the coarsest allowed deflection
+            }
+        }
+    }
+    
+    // The last pass may have coarsened meshes after total was summed
+    total = 0;
+    for (const auto& mesh : meshes) {
+        total += static_cast<uint64_t>(meshTriangleCount(*mesh));
+    }
+    if (total > triangle_budget) {
+        spdlog::warn("[{}] getMeshesWithinBudget: {} triangles exceed the budget of {} at the coarsest quality",
+                     client_id, total, triangle_budget);
+    }
+    return meshes;
+}
+
+std::shared_ptr<geometry::MeshData> GeometryServiceImpl::extractMeshData(const ShapeData& shape_data,
+                                                                         const geometry::MeshOptions& options,
+                                                                         const MeshDeflection& deflection) {
+    STAGE_SPAN(extract_span, "ExtractMesh");
+    const std::string& shape_id = shape_data.shape_id;
+    const uint32_t lod = std::min(options.lod(), kMeshLodCount - 1);
     
-    // Thread-safe shape data lookup with copy
-    ShapeData shape_data_copy;
-    bool shape_found = false;
+    TopoDS_Shape shape = shape_data.topo_shape;
+    double linear_deflection = deflection.linear;
+    double angular_deflection = deflection.angular;
+    if (lod > 0) {
+        linear_deflection = lodLinearDeflection(deflection.linear, shapeDiagonal(shape), lod);
+        angular_deflection = lodAngularDeflection(deflection.angular, lod);
+    }
     
-    // First check deprecated global shapes_
-    auto it = shapes_.find(shape_id);
-    if (it != shapes_.end()) {
-        shape_data_copy = it->second;  // Make a copy
-        shape_found = true;
+    // Only the shape's default quality is stored on the shape itself; anything else is
+    // meshed on a topology copy so the shared triangulation is never replaced
+    MeshDeflection shape_default = resolveMeshDeflection(shape_data, geometry::MeshOptions());
+    std::unique_lock<std::mutex> in_place_lock;
+    if (lod > 0 || linear_deflection != shape_default.linear || angular_deflection != shape_default.angular) {
+        shape = BRepBuilderAPI_Copy(shape, Standard_False, Standard_False).Shape();
+        BRepTools::Clean(shape, Standard_True);
     } else {
-        // Search through all sessions with proper locking
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        for (const auto& [client_id, session] : client_sessions_) {
-            auto session_it = session->shapes.find(shape_id);
-            if (session_it != session->shapes.end()) {
-                shape_data_copy = session_it->second;  // Make a copy while holding lock
-                shape_found = true;
-                break;
-            }
-        }
-        // Lock automatically released here, but we have our own copy
+        // Held until the triangulations and their normals are complete
+        in_place_lock = std::unique_lock<std::mutex>(meshingMutexFor(shape));
     }
-    
-    if (!shape_found) {
-        spdlog::error("extractMeshData: Shape not found: {}", shape_id);
+    auto newMesh = [&](size_t arena_bytes) {
+        auto mesh_data = newArenaMeshData(arena_bytes);
+        mesh_data->set_shape_id(shape_id);
+        mesh_data->set_lod(lod);
+        mesh_data->set_linear_deflection(linear_deflection);
+        mesh_data->set_angular_deflection(angular_deflection);
+        mesh_data->mutable_color()->CopyFrom(shape_data.color);
         return mesh_data;
-    }
-    
-    // Now work with our thread-safe copy
-    const TopoDS_Shape& shape = shape_data_copy.topo_shape;
+    };
     
     // Generate mesh if not already done
-    BRepMesh_IncrementalMesh mesh(shape, 0.1, Standard_False, 0.5, Standard_True);
-    if (!mesh.IsDone()) {
+    bool meshed = false;
+    {
+        STAGE_SPAN(tessellate_span, "Tessellate");
+        BRepMesh_IncrementalMesh mesh(shape, linear_deflection, Standard_False, angular_deflection,
+                                      parallel_meshing_ ? Standard_True : Standard_False);
+        meshed = mesh.IsDone();
+    }
+    if (!meshed) {
         spdlog::error("extractMeshData: Failed to generate mesh for shape: {}", shape_id);
-        return mesh_data;
+        return newMesh(0);
     }
+    STAGE_SPAN(triangulation_span, "ExtractTriangulation");
     
-    std::vector<gp_Pnt> vertices;
-    std::vector<gp_Vec> normals;
-    std::vector<int> indices;
-    
-    // Extract triangulation from all faces
-    TopExp_Explorer face_explorer(shape, TopAbs_FACE);
-    int vertex_offset = 0;
+    // Collect per-face triangulations, then prefix-sum node and triangle counts
+    // so every face can write into its own slice of the preallocated buffers
+    struct FaceSlice {
+        TopoDS_Face face;
+        Handle(Poly_Triangulation) triangulation;
+        gp_Trsf transform;
+        bool reversed{false};
+        bool compute_normals{false};  // Set on the first face referencing a triangulation without normals
+        int vertex_start{0};
+        int triangle_start{0};
+    };
+    // Per worker thread and reused by every mesh it extracts. Faces are dropped
+    // after each call so no deleted shape's triangulation is kept alive, and
+    // buffers grown past the retention cap by one huge shape are given back.
+    struct Scratch {
+        std::vector<FaceSlice> faces;
+        std::unordered_set<const Poly_Triangulation*> pending_normals;
+        std::vector<gp_Pnt> vertices;
+        std::vector<gp_Vec> normals;
+        std::vector<int> indices;
+    };
+    struct ScratchRelease {
+        Scratch& scratch;
+        ~ScratchRelease() {
+            scratch.faces.clear();
+            scratch.pending_normals.clear();
+            if (scratch.vertices.capacity() > kMaxRetainedScratchVertices) {
+                scratch.vertices = {};
+                scratch.normals = {};
+            }
+            if (scratch.indices.capacity() > kMaxRetainedScratchVertices * 6) {
+                scratch.indices = {};
+            }
+        }
+    };
+    static thread_local Scratch scratch;
+    ScratchRelease release{scratch};
+    auto& faces = scratch.faces;
+    auto& pending_normals = scratch.pending_normals;
+    const bool include_normals = !options.omit_normals();
+    int total_vertices = 0;
+    int total_triangles = 0;
     
-    for (; face_explorer.More(); face_explorer.Next()) {
+    for (TopExp_Explorer face_explorer(shape, TopAbs_FACE); face_explorer.More(); face_explorer.Next()) {
         const TopoDS_Face& face = TopoDS::Face(face_explorer.Current());
         TopLoc_Location location;
         
@@ -706,74 +2652,140 @@ geometry::MeshData GeometryServiceImpl::extractMeshData(const std::string& shape
             continue;
         }
         
-        // Get node and triangle data using new API
-        int nb_nodes = triangulation->NbNodes();
-        int nb_triangles = triangulation->NbTriangles();
+        FaceSlice slice;
+        slice.face = face;
+        slice.triangulation = triangulation;
+        slice.transform = location.Transformation();
+        slice.reversed = (face.Orientation() == TopAbs_REVERSED);
+        slice.vertex_start = total_vertices;
+        slice.triangle_start = total_triangles;
+        // Instanced faces share one triangulation; compute its normals only once
+        slice.compute_normals = include_normals && !triangulation->HasNormals()
+                                && pending_normals.insert(triangulation.get()).second;
+        faces.push_back(slice);
         
-        // Transform vertices by location
-        gp_Trsf transform = location.Transformation();
+        total_vertices += triangulation->NbNodes();
+        total_triangles += triangulation->NbTriangles();
+    }
+    
+    // Every vertex and index is written below; normals stay zero for faces without any
+    auto& vertices = scratch.vertices;
+    auto& normals = scratch.normals;
+    auto& indices = scratch.indices;
+    vertices.resize(total_vertices);
+    normals.assign(include_normals ? total_vertices : 0, gp_Vec());
+    indices.resize(static_cast<size_t>(total_triangles) * 3);
+    
+    const bool run_parallel = parallel_meshing_ && faces.size() > 1;
+    
+    // Surface-evaluated normals, falling back to triangle normals for faces without a surface.
+    // Stored on the triangulation, so later requests and cache misses reuse them.
+    if (!pending_normals.empty()) {
+        OSD_Parallel::For(0, static_cast<int>(faces.size()), [&](int face_index) {
+            const FaceSlice& slice = faces[face_index];
+            if (slice.compute_normals) {
+                BRepLib_ToolTriangulatedShape::ComputeNormals(slice.face, slice.triangulation);
+            }
+        }, !run_parallel);
+    }
+    if (in_place_lock.owns_lock()) {
+        in_place_lock.unlock();  // Extraction below only reads the collected triangulations
+    }
+    
+    auto extractFace = [&](int face_index) {
+        const FaceSlice& slice = faces[face_index];
+        const Handle(Poly_Triangulation)& triangulation = slice.triangulation;
         
-        // Add vertices
-        int face_vertex_start = vertices.size();
+        // Transform vertices by location
+        const int nb_nodes = triangulation->NbNodes();
         for (int i = 1; i <= nb_nodes; i++) {
             gp_Pnt point = triangulation->Node(i);
-            point.Transform(transform);
-            vertices.push_back(point);
+            point.Transform(slice.transform);
+            vertices[slice.vertex_start + i - 1] = point;
         }
         
-        // Add triangles (convert to indices)
-        Standard_Boolean reverse_orientation = (face.Orientation() == TopAbs_REVERSED);
-        
+        // Convert to 0-based indexing and add vertex offset
+        const int nb_triangles = triangulation->NbTriangles();
+        int* out = indices.data() + static_cast<size_t>(slice.triangle_start) * 3;
         for (int i = 1; i <= nb_triangles; i++) {
-            const Poly_Triangle& triangle = triangulation->Triangle(i);
             Standard_Integer n1, n2, n3;
-            triangle.Get(n1, n2, n3);
-            
-            // Convert to 0-based indexing and add vertex offset
-            int idx1 = face_vertex_start + (n1 - 1);
-            int idx2 = face_vertex_start + (n2 - 1);
-            int idx3 = face_vertex_start + (n3 - 1);
+            triangulation->Triangle(i).Get(n1, n2, n3);
             
-            if (reverse_orientation) {
-                indices.push_back(idx1);
-                indices.push_back(idx3);
-                indices.push_back(idx2);
-            } else {
-                indices.push_back(idx1);
-                indices.push_back(idx2);
-                indices.push_back(idx3);
-            }
+            *out++ = slice.vertex_start + (n1 - 1);
+            *out++ = slice.vertex_start + (slice.reversed ? n3 : n2) - 1;
+            *out++ = slice.vertex_start + (slice.reversed ? n2 : n3) - 1;
         }
         
-        // Calculate normals for this face (simplified approach)
-        gp_Vec face_normal(0, 0, 1); // Placeholder - should calculate actual normal
-        for (int i = face_vertex_start; i < vertices.size(); i++) {
-            normals.push_back(face_normal);
+        // Normals follow the face location and orientation
+        if (include_normals && triangulation->HasNormals()) {
+            for (int i = 1; i <= nb_nodes; i++) {
+                gp_Dir normal = triangulation->Normal(i);
+                normal.Transform(slice.transform);
+                if (slice.reversed) {
+                    normal.Reverse();
+                }
+                normals[slice.vertex_start + i - 1] = gp_Vec(normal);
+            }
         }
-    }
-    
-    // Convert to protobuf format
-    for (const gp_Pnt& vertex : vertices) {
-        geometry::Point3D* proto_vertex = mesh_data.add_vertices();
-        proto_vertex->set_x(vertex.X());
-        proto_vertex->set_y(vertex.Y());
-        proto_vertex->set_z(vertex.Z());
-    }
+    };
     
-    for (const gp_Vec& normal : normals) {
-        geometry::Vector3D* proto_normal = mesh_data.add_normals();
-        proto_normal->set_x(normal.X());
-        proto_normal->set_y(normal.Y());
-        proto_normal->set_z(normal.Z());
-    }
+    OSD_Parallel::For(0, static_cast<int>(faces.size()), extractFace, !run_parallel);
     
-    for (int index : indices) {
-        mesh_data.add_indices(index);
+    // Convert to protobuf format
+    const bool packed_encoding = options.encoding() == geometry::MESH_ENCODING_PACKED_FLOAT32 ||
+                                 options.encoding() == geometry::MESH_ENCODING_PACKED_FLOAT64 ||
+                                 options.encoding() == geometry::MESH_ENCODING_QUANTIZED;
+    auto mesh = newMesh(packed_encoding ? 0 : legacyMeshArenaBytes(vertices.size(), normals.size(), indices.size()));
+    geometry::MeshData& mesh_data = *mesh;
+    switch (options.encoding()) {
+        case geometry::MESH_ENCODING_PACKED_FLOAT32:
+        case geometry::MESH_ENCODING_PACKED_FLOAT64: {
+            geometry::PackedMeshBuffers* packed = mesh_data.mutable_packed();
+            packed->set_encoding(options.encoding());
+            packed->set_vertex_count(static_cast<uint32_t>(vertices.size()));
+            packed->set_triangle_count(static_cast<uint32_t>(indices.size() / 3));
+            if (options.encoding() == geometry::MESH_ENCODING_PACKED_FLOAT32) {
+                packVec3<float>(vertices, *packed->mutable_positions());
+                packVec3<float>(normals, *packed->mutable_normals());
+            } else {
+                packVec3<double>(vertices, *packed->mutable_positions());
+                packVec3<double>(normals, *packed->mutable_normals());
+            }
+            packIndices(indices, *packed->mutable_indices());
+            break;
+        }
+        case geometry::MESH_ENCODING_QUANTIZED: {
+            geometry::PackedMeshBuffers* packed = mesh_data.mutable_packed();
+            packed->set_encoding(options.encoding());
+            packed->set_vertex_count(static_cast<uint32_t>(vertices.size()));
+            packed->set_triangle_count(static_cast<uint32_t>(indices.size() / 3));
+            packQuantizedVertices(toFloats(vertices), toFloats(normals), *packed);
+            MeshCodec::EncodeIndices(reinterpret_cast<const uint32_t*>(indices.data()), indices.size(),
+                                     *packed->mutable_indices());
+            break;
+        }
+        default: {
+            mesh_data.mutable_vertices()->Reserve(static_cast<int>(vertices.size()));
+            for (const gp_Pnt& vertex : vertices) {
+                geometry::Point3D* proto_vertex = mesh_data.add_vertices();
+                proto_vertex->set_x(vertex.X());
+                proto_vertex->set_y(vertex.Y());
+                proto_vertex->set_z(vertex.Z());
+            }
+            
+            mesh_data.mutable_normals()->Reserve(static_cast<int>(normals.size()));
+            for (const gp_Vec& normal : normals) {
+                geometry::Vector3D* proto_normal = mesh_data.add_normals();
+                proto_normal->set_x(normal.X());
+                proto_normal->set_y(normal.Y());
+                proto_normal->set_z(normal.Z());
+            }
+            
+            mesh_data.mutable_indices()->Add(indices.begin(), indices.end());
+            break;
+        }
     }
     
-    // Set color from our thread-safe copy
-    mesh_data.mutable_color()->CopyFrom(shape_data_copy.color);
-    
     // Calculate bounding box (simplified)
     if (!vertices.empty()) {
         gp_Pnt min_pt = vertices[0];
@@ -793,38 +2805,26 @@ geometry::MeshData GeometryServiceImpl::extractMeshData(const std::string& shape
         bounding_box->mutable_max()->CopyFrom(toProtoPoint(max_pt));
     }
     
-    spdlog::info("extractMeshData: Generated mesh for {}: {} vertices, {} triangles", 
-                shape_id, vertices.size(), indices.size() / 3);
+    spdlog::info("extractMeshData: Generated mesh for {} (LOD {}, deflection {}): {} vertices, {} triangles", 
+                shape_id, lod, linear_deflection, vertices.size(), indices.size() / 3);
     
-    return mesh_data;
+    return mesh;
 }
 
 
-Handle(AIS_Shape) GeometryServiceImpl::createSphereShape(const geometry::SphereRequest& request) {
+TopoDS_Shape GeometryServiceImpl::createSphereShape(const geometry::SphereRequest& request) {
     gp_Pnt center = fromProtoPoint(request.center());
     
     TopoDS_Shape sphere = BRepPrimAPI_MakeSphere(center, request.radius()).Shape();
-    Handle(AIS_Shape) ais_shape = new AIS_Shape(sphere);
-    
-    // Set color
-    Quantity_Color occt_color = fromProtoColor(request.color());
-    ais_shape->SetColor(occt_color);
-    
-    return ais_shape;
+    return sphere;
 }
 
-Handle(AIS_Shape) GeometryServiceImpl::createCylinderShape(const geometry::CylinderRequest& request) {
+TopoDS_Shape GeometryServiceImpl::createCylinderShape(const geometry::CylinderRequest& request) {
     gp_Pnt position = fromProtoPoint(request.position());
     gp_Ax2 axes(position, gp::DZ());  // Default axis along Z-direction
     
     TopoDS_Shape cylinder = BRepPrimAPI_MakeCylinder(axes, request.radius(), request.height()).Shape();
-    Handle(AIS_Shape) ais_shape = new AIS_Shape(cylinder);
-    
-    // Set color
-    Quantity_Color occt_color = fromProtoColor(request.color());
-    ais_shape->SetColor(occt_color);
-    
-    return ais_shape;
+    return cylinder;
 }
 
 // =============================================================================
@@ -834,133 +2834,629 @@ Handle(AIS_Shape) GeometryServiceImpl::createCylinderShape(const geometry::Cylin
 grpc::Status GeometryServiceImpl::ImportModelFile(grpc::ServerContext* context,
                                                  const geometry::ModelFileRequest* request,
                                                  geometry::ModelImportResponse* response) {
-    std::string client_id = getClientId(context);
+    return handleImportModelFile(getClientId(context), request, response);
+}
+
+grpc::Status GeometryServiceImpl::handleImportModelFile(const std::string& client_id,
+                                                       const geometry::ModelFileRequest* request,
+                                                       geometry::ModelImportResponse* response) {
+    STAGE_SPAN(rpc_span, "ImportModelFile");
     spdlog::info("[{}] ImportModelFile: Importing file: {}", client_id, request->file_path());
     
     // Get or create session for this client
     auto session = getOrCreateSession(client_id);
     
     try {
-        // Import with proper exception safety
-        std::vector<std::string> shape_ids = importModelFileInternal(
-            request->file_path(), request->options());
-        
-        // Move shapes from global to session with rollback capability
-        std::vector<std::string> session_shape_ids;
-        std::vector<std::pair<std::string, ShapeData>> backup_shapes;
-        
-        try {
-            for (const auto& shape_id : shape_ids) {
-                auto it = shapes_.find(shape_id);
-                if (it != shapes_.end()) {
-                    // Generate new session-specific ID
-                    std::string new_shape_id = session->generateShapeId();
-                    
-                    // Back up the original shape for rollback
-                    backup_shapes.emplace_back(shape_id, it->second);
-                    
-                    // Move to session
-                    ShapeData shape_data = std::move(it->second);
-                    shape_data.shape_id = new_shape_id;
-                    session->shapes[new_shape_id] = std::move(shape_data);
-                    shapes_.erase(it);
-                    
-                    session_shape_ids.push_back(new_shape_id);
-                }
-            }
-            shape_ids = std::move(session_shape_ids);  // Use session IDs
-        } catch (...) {
-            // Rollback: restore backed up shapes
-            for (const auto& [orig_id, shape_data] : backup_shapes) {
-                shapes_[orig_id] = shape_data;
-            }
-            // Remove any partially added shapes from session
-            for (const auto& session_id : session_shape_ids) {
-                session->shapes.erase(session_id);
+        // Import with proper exception safety
+        std::vector<std::string> shape_ids = importModelIntoSession(*session, request->file_path(), request->options());
+        size_t session_shape_count = session->shapeCount();
+        
+        response->set_success(true);
+        response->set_message("Model file imported successfully");
+        
+        for (const auto& shape_id : shape_ids) {
+            response->add_shape_ids(shape_id);
+        }
+        
+        // Detect format and set file info
+        std::string detected_format = detectFileFormat(request->file_path(), request->options().force_format());
+        response->set_detected_format(detected_format);
+        
+        geometry::ModelFileInfo file_info = getModelFileInfo(
+            request->file_path(), "", shape_ids.size(), detected_format);
+        response->mutable_file_info()->CopyFrom(file_info);
+        
+        spdlog::info("[{}] ImportModelFile: Successfully imported {} shapes from {} (format: {}, session has {} total shapes)", 
+                    client_id, shape_ids.size(), request->file_path(), detected_format, session_shape_count);
+        
+    } catch (const std::exception& e) {
+        response->set_success(false);
+        response->set_message(std::string("Failed to import model file: ") + e.what());
+        spdlog::error("ImportModelFile: Exception: {}", e.what());
+    }
+    
+    return grpc::Status::OK;
+}
+
+
+grpc::Status GeometryServiceImpl::ImportModelFiles(grpc::ServerContext* context,
+                                                  const geometry::ImportModelFilesRequest* request,
+                                                  geometry::ImportModelFilesResponse* response) {
+    std::string client_id = getClientId(context);
+    spdlog::info("[{}] ImportModelFiles: Importing {} files", client_id, request->file_paths_size());
+    
+    BulkImport bulk(*request);
+    size_t readers = std::min(static_cast<size_t>(request->file_paths_size()), max_concurrent_imports_);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < readers; ++i) {
+        threads.emplace_back([this, &bulk, context] {
+            while (importNextBulkFile(bulk, context->IsCancelled())) {}
+        });
+    }
+    while (importNextBulkFile(bulk, context->IsCancelled())) {}
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return finishBulkImport(client_id, bulk, response, context->IsCancelled());
+}
+
+GeometryServiceImpl::BulkImport::BulkImport(const geometry::ImportModelFilesRequest& request)
+    : request(request)
+    , results(request.file_paths_size())
+    , staged_ids(request.file_paths_size()) {
+    initDataExchangeControllers();
+}
+
+bool GeometryServiceImpl::importNextBulkFile(BulkImport& bulk, bool cancelled) {
+    size_t index = bulk.next_file.fetch_add(1);
+    if (index >= bulk.results.size()) {
+        return false;
+    }
+    
+    const std::string& file_path = bulk.request.file_paths(static_cast<int>(index));
+    geometry::FileImportResult& result = bulk.results[index];
+    result.set_file_path(file_path);
+    if (cancelled) {
+        result.set_message("Import cancelled");
+        return true;
+    }
+    
+    STAGE_SPAN(file_span, "ImportBulkFile");
+    auto start = std::chrono::steady_clock::now();
+    try {
+        const geometry::ModelImportOptions& options = bulk.request.options();
+        result.set_detected_format(detectFileFormat(file_path, options.force_format()));
+        bulk.staged_ids[index] = importModelFileInternal(file_path, options);
+        result.set_success(true);
+        result.set_message("Model file imported successfully");
+    } catch (const std::exception& e) {
+        result.set_message(std::string("Failed to import model file: ") + e.what());
+        spdlog::warn("importNextBulkFile: Failed to import {}: {}", file_path, e.what());
+    }
+    result.set_import_time_ms(
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    return true;
+}
+
+grpc::Status GeometryServiceImpl::finishBulkImport(const std::string& client_id, BulkImport& bulk,
+                                                   geometry::ImportModelFilesResponse* response, bool cancelled) {
+    std::vector<std::string> staged;
+    for (const auto& ids : bulk.staged_ids) {
+        staged.insert(staged.end(), ids.begin(), ids.end());
+    }
+    if (cancelled) {
+        discardStagedShapes(staged);
+        spdlog::info("[{}] ImportModelFiles: Cancelled, discarded {} staged shapes", client_id, staged.size());
+        return grpc::Status(grpc::StatusCode::CANCELLED, "Import cancelled");
+    }
+    
+    // One adoption for all files keeps the session lock and change log traffic to a single pass
+    auto session = getOrCreateSession(client_id);
+    std::vector<std::string> session_ids;
+    try {
+        session_ids = adoptStagedShapes(*session, staged, bulk.request.options().precision());
+    } catch (const std::runtime_error& e) {
+        // Over the memory quota: none of the files is imported
+        for (auto& result : bulk.results) {
+            if (result.success()) {
+                result.set_success(false);
+                result.set_message(e.what());
+            }
+            *response->add_results() = std::move(result);
+        }
+        response->set_success(false);
+        response->set_message(e.what());
+        spdlog::warn("[{}] ImportModelFiles: {}", client_id, e.what());
+        return grpc::Status::OK;
+    }
+    
+    size_t next_id = 0;
+    uint32_t imported_files = 0;
+    for (size_t i = 0; i < bulk.results.size(); ++i) {
+        geometry::FileImportResult& result = bulk.results[i];
+        for (size_t n = 0; n < bulk.staged_ids[i].size() && next_id < session_ids.size(); ++n) {
+            result.add_shape_ids(session_ids[next_id++]);
+        }
+        if (result.success()) {
+            ++imported_files;
+        }
+        *response->add_results() = std::move(result);
+    }
+    
+    response->set_success(imported_files == bulk.results.size());
+    response->set_imported_files(imported_files);
+    response->set_shape_count(static_cast<uint32_t>(session_ids.size()));
+    response->set_message("Imported " + std::to_string(imported_files) + " of " +
+                          std::to_string(bulk.results.size()) + " files");
+    spdlog::info("[{}] ImportModelFiles: Imported {} of {} files, {} shapes (session has {} total shapes)",
+                client_id, imported_files, bulk.results.size(), session_ids.size(), session->shapeCount());
+    return grpc::Status::OK;
+}
+
+void GeometryServiceImpl::discardStagedShapes(const std::vector<std::string>& staged_ids) {
+    std::lock_guard<std::mutex> lock(staging_mutex_);
+    for (const auto& shape_id : staged_ids) {
+        shapes_.erase(shape_id);
+    }
+}
+
+std::vector<std::string> GeometryServiceImpl::adoptStagedShapes(ClientSession& session,
+                                                               const std::vector<std::string>& staged_ids,
+                                                               double precision, TopTools_MapOfShape* counted) {
+    // Move shapes from the staging area to the session
+    std::vector<std::pair<std::string, ShapeData>> imported;
+    {
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        for (const auto& shape_id : staged_ids) {
+            auto it = shapes_.find(shape_id);
+            if (it != shapes_.end()) {
+                imported.emplace_back(session.generateShapeId(), std::move(it->second));
+                shapes_.erase(it);
+            }
+        }
+    }
+    
+    // The import precision becomes the default deflection of each shape
+    if (precision > 0.0) {
+        for (auto& imported_shape : imported) {
+            ShapeData& shape_data = imported_shape.second;
+            shape_data.default_deflection = clampDeflection(precision, shapeDiagonal(shape_data.topo_shape));
+        }
+    }
+    
+    // Repeated parts are counted on their first shape only
+    TopTools_MapOfShape local_counted;
+    for (auto& imported_shape : imported) {
+        measureShape(imported_shape.second, counted ? counted : &local_counted);
+    }
+    std::vector<std::string> session_ids;
+    for (auto& [session_id, shape_data] : imported) {
+        shape_data.shape_id = session_id;
+        session_ids.push_back(session_id);
+    }
+    std::string memory_error = addShapesWithinLimits(session, std::move(imported));
+    if (!memory_error.empty()) {
+        throw std::runtime_error(memory_error);
+    }
+    for (const auto& shape_id : session_ids) {
+        session.recordChange(shape_id, geometry::SCENE_CHANGE_ADDED);
+    }
+    enforceMemoryLimits(session.client_id);
+    return session_ids;
+}
+
+grpc::Status GeometryServiceImpl::ExportModelFile(grpc::ServerContext* context,
+                                                 const geometry::ModelExportRequest* request,
+                                                 geometry::ModelFileResponse* response) {
+    return handleExportModelFile(getClientId(context), request, response);
+}
+
+grpc::Status GeometryServiceImpl::handleExportModelFile(const std::string& client_id,
+                                                       const geometry::ModelExportRequest* request,
+                                                       geometry::ModelFileResponse* response) {
+    STAGE_SPAN(rpc_span, "ExportModelFile");
+    auto session = getOrCreateSession(client_id);
+    
+    spdlog::info("[{}] ExportModelFile: Exporting {} shapes to format: {}", client_id, 
+                request->shape_ids_size(), request->options().format());
+    
+    try {
+        std::string model_data;
+        geometry::ModelFileInfo file_info;
+        
+        // Collect the session shapes to export; unknown IDs are skipped
+        std::vector<TopoDS_Shape> shapes_to_export;
+        for (const auto& shape_id : request->shape_ids()) {
+            if (auto shape_data = session->findShape(shape_id)) {
+                shapes_to_export.push_back(shape_data->topo_shape);
+            }
+        }
+        
+        bool success = exportModelFileInternal(shapes_to_export, request->options(), model_data, file_info);
+        
+        if (success) {
+            response->set_success(true);
+            response->set_message("Model file exported successfully");
+            response->set_model_data(model_data);
+            response->set_filename(file_info.filename());
+            response->mutable_file_info()->CopyFrom(file_info);
+            
+            spdlog::info("[{}] ExportModelFile: Successfully exported {} shapes to {} format, size: {} bytes", client_id, 
+                        shapes_to_export.size(), request->options().format(), model_data.size());
+        } else {
+            response->set_success(false);
+            response->set_message("Failed to export model file");
+        }
+        
+    } catch (const std::exception& e) {
+        response->set_success(false);
+        response->set_message(std::string("Failed to export model file: ") + e.what());
+        spdlog::error("ExportModelFile: Exception: {}", e.what());
+    }
+    
+    return grpc::Status::OK;
+}
+
+// =============================================================================
+// Chunked model transfer
+// =============================================================================
+
+namespace {
+
+constexpr uint32_t kDefaultTransferChunkSize = 1u << 20;
+constexpr uint32_t kMinTransferChunkSize = 4u << 10;
+constexpr uint32_t kMaxTransferChunkSize = 3u << 20;  // Stays below the default 4 MiB message limit
+constexpr uint64_t kMaxInMemoryUploadSize = 64u << 20;  // Larger or unsized uploads are spooled
+
+} // namespace
+
+std::string GeometryServiceImpl::generateTransferId() {
+    static std::atomic<uint64_t> transfer_counter{1};
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::stringstream ss;
+    ss << "transfer_" << std::hex << now << "_" << transfer_counter.fetch_add(1);
+    return ss.str();
+}
+
+grpc::Status GeometryServiceImpl::UploadModel(grpc::ServerContext* context,
+                                             grpc::ServerReader<geometry::ModelChunk>* reader,
+                                             geometry::UploadModelResponse* response) {
+    STAGE_SPAN(rpc_span, "UploadModel");
+    std::string client_id = getClientId(context);
+    auto session = getOrCreateSession(client_id);
+    
+    std::shared_ptr<PendingUpload> upload;
+    try {
+        receiveUpload(*session, reader, response, upload);
+    } catch (const std::exception& e) {
+        response->set_success(false);
+        response->set_message(std::string("Failed to upload model: ") + e.what());
+        spdlog::error("UploadModel: Exception: {}", e.what());
+    }
+    
+    if (upload) {
+        // Release the transfer so a later stream can resume it
+        std::lock_guard<std::mutex> lock(session->transfers_mutex);
+        upload->active = false;
+        response->set_transfer_id(upload->transfer_id);
+        response->set_committed_offset(upload->committed);
+    }
+    
+    spdlog::info("[{}] UploadModel: success={} complete={} committed={} bytes{}", client_id, response->success(),
+                response->complete(), response->committed_offset(),
+                response->success() ? "" : " (" + response->message() + ")");
+    return grpc::Status::OK;
+}
+
+std::shared_ptr<GeometryServiceImpl::PendingUpload> GeometryServiceImpl::beginUpload(
+    ClientSession& session, const geometry::ModelChunk& header, std::string& error) {
+    
+    // A new transfer is set up, and its buffer reserved, before taking transfers_mutex
+    std::shared_ptr<PendingUpload> upload;
+    if (header.transfer_id().empty()) {
+        if (header.filename().empty()) {
+            error = "First chunk of an upload must carry the filename";
+            return nullptr;
+        }
+        upload = std::make_shared<PendingUpload>(std::filesystem::path(header.filename()).filename().string());
+        upload->transfer_id = generateTransferId();
+        upload->options = header.import_options();
+        upload->total_size = header.total_size();
+        const std::string format = detectFileFormat(upload->filename, upload->options.force_format());
+        if (hasStreamReader(format) && upload->total_size > 0 && upload->total_size <= kMaxInMemoryUploadSize) {
+            {
+                std::lock_guard<std::mutex> lock(session.shapes_mutex);
+                error = reserveShapeMemory(session, upload->total_size);
+                if (!error.empty()) {
+                    return nullptr;
+                }
+                session.upload_bytes.fetch_add(upload->total_size, std::memory_order_relaxed);
+            }
+            upload->reserveBuffer(shape_bytes_, session.upload_bytes, upload->total_size);
+            upload->buffer.reserve(static_cast<size_t>(upload->total_size));
+        } else {
+            upload->spool.emplace(upload->filename);
+            upload->out.open(upload->spool->path(), std::ios::binary | std::ios::trunc);
+            if (!upload->out) {
+                error = "Cannot create spool file for " + header.filename();
+                return nullptr;
+            }
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(session.transfers_mutex);
+    
+    // Resume an existing transfer
+    if (!upload) {
+        auto it = session.uploads.find(header.transfer_id());
+        if (it == session.uploads.end()) {
+            error = "Unknown or expired transfer id: " + header.transfer_id();
+            return nullptr;
+        }
+        if (it->second->active) {
+            error = "Transfer " + header.transfer_id() + " is already being uploaded";
+            return nullptr;
+        }
+        it->second->active = true;
+        return it->second;
+    }
+    
+    // Make room by dropping the least recently written idle upload
+    while (session.uploads.size() >= ClientSession::kMaxPendingUploads) {
+        auto oldest = session.uploads.end();
+        for (auto it = session.uploads.begin(); it != session.uploads.end(); ++it) {
+            if (!it->second->active && (oldest == session.uploads.end() ||
+                                        it->second->last_write < oldest->second->last_write)) {
+                oldest = it;
+            }
+        }
+        if (oldest == session.uploads.end()) {
+            error = "Too many concurrent uploads for this client";
+            return nullptr;  // Gives the reservation back
+        }
+        spdlog::info("UploadModel: Dropping stale upload {} ({} bytes)", oldest->first, oldest->second->committed);
+        session.uploads.erase(oldest);
+    }
+    
+    upload->active = true;
+    session.uploads[upload->transfer_id] = upload;
+    return upload;
+}
+
+void GeometryServiceImpl::receiveUpload(ClientSession& session, grpc::ServerReader<geometry::ModelChunk>* reader,
+                                        geometry::UploadModelResponse* response,
+                                        std::shared_ptr<PendingUpload>& upload) {
+    using occt_imgui::common::Utils;
+    
+    geometry::ModelChunk chunk;
+    uint32_t expected_crc = 0;
+    response->set_success(true);
+    
+    while (reader->Read(&chunk)) {
+        session.updateActivity();
+        
+        if (!upload) {
+            std::string error;
+            upload = beginUpload(session, chunk, error);
+            if (!upload) {
+                response->set_success(false);
+                response->set_message(error);
+                return;
+            }
+        } else if (!chunk.transfer_id().empty() && chunk.transfer_id() != upload->transfer_id) {
+            response->set_success(false);
+            response->set_message("Chunk belongs to a different transfer: " + chunk.transfer_id());
+            return;
+        }
+        
+        if (chunk.file_crc32() != 0) {
+            expected_crc = chunk.file_crc32();
+        }
+        
+        const std::string& data = chunk.data();
+        if (!data.empty()) {
+            if (Utils::Crc32(data.data(), data.size()) != chunk.crc32()) {
+                response->set_success(false);
+                response->set_message("CRC mismatch in chunk at offset " + std::to_string(chunk.offset()));
+                return;
+            }
+            if (chunk.offset() > upload->committed) {
+                response->set_success(false);
+                response->set_message("Chunk at offset " + std::to_string(chunk.offset()) +
+                                      " leaves a gap after committed offset " + std::to_string(upload->committed));
+                return;
+            }
+            
+            // Chunks overlapping the committed range are resent after a resume; keep only the new bytes
+            uint64_t skip = upload->committed - chunk.offset();
+            if (skip < data.size()) {
+                const char* fresh = data.data() + skip;
+                size_t fresh_size = data.size() - static_cast<size_t>(skip);
+                if (upload->total_size > 0 && upload->committed + fresh_size > upload->total_size) {
+                    response->set_success(false);
+                    response->set_message("Upload exceeds the announced size of " +
+                                          std::to_string(upload->total_size) + " bytes");
+                    return;
+                }
+                if (upload->spool) {
+                    upload->out.write(fresh, static_cast<std::streamsize>(fresh_size));
+                    upload->out.flush();
+                    if (!upload->out) {
+                        throw std::runtime_error("Failed to write spool file");
+                    }
+                } else {
+                    upload->buffer.append(fresh, fresh_size);
+                }
+                upload->crc = Utils::Crc32(fresh, fresh_size, upload->crc);
+                upload->committed += fresh_size;
+                upload->last_write = std::chrono::steady_clock::now();
+            }
+        }
+        
+        if (chunk.last()) {
+            finishUpload(session, *upload, expected_crc, response);
+            return;
+        }
+    }
+}
+
+void GeometryServiceImpl::finishUpload(ClientSession& session, PendingUpload& upload, uint32_t expected_crc,
+                                       geometry::UploadModelResponse* response) {
+    if (upload.total_size > 0 && upload.committed != upload.total_size) {
+        // Keep the transfer so the client can resend from the committed offset
+        response->set_success(false);
+        response->set_message("Upload incomplete: received " + std::to_string(upload.committed) + " of " +
+                              std::to_string(upload.total_size) + " bytes");
+        return;
+    }
+    if (expected_crc != 0 && expected_crc != upload.crc) {
+        // The committed bytes themselves are wrong, so the transfer cannot be resumed
+        response->set_success(false);
+        response->set_message("File CRC mismatch, upload discarded");
+        std::lock_guard<std::mutex> lock(session.transfers_mutex);
+        session.uploads.erase(upload.transfer_id);
+        return;
+    }
+    if (upload.spool) {
+        upload.out.close();
+    }
+    // The imported shapes reserve their own memory in place of the buffer's
+    upload.releaseBuffer();
+    
+    auto* result = response->mutable_import_result();
+    try {
+        std::string format = detectFileFormat(upload.filename, upload.options.force_format());
+        if (format == "UNKNOWN") {
+            std::string head;
+            if (upload.spool) {
+                std::ifstream in(upload.spool->path(), std::ios::binary);
+                head.resize(4096);
+                in.read(head.data(), static_cast<std::streamsize>(head.size()));
+                head.resize(static_cast<size_t>(in.gcount()));
+            } else {
+                head = upload.buffer.substr(0, 4096);
             }
-            throw;  // Re-throw original exception
+            format = detectFormatFromContent(head);
         }
         
-        response->set_success(true);
-        response->set_message("Model file imported successfully");
+        geometry::ModelImportOptions options = upload.options;
+        options.set_force_format(format);
+        std::vector<std::string> shape_ids;
+        runGated(import_gate_, [&] {
+            shape_ids = upload.spool ? importModelIntoSession(session, upload.spool->path(), options)
+                                     : importModelDataIntoSession(session, upload.buffer, upload.filename, options);
+        });
         
+        result->set_success(true);
+        result->set_message("Model file imported successfully");
         for (const auto& shape_id : shape_ids) {
-            response->add_shape_ids(shape_id);
+            result->add_shape_ids(shape_id);
         }
+        result->set_detected_format(format);
+        geometry::ModelFileInfo file_info = getModelFileInfo(upload.filename, "", shape_ids.size(), format);
+        file_info.set_file_size(upload.committed);
+        result->mutable_file_info()->CopyFrom(file_info);
         
-        // Detect format and set file info
-        std::string detected_format = detectFileFormat(request->file_path(), request->options().force_format());
-        response->set_detected_format(detected_format);
-        
-        geometry::ModelFileInfo file_info = getModelFileInfo(
-            request->file_path(), "", shape_ids.size(), detected_format);
-        response->mutable_file_info()->CopyFrom(file_info);
-        
-        spdlog::info("[{}] ImportModelFile: Successfully imported {} shapes from {} (format: {}, session has {} total shapes)", 
-                    client_id, shape_ids.size(), request->file_path(), detected_format, session->shapes.size());
-        
+        response->set_success(true);
+        response->set_message("Model uploaded and imported successfully");
     } catch (const std::exception& e) {
+        result->set_success(false);
+        result->set_message(std::string("Failed to import model file: ") + e.what());
         response->set_success(false);
-        response->set_message(std::string("Failed to import model file: ") + e.what());
-        spdlog::error("ImportModelFile: Exception: {}", e.what());
+        response->set_message(result->message());
     }
+    response->set_complete(true);
     
-    return grpc::Status::OK;
+    // The buffer or spool file is released once the last reference goes away
+    std::lock_guard<std::mutex> lock(session.transfers_mutex);
+    session.uploads.erase(upload.transfer_id);
 }
 
-
-grpc::Status GeometryServiceImpl::ExportModelFile(grpc::ServerContext* context,
-                                                 const geometry::ModelExportRequest* request,
-                                                 geometry::ModelFileResponse* response) {
+grpc::Status GeometryServiceImpl::DownloadModel(grpc::ServerContext* context,
+                                               const geometry::DownloadModelRequest* request,
+                                               grpc::ServerWriter<geometry::ModelChunk>* writer) {
+    STAGE_SPAN(rpc_span, "DownloadModel");
+    using occt_imgui::common::Utils;
+    
     std::string client_id = getClientId(context);
     auto session = getOrCreateSession(client_id);
     
-    spdlog::info("[{}] ExportModelFile: Exporting {} shapes to format: {}", client_id, 
-                request->shape_ids_size(), request->options().format());
+    uint32_t chunk_size = request->chunk_size() ? request->chunk_size() : kDefaultTransferChunkSize;
+    chunk_size = std::clamp(chunk_size, kMinTransferChunkSize, kMaxTransferChunkSize);
     
     try {
-        std::vector<std::string> shape_ids(request->shape_ids().begin(), request->shape_ids().end());
-        std::string model_data;
-        geometry::ModelFileInfo file_info;
-        
-        // Temporarily copy session shapes to global shapes_ for export
-        std::vector<std::string> temp_added;
-        for (const auto& shape_id : shape_ids) {
-            auto it = session->shapes.find(shape_id);
-            if (it != session->shapes.end() && shapes_.find(shape_id) == shapes_.end()) {
-                shapes_[shape_id] = it->second;
-                temp_added.push_back(shape_id);
+        CompletedExport transfer;
+        if (!request->transfer_id().empty()) {
+            // Resume: serve the exact bytes of the earlier export
+            std::lock_guard<std::mutex> lock(session->transfers_mutex);
+            if (!session->last_export || session->last_export->transfer_id != request->transfer_id()) {
+                return grpc::Status(grpc::StatusCode::NOT_FOUND,
+                                    "Unknown or expired transfer id: " + request->transfer_id());
+            }
+            transfer = *session->last_export;
+        } else {
+            std::vector<TopoDS_Shape> shapes_to_export;
+            for (const auto& shape_id : request->shape_ids()) {
+                if (auto shape_data = session->findShape(shape_id)) {
+                    shapes_to_export.push_back(shape_data->topo_shape);
+                }
+            }
+            
+            auto model_data = std::make_shared<std::string>();
+            geometry::ModelFileInfo file_info;
+            if (!exportModelFileInternal(shapes_to_export, request->options(), *model_data, file_info)) {
+                return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to export model file");
             }
+            
+            transfer.transfer_id = generateTransferId();
+            transfer.filename = file_info.filename();
+            transfer.crc = Utils::Crc32(model_data->data(), model_data->size());
+            transfer.data = std::move(model_data);
+            
+            std::lock_guard<std::mutex> lock(session->transfers_mutex);
+            session->last_export = transfer;
         }
         
-        bool success = exportModelFileInternal(shape_ids, request->options(), model_data, file_info);
-        
-        // Clean up temporary shapes
-        for (const auto& shape_id : temp_added) {
-            shapes_.erase(shape_id);
+        const std::string& data = *transfer.data;
+        uint64_t offset = request->offset();
+        if (offset > data.size()) {
+            return grpc::Status(grpc::StatusCode::OUT_OF_RANGE,
+                                "Offset " + std::to_string(offset) + " is past the end of the file");
         }
         
-        if (success) {
-            response->set_success(true);
-            response->set_message("Model file exported successfully");
-            response->set_model_data(model_data);
-            response->set_filename(file_info.filename());
-            response->mutable_file_info()->CopyFrom(file_info);
+        spdlog::info("[{}] DownloadModel: Streaming {} ({} bytes) from offset {} in {} byte chunks", client_id,
+                    transfer.filename, data.size(), offset, chunk_size);
+        
+        bool first = true;
+        do {
+            size_t size = std::min<uint64_t>(chunk_size, data.size() - offset);
+            geometry::ModelChunk chunk;
+            chunk.set_transfer_id(transfer.transfer_id);
+            chunk.set_offset(offset);
+            chunk.set_data(data.data() + offset, size);
+            chunk.set_crc32(Utils::Crc32(data.data() + offset, size));
+            if (first) {
+                chunk.set_filename(transfer.filename);
+                chunk.set_total_size(data.size());
+                chunk.set_file_crc32(transfer.crc);
+                first = false;
+            }
+            offset += size;
+            chunk.set_last(offset == data.size());
             
-            spdlog::info("[{}] ExportModelFile: Successfully exported {} shapes to {} format, size: {} bytes", client_id, 
-                        shape_ids.size(), request->options().format(), model_data.size());
-        } else {
-            response->set_success(false);
-            response->set_message("Failed to export model file");
-        }
+            if (context->IsCancelled() || !tracedWrite(writer, chunk)) {
+                spdlog::warn("[{}] DownloadModel: Client went away at offset {}", client_id, chunk.offset());
+                return grpc::Status(grpc::StatusCode::CANCELLED, "Download interrupted");
+            }
+            session->updateActivity();
+        } while (offset < data.size());
+        
+        return grpc::Status::OK;
         
     } catch (const std::exception& e) {
-        response->set_success(false);
-        response->set_message(std::string("Failed to export model file: ") + e.what());
-        spdlog::error("ExportModelFile: Exception: {}", e.what());
+        spdlog::error("DownloadModel: Exception occurred: {}", e.what());
+        return grpc::Status(grpc::StatusCode::INTERNAL, "Failed to download model: " + std::string(e.what()));
     }
-    
-    return grpc::Status::OK;
 }
 
 grpc::Status GeometryServiceImpl::DisconnectClient(grpc::ServerContext* context,
@@ -969,17 +3465,13 @@ grpc::Status GeometryServiceImpl::DisconnectClient(grpc::ServerContext* context,
     std::string client_id = getClientId(context);
     
     // Remove client session if it exists
-    {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        auto it = client_sessions_.find(client_id);
-        if (it != client_sessions_.end()) {
-            size_t shape_count = it->second->shapes.size();
-            client_sessions_.erase(it);
-            spdlog::info("[{}] DisconnectClient: Session removed, cleared {} shapes, {} active sessions remaining", 
-                        client_id, shape_count, client_sessions_.size());
-        } else {
-            spdlog::warn("[{}] DisconnectClient: No active session found for client", client_id);
-        }
+    if (auto session = removeSession(client_id)) {
+        size_t shape_count = session->shapeCount();
+        retireSession(*session);
+        spdlog::info("[{}] DisconnectClient: Session removed, cleared {} shapes, {} active sessions remaining", 
+                    client_id, shape_count, getSessionCount());
+    } else {
+        spdlog::warn("[{}] DisconnectClient: No active session found for client", client_id);
     }
     
     response->set_success(true);
@@ -995,14 +3487,83 @@ grpc::Status GeometryServiceImpl::DisconnectClient(grpc::ServerContext* context,
 // =============================================================================
 
 std::vector<std::string> GeometryServiceImpl::importModelFileInternal(
-    const std::string& file_path, const geometry::ModelImportOptions& options) {
-    
-    std::vector<std::string> shape_ids;
+    const std::string& file_path, const geometry::ModelImportOptions& options, const StagedShapesSink& sink) {
     
     // Detect file format
     std::string format = detectFileFormat(file_path, options.force_format());
     spdlog::info("importModelFileInternal: Detected format '{}' for file: {}", format, file_path);
     
+    // A disk cache hit skips reading and translating the file
+    std::string cache_key;
+    if (model_disk_cache_) {
+        cache_key = ModelDiskCache::makeKey(file_path, format, options);
+        if (!cache_key.empty()) {
+            std::vector<std::string> cached_ids = stageCachedModel(cache_key);
+            if (!cached_ids.empty()) {
+                spdlog::info("importModelFileInternal: Loaded {} shapes for {} from the model cache",
+                             cached_ids.size(), file_path);
+                return cached_ids;
+            }
+        }
+    }
+    
+    // Streamed pieces are collected for the cache entry before they leave the staging area
+    std::vector<ModelDiskCache::CachedShape> cached_shapes;
+    StagedShapesSink forward = sink;
+    if (sink && !cache_key.empty()) {
+        forward = [&](const std::vector<std::string>& staged_ids) {
+            collectCachedShapes(cache_key, staged_ids, cached_shapes);
+            sink(staged_ids);
+        };
+    }
+    
+    std::vector<std::string> shape_ids = translateModelFile(file_path, format, options, forward);
+    if (!cache_key.empty()) {
+        collectCachedShapes(cache_key, shape_ids, cached_shapes);
+        model_disk_cache_->storeShapes(cache_key, cached_shapes);
+    }
+    return shape_ids;
+}
+
+std::vector<std::string> GeometryServiceImpl::importModelIntoSession(
+    ClientSession& session, const std::string& file_path, const geometry::ModelImportOptions& options) {
+    
+    std::vector<std::string> session_ids;
+    TopTools_MapOfShape counted;  // Parts shared by streamed pieces
+    auto adopt = [&](const std::vector<std::string>& staged_ids) {
+        std::vector<std::string> adopted = adoptStagedShapes(session, staged_ids, options.precision(), &counted);
+        session_ids.insert(session_ids.end(), adopted.begin(), adopted.end());
+    };
+    
+    try {
+        adopt(importModelFileInternal(file_path, options, adopt));  // Streamed pieces are skipped here
+    } catch (...) {
+        // A failed import leaves nothing behind, including pieces already shown
+        {
+            std::lock_guard<std::mutex> lock(session.shapes_mutex);
+            for (const auto& shape_id : session_ids) {
+                auto it = session.shapes.find(shape_id);
+                if (it != session.shapes.end()) {
+                    session.eraseShapeLocked(it);
+                }
+            }
+        }
+        for (const auto& shape_id : session_ids) {
+            session.recordChange(shape_id, geometry::SCENE_CHANGE_DELETED);
+        }
+        mesh_cache_.invalidateShapes(session.client_id, session_ids);
+        throw;
+    }
+    return session_ids;
+}
+
+std::vector<std::string> GeometryServiceImpl::translateModelFile(
+    const std::string& file_path, const std::string& format, const geometry::ModelImportOptions& options,
+    const StagedShapesSink& sink) {
+    STAGE_SPAN(translate_span, "TranslateModel");
+    
+    std::vector<std::string> shape_ids;
+    
     // First try using DE_Wrapper for unified import
     try {
         #ifdef HAVE_DE_WRAPPER
@@ -1014,11 +3575,8 @@ std::vector<std::string> GeometryServiceImpl::importModelFileInternal(
             if (wrapper->Read(path, shape)) {
                 if (!shape.IsNull()) {
                     std::string shape_id = generateShapeId();
-                    Handle(AIS_Shape) ais_shape = new AIS_Shape(shape);
-                    
                     // Store shape data
                     ShapeData shape_data;
-                    shape_data.ais_shape = ais_shape;
                     shape_data.topo_shape = shape;
                     shape_data.color.set_r(0.8);
                     shape_data.color.set_g(0.8);
@@ -1026,7 +3584,7 @@ std::vector<std::string> GeometryServiceImpl::importModelFileInternal(
                     shape_data.color.set_a(1.0); // Default color
                     shape_data.shape_id = shape_id;
                     
-                    shapes_[shape_id] = std::move(shape_data);
+                    stageShape(shape_id, std::move(shape_data));
                     shape_ids.push_back(shape_id);
                     
                     spdlog::info("importModelFileInternal: Successfully imported using DE_Wrapper: {}", shape_id);
@@ -1040,55 +3598,63 @@ std::vector<std::string> GeometryServiceImpl::importModelFileInternal(
     }
     
     // Fallback to format-specific readers
-    return importModelFileInternal_FormatSpecific(file_path, format, options);
+    return importModelFileInternal_FormatSpecific(file_path, format, options, sink);
+}
+
+std::vector<std::string> GeometryServiceImpl::stageCachedModel(const std::string& cache_key) {
+    std::vector<ModelDiskCache::CachedShape> cached;
+    if (!model_disk_cache_->loadShapes(cache_key, cached)) {
+        return {};
+    }
+    
+    std::vector<ShapeData> shapes;
+    shapes.reserve(cached.size());
+    for (size_t i = 0; i < cached.size(); ++i) {
+        ShapeData shape_data;
+        shape_data.topo_shape = cached[i].shape;
+        shape_data.shape_id = generateShapeId();
+        shape_data.visible = true;
+        shape_data.color = cached[i].color;
+        shape_data.disk_cache_key = cache_key;
+        shape_data.disk_cache_index = i;
+        shape_data.disk_cache_generation = shape_data.generation;
+        shapes.push_back(std::move(shape_data));
+    }
+    assignPrototypes(shapes);  // The cache keeps the parts shared
+    
+    std::vector<std::string> shape_ids;
+    for (ShapeData& shape_data : shapes) {
+        shape_ids.push_back(shape_data.shape_id);
+        stageShape(shape_data.shape_id, std::move(shape_data));
+    }
+    return shape_ids;
+}
+
+void GeometryServiceImpl::collectCachedShapes(const std::string& cache_key, const std::vector<std::string>& staged_ids,
+                                              std::vector<ModelDiskCache::CachedShape>& shapes) {
+    std::lock_guard<std::mutex> lock(staging_mutex_);
+    for (const auto& shape_id : staged_ids) {
+        auto it = shapes_.find(shape_id);
+        if (it == shapes_.end()) {
+            continue;  // Streamed to the session and collected then
+        }
+        ShapeData& shape_data = it->second;
+        shape_data.disk_cache_key = cache_key;
+        shape_data.disk_cache_index = shapes.size();
+        shape_data.disk_cache_generation = shape_data.generation;
+        shapes.push_back({shape_data.topo_shape, shape_data.color});
+    }
 }
 
 std::vector<std::string> GeometryServiceImpl::importModelFileInternal_FormatSpecific(
-    const std::string& file_path, const std::string& format, const geometry::ModelImportOptions& options) {
+    const std::string& file_path, const std::string& format, const geometry::ModelImportOptions& options,
+    const StagedShapesSink& sink) {
     
     std::vector<std::string> shape_ids;
     
     try {
         if (format == "STEP" || format == "STP") {
-            // Use STEPControl_Reader for STEP import
-            STEPControl_Reader reader;
-            IFSelect_ReturnStatus status = reader.ReadFile(file_path.c_str());
-            
-            if (status != IFSelect_RetDone) {
-                throw std::runtime_error("Failed to read STEP file");
-            }
-            
-            // Transfer roots
-            Standard_Integer nb_roots = reader.NbRootsForTransfer();
-            reader.TransferRoots();
-            
-            // Get the shape
-            TopoDS_Shape shape = reader.OneShape();
-            if (shape.IsNull()) {
-                throw std::runtime_error("Failed to transfer STEP data");
-            }
-            
-            // Store the shape
-            std::string shape_id = generateShapeId();
-            
-            Handle(AIS_Shape) ais_shape = new AIS_Shape(shape);
-            ais_shape->SetDisplayMode(AIS_Shaded);
-            
-            ShapeData shape_data;
-            shape_data.ais_shape = ais_shape;
-            shape_data.topo_shape = shape;
-            shape_data.shape_id = shape_id;
-            shape_data.visible = true;
-            shape_data.color.set_r(0.7f);
-            shape_data.color.set_g(0.7f);
-            shape_data.color.set_b(0.7f);
-            shape_data.color.set_a(1.0f);
-            
-            shapes_[shape_id] = std::move(shape_data);
-            shape_ids.push_back(shape_id);
-            
-            spdlog::info("Successfully imported STEP file: {} shape(s)", shape_ids.size());
-            return shape_ids;
+            return importStepFileInternal(file_path, options);
             
         } else if (format == "IGES" || format == "IGS") {
             return importIgesFileInternal(file_path, options);
@@ -1106,36 +3672,15 @@ std::vector<std::string> GeometryServiceImpl::importModelFileInternal_FormatSpec
                 throw std::runtime_error("Invalid BREP data");
             }
             
-            // Store the shape
-            std::string shape_id = generateShapeId();
-            
-            Handle(AIS_Shape) ais_shape = new AIS_Shape(shape);
-            ais_shape->SetDisplayMode(AIS_Shaded);
-            
-            ShapeData shape_data;
-            shape_data.ais_shape = ais_shape;
-            shape_data.topo_shape = shape;
-            shape_data.shape_id = shape_id;
-            shape_data.visible = true;
-            shape_data.color.set_r(0.7f);
-            shape_data.color.set_g(0.7f);
-            shape_data.color.set_b(0.7f);
-            shape_data.color.set_a(1.0f);
-            
-            shapes_[shape_id] = std::move(shape_data);
-            shape_ids.push_back(shape_id);
-            
+            shape_ids.push_back(stageBrepShape(shape));
             spdlog::info("Successfully imported BREP file: {} shape(s)", shape_ids.size());
             return shape_ids;
             
-        } else if (format == "STL") {
-            return importStlFileInternal(file_path, options);
+        } else if (format == "OBJ" && options.import_colors() && objUsesMaterials(file_path)) {
+            return importObjFileInternal(file_path, options);  // XDE reader keeps the materials
             
-        } else if (format == "OBJ") {
-            return importObjFileInternal(file_path, options);
-            
-        } else if (format == "PLY") {
-            return importPlyFileInternal(file_path, options);
+        } else if (MeshStreamImporter::supportsFormat(format)) {
+            return importMeshFileInternal(file_path, format, sink);
             
         } else if (format == "GLTF" || format == "GLB") {
             return importGltfFileInternal(file_path, options);
@@ -1150,56 +3695,156 @@ std::vector<std::string> GeometryServiceImpl::importModelFileInternal_FormatSpec
     }
 }
 
-std::vector<std::string> GeometryServiceImpl::importStlFileInternal(
-    const std::string& file_path, const geometry::ModelImportOptions& options) {
+std::vector<std::string> GeometryServiceImpl::importMeshFileInternal(
+    const std::string& file_path, const std::string& format, const StagedShapesSink& sink) {
     
+    // Same default colors as the whole-file readers used before (no color info in STL)
+    Quantity_Color default_color = format == "OBJ" ? Quantity_Color(0.6, 0.8, 0.7, Quantity_TOC_RGB)
+                                                   : Quantity_Color(0.7, 0.7, 0.9, Quantity_TOC_RGB);
     std::vector<std::string> shape_ids;
     
     try {
-        // Use RWStl to read STL file - returns a triangulation
-        Handle(Poly_Triangulation) triangulation = RWStl::ReadFile(file_path.c_str());
-        if (triangulation.IsNull()) {
-            throw std::runtime_error("Failed to read STL file using RWStl");
-        }
+        // Each sub-mesh becomes a face carrying just its triangulation
+        MeshStreamImporter::Result result = MeshStreamImporter::importFile(
+            file_path, format, mesh_import_options_, [&](const Handle(Poly_Triangulation)& chunk) {
+                TopoDS_Face face;
+                BRep_Builder builder;
+                builder.MakeFace(face);
+                builder.UpdateFace(face, chunk);
+                
+                std::string shape_id = generateShapeId();
+                ShapeData shape_data;
+                shape_data.topo_shape = face;
+                shape_data.color = toProtoColor(default_color);
+                shape_data.shape_id = shape_id;
+                
+                stageShape(shape_id, std::move(shape_data));
+                shape_ids.push_back(shape_id);
+                if (sink) {
+                    sink({shape_id});
+                }
+            });
         
-        // Convert triangulation to shape (create a face from the triangulation)
-        TopoDS_Face face;
-        BRep_Builder builder;
-        builder.MakeFace(face);
-        builder.UpdateFace(face, triangulation);
-        TopoDS_Shape shape = face;
+        spdlog::info("importMeshFileInternal: Imported {} triangles from {} file as {} sub-meshes",
+                     result.triangles, format, result.chunks);
         
-        if (shape.IsNull()) {
-            throw std::runtime_error("STL file produced null shape");
+    } catch (const std::exception& e) {
+        discardStagedShapes(shape_ids);  // Pieces not yet handed to the sink
+        throw std::runtime_error("Failed to import " + format + " file '" + file_path + "': " + e.what());
+    }
+    
+    return shape_ids;
+}
+
+std::vector<std::string> GeometryServiceImpl::importStepFileInternal(
+    const std::string& file_path, const geometry::ModelImportOptions& options) {
+    
+    STEPCAFControl_Reader reader;
+    {
+        STAGE_SPAN(read_span, "StepRead");
+        if (reader.ReadFile(file_path.c_str()) != IFSelect_RetDone) {
+            throw std::runtime_error("Failed to read STEP file");
         }
-        
-        // Create AIS shape
-        std::string shape_id = generateShapeId();
-        Handle(AIS_Shape) ais_shape = new AIS_Shape(shape);
-        
-        // Set default color for STL (no color info in STL files)
-        Quantity_Color default_color(0.7, 0.7, 0.9, Quantity_TOC_RGB);
-        ais_shape->SetColor(default_color);
-        
-        // Store shape data
+    }
+    return transferStepModel(reader, options);
+}
+
+std::vector<std::string> GeometryServiceImpl::transferStepModel(
+    STEPCAFControl_Reader& reader, const geometry::ModelImportOptions& options) {
+    
+    Handle(TDocStd_Document) doc = newXcafDocument();
+    
+    reader.SetColorMode(options.import_colors());
+    reader.SetNameMode(false);
+    reader.SetLayerMode(false);
+    {
+        STAGE_SPAN(transfer_span, "StepTransfer");
+        if (!reader.Transfer(doc)) {
+            throw std::runtime_error("Failed to transfer STEP data");
+        }
+    }
+    
+    Handle(XCAFDoc_ShapeTool) shape_tool = XCAFDoc_DocumentTool::ShapeTool(doc->Main());
+    Handle(XCAFDoc_ColorTool) color_tool = XCAFDoc_DocumentTool::ColorTool(doc->Main());
+    const Quantity_Color default_color(0.7, 0.7, 0.7, Quantity_TOC_RGB);
+    
+    // Part occurrences in model coordinates; the shapes of one part share its TShape
+    struct Occurrence {
+        TopoDS_Shape shape;
+        Quantity_Color color;
+    };
+    std::vector<Occurrence> occurrences;
+    auto colorOf = [&](const TDF_Label& label, Quantity_Color& color) {
+        return options.import_colors() && (color_tool->GetColor(label, XCAFDoc_ColorSurf, color) ||
+                                           color_tool->GetColor(label, XCAFDoc_ColorGen, color));
+    };
+    std::function<void(const TDF_Label&, const TopLoc_Location&, const Quantity_Color&)> collect =
+        [&](const TDF_Label& label, const TopLoc_Location& parent_location, const Quantity_Color& parent_color) {
+            TDF_Label part = label;
+            TopLoc_Location location = parent_location;
+            Quantity_Color color = parent_color;
+            const bool own_color = colorOf(label, color);  // An occurrence's color wins over its part's
+            if (XCAFDoc_ShapeTool::IsReference(label)) {
+                XCAFDoc_ShapeTool::GetReferredShape(label, part);
+                location = parent_location * XCAFDoc_ShapeTool::GetLocation(label);
+                if (!own_color) {
+                    colorOf(part, color);
+                }
+            }
+            
+            if (XCAFDoc_ShapeTool::IsAssembly(part)) {
+                TDF_LabelSequence components;
+                XCAFDoc_ShapeTool::GetComponents(part, components);
+                for (int i = 1; i <= components.Length(); ++i) {
+                    collect(components.Value(i), location, color);
+                }
+                return;
+            }
+            TopoDS_Shape shape = XCAFDoc_ShapeTool::GetShape(part);
+            if (!shape.IsNull()) {
+                occurrences.push_back({shape.Moved(location), color});
+            }
+        };
+    
+    TDF_LabelSequence free_labels;
+    shape_tool->GetFreeShapes(free_labels);
+    if (options.merge_shapes()) {
+        // One compound of the whole model, as a plain STEP reader gives
+        TopoDS_Shape shape = shape_tool->GetOneShape();
+        if (!shape.IsNull()) {
+            occurrences.push_back({shape, default_color});
+        }
+    } else {
+        for (int i = 1; i <= free_labels.Length(); ++i) {
+            collect(free_labels.Value(i), TopLoc_Location(), default_color);
+        }
+    }
+    if (occurrences.empty()) {
+        throw std::runtime_error("No shapes found in STEP data");
+    }
+    
+    std::vector<ShapeData> shapes;
+    shapes.reserve(occurrences.size());
+    for (const Occurrence& occurrence : occurrences) {
         ShapeData shape_data;
-        shape_data.ais_shape = ais_shape;
-        shape_data.topo_shape = shape;
-        shape_data.color.set_r(0.7);
-        shape_data.color.set_g(0.7);
-        shape_data.color.set_b(0.9);
-        shape_data.color.set_a(1.0);
-        shape_data.shape_id = shape_id;
-        
-        shapes_[shape_id] = std::move(shape_data);
-        shape_ids.push_back(shape_id);
-        
-        spdlog::info("importStlFileInternal: Successfully imported STL file: {}", shape_id);
-        
-    } catch (const std::exception& e) {
-        throw std::runtime_error("Failed to import STL file '" + file_path + "': " + e.what());
+        shape_data.topo_shape = occurrence.shape;
+        shape_data.shape_id = generateShapeId();
+        shape_data.visible = true;
+        shape_data.color = toProtoColor(occurrence.color);
+        shapes.push_back(std::move(shape_data));
     }
+    assignPrototypes(shapes);
     
+    std::vector<std::string> shape_ids;
+    std::unordered_set<std::string> prototypes;
+    for (ShapeData& shape_data : shapes) {
+        if (!shape_data.prototype_id.empty()) {
+            prototypes.insert(shape_data.prototype_id);
+        }
+        shape_ids.push_back(shape_data.shape_id);
+        stageShape(shape_data.shape_id, std::move(shape_data));
+    }
+    spdlog::info("Successfully imported STEP file: {} shape(s), {} repeated part(s)", shape_ids.size(), prototypes.size());
     return shape_ids;
 }
 
@@ -1212,13 +3857,18 @@ std::vector<std::string> GeometryServiceImpl::importIgesFileInternal(
         IGESControl_Reader reader;
         
         // Read the IGES file
-        IFSelect_ReturnStatus status = reader.ReadFile(file_path.c_str());
-        if (status != IFSelect_RetDone) {
-            throw std::runtime_error("Failed to read IGES file");
+        {
+            STAGE_SPAN(read_span, "IgesRead");
+            if (reader.ReadFile(file_path.c_str()) != IFSelect_RetDone) {
+                throw std::runtime_error("Failed to read IGES file");
+            }
         }
         
         // Transfer shapes
-        reader.TransferRoots();
+        {
+            STAGE_SPAN(transfer_span, "IgesTransfer");
+            reader.TransferRoots();
+        }
         int nb_shapes = reader.NbShapes();
         
         if (nb_shapes == 0) {
@@ -1229,15 +3879,8 @@ std::vector<std::string> GeometryServiceImpl::importIgesFileInternal(
             TopoDS_Shape shape = reader.Shape(i);
             if (!shape.IsNull()) {
                 std::string shape_id = generateShapeId();
-                Handle(AIS_Shape) ais_shape = new AIS_Shape(shape);
-                
-                // Set default color
-                Quantity_Color default_color(0.8, 0.7, 0.6, Quantity_TOC_RGB);
-                ais_shape->SetColor(default_color);
-                
                 // Store shape data
                 ShapeData shape_data;
-                shape_data.ais_shape = ais_shape;
                 shape_data.topo_shape = shape;
                 shape_data.color.set_r(0.8);
                 shape_data.color.set_g(0.7);
@@ -1245,7 +3888,7 @@ std::vector<std::string> GeometryServiceImpl::importIgesFileInternal(
                 shape_data.color.set_a(1.0);
                 shape_data.shape_id = shape_id;
                 
-                shapes_[shape_id] = std::move(shape_data);
+                stageShape(shape_id, std::move(shape_data));
                 shape_ids.push_back(shape_id);
                 
                 spdlog::info("importIgesFileInternal: Successfully imported IGES shape: {}", shape_id);
@@ -1266,9 +3909,7 @@ std::vector<std::string> GeometryServiceImpl::importObjFileInternal(
     
     try {
         // Create XDE document for OBJ import with materials/colors
-        Handle(TDocStd_Document) doc;
-        Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
-        app->NewDocument("MDTV-XCAF", doc);
+        Handle(TDocStd_Document) doc = newXcafDocument();
         
         RWObj_CafReader reader;
         
@@ -1299,21 +3940,14 @@ std::vector<std::string> GeometryServiceImpl::importObjFileInternal(
             
             if (shape_tool->GetShape(label, shape) && !shape.IsNull()) {
                 std::string shape_id = generateShapeId();
-                Handle(AIS_Shape) ais_shape = new AIS_Shape(shape);
-                
                 // Try to get color from XDE
                 Handle(XCAFDoc_ColorTool) color_tool = XCAFDoc_DocumentTool::ColorTool(doc->Main());
                 Quantity_Color obj_color(0.6, 0.8, 0.7, Quantity_TOC_RGB); // Default OBJ color
                 
-                if (color_tool->GetColor(label, XCAFDoc_ColorSurf, obj_color)) {
-                    ais_shape->SetColor(obj_color);
-                } else {
-                    ais_shape->SetColor(obj_color);
-                }
+                color_tool->GetColor(label, XCAFDoc_ColorSurf, obj_color);
                 
                 // Store shape data
                 ShapeData shape_data;
-                shape_data.ais_shape = ais_shape;
                 shape_data.topo_shape = shape;
                 shape_data.color.set_r(obj_color.Red());
                 shape_data.color.set_g(obj_color.Green());
@@ -1321,7 +3955,7 @@ std::vector<std::string> GeometryServiceImpl::importObjFileInternal(
                 shape_data.color.set_a(1.0);
                 shape_data.shape_id = shape_id;
                 
-                shapes_[shape_id] = std::move(shape_data);
+                stageShape(shape_id, std::move(shape_data));
                 shape_ids.push_back(shape_id);
                 
                 spdlog::info("importObjFileInternal: Successfully imported OBJ shape: {}", shape_id);
@@ -1371,6 +4005,17 @@ std::string GeometryServiceImpl::detectFormatFromExtension(const std::string& fi
     return "UNKNOWN";
 }
 
+std::string GeometryServiceImpl::detectFormatFromContent(const std::string& content) {
+    // Sniff well-known headers of in-memory data that arrived without a usable name
+    std::string_view head(content.data(), std::min<size_t>(content.size(), 256));
+    if (head.find("ISO-10303-21") != std::string_view::npos) return "STEP";
+    if (head.find("CASCADE Topology") != std::string_view::npos) return "BREP";
+    if (head.rfind("ply", 0) == 0) return "PLY";
+    if (head.rfind("glTF", 0) == 0) return "GLB";
+    if (head.rfind("solid", 0) == 0) return "STL";  // ASCII STL
+    if (head.size() >= 73 && head[72] == 'S') return "IGES";  // Start section flag in column 73
+    return "UNKNOWN";
+}
 
 geometry::ModelFileInfo GeometryServiceImpl::getModelFileInfo(
     const std::string& filename, const std::string& model_data, int shape_count, const std::string& format) {
@@ -1420,48 +4065,107 @@ geometry::ModelFileInfo GeometryServiceImpl::getModelFileInfo(
 std::vector<std::string> GeometryServiceImpl::importModelDataInternal(
     const std::string& model_data, const std::string& filename, const geometry::ModelImportOptions& options) {
     
-    // For data import, we need to write to a temporary file first
-    // This is a limitation of most OCCT readers that expect file paths
+    std::string format = detectFileFormat(filename, options.force_format());
+    if (format == "UNKNOWN") {
+        format = detectFormatFromContent(model_data);
+    }
+    
+    // Same disk cache entries as importing the bytes from a file
+    std::string cache_key;
+    if (model_disk_cache_) {
+        cache_key = ModelDiskCache::makeDataKey(model_data, format, options);
+        std::vector<std::string> cached_ids = stageCachedModel(cache_key);
+        if (!cached_ids.empty()) {
+            spdlog::info("importModelDataInternal: Loaded {} shapes for {} from the model cache",
+                         cached_ids.size(), filename);
+            return cached_ids;
+        }
+    }
     
-    std::string temp_filename = "/tmp/occt_import_" + std::to_string(std::time(nullptr)) + "_" + filename;
+    std::vector<std::string> shape_ids;
+    if (hasStreamReader(format)) {
+        std::istringstream stream(model_data);
+        shape_ids = importModelStreamInternal(stream, filename, format, options);
+    } else {
+        // Other readers only accept paths: fall back to a uniquely named temp file
+        spdlog::debug("importModelDataInternal: No stream reader for {}, using a temporary file", format);
+        ScopedTempFile temp_file(filename.empty() ? "model." + format : filename);
+        temp_file.write(model_data);
+        shape_ids = translateModelFile(temp_file.path(), format, options, nullptr);
+    }
     
-    try {
-        // Write data to temporary file
-        std::ofstream temp_file(temp_filename, std::ios::binary);
-        if (!temp_file) {
-            throw std::runtime_error("Failed to create temporary file: " + temp_filename);
+    if (!cache_key.empty()) {
+        std::vector<ModelDiskCache::CachedShape> cached_shapes;
+        collectCachedShapes(cache_key, shape_ids, cached_shapes);
+        model_disk_cache_->storeShapes(cache_key, cached_shapes);
+    }
+    return shape_ids;
+}
+
+bool GeometryServiceImpl::hasStreamReader(const std::string& format) {
+    return format == "STEP" || format == "STP" || format == "BREP" || format == "BRP";
+}
+
+std::vector<std::string> GeometryServiceImpl::importModelDataIntoSession(
+    ClientSession& session, const std::string& model_data, const std::string& filename,
+    const geometry::ModelImportOptions& options) {
+    return adoptStagedShapes(session, importModelDataInternal(model_data, filename, options), options.precision());
+}
+
+std::vector<std::string> GeometryServiceImpl::importModelData(const std::string& client_id,
+                                                              const std::string& model_data,
+                                                              const std::string& filename,
+                                                              const geometry::ModelImportOptions& options) {
+    auto session = getOrCreateSession(client_id);
+    return importModelDataIntoSession(*session, model_data, filename, options);
+}
+
+std::vector<std::string> GeometryServiceImpl::importModelStreamInternal(
+    std::istream& stream, const std::string& name, const std::string& format,
+    const geometry::ModelImportOptions& options) {
+    STAGE_SPAN(translate_span, "TranslateModel");
+    
+    if (format == "STEP" || format == "STP") {
+        // Same XCAF transfer as files, so part occurrences, colors and instancing survive
+        STEPCAFControl_Reader reader;
+        {
+            STAGE_SPAN(read_span, "StepRead");
+            if (reader.ChangeReader().ReadStream(name.c_str(), stream) != IFSelect_RetDone) {
+                throw std::runtime_error("Failed to read STEP data");
+            }
         }
-        temp_file.write(model_data.data(), model_data.size());
-        temp_file.close();
-        
-        // Import from temporary file
-        std::vector<std::string> shape_ids = importModelFileInternal(temp_filename, options);
-        
-        // Clean up temporary file
-        std::filesystem::remove(temp_filename);
-        
+        std::vector<std::string> shape_ids = transferStepModel(reader, options);
+        spdlog::info("importModelStreamInternal: Imported STEP data '{}' from memory: {} shape(s)",
+                     name, shape_ids.size());
         return shape_ids;
-        
-    } catch (const std::exception& e) {
-        // Clean up temporary file on error
-        try {
-            std::filesystem::remove(temp_filename);
-        } catch (...) {
-            // Ignore cleanup errors
+    }
+    if (format == "BREP" || format == "BRP") {
+        TopoDS_Shape shape;
+        BRep_Builder builder;
+        BRepTools::Read(shape, stream, builder);
+        if (shape.IsNull()) {
+            throw std::runtime_error("Invalid BREP data");
         }
-        throw;
+        std::string shape_id = stageBrepShape(shape);
+        spdlog::info("importModelStreamInternal: Imported BREP data '{}' from memory: {}", name, shape_id);
+        return {shape_id};
     }
+    throw std::runtime_error("No stream reader for format: " + format);
 }
 
-std::vector<std::string> GeometryServiceImpl::importPlyFileInternal(
-    const std::string& file_path, const geometry::ModelImportOptions& options) {
-    
-    std::vector<std::string> shape_ids;
-    
-    // PLY format is not yet supported - just log and return empty vector
-    spdlog::warn("importPlyFileInternal: PLY format import is not yet supported for file: {}", file_path);
+std::string GeometryServiceImpl::stageBrepShape(const TopoDS_Shape& shape) {
+    std::string shape_id = generateShapeId();
+    ShapeData shape_data;
+    shape_data.topo_shape = shape;
+    shape_data.shape_id = shape_id;
+    shape_data.visible = true;
+    shape_data.color.set_r(0.7f);
+    shape_data.color.set_g(0.7f);
+    shape_data.color.set_b(0.7f);
+    shape_data.color.set_a(1.0f);
     
-    return shape_ids;
+    stageShape(shape_id, std::move(shape_data));
+    return shape_id;
 }
 
 std::vector<std::string> GeometryServiceImpl::importGltfFileInternal(
@@ -1476,19 +4180,10 @@ std::vector<std::string> GeometryServiceImpl::importGltfFileInternal(
 }
 
 bool GeometryServiceImpl::exportModelFileInternal(
-    const std::vector<std::string>& shape_ids, const geometry::ModelExportOptions& options,
+    const std::vector<TopoDS_Shape>& shapes_to_export, const geometry::ModelExportOptions& options,
     std::string& model_data, geometry::ModelFileInfo& file_info) {
     
     try {
-        // Collect shapes to export
-        std::vector<TopoDS_Shape> shapes_to_export;
-        for (const auto& shape_id : shape_ids) {
-            auto it = shapes_.find(shape_id);
-            if (it != shapes_.end()) {
-                shapes_to_export.push_back(it->second.topo_shape);
-            }
-        }
-        
         if (shapes_to_export.empty()) {
             spdlog::error("exportModelFileInternal: No valid shapes found");
             return false;
@@ -1521,32 +4216,27 @@ bool GeometryServiceImpl::exportModelFileInternal(
                 return false;
             }
             
-            // Write to temporary file then read it back
-            std::string temp_file = "temp_export.step";
-            if (!writer.Write(temp_file.c_str())) {
-                spdlog::error("exportModelFileInternal: Failed to write STEP file");
+#if OCC_VERSION_HEX >= 0x070700
+            // Serialize straight into memory
+            std::ostringstream stream;
+            if (writer.WriteStream(stream) != IFSelect_RetDone) {
+                spdlog::error("exportModelFileInternal: Failed to write STEP stream");
                 return false;
             }
-            
-            // Read file content
-            std::ifstream file(temp_file, std::ios::binary | std::ios::ate);
-            if (!file) {
-                spdlog::error("exportModelFileInternal: Failed to open temp file");
+            model_data = stream.str();
+#else
+            // Older OCCT has no stream writer: use a uniquely named temp file
+            ScopedTempFile temp_file("model.step");
+            if (writer.Write(temp_file.path().c_str()) != IFSelect_RetDone) {
+                spdlog::error("exportModelFileInternal: Failed to write STEP file");
                 return false;
             }
-            
-            size_t file_size = file.tellg();
-            file.seekg(0, std::ios::beg);
-            model_data.resize(file_size);
-            file.read(&model_data[0], file_size);
-            file.close();
-            
-            // Delete temp file
-            std::remove(temp_file.c_str());
+            model_data = temp_file.read();
+#endif
             
             // Set file info
             file_info.set_filename("model.step");
-            file_info.set_file_size(file_size);
+            file_info.set_file_size(model_data.size());
             file_info.set_shape_count(shapes_to_export.size());
             file_info.set_format("STEP");
             
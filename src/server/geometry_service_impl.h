@@ -3,19 +3,29 @@
 #include <memory>
 #include <unordered_map>
 #include <string>
+#include <array>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
 
 // gRPC and Protocol Buffer includes
 #include "geometry_service.grpc.pb.h"
 
-// OCCT includes
-#include <AIS_InteractiveContext.hxx>
-#include <AIS_InteractiveObject.hxx>
-#include <AIS_Shape.hxx>
+// OCCT includes (modeling and data exchange only; the server has no viewer)
+#include <Quantity_Color.hxx>
 #include <TopoDS_Shape.hxx>
-#include <V3d_Viewer.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Vec.hxx>
 // STEP import/export includes
 #include <STEPCAFControl_Reader.hxx>
 #include <STEPCAFControl_Writer.hxx>
@@ -26,9 +36,56 @@
 // Standard includes
 #include <grpcpp/grpcpp.h>
 
+#include "mesh_cache.h"
+#include "mesh_stream_importer.h"
+#include "model_disk_cache.h"
+#include "scoped_temp_file.h"
+#include "shape_memory.h"
+#include "spatial_index.h"
+#include "view_camera.h"
+
+// Server-wide configuration, usually filled from the command line
+struct GeometryServiceOptions {
+    size_t mesh_cache_budget_bytes{MeshCache::kDefaultBudgetBytes};
+    bool parallel_meshing{true};  // OCCT parallel mesher plus per-face parallel extraction
+    
+    // On-disk cache of imported models and their meshes, kept across restarts; empty disables it
+    std::string model_cache_dir;
+    uint64_t model_cache_budget_bytes{ModelDiskCache::kDefaultBudgetBytes};
+    
+    // STL, OBJ and PLY files are imported as spatial sub-meshes of at most this many triangles
+    size_t import_chunk_triangles{MeshStreamImporter::kDefaultChunkTriangles};
+    
+    // Idle sessions are evicted by a background sweeper, never on the request path
+    std::chrono::milliseconds session_idle_timeout{std::chrono::minutes(30)};
+    std::chrono::milliseconds session_sweep_interval{std::chrono::minutes(1)};
+    
+    // Estimated memory (BRep, triangulations and cached meshes) one session, or all
+    // of them, may hold; 0 = unlimited. Cached meshes are evicted first, shapes that
+    // would still not fit are refused.
+    uint64_t session_memory_quota_bytes{0};
+    uint64_t memory_limit_bytes{0};
+    
+    // Async (callback API) mode: heavy RPCs run on a bounded worker pool, see AsyncGeometryService
+    bool async_server{false};
+    size_t worker_threads{0};            // 0 = hardware concurrency
+    size_t max_concurrent_meshing{0};    // 0 = worker_threads
+    size_t max_concurrent_imports{2};
+    size_t max_concurrent_exports{2};
+    size_t max_queued_per_rpc{64};       // Further requests fail with RESOURCE_EXHAUSTED
+    int grpc_max_threads{0};             // Caps gRPC sync threads, 0 = gRPC default
+    // Compression for responses to clients that accept it (gzip or deflate), e.g. for WAN sites
+    grpc_compression_algorithm grpc_compression{GRPC_COMPRESS_NONE};
+    
+    // HTTP endpoint ("host:port") serving /metrics for Prometheus and /traces with the
+    // last trace_span_capacity stage spans; empty disables both
+    std::string metrics_address;
+    size_t trace_span_capacity{4096};
+};
+
 class GeometryServiceImpl final : public geometry::GeometryService::Service {
 public:
-    GeometryServiceImpl();
+    explicit GeometryServiceImpl(const GeometryServiceOptions& options = GeometryServiceOptions());
     ~GeometryServiceImpl();
 
     // Primitive creation methods
@@ -61,15 +118,47 @@ public:
                               const geometry::ColorRequest* request,
                               geometry::StatusResponse* response) override;
 
+    grpc::Status ExecuteBatch(grpc::ServerContext* context,
+                             const geometry::BatchRequest* request,
+                             geometry::BatchResponse* response) override;
+
     // Mesh data retrieval
     grpc::Status GetMeshData(grpc::ServerContext* context,
                             const geometry::ShapeRequest* request,
                             geometry::MeshData* response) override;
 
     grpc::Status GetAllMeshes(grpc::ServerContext* context,
-                             const geometry::EmptyRequest* request,
+                             const geometry::MeshRequest* request,
                              grpc::ServerWriter<geometry::MeshData>* writer) override;
 
+    grpc::Status StreamMeshLods(grpc::ServerContext* context,
+                               const geometry::MeshLodRequest* request,
+                               grpc::ServerWriter<geometry::MeshData>* writer) override;
+
+    grpc::Status SyncScene(grpc::ServerContext* context,
+                          const geometry::SceneSyncRequest* request,
+                          grpc::ServerWriter<geometry::SceneChange>* writer) override;
+
+    grpc::Status SubscribeSceneChanges(grpc::ServerContext* context,
+                                      const geometry::SceneSubscribeRequest* request,
+                                      grpc::ServerWriter<geometry::SceneChange>* writer) override;
+
+    // Spatial queries
+    grpc::Status RayPick(grpc::ServerContext* context,
+                        const geometry::RayPickRequest* request,
+                        geometry::RayPickResponse* response) override;
+
+    grpc::Status BoxQuery(grpc::ServerContext* context,
+                         const geometry::BoxQueryRequest* request,
+                         geometry::ShapeQueryResponse* response) override;
+
+    grpc::Status FrustumCull(grpc::ServerContext* context,
+                            const geometry::FrustumCullRequest* request,
+                            geometry::ShapeQueryResponse* response) override;
+
+    grpc::Status UpdateCamera(grpc::ServerContext* context,
+                             const geometry::CameraUpdateRequest* request,
+                             geometry::StatusResponse* response) override;
 
     // System operations
     grpc::Status ClearAll(grpc::ServerContext* context,
@@ -95,6 +184,19 @@ public:
                                 const geometry::ModelExportRequest* request,
                                 geometry::ModelFileResponse* response) override;
 
+    grpc::Status ImportModelFiles(grpc::ServerContext* context,
+                                 const geometry::ImportModelFilesRequest* request,
+                                 geometry::ImportModelFilesResponse* response) override;
+
+    // Chunked model transfer
+    grpc::Status UploadModel(grpc::ServerContext* context,
+                            grpc::ServerReader<geometry::ModelChunk>* reader,
+                            geometry::UploadModelResponse* response) override;
+
+    grpc::Status DownloadModel(grpc::ServerContext* context,
+                              const geometry::DownloadModelRequest* request,
+                              grpc::ServerWriter<geometry::ModelChunk>* writer) override;
+
     // Client session management
     grpc::Status DisconnectClient(grpc::ServerContext* context,
                                  const geometry::EmptyRequest* request,
@@ -102,30 +204,430 @@ public:
 
     // LoadModelFromData removed - not needed for current implementation
 
+    // Context-free bodies of the heavy RPCs, shared by the sync handlers above
+    // and by AsyncGeometryService, which runs them on its worker pool
+    grpc::Status handleGetMeshData(const std::string& client_id,
+                                   const geometry::ShapeRequest* request,
+                                   geometry::MeshData* response);
+    grpc::Status handleImportModelFile(const std::string& client_id,
+                                       const geometry::ModelFileRequest* request,
+                                       geometry::ModelImportResponse* response);
+    grpc::Status handleExportModelFile(const std::string& client_id,
+                                       const geometry::ModelExportRequest* request,
+                                       geometry::ModelFileResponse* response);
+    grpc::Status handleExecuteBatch(const std::string& client_id,
+                                    const geometry::BatchRequest* request,
+                                    geometry::BatchResponse* response);
+
+    // Imports model bytes into the client's session and returns the new shape IDs;
+    // throws on failure. UploadModel takes this path for uploads it buffers in memory.
+    std::vector<std::string> importModelData(const std::string& client_id, const std::string& model_data,
+                                             const std::string& filename,
+                                             const geometry::ModelImportOptions& options);
+
+    // Heavy steps inside the streaming handlers: meshing one shape, and translating an
+    // uploaded model. A front end with worker lanes sets gates that run them within its
+    // lane limits; without gates they run directly on the calling thread.
+    using WorkGate = std::function<void(const std::function<void()>& work)>;
+    void setWorkGates(WorkGate meshing, WorkGate import);
+
+    // Bulk import shared by any number of reader threads: each importNextBulkFile
+    // call reads one file into the staging area and returns false once none are
+    // left; finishBulkImport then moves all staged shapes into the session at once
+    struct BulkImport {
+        explicit BulkImport(const geometry::ImportModelFilesRequest& request);
+        
+        const geometry::ImportModelFilesRequest& request;
+        std::vector<geometry::FileImportResult> results;   // In request order
+        std::vector<std::vector<std::string>> staged_ids;  // Per file
+        std::atomic<size_t> next_file{0};
+    };
+    bool importNextBulkFile(BulkImport& bulk, bool cancelled);
+    grpc::Status finishBulkImport(const std::string& client_id, BulkImport& bulk,
+                                  geometry::ImportModelFilesResponse* response, bool cancelled);
+    size_t maxConcurrentImports() const { return max_concurrent_imports_; }
+    uint64_t sessionMemoryQuotaBytes() const { return session_memory_quota_bytes_; }
+    uint64_t memoryLimitBytes() const { return memory_limit_bytes_; }
+
+    // Reads the "client-id" metadata; works for sync and callback contexts
+    static std::string getClientId(const grpc::ServerContextBase* context);
+
+    // Mesh levels of detail, LOD 0 is full quality; coarser requests are clamped
+    static constexpr uint32_t kMeshLodCount = 3;
+
+    // Tessellation cache statistics (for diagnostics and tests)
+    MeshCache::Stats getMeshCacheStats() const;
+    ModelDiskCache::Stats getModelDiskCacheStats() const;  // All zero when disabled
+    size_t getSessionCount() const;
+    size_t getShapeCount() const;  // Across all sessions
+    
+    // Estimated memory, see shape_memory.h; meshes are the tessellation cache entries
+    struct MemoryUsage {
+        uint64_t brep_bytes{0};
+        uint64_t triangulation_bytes{0};
+        uint64_t mesh_cache_bytes{0};
+        
+        uint64_t total() const { return brep_bytes + triangulation_bytes + mesh_cache_bytes; }
+    };
+    MemoryUsage getMemoryUsage() const;  // Across all sessions
+    MemoryUsage getSessionMemoryUsage(const std::string& client_id) const;
+
 private:
     struct ShapeData {
-        Handle(AIS_Shape) ais_shape;
         TopoDS_Shape topo_shape;
         geometry::Color color;
         std::string shape_id;
         bool visible{true};
         bool selected{false};
         bool highlighted{false};
+        double default_deflection{0.0};  // Linear deflection from the import precision, 0 = server default
+        uint64_t generation{nextShapeGeneration()};  // Bumped on any geometry/appearance change
+        
+        // Model disk cache entry the shape was imported into or from; its
+        // cached meshes apply while the shape is still at this generation
+        std::string disk_cache_key;
+        size_t disk_cache_index{0};
+        uint64_t disk_cache_generation{0};
+        
+        // Shapes of one import that repeat a part share a prototype: the part without
+        // its placement. Meshes come from the prototype, tessellated once for all of them.
+        std::string prototype_id;
+        TopoDS_Shape prototype_shape;
+        
+        // Estimated footprint; zero for instances whose geometry another shape of
+        // the same import already accounts for
+        uint64_t brep_bytes{0};
+        uint64_t triangulation_bytes{0};
+        
+        uint64_t memoryBytes() const { return brep_bytes + triangulation_bytes; }
+        
+        // Still placed prototype_shape; false once a transform rebuilt the geometry
+        bool isInstance() const {
+            return !prototype_id.empty() && topo_shape.TShape() == prototype_shape.TShape() &&
+                   topo_shape.Orientation() == prototype_shape.Orientation();
+        }
+    };
+    
+    // Prototype geometry one stream has sent, keyed by prototype and LOD, so later
+    // instances are sent without it
+    using SentPrototypes = std::unordered_map<std::string, std::shared_ptr<const geometry::MeshData>>;
+    
+    // Full-quality (LOD 0) tessellation parameters resolved for one request
+    struct MeshDeflection {
+        double linear{0.0};
+        double angular{0.0};
+    };
+
+    // Latest change recorded for a shape, compacted per shape ID
+    struct ShapeChange {
+        geometry::SceneChangeType type{geometry::SCENE_CHANGE_ADDED};
+        uint64_t version{0};
+    };
+
+    // Pending events for one SubscribeSceneChanges stream. Events carry only
+    // shape_id/type/version; meshes are attached on the streaming thread.
+    struct SceneSubscriber {
+        static constexpr size_t kMaxPendingEvents = 4096;
+        
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<geometry::SceneChange> pending;
+        bool closed{false};
+        
+        void push(geometry::SceneChange event) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (pending.size() >= kMaxPendingEvents) {
+                    // Slow consumer: collapse the backlog into a single resync request
+                    geometry::SceneChange reset;
+                    reset.set_type(geometry::SCENE_CHANGE_RESET);
+                    reset.set_scene_version(event.scene_version());
+                    pending.clear();
+                    pending.push_back(std::move(reset));
+                } else {
+                    pending.push_back(std::move(event));
+                }
+            }
+            cv.notify_one();
+        }
+        
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+            }
+            cv.notify_one();
+        }
+    };
+
+    // Chunked upload. Small uploads of a known size are buffered and imported straight
+    // from memory; others are spooled to disk so memory stays bounded by the chunk size.
+    struct PendingUpload {
+        explicit PendingUpload(const std::string& name) : filename(name) {}
+        ~PendingUpload() { releaseBuffer(); }
+        
+        // A buffered upload reserves its announced size against the memory limits
+        // until it completes or is dropped
+        void reserveBuffer(std::atomic<uint64_t>& server_bytes, std::atomic<uint64_t>& session_bytes,
+                           uint64_t bytes) {
+            reserved_server_bytes = &server_bytes;
+            reserved_session_bytes = &session_bytes;
+            reserved_bytes = bytes;
+        }
+        void releaseBuffer() {
+            if (reserved_bytes > 0) {
+                reserved_server_bytes->fetch_sub(reserved_bytes, std::memory_order_relaxed);
+                reserved_session_bytes->fetch_sub(reserved_bytes, std::memory_order_relaxed);
+                reserved_bytes = 0;
+            }
+        }
+        
+        std::string transfer_id;
+        std::string filename;
+        geometry::ModelImportOptions options;
+        std::string buffer;                   // Committed bytes when not spooled
+        std::optional<ScopedTempFile> spool;  // Set for uploads spooled to disk
+        std::ofstream out;
+        uint64_t total_size{0};
+        uint64_t committed{0};   // Bytes durably appended to the buffer or spool
+        uint32_t crc{0};         // Running CRC-32 of the committed bytes
+        bool active{false};      // A stream is writing; guarded by transfers_mutex
+        std::chrono::steady_clock::time_point last_write{std::chrono::steady_clock::now()};
+        std::atomic<uint64_t>* reserved_server_bytes{nullptr};
+        std::atomic<uint64_t>* reserved_session_bytes{nullptr};
+        uint64_t reserved_bytes{0};
+    };
+    
+    // Latest export of a session, kept so an interrupted download resumes on identical bytes
+    struct CompletedExport {
+        std::string transfer_id;
+        std::string filename;
+        std::shared_ptr<const std::string> data;
+        uint32_t crc{0};
     };
 
     // Client session management
     struct ClientSession {
+        static constexpr size_t kMaxTombstones = 1024;
+        static constexpr size_t kMaxPendingUploads = 4;
+        
         std::string client_id;
-        std::unordered_map<std::string, ShapeData> shapes;
+        std::unordered_map<std::string, ShapeData> shapes;  // Guarded by shapes_mutex
+        // Lock before change_log_mutex when both are needed, and never hold it while taking
+        // a session shard lock, which is taken before it (e.g. by getShapeCount)
+        mutable std::mutex shapes_mutex;
+        // Sums of the shapes' estimates, kept in step by the *ShapeLocked helpers
+        // together with the server-wide total
+        std::atomic<uint64_t> brep_bytes{0};
+        std::atomic<uint64_t> triangulation_bytes{0};
+        std::atomic<uint64_t>& server_shape_bytes;
+        std::atomic<uint64_t> upload_bytes{0};  // Reserved by buffered uploads, see PendingUpload
         std::atomic<int> shape_counter{0};
-        std::chrono::steady_clock::time_point last_activity;
+        std::atomic<std::chrono::steady_clock::time_point> last_activity;  // Touched under a shared shard lock
+        
+        // Scene change log for incremental sync. Versions come from a server-wide
+        // counter, so versions from an expired session always predate this one.
+        std::unordered_map<std::string, ShapeChange> change_log;
+        uint64_t scene_version{0};
+        uint64_t change_log_floor{0};  // Clients behind this version need a full resync
+        size_t tombstone_count{0};
+        std::vector<std::weak_ptr<SceneSubscriber>> subscribers;  // Guarded by change_log_mutex
+        std::mutex change_log_mutex;
+        
+        // Chunked transfers, guarded by transfers_mutex
+        std::unordered_map<std::string, std::shared_ptr<PendingUpload>> uploads;
+        std::optional<CompletedExport> last_export;
+        std::mutex transfers_mutex;
+        
+        // Spatial index, brought up to date from the change log before each query.
+        // Guarded by spatial_mutex, which is locked before shapes_mutex.
+        SceneSpatialIndex spatial_index;
+        uint64_t spatial_version{0};  // Scene version the index reflects
+        std::mutex spatial_mutex;
+        
+        // Camera of the client's view from UpdateCamera, guarded by camera_mutex
+        std::optional<ViewCamera> camera;
+        std::atomic<uint64_t> camera_version{0};  // Bumped on every update, read without the lock
+        std::mutex camera_mutex;
         
-        ClientSession(const std::string& id) 
+        ClientSession(const std::string& id, std::atomic<uint64_t>& server_shape_bytes) 
             : client_id(id)
-            , last_activity(std::chrono::steady_clock::now()) {}
+            , server_shape_bytes(server_shape_bytes)
+            , last_activity(std::chrono::steady_clock::now())
+            , scene_version(nextSceneVersion())
+            , change_log_floor(scene_version) {}
+        
+        // The shapes stay in server memory until the last reference to the session goes
+        ~ClientSession() {
+            server_shape_bytes.fetch_sub(shapeBytes(), std::memory_order_relaxed);
+        }
+        
+        // Must be called after the mutation of shapes has been applied
+        uint64_t recordChange(const std::string& shape_id, geometry::SceneChangeType type) {
+            std::lock_guard<std::mutex> lock(change_log_mutex);
+            return recordChangeLocked(shape_id, type);
+        }
+        
+        // recordChange for many shapes under one change_log_mutex acquisition
+        uint64_t recordChanges(const std::vector<std::pair<std::string, geometry::SceneChangeType>>& changes) {
+            std::lock_guard<std::mutex> lock(change_log_mutex);
+            for (const auto& [shape_id, type] : changes) {
+                recordChangeLocked(shape_id, type);
+            }
+            return scene_version;
+        }
+        
+        // Must be called with change_log_mutex locked
+        uint64_t recordChangeLocked(const std::string& shape_id, geometry::SceneChangeType type) {
+            scene_version = nextSceneVersion();
+            auto [it, inserted] = change_log.try_emplace(shape_id);
+            if (!inserted && it->second.type == geometry::SCENE_CHANGE_DELETED) {
+                tombstone_count--;
+            }
+            it->second.type = type;
+            it->second.version = scene_version;
+            if (type == geometry::SCENE_CHANGE_DELETED && ++tombstone_count > kMaxTombstones) {
+                compactTombstones();
+            }
+            publish(shape_id, type);
+            return scene_version;
+        }
+        
+        // Forces every client to resync from scratch (e.g. after ClearAll)
+        uint64_t recordReset() {
+            std::lock_guard<std::mutex> lock(change_log_mutex);
+            scene_version = nextSceneVersion();
+            change_log.clear();
+            tombstone_count = 0;
+            change_log_floor = scene_version;
+            publish("", geometry::SCENE_CHANGE_RESET);
+            return scene_version;
+        }
+        
+        void addSubscriber(const std::shared_ptr<SceneSubscriber>& subscriber) {
+            std::lock_guard<std::mutex> lock(change_log_mutex);
+            subscribers.push_back(subscriber);
+        }
+        
+        // A session with an open subscription stream is in use even when idle
+        bool hasSubscribers() {
+            std::lock_guard<std::mutex> lock(change_log_mutex);
+            std::erase_if(subscribers, [](const auto& weak_subscriber) { return weak_subscriber.expired(); });
+            return !subscribers.empty();
+        }
+        
+        // Ends all subscription streams, e.g. when the session is removed
+        void closeSubscribers() {
+            std::lock_guard<std::mutex> lock(change_log_mutex);
+            for (const auto& weak_subscriber : subscribers) {
+                if (auto subscriber = weak_subscriber.lock()) {
+                    subscriber->close();
+                }
+            }
+            subscribers.clear();
+        }
+        
+        // Must be called with change_log_mutex locked
+        void publish(const std::string& shape_id, geometry::SceneChangeType type) {
+            std::erase_if(subscribers, [](const auto& weak_subscriber) { return weak_subscriber.expired(); });
+            for (const auto& weak_subscriber : subscribers) {
+                if (auto subscriber = weak_subscriber.lock()) {
+                    geometry::SceneChange event;
+                    event.set_type(type);
+                    event.set_shape_id(shape_id);
+                    event.set_scene_version(scene_version);
+                    subscriber->push(std::move(event));
+                }
+            }
+        }
+        
+        // Must be called with change_log_mutex locked
+        void compactTombstones() {
+            std::erase_if(change_log, [](const auto& entry) {
+                return entry.second.type == geometry::SCENE_CHANGE_DELETED;
+            });
+            tombstone_count = 0;
+            change_log_floor = scene_version;
+        }
+        
+        // Shape map mutations that keep the memory sums right; call with shapes_mutex locked
+        void putShapeLocked(const std::string& shape_id, ShapeData shape_data) {
+            account(shape_data, true);
+            auto [it, inserted] = shapes.try_emplace(shape_id);
+            if (!inserted) {
+                account(it->second, false);
+            }
+            it->second = std::move(shape_data);
+        }
+        
+        void eraseShapeLocked(std::unordered_map<std::string, ShapeData>::iterator it) {
+            account(it->second, false);
+            shapes.erase(it);
+        }
+        
+        void clearShapesLocked() {
+            server_shape_bytes.fetch_sub(shapeBytes(), std::memory_order_relaxed);
+            shapes.clear();
+            brep_bytes.store(0, std::memory_order_relaxed);
+            triangulation_bytes.store(0, std::memory_order_relaxed);
+        }
+        
+        void setTriangulationBytesLocked(ShapeData& shape_data, uint64_t bytes) {
+            triangulation_bytes.fetch_sub(shape_data.triangulation_bytes, std::memory_order_relaxed);
+            triangulation_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            server_shape_bytes.fetch_sub(shape_data.triangulation_bytes, std::memory_order_relaxed);
+            server_shape_bytes.fetch_add(bytes, std::memory_order_relaxed);
+            shape_data.triangulation_bytes = bytes;
+        }
+        
+        void account(const ShapeData& shape_data, bool add) {
+            if (add) {
+                brep_bytes.fetch_add(shape_data.brep_bytes, std::memory_order_relaxed);
+                triangulation_bytes.fetch_add(shape_data.triangulation_bytes, std::memory_order_relaxed);
+                server_shape_bytes.fetch_add(shape_data.memoryBytes(), std::memory_order_relaxed);
+            } else {
+                brep_bytes.fetch_sub(shape_data.brep_bytes, std::memory_order_relaxed);
+                triangulation_bytes.fetch_sub(shape_data.triangulation_bytes, std::memory_order_relaxed);
+                server_shape_bytes.fetch_sub(shape_data.memoryBytes(), std::memory_order_relaxed);
+            }
+        }
+        
+        uint64_t shapeBytes() const {
+            return brep_bytes.load(std::memory_order_relaxed) + triangulation_bytes.load(std::memory_order_relaxed);
+        }
+        
+        // Copies are cheap (handles plus a color) and safe to use without the lock
+        std::optional<ShapeData> findShape(const std::string& shape_id) const {
+            std::lock_guard<std::mutex> lock(shapes_mutex);
+            auto it = shapes.find(shape_id);
+            if (it == shapes.end()) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+        
+        std::vector<ShapeData> snapshotShapes() const {
+            std::lock_guard<std::mutex> lock(shapes_mutex);
+            std::vector<ShapeData> snapshot;
+            snapshot.reserve(shapes.size());
+            for (const auto& [shape_id, shape_data] : shapes) {
+                snapshot.push_back(shape_data);
+            }
+            return snapshot;
+        }
+        
+        std::optional<ViewCamera> currentCamera() {
+            std::lock_guard<std::mutex> lock(camera_mutex);
+            return camera;
+        }
+        
+        size_t shapeCount() const {
+            std::lock_guard<std::mutex> lock(shapes_mutex);
+            return shapes.size();
+        }
         
         void updateActivity() {
-            last_activity = std::chrono::steady_clock::now();
+            last_activity.store(std::chrono::steady_clock::now(), std::memory_order_relaxed);
         }
         
         std::string generateShapeId() {
@@ -134,16 +636,83 @@ private:
     };
 
     // Internal helper methods
-    std::string getClientId(grpc::ServerContext* context) const;
+    static uint64_t nextShapeGeneration();
+    static uint64_t nextSceneVersion();
+    // Gives shapes that share a TopoDS_TShape a common prototype
+    static void assignPrototypes(std::vector<ShapeData>& shapes);
     std::string generateShapeId();  // Deprecated - use session->generateShapeId() instead
+    static std::string generateTransferId();
+    void stageShape(const std::string& shape_id, ShapeData shape_data);  // Used by the importers
     std::shared_ptr<ClientSession> getOrCreateSession(const std::string& client_id);
-    void cleanupInactiveSessions(std::chrono::minutes timeout = std::chrono::minutes(30));
-    Handle(AIS_Shape) createBoxShape(const geometry::BoxRequest& request);
-    Handle(AIS_Shape) createConeShape(const geometry::ConeRequest& request);
-    Handle(AIS_Shape) createSphereShape(const geometry::SphereRequest& request);
-    Handle(AIS_Shape) createCylinderShape(const geometry::CylinderRequest& request);
+    std::shared_ptr<ClientSession> removeSession(const std::string& client_id);
+    void retireSession(ClientSession& session);  // Closes streams and drops cached meshes
+    void evictIdleSessions();
+    void runSessionSweeper();
+    TopoDS_Shape createBoxShape(const geometry::BoxRequest& request);
+    TopoDS_Shape createConeShape(const geometry::ConeRequest& request);
+    TopoDS_Shape createSphereShape(const geometry::SphereRequest& request);
+    TopoDS_Shape createCylinderShape(const geometry::CylinderRequest& request);
+    // Fills in the shape's memory estimate, skipping sub-shapes already in counted
+    static void measureShape(ShapeData& shape_data, TopTools_MapOfShape* counted = nullptr);
+    // Reserves additional_bytes of new shapes on the server total when they fit the
+    // session quota (on top of session_pending_bytes not yet in the session, and the
+    // buffered uploads) and the server limit, else returns the reason they are refused.
+    // Call with the session's shapes_mutex locked and release the reservation once the
+    // shapes are added.
+    std::string reserveShapeMemory(const ClientSession& session, uint64_t additional_bytes,
+                                   uint64_t session_pending_bytes = 0);
+    void releaseShapeMemory(uint64_t bytes);
+    // Adds new shapes to the session if they fit the memory limits, else returns why not
+    std::string addShapesWithinLimits(ClientSession& session, std::vector<std::pair<std::string, ShapeData>> shapes);
+    // Evicts cached meshes, the session's own ones first, until the session quota and
+    // the server limit hold again
+    void enforceMemoryLimits(const std::string& client_id);
+    uint64_t totalShapeBytes() const;
+    // Caches a mesh of the client's and applies the memory limits
+    void cacheMesh(const MeshCacheKey& key, std::shared_ptr<const geometry::MeshData> mesh);
+    // Accounts the triangulation meshing at the default quality left on the shape itself
+    void recordTriangulation(const std::string& client_id, const ShapeData& shape_data);
+    // Applies a row-major 4x4 proto transform; returns false with a message on failure
+    static bool transformTopoShape(const TopoDS_Shape& shape, const geometry::Transform& transform,
+                                   TopoDS_Shape& result, std::string& error);
     
-    geometry::MeshData extractMeshData(const std::string& shape_id);
+    static MeshDeflection resolveMeshDeflection(const ShapeData& shape_data, const geometry::MeshOptions& options);
+    // For instanced shapes with MeshOptions.instancing this is the shared prototype
+    // mesh; shapeMeshMessage turns it into the shape's message
+    std::shared_ptr<const geometry::MeshData> getCachedMeshData(const std::string& client_id,
+                                                                const ShapeData& shape_data,
+                                                                const geometry::MeshOptions& options);
+    std::shared_ptr<const geometry::MeshData> getPrototypeMeshData(const std::string& client_id,
+                                                                   const ShapeData& shape_data,
+                                                                   const geometry::MeshOptions& options);
+    // The message to send for shape_data: mesh itself, or for a prototype mesh the
+    // shape's instance of it, without geometry when sent already lists it. Built
+    // messages go into scratch.
+    static const geometry::MeshData& shapeMeshMessage(const ShapeData& shape_data,
+                                                      const std::shared_ptr<const geometry::MeshData>& mesh,
+                                                      SentPrototypes* sent, geometry::MeshData& scratch);
+    // Meshes every shape, coarsening the deflections until the total fits the triangle budget
+    std::vector<std::shared_ptr<const geometry::MeshData>> getMeshesWithinBudget(
+        const std::string& client_id, const std::vector<ShapeData>& shapes,
+        const geometry::MeshOptions& options, uint64_t triangle_budget);
+    // Tessellates into per-thread scratch buffers and returns the mesh on an arena of its own
+    std::shared_ptr<geometry::MeshData> extractMeshData(const ShapeData& shape_data,
+                                                        const geometry::MeshOptions& options,
+                                                        const MeshDeflection& deflection);
+    // Applies changes since the last sync to session.spatial_index; call with spatial_mutex locked
+    void syncSpatialIndex(ClientSession& session);
+    SceneSpatialIndex::MeshLoader spatialMeshLoader(const std::string& client_id, ClientSession& session);
+    static std::optional<ViewCamera> fromProtoCamera(const geometry::ViewCamera& camera);
+    // Sends shapes in the order a client looking through camera (or later the session
+    // camera) wants them: in view and largest on screen first, shapes behind nearer
+    // geometry after those, culled ones last. Without any camera the order is kept.
+    // send returns false to stop.
+    void streamInViewOrder(const std::string& client_id, ClientSession& session, std::vector<ShapeData> shapes,
+                           std::optional<ViewCamera> camera, const std::function<bool(const ShapeData&)>& send);
+    // Bounds of each shape from the spatial index
+    std::vector<Aabb> spatialBounds(ClientSession& session, const std::vector<ShapeData>& shapes);
+    bool occludedInView(const std::string& client_id, ClientSession& session, const ViewCamera& camera,
+                        const std::string& shape_id, const Aabb& box);
     void setShapeColorInternal(const std::string& shape_id, const geometry::Color& color);
     
     // Convert between OCCT and Proto types
@@ -154,13 +723,48 @@ private:
     gp_Vec fromProtoVector(const geometry::Vector3D& vector);
     Quantity_Color fromProtoColor(const geometry::Color& color);
 
-    // Unified model file helper methods
+    // Unified model file helper methods. Importers that produce a model piece by
+    // piece hand each staged piece to the sink, if given, before reading on; the
+    // returned IDs then include shapes that have already left the staging area.
+    using StagedShapesSink = std::function<void(const std::vector<std::string>& staged_ids)>;
     std::vector<std::string> importModelFileInternal(const std::string& file_path,
-                                                     const geometry::ModelImportOptions& options);
+                                                     const geometry::ModelImportOptions& options,
+                                                     const StagedShapesSink& sink = nullptr);
+    std::vector<std::string> translateModelFile(const std::string& file_path, const std::string& format,
+                                                const geometry::ModelImportOptions& options,
+                                                const StagedShapesSink& sink);
+    // Imports into the session, adding streamed pieces as they arrive; returns the session IDs
+    std::vector<std::string> importModelIntoSession(ClientSession& session, const std::string& file_path,
+                                                    const geometry::ModelImportOptions& options);
+    // Model disk cache: stage the shapes of an entry, or collect staged shapes for a new one
+    std::vector<std::string> stageCachedModel(const std::string& cache_key);
+    void collectCachedShapes(const std::string& cache_key, const std::vector<std::string>& staged_ids,
+                             std::vector<ModelDiskCache::CachedShape>& shapes);
+    // STEP and BREP bytes are parsed from memory, other formats through a temporary file
     std::vector<std::string> importModelDataInternal(const std::string& model_data,
                                                      const std::string& filename,
                                                      const geometry::ModelImportOptions& options);
-    bool exportModelFileInternal(const std::vector<std::string>& shape_ids,
+    std::vector<std::string> importModelDataIntoSession(ClientSession& session, const std::string& model_data,
+                                                        const std::string& filename,
+                                                        const geometry::ModelImportOptions& options);
+    // Throws std::runtime_error when the shapes do not fit the memory quota or limit;
+    // parts already in counted are not accounted again
+    std::vector<std::string> adoptStagedShapes(ClientSession& session, const std::vector<std::string>& staged_ids,
+                                               double precision, TopTools_MapOfShape* counted = nullptr);
+    void discardStagedShapes(const std::vector<std::string>& staged_ids);
+    std::shared_ptr<PendingUpload> beginUpload(ClientSession& session, const geometry::ModelChunk& header,
+                                               std::string& error);
+    void receiveUpload(ClientSession& session, grpc::ServerReader<geometry::ModelChunk>* reader,
+                       geometry::UploadModelResponse* response, std::shared_ptr<PendingUpload>& upload);
+    void finishUpload(ClientSession& session, PendingUpload& upload, uint32_t expected_crc,
+                      geometry::UploadModelResponse* response);
+    // STEP and BREP, which are read from streams instead of files
+    static bool hasStreamReader(const std::string& format);
+    std::vector<std::string> importModelStreamInternal(std::istream& stream,
+                                                       const std::string& name,
+                                                       const std::string& format,
+                                                       const geometry::ModelImportOptions& options);
+    bool exportModelFileInternal(const std::vector<TopoDS_Shape>& shapes_to_export,
                                 const geometry::ModelExportOptions& options,
                                 std::string& model_data,
                                 geometry::ModelFileInfo& file_info);
@@ -175,31 +779,71 @@ private:
     // Format-specific import methods
     std::vector<std::string> importModelFileInternal_FormatSpecific(const std::string& file_path,
                                                                    const std::string& format,
-                                                                   const geometry::ModelImportOptions& options);
-    std::vector<std::string> importStlFileInternal(const std::string& file_path,
-                                                   const geometry::ModelImportOptions& options);
+                                                                   const geometry::ModelImportOptions& options,
+                                                                   const StagedShapesSink& sink);
+    // STL, OBJ and PLY through MeshStreamImporter, one shape per sub-mesh
+    std::vector<std::string> importMeshFileInternal(const std::string& file_path, const std::string& format,
+                                                    const StagedShapesSink& sink);
+    // STEP through XCAF: one shape per part occurrence, repeated parts instanced
+    std::vector<std::string> importStepFileInternal(const std::string& file_path,
+                                                    const geometry::ModelImportOptions& options);
+    // Stages the model a reader has read from a file or a stream
+    std::vector<std::string> transferStepModel(STEPCAFControl_Reader& reader,
+                                               const geometry::ModelImportOptions& options);
+    // Stages a whole BREP shape with the default import color; returns its staged ID
+    std::string stageBrepShape(const TopoDS_Shape& shape);
     std::vector<std::string> importIgesFileInternal(const std::string& file_path,
                                                     const geometry::ModelImportOptions& options);
     std::vector<std::string> importObjFileInternal(const std::string& file_path,
                                                    const geometry::ModelImportOptions& options);
-    std::vector<std::string> importPlyFileInternal(const std::string& file_path,
-                                                   const geometry::ModelImportOptions& options);
     std::vector<std::string> importGltfFileInternal(const std::string& file_path,
                                                     const geometry::ModelImportOptions& options);
     
 
     // Internal data
-    std::unordered_map<std::string, ShapeData> shapes_;  // Deprecated - for backward compatibility only
+    std::unordered_map<std::string, ShapeData> shapes_;  // Import staging area, guarded by staging_mutex_
+    std::mutex staging_mutex_;
     std::atomic<int> shape_counter_{0};  // Deprecated - use per-session counter
     
-    // Session management
-    std::unordered_map<std::string, std::shared_ptr<ClientSession>> client_sessions_;
-    mutable std::mutex sessions_mutex_;  // Protects client_sessions_
-    std::chrono::steady_clock::time_point last_cleanup_;
+    // Session registry, sharded by client ID so concurrent clients rarely share a lock
+    static constexpr size_t kSessionShards = 16;
+    struct SessionShard {
+        std::unordered_map<std::string, std::shared_ptr<ClientSession>> sessions;
+        mutable std::shared_mutex mutex;
+    };
+    SessionShard& shardFor(const std::string& client_id);
+    const SessionShard& shardFor(const std::string& client_id) const;
+    std::shared_ptr<ClientSession> findSession(const std::string& client_id) const;  // Null when none
+    // Shape bytes of all live sessions plus reservations, declared first so it outlives them
+    std::atomic<uint64_t> shape_bytes_{0};
+    std::array<SessionShard, kSessionShards> session_shards_;
+    
+    // Background idle-session eviction
+    std::chrono::milliseconds session_idle_timeout_;
+    std::chrono::milliseconds session_sweep_interval_;
+    std::thread session_sweeper_;
+    std::mutex sweeper_mutex_;
+    std::condition_variable sweeper_cv_;
+    bool stopping_{false};
     
     bool connected_{true};  // Service connection status
+    bool parallel_meshing_{true};
+    size_t max_concurrent_imports_{1};  // Reader threads of a sync ImportModelFiles call
+    uint64_t session_memory_quota_bytes_{0};  // 0 = unlimited
+    uint64_t memory_limit_bytes_{0};
+    MeshStreamImporter::Options mesh_import_options_;
+    WorkGate meshing_gate_;  // Set before serving, see setWorkGates
+    WorkGate import_gate_;
+    static void runGated(const WorkGate& gate, const std::function<void()>& work);
     
-    // OCCT context
-    Handle(AIS_InteractiveContext) context_;
-    Handle(V3d_Viewer) viewer_;
+    // Finished meshes keyed by client, shape, generation and deflection
+    MeshCache mesh_cache_;
+    // Meshing at the default quality writes the triangulation and normals onto the
+    // shape's own faces, which instances share with their prototype. Callers meshing
+    // the same TopoDS_TShape take the same stripe, so one tessellates and the others
+    // reuse its triangulation.
+    static constexpr size_t kMeshingLockStripes = 64;
+    std::mutex& meshingMutexFor(const TopoDS_Shape& shape);
+    std::array<std::mutex, kMeshingLockStripes> meshing_mutexes_;
+    std::unique_ptr<ModelDiskCache> model_disk_cache_;  // Null when disabled
 };
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "mesh_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+void hashCombine(size_t& seed, size_t value) {
+    seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+} // namespace
+
+size_t MeshCacheKeyHash::operator()(const MeshCacheKey& key) const {
+    size_t seed = std::hash<std::string>{}(key.client_id);
+    hashCombine(seed, std::hash<std::string>{}(key.shape_id));
+    hashCombine(seed, std::hash<uint64_t>{}(key.generation));
+    hashCombine(seed, std::hash<double>{}(key.linear_deflection));
+    hashCombine(seed, std::hash<double>{}(key.angular_deflection));
+    hashCombine(seed, std::hash<uint32_t>{}(key.lod));
+    hashCombine(seed, std::hash<int>{}(static_cast<int>(key.encoding)));
+    hashCombine(seed, std::hash<bool>{}(key.include_normals));
+    return seed;
+}
+
+MeshCache::MeshCache(size_t budget_bytes)
+    : budget_bytes_(budget_bytes) {}
+
+std::shared_ptr<const geometry::MeshData> MeshCache::find(const MeshCacheKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        misses_++;
+        return nullptr;
+    }
+
+    // Move to front of LRU list
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->mesh;
+}
+
+void MeshCache::insert(const MeshCacheKey& key, std::shared_ptr<const geometry::MeshData> mesh) {
+    if (!mesh) {
+        return;
+    }
+    size_t bytes = mesh->ByteSizeLong();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bytes > budget_bytes_) {
+        return;
+    }
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        eraseEntry(it->second);
+    }
+
+    lru_.push_front(Entry{key, std::move(mesh), bytes});
+    index_[key] = lru_.begin();
+    bytes_ += bytes;
+    ClientEntries& client = clients_[key.client_id];
+    client.bytes += bytes;
+    client.shapes[key.shape_id].push_back(lru_.begin());
+    evictToBudget();
+}
+
+void MeshCache::invalidateShape(const std::string& client_id, const std::string& shape_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    eraseShapeEntries(client_id, shape_id);
+}
+
+void MeshCache::invalidateShapes(const std::string& client_id, const std::vector<std::string>& shape_ids) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& shape_id : shape_ids) {
+        eraseShapeEntries(client_id, shape_id);
+    }
+}
+
+void MeshCache::invalidateClient(const std::string& client_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto client = clients_.find(client_id);
+    if (client == clients_.end()) {
+        return;
+    }
+    std::vector<EntryList::iterator> entries;
+    for (const auto& [shape_id, shape_entries] : client->second.shapes) {
+        entries.insert(entries.end(), shape_entries.begin(), shape_entries.end());
+    }
+    for (auto entry : entries) {
+        eraseEntry(entry);
+    }
+}
+
+void MeshCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    lru_.clear();
+    bytes_ = 0;
+    clients_.clear();
+}
+
+size_t MeshCache::clientBytes(const std::string& client_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = clients_.find(client_id);
+    return it == clients_.end() ? 0 : it->second.bytes;
+}
+
+size_t MeshCache::evictClient(const std::string& client_id, size_t target_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto client = clients_.find(client_id);
+    if (client == clients_.end() || client->second.bytes <= target_bytes) {
+        return 0;
+    }
+    const size_t excess = client->second.bytes - target_bytes;
+    size_t freed = 0;
+    for (auto it = lru_.end(); it != lru_.begin() && freed < excess;) {
+        auto entry = std::prev(it);
+        if (entry->key.client_id == client_id) {
+            freed += entry->bytes;
+            eraseEntry(entry);
+            evictions_++;
+        } else {
+            it = entry;
+        }
+    }
+    return freed;
+}
+
+size_t MeshCache::shrinkTo(size_t target_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t before = bytes_;
+    while (bytes_ > target_bytes && !lru_.empty()) {
+        eraseEntry(std::prev(lru_.end()));
+        evictions_++;
+    }
+    return before - bytes_;
+}
+
+void MeshCache::setBudget(size_t budget_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_bytes_ = budget_bytes;
+    evictToBudget();
+}
+
+MeshCache::Stats MeshCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entries = index_.size();
+    stats.bytes = bytes_;
+    stats.budget_bytes = budget_bytes_;
+    return stats;
+}
+
+void MeshCache::evictToBudget() {
+    while (bytes_ > budget_bytes_ && !lru_.empty()) {
+        eraseEntry(std::prev(lru_.end()));
+        evictions_++;
+    }
+}
+
+void MeshCache::eraseEntry(EntryList::iterator it) {
+    bytes_ -= it->bytes;
+    auto client = clients_.find(it->key.client_id);
+    if (client != clients_.end()) {
+        client->second.bytes -= it->bytes;
+        auto shape = client->second.shapes.find(it->key.shape_id);
+        if (shape != client->second.shapes.end()) {
+            auto& entries = shape->second;
+            entries.erase(std::find(entries.begin(), entries.end(), it));
+            if (entries.empty()) {
+                client->second.shapes.erase(shape);
+            }
+        }
+        if (client->second.shapes.empty()) {
+            clients_.erase(client);
+        }
+    }
+    index_.erase(it->key);
+    lru_.erase(it);
+}
+
+void MeshCache::eraseShapeEntries(const std::string& client_id, const std::string& shape_id) {
+    auto client = clients_.find(client_id);
+    if (client == clients_.end()) {
+        return;
+    }
+    auto shape = client->second.shapes.find(shape_id);
+    if (shape == client->second.shapes.end()) {
+        return;
+    }
+    // Copied: erasing the last entry drops the shape and possibly the client
+    const std::vector<EntryList::iterator> entries = shape->second;
+    for (auto entry : entries) {
+        eraseEntry(entry);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "geometry_types.pb.h"
+
+// Identifies one tessellated result. The generation changes whenever the
+// shape geometry or appearance changes, so stale entries are never hit and
+// simply age out of the LRU.
+struct MeshCacheKey {
+    std::string client_id;
+    std::string shape_id;
+    uint64_t generation{0};
+    double linear_deflection{0.0};
+    double angular_deflection{0.0};
+    uint32_t lod{0};
+    geometry::MeshEncoding encoding{geometry::MESH_ENCODING_LEGACY};
+    bool include_normals{true};
+
+    bool operator==(const MeshCacheKey& other) const = default;
+};
+
+struct MeshCacheKeyHash {
+    size_t operator()(const MeshCacheKey& key) const;
+};
+
+// Thread-safe LRU cache of finished MeshData messages, bounded by the
+// serialized size of the cached messages.
+class MeshCache {
+public:
+    static constexpr size_t kDefaultBudgetBytes = 256ull * 1024 * 1024;
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t entries{0};
+        size_t bytes{0};
+        size_t budget_bytes{0};
+    };
+
+    explicit MeshCache(size_t budget_bytes = kDefaultBudgetBytes);
+
+    // Returns nullptr on miss
+    std::shared_ptr<const geometry::MeshData> find(const MeshCacheKey& key);
+
+    // Entries larger than the whole budget are not cached
+    void insert(const MeshCacheKey& key, std::shared_ptr<const geometry::MeshData> mesh);
+
+    // Cost is proportional to the entries dropped, not to the size of the cache
+    void invalidateShape(const std::string& client_id, const std::string& shape_id);
+    void invalidateShapes(const std::string& client_id, const std::vector<std::string>& shape_ids);
+    void invalidateClient(const std::string& client_id);
+    void clear();
+
+    // Bytes cached for one client, for per-session memory accounting
+    size_t clientBytes(const std::string& client_id) const;
+    // Evict least recently used entries until the client holds at most
+    // target_bytes, or the whole cache at most target_bytes; return the bytes freed
+    size_t evictClient(const std::string& client_id, size_t target_bytes);
+    size_t shrinkTo(size_t target_bytes);
+
+    // A budget of 0 disables caching
+    void setBudget(size_t budget_bytes);
+    Stats stats() const;
+
+private:
+    struct Entry {
+        MeshCacheKey key;
+        std::shared_ptr<const geometry::MeshData> mesh;
+        size_t bytes{0};
+    };
+    using EntryList = std::list<Entry>;
+
+    // Entries of one client by shape, so invalidation does not walk the LRU
+    struct ClientEntries {
+        size_t bytes{0};
+        std::unordered_map<std::string, std::vector<EntryList::iterator>> shapes;
+    };
+
+    // Must be called with mutex_ locked
+    void evictToBudget();
+    void eraseEntry(EntryList::iterator it);
+    void eraseShapeEntries(const std::string& client_id, const std::string& shape_id);
+
+    EntryList lru_;  // Most recently used at the front
+    std::unordered_map<MeshCacheKey, EntryList::iterator, MeshCacheKeyHash> index_;
+    size_t budget_bytes_;
+    size_t bytes_{0};
+    std::unordered_map<std::string, ClientEntries> clients_;  // Clients with cached entries only
+    uint64_t hits_{0};
+    uint64_t misses_{0};
+    uint64_t evictions_{0};
+    mutable std::mutex mutex_;
+};
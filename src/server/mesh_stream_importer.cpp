@@ -0,0 +1,767 @@
+#include "mesh_stream_importer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <Poly_Triangle.hxx>
+#include <gp_Pnt.hxx>
+
+namespace {
+
+using Point = std::array<double, 3>;
+
+// Read-only mapping of a whole file. Parsers report their progress through
+// release() so resident memory does not grow with the file size.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        LARGE_INTEGER size{};
+        if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size)) {
+            close();
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ > 0) {
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            data_ = mapping_ ? static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        }
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        page_size_ = info.dwPageSize;
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        struct stat status{};
+        if (fd_ < 0 || ::fstat(fd_, &status) != 0) {
+            close();
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+        size_ = static_cast<size_t>(status.st_size);
+        if (size_ > 0) {
+            void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+            if (data != MAP_FAILED) {
+                data_ = static_cast<const char*>(data);
+                ::madvise(data, size_, MADV_SEQUENTIAL);
+            }
+        }
+        page_size_ = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+        if (size_ > 0 && !data_) {
+            close();
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+    }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // The current pass no longer needs the pages before offset
+    void release(size_t offset) {
+        static constexpr size_t kReleaseStep = 32 * 1024 * 1024;
+        offset = std::min(offset, size_) / page_size_ * page_size_;
+        if (offset < released_ + kReleaseStep) {
+            return;
+        }
+        char* begin = const_cast<char*>(data_) + released_;
+#if defined(_WIN32)
+        VirtualUnlock(begin, offset - released_);  // Drops unlocked pages from the working set
+#else
+        ::madvise(begin, offset - released_, MADV_DONTNEED);
+#endif
+        released_ = offset;
+    }
+
+    // Starts another pass over the file
+    void rewind() { released_ = 0; }
+
+private:
+    void close() {
+#if defined(_WIN32)
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+    }
+
+#if defined(_WIN32)
+    HANDLE file_{INVALID_HANDLE_VALUE};
+    HANDLE mapping_{nullptr};
+#else
+    int fd_{-1};
+#endif
+    const char* data_{nullptr};
+    size_t size_{0};
+    size_t page_size_{4096};
+    size_t released_{0};
+};
+
+struct Bounds {
+    Point min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+              std::numeric_limits<double>::max()};
+    Point max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(),
+              std::numeric_limits<double>::lowest()};
+
+    void add(const Point& p) {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], p[i]);
+            max[i] = std::max(max[i], p[i]);
+        }
+    }
+
+    bool empty() const { return min[0] > max[0]; }
+};
+
+// Sorts triangles into a grid over the model bounds. Every cell welds its own
+// vertices and is emitted as a triangulation once it holds a full chunk; when
+// too many triangles wait in partly filled cells, the fullest one goes early.
+class SpatialChunker {
+public:
+    SpatialChunker(const Bounds& bounds, size_t expected_triangles,
+                   const MeshStreamImporter::Options& options, const MeshStreamImporter::ChunkSink& sink)
+        : sink_(sink)
+        , max_chunk_(std::max<size_t>(1, options.max_chunk_triangles))
+        , max_pending_(max_chunk_ * std::max<size_t>(1, options.max_pending_chunks)) {
+        Point extent{};
+        double diagonal = 0.0;
+        for (int i = 0; i < 3; ++i) {
+            origin_[i] = bounds.min[i];
+            extent[i] = std::max(0.0, bounds.max[i] - bounds.min[i]);
+            diagonal += extent[i] * extent[i];
+        }
+        diagonal = std::sqrt(diagonal);
+
+        // Welding snaps positions to a grid, at most 21 bits per axis so a key packs into 64 bits
+        double tolerance = options.weld_tolerance > 0.0 ? options.weld_tolerance : diagonal * 1e-6;
+        double max_extent = std::max({extent[0], extent[1], extent[2]});
+        weld_step_ = std::max({tolerance, max_extent / static_cast<double>(kWeldMask - 1),
+                               std::numeric_limits<double>::min()});
+
+        // About one chunk per cell; flat axes (e.g. a planar scan) get a single cell
+        size_t target_cells = std::max<size_t>(1, (expected_triangles + max_chunk_ - 1) / max_chunk_);
+        int active_axes = 0;
+        double volume = 1.0;
+        for (int i = 0; i < 3; ++i) {
+            if (extent[i] > diagonal * 1e-3) {
+                active_axes++;
+                volume *= extent[i];
+            }
+        }
+        double edge = active_axes > 0 ? std::pow(volume / static_cast<double>(target_cells), 1.0 / active_axes) : 0.0;
+        for (int i = 0; i < 3; ++i) {
+            dims_[i] = 1;
+            if (edge > 0.0 && extent[i] > diagonal * 1e-3) {
+                dims_[i] = static_cast<size_t>(std::clamp(std::ceil(extent[i] / edge), 1.0,
+                                                          static_cast<double>(kMaxCellsPerAxis)));
+            }
+            cell_scale_[i] = extent[i] > 0.0 ? static_cast<double>(dims_[i]) / extent[i] : 0.0;
+        }
+    }
+
+    void add(const Point& a, const Point& b, const Point& c) {
+        size_t cell_index = 0;
+        for (int i = 0; i < 3; ++i) {
+            double centroid = (a[i] + b[i] + c[i]) / 3.0;
+            double position = std::max(0.0, (centroid - origin_[i]) * cell_scale_[i]);
+            cell_index = cell_index * dims_[i] + std::min(dims_[i] - 1, static_cast<size_t>(position));
+        }
+
+        auto it = cells_.try_emplace(cell_index).first;
+        Cell& cell = it->second;
+        uint32_t i0 = weld(cell, a);
+        uint32_t i1 = weld(cell, b);
+        uint32_t i2 = weld(cell, c);
+        if (i0 == i1 || i1 == i2 || i0 == i2) {
+            return;  // Collapsed by welding
+        }
+        cell.triangles.insert(cell.triangles.end(), {i0, i1, i2});
+        pending_++;
+
+        if (cell.triangles.size() / 3 >= max_chunk_) {
+            emit(it);
+        } else if (pending_ > max_pending_) {
+            auto fullest = std::max_element(cells_.begin(), cells_.end(), [](const auto& x, const auto& y) {
+                return x.second.triangles.size() < y.second.triangles.size();
+            });
+            emit(fullest);
+        }
+    }
+
+    MeshStreamImporter::Result finish() {
+        std::vector<size_t> remaining;
+        remaining.reserve(cells_.size());
+        for (const auto& [cell_index, cell] : cells_) {
+            remaining.push_back(cell_index);
+        }
+        std::sort(remaining.begin(), remaining.end());  // Neighbouring cells one after another
+        for (size_t cell_index : remaining) {
+            emit(cells_.find(cell_index));
+        }
+        return result_;
+    }
+
+private:
+    static constexpr uint64_t kWeldMask = (1ull << 21) - 1;
+    static constexpr size_t kMaxCellsPerAxis = 64;
+
+    struct Cell {
+        std::vector<float> nodes;         // x, y, z per vertex
+        std::vector<uint32_t> triangles;  // Three node indices per triangle
+        std::unordered_map<uint64_t, uint32_t> welded;  // Snapped position to node index
+    };
+    using CellMap = std::unordered_map<size_t, Cell>;
+
+    uint32_t weld(Cell& cell, const Point& p) {
+        uint64_t key = 0;
+        for (int i = 0; i < 3; ++i) {
+            double steps = std::clamp(std::round((p[i] - origin_[i]) / weld_step_), 0.0, static_cast<double>(kWeldMask));
+            key = (key << 21) | static_cast<uint64_t>(steps);
+        }
+        auto [it, inserted] = cell.welded.try_emplace(key, static_cast<uint32_t>(cell.nodes.size() / 3));
+        if (inserted) {
+            cell.nodes.insert(cell.nodes.end(), {static_cast<float>(p[0]), static_cast<float>(p[1]),
+                                                 static_cast<float>(p[2])});
+        }
+        return it->second;
+    }
+
+    void emit(CellMap::iterator it) {
+        const Cell& cell = it->second;
+        const int node_count = static_cast<int>(cell.nodes.size() / 3);
+        const int triangle_count = static_cast<int>(cell.triangles.size() / 3);
+
+        Handle(Poly_Triangulation) chunk = new Poly_Triangulation();
+        chunk->SetDoublePrecision(false);  // Mesh files carry single precision anyway
+        chunk->ResizeNodes(node_count, Standard_False);
+        chunk->ResizeTriangles(triangle_count, Standard_False);
+        for (int n = 0; n < node_count; ++n) {
+            chunk->SetNode(n + 1, gp_Pnt(cell.nodes[3 * n], cell.nodes[3 * n + 1], cell.nodes[3 * n + 2]));
+        }
+        for (int t = 0; t < triangle_count; ++t) {
+            chunk->SetTriangle(t + 1, Poly_Triangle(static_cast<int>(cell.triangles[3 * t]) + 1,
+                                                    static_cast<int>(cell.triangles[3 * t + 1]) + 1,
+                                                    static_cast<int>(cell.triangles[3 * t + 2]) + 1));
+        }
+
+        pending_ -= static_cast<size_t>(triangle_count);
+        result_.triangles += static_cast<size_t>(triangle_count);
+        result_.chunks++;
+        cells_.erase(it);
+        sink_(chunk);
+    }
+
+    const MeshStreamImporter::ChunkSink& sink_;
+    size_t max_chunk_;
+    size_t max_pending_;
+    Point origin_{};
+    std::array<size_t, 3> dims_{1, 1, 1};
+    Point cell_scale_{};
+    double weld_step_{1.0};
+    CellMap cells_;
+    size_t pending_{0};
+    MeshStreamImporter::Result result_;
+};
+
+// Polygons are split into triangle fans
+void addPolygon(SpatialChunker& chunker, const std::vector<Point>& polygon) {
+    for (size_t i = 2; i < polygon.size(); ++i) {
+        chunker.add(polygon[0], polygon[i - 1], polygon[i]);
+    }
+}
+
+// Text parsing straight from the mapping, one line at a time
+
+bool nextLine(const char*& pos, const char* end, std::string_view& line) {
+    if (pos >= end) {
+        return false;
+    }
+    const char* eol = static_cast<const char*>(std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+    const char* line_end = eol ? eol : end;
+    line = std::string_view(pos, static_cast<size_t>(line_end - pos));
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    pos = eol ? eol + 1 : end;
+    return true;
+}
+
+std::string_view nextToken(std::string_view& rest) {
+    size_t start = rest.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        rest = {};
+        return {};
+    }
+    size_t stop = rest.find_first_of(" \t", start);
+    std::string_view token = rest.substr(start, stop == std::string_view::npos ? stop : stop - start);
+    rest = stop == std::string_view::npos ? std::string_view() : rest.substr(stop);
+    return token;
+}
+
+bool parseDouble(std::string_view token, double& value) {
+    char buffer[64];
+    if (token.empty() || token.size() >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+    char* parsed_end = nullptr;
+    value = std::strtod(buffer, &parsed_end);
+    return parsed_end == buffer + token.size();
+}
+
+bool parsePoint(std::string_view rest, Point& p) {
+    return parseDouble(nextToken(rest), p[0]) && parseDouble(nextToken(rest), p[1]) &&
+           parseDouble(nextToken(rest), p[2]);
+}
+
+template <typename T>
+T loadValue(const char* data, bool swap_bytes) {
+    std::array<char, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), data, sizeof(T));
+    if (swap_bytes) {
+        std::reverse(bytes.begin(), bytes.end());
+    }
+    T value;
+    std::memcpy(&value, bytes.data(), sizeof(T));
+    return value;
+}
+
+// STL: binary files are recognised by their exact size, as some start with "solid" too
+
+constexpr size_t kStlHeaderSize = 84;
+constexpr size_t kStlTriangleSize = 50;
+
+MeshStreamImporter::Result readBinaryStl(MappedFile& file, const MeshStreamImporter::Options& options,
+                                         const MeshStreamImporter::ChunkSink& sink) {
+    const bool swap_bytes = std::endian::native == std::endian::big;
+    const size_t count = std::min<size_t>(loadValue<uint32_t>(file.data() + 80, swap_bytes),
+                                          (file.size() - kStlHeaderSize) / kStlTriangleSize);
+    auto vertex = [&](size_t triangle, int corner) {
+        const char* record = file.data() + kStlHeaderSize + triangle * kStlTriangleSize + 12 + corner * 12;
+        return Point{loadValue<float>(record, swap_bytes), loadValue<float>(record + 4, swap_bytes),
+                     loadValue<float>(record + 8, swap_bytes)};
+    };
+
+    Bounds bounds;
+    for (size_t t = 0; t < count; ++t) {
+        bounds.add(vertex(t, 0));
+        bounds.add(vertex(t, 1));
+        bounds.add(vertex(t, 2));
+        file.release(kStlHeaderSize + t * kStlTriangleSize);
+    }
+    if (bounds.empty()) {
+        return {};
+    }
+
+    file.rewind();
+    SpatialChunker chunker(bounds, count, options, sink);
+    for (size_t t = 0; t < count; ++t) {
+        chunker.add(vertex(t, 0), vertex(t, 1), vertex(t, 2));
+        file.release(kStlHeaderSize + t * kStlTriangleSize);
+    }
+    return chunker.finish();
+}
+
+MeshStreamImporter::Result readAsciiStl(MappedFile& file, const MeshStreamImporter::Options& options,
+                                        const MeshStreamImporter::ChunkSink& sink) {
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    std::string_view line;
+
+    Bounds bounds;
+    size_t vertex_count = 0;
+    for (const char* pos = begin; nextLine(pos, end, line);) {
+        std::string_view rest = line;
+        Point p;
+        if (nextToken(rest) == "vertex" && parsePoint(rest, p)) {
+            bounds.add(p);
+            vertex_count++;
+        }
+        file.release(static_cast<size_t>(pos - begin));
+    }
+    if (bounds.empty()) {
+        return {};
+    }
+
+    file.rewind();
+    SpatialChunker chunker(bounds, vertex_count / 3, options, sink);
+    std::vector<Point> loop;
+    for (const char* pos = begin; nextLine(pos, end, line);) {
+        std::string_view rest = line;
+        std::string_view keyword = nextToken(rest);
+        Point p;
+        if (keyword == "vertex") {
+            if (!parsePoint(rest, p)) {
+                throw std::runtime_error("Malformed STL vertex");
+            }
+            loop.push_back(p);
+        } else if (keyword == "endloop") {
+            addPolygon(chunker, loop);
+            loop.clear();
+        } else if (keyword == "outer") {
+            loop.clear();
+        }
+        file.release(static_cast<size_t>(pos - begin));
+    }
+    return chunker.finish();
+}
+
+MeshStreamImporter::Result readStl(MappedFile& file, const MeshStreamImporter::Options& options,
+                                   const MeshStreamImporter::ChunkSink& sink) {
+    if (file.size() >= kStlHeaderSize) {
+        uint32_t count = loadValue<uint32_t>(file.data() + 80, std::endian::native == std::endian::big);
+        if (kStlHeaderSize + static_cast<uint64_t>(count) * kStlTriangleSize == file.size()) {
+            return readBinaryStl(file, options, sink);
+        }
+    }
+    std::string_view head(file.data(), std::min<size_t>(file.size(), 512));
+    size_t start = head.find_first_not_of(" \t\r\n");
+    if (start != std::string_view::npos && head.substr(start, 5) == "solid") {
+        return readAsciiStl(file, options, sink);
+    }
+    if (file.size() >= kStlHeaderSize) {
+        return readBinaryStl(file, options, sink);  // Truncated or padded binary file
+    }
+    throw std::runtime_error("Not an STL file");
+}
+
+// OBJ: faces index a global vertex list, so positions are kept (as floats) for the face pass
+
+MeshStreamImporter::Result readObj(MappedFile& file, const MeshStreamImporter::Options& options,
+                                   const MeshStreamImporter::ChunkSink& sink) {
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    std::string_view line;
+
+    std::vector<float> positions;
+    Bounds bounds;
+    size_t expected_triangles = 0;
+    for (const char* pos = begin; nextLine(pos, end, line);) {
+        std::string_view rest = line;
+        std::string_view keyword = nextToken(rest);
+        if (keyword == "v") {
+            Point p;
+            if (!parsePoint(rest, p)) {
+                throw std::runtime_error("Malformed OBJ vertex");
+            }
+            positions.insert(positions.end(), {static_cast<float>(p[0]), static_cast<float>(p[1]),
+                                               static_cast<float>(p[2])});
+            bounds.add({positions[positions.size() - 3], positions[positions.size() - 2], positions.back()});
+        } else if (keyword == "f") {
+            expected_triangles++;
+        }
+        file.release(static_cast<size_t>(pos - begin));
+    }
+    if (bounds.empty()) {
+        return {};
+    }
+
+    file.rewind();
+    SpatialChunker chunker(bounds, expected_triangles, options, sink);
+    const int64_t vertex_total = static_cast<int64_t>(positions.size() / 3);
+    int64_t vertices_seen = 0;  // Negative indices count back from here
+    std::vector<Point> polygon;
+    for (const char* pos = begin; nextLine(pos, end, line);) {
+        std::string_view rest = line;
+        std::string_view keyword = nextToken(rest);
+        if (keyword == "v") {
+            vertices_seen++;
+        } else if (keyword == "f") {
+            polygon.clear();
+            for (std::string_view token = nextToken(rest); !token.empty(); token = nextToken(rest)) {
+                token = token.substr(0, token.find('/'));  // Texture and normal indices are not used
+                int64_t index = 0;
+                auto parsed = std::from_chars(token.data(), token.data() + token.size(), index);
+                index = index < 0 ? vertices_seen + index : index - 1;
+                if (parsed.ec != std::errc() || index < 0 || index >= vertex_total) {
+                    throw std::runtime_error("OBJ face index out of range");
+                }
+                const float* p = positions.data() + 3 * index;
+                polygon.push_back({p[0], p[1], p[2]});
+            }
+            addPolygon(chunker, polygon);
+        }
+        file.release(static_cast<size_t>(pos - begin));
+    }
+    return chunker.finish();
+}
+
+// PLY: ASCII and both binary byte orders; the vertex element must precede the faces
+
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+std::optional<PlyType> parsePlyType(std::string_view name) {
+    if (name == "char" || name == "int8") return PlyType::Int8;
+    if (name == "uchar" || name == "uint8") return PlyType::UInt8;
+    if (name == "short" || name == "int16") return PlyType::Int16;
+    if (name == "ushort" || name == "uint16") return PlyType::UInt16;
+    if (name == "int" || name == "int32") return PlyType::Int32;
+    if (name == "uint" || name == "uint32") return PlyType::UInt32;
+    if (name == "float" || name == "float32") return PlyType::Float32;
+    if (name == "double" || name == "float64") return PlyType::Float64;
+    return std::nullopt;
+}
+
+struct PlyProperty {
+    std::string name;
+    PlyType type{PlyType::Float32};
+    PlyType count_type{PlyType::UInt8};  // List properties only
+    bool is_list{false};
+};
+
+struct PlyElement {
+    std::string name;
+    size_t count{0};
+    std::vector<PlyProperty> properties;
+};
+
+// Property values of a PLY body, read one at a time
+class PlyValueReader {
+public:
+    enum class Format { Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+    PlyValueReader(MappedFile& file, size_t offset, Format format)
+        : file_(file)
+        , pos_(file.data() + offset)
+        , end_(file.data() + file.size())
+        , format_(format)
+        , swap_bytes_((format == Format::BinaryBigEndian) != (std::endian::native == std::endian::big)) {}
+
+    double read(PlyType type) {
+        double value = 0.0;
+        if (format_ == Format::Ascii ? !readText(value) : !readBinary(type, value)) {
+            throw std::runtime_error("Unexpected end of PLY data");
+        }
+        return value;
+    }
+
+    void release() { file_.release(static_cast<size_t>(pos_ - file_.data())); }
+
+private:
+    bool readText(double& value) {
+        while (pos_ < end_ && std::isspace(static_cast<unsigned char>(*pos_))) {
+            ++pos_;
+        }
+        const char* start = pos_;
+        while (pos_ < end_ && !std::isspace(static_cast<unsigned char>(*pos_))) {
+            ++pos_;
+        }
+        return parseDouble(std::string_view(start, static_cast<size_t>(pos_ - start)), value);
+    }
+
+    bool readBinary(PlyType type, double& value) {
+        static constexpr size_t kSizes[] = {1, 1, 2, 2, 4, 4, 4, 8};
+        size_t size = kSizes[static_cast<int>(type)];
+        if (static_cast<size_t>(end_ - pos_) < size) {
+            return false;
+        }
+        switch (type) {
+            case PlyType::Int8: value = loadValue<int8_t>(pos_, false); break;
+            case PlyType::UInt8: value = loadValue<uint8_t>(pos_, false); break;
+            case PlyType::Int16: value = loadValue<int16_t>(pos_, swap_bytes_); break;
+            case PlyType::UInt16: value = loadValue<uint16_t>(pos_, swap_bytes_); break;
+            case PlyType::Int32: value = loadValue<int32_t>(pos_, swap_bytes_); break;
+            case PlyType::UInt32: value = loadValue<uint32_t>(pos_, swap_bytes_); break;
+            case PlyType::Float32: value = loadValue<float>(pos_, swap_bytes_); break;
+            case PlyType::Float64: value = loadValue<double>(pos_, swap_bytes_); break;
+        }
+        pos_ += size;
+        return true;
+    }
+
+    MappedFile& file_;
+    const char* pos_;
+    const char* end_;
+    Format format_;
+    bool swap_bytes_;
+};
+
+MeshStreamImporter::Result readPly(MappedFile& file, const MeshStreamImporter::Options& options,
+                                   const MeshStreamImporter::ChunkSink& sink) {
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    const char* pos = begin;
+    std::string_view line;
+    if (!nextLine(pos, end, line) || line != "ply") {
+        throw std::runtime_error("Not a PLY file");
+    }
+
+    std::optional<PlyValueReader::Format> format;
+    std::vector<PlyElement> elements;
+    bool header_done = false;
+    while (!header_done && nextLine(pos, end, line)) {
+        std::string_view rest = line;
+        std::string_view keyword = nextToken(rest);
+        if (keyword == "format") {
+            std::string_view name = nextToken(rest);
+            if (name == "ascii") format = PlyValueReader::Format::Ascii;
+            if (name == "binary_little_endian") format = PlyValueReader::Format::BinaryLittleEndian;
+            if (name == "binary_big_endian") format = PlyValueReader::Format::BinaryBigEndian;
+        } else if (keyword == "element") {
+            PlyElement element;
+            element.name = std::string(nextToken(rest));
+            std::string_view count = nextToken(rest);
+            std::from_chars(count.data(), count.data() + count.size(), element.count);
+            elements.push_back(std::move(element));
+        } else if (keyword == "property" && !elements.empty()) {
+            PlyProperty property;
+            std::string_view type = nextToken(rest);
+            std::optional<PlyType> count_type;
+            if (type == "list") {
+                property.is_list = true;
+                count_type = parsePlyType(nextToken(rest));
+                type = nextToken(rest);
+            }
+            std::optional<PlyType> value_type = parsePlyType(type);
+            if (!value_type || (property.is_list && !count_type)) {
+                throw std::runtime_error("Unsupported PLY property type");
+            }
+            property.type = *value_type;
+            property.count_type = count_type.value_or(PlyType::UInt8);
+            property.name = std::string(nextToken(rest));
+            elements.back().properties.push_back(std::move(property));
+        } else if (keyword == "end_header") {
+            header_done = true;
+        }
+    }
+    if (!header_done || !format) {
+        throw std::runtime_error("Malformed PLY header");
+    }
+
+    PlyValueReader reader(file, static_cast<size_t>(pos - begin), *format);
+    std::vector<float> positions;
+    Bounds bounds;
+    std::optional<SpatialChunker> chunker;
+    std::vector<Point> polygon;
+    for (const PlyElement& element : elements) {
+        const bool is_vertex = element.name == "vertex";
+        const bool is_face = element.name == "face";
+        int axis_of[3] = {-1, -1, -1};
+        int index_list = -1;
+        for (size_t p = 0; p < element.properties.size(); ++p) {
+            const PlyProperty& property = element.properties[p];
+            if (is_vertex && !property.is_list && property.name.size() == 1 && property.name[0] >= 'x' &&
+                property.name[0] <= 'z') {
+                axis_of[property.name[0] - 'x'] = static_cast<int>(p);
+            }
+            if (is_face && property.is_list &&
+                (index_list < 0 || property.name == "vertex_indices" || property.name == "vertex_index")) {
+                index_list = static_cast<int>(p);
+            }
+        }
+        if (is_vertex && (axis_of[0] < 0 || axis_of[1] < 0 || axis_of[2] < 0)) {
+            throw std::runtime_error("PLY vertices without x, y and z");
+        }
+        if (is_face && index_list >= 0) {
+            if (bounds.empty()) {
+                throw std::runtime_error("PLY faces must follow the vertices");
+            }
+            chunker.emplace(bounds, element.count, options, sink);
+        }
+
+        const int64_t vertex_total = static_cast<int64_t>(positions.size() / 3);
+        for (size_t item = 0; item < element.count; ++item) {
+            Point vertex{};
+            polygon.clear();
+            for (size_t p = 0; p < element.properties.size(); ++p) {
+                const PlyProperty& property = element.properties[p];
+                if (!property.is_list) {
+                    double value = reader.read(property.type);
+                    for (int axis = 0; axis < 3; ++axis) {
+                        if (axis_of[axis] == static_cast<int>(p)) {
+                            vertex[axis] = value;
+                        }
+                    }
+                    continue;
+                }
+                auto count = static_cast<size_t>(reader.read(property.count_type));
+                for (size_t i = 0; i < count; ++i) {
+                    double value = reader.read(property.type);
+                    if (chunker && static_cast<int>(p) == index_list) {
+                        auto index = static_cast<int64_t>(value);
+                        if (index < 0 || index >= vertex_total) {
+                            throw std::runtime_error("PLY face index out of range");
+                        }
+                        const float* v = positions.data() + 3 * index;
+                        polygon.push_back({v[0], v[1], v[2]});
+                    }
+                }
+            }
+            if (is_vertex) {
+                positions.insert(positions.end(), {static_cast<float>(vertex[0]), static_cast<float>(vertex[1]),
+                                                   static_cast<float>(vertex[2])});
+                bounds.add({positions[positions.size() - 3], positions[positions.size() - 2], positions.back()});
+            } else if (chunker) {
+                addPolygon(*chunker, polygon);
+            }
+            reader.release();
+        }
+        if (chunker) {
+            return chunker->finish();  // Later elements carry nothing we use
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+bool MeshStreamImporter::supportsFormat(const std::string& format) {
+    return format == "STL" || format == "OBJ" || format == "PLY";
+}
+
+MeshStreamImporter::Result MeshStreamImporter::importFile(const std::string& file_path, const std::string& format,
+                                                          const Options& options, const ChunkSink& sink) {
+    MappedFile file(file_path);
+    Result result;
+    if (format == "STL") {
+        result = readStl(file, options, sink);
+    } else if (format == "OBJ") {
+        result = readObj(file, options, sink);
+    } else if (format == "PLY") {
+        result = readPly(file, options, sink);
+    } else {
+        throw std::runtime_error("No streaming reader for format: " + format);
+    }
+    if (result.triangles == 0) {
+        throw std::runtime_error("No triangles found in " + format + " file");
+    }
+    return result;
+}
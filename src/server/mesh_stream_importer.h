@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include <Poly_Triangulation.hxx>
+
+// Bounded-memory reader for triangle mesh files (STL, OBJ, PLY). The file is
+// memory-mapped and parsed front to back, giving pages back once they are
+// consumed. Triangles are sorted into a coarse spatial grid over the model;
+// each grid cell collects its triangles with duplicate vertices merged and is
+// handed to the sink as a separate triangulation as soon as it is full, so the
+// first parts of a large scan are available while the rest is still read.
+class MeshStreamImporter {
+public:
+    static constexpr size_t kDefaultChunkTriangles = 256 * 1024;
+
+    struct Options {
+        size_t max_chunk_triangles{kDefaultChunkTriangles};
+        // Triangles held in partly filled cells, in chunks; beyond this the fullest cell is emitted early
+        size_t max_pending_chunks{16};
+        // Vertices closer than this are merged; 0 = 1e-6 of the model's bounding box diagonal
+        double weld_tolerance{0.0};
+    };
+
+    struct Result {
+        size_t triangles{0};  // Emitted, after dropping triangles degenerated by welding
+        size_t chunks{0};
+    };
+
+    using ChunkSink = std::function<void(const Handle(Poly_Triangulation)& chunk)>;
+
+    static bool supportsFormat(const std::string& format);
+
+    // Chunks are emitted on the calling thread; throws std::runtime_error if the
+    // file cannot be parsed or holds no triangles
+    static Result importFile(const std::string& file_path, const std::string& format,
+                             const Options& options, const ChunkSink& sink);
+};
@@ -0,0 +1,176 @@
+#include "metrics_exporter.h"
+
+#include <iterator>
+#include <vector>
+
+#include <spdlog/fmt/fmt.h>
+
+#include "common/grpc_performance_monitor.h"
+#include "geometry_service_impl.h"
+#include "process_memory.h"
+
+namespace {
+
+// Histogram bucket upper bounds in seconds, from sub-millisecond RPCs to long imports
+const std::vector<double> kLatencyBoundsSeconds{0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                                0.1,    0.25,  0.5,    1.0,   2.5,  5.0,   10.0, 30.0, 60.0};
+
+std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '"': escaped += "\\\""; break;
+            case '\n': escaped += "\\n"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+class TextWriter {
+public:
+    void family(const char* name, const char* type, const char* help) {
+        fmt::format_to(std::back_inserter(text_), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+    }
+
+    template<typename Value>
+    void sample(const std::string& name, const std::string& labels, Value value) {
+        if (labels.empty()) {
+            fmt::format_to(std::back_inserter(text_), "{} {}\n", name, value);
+        } else {
+            fmt::format_to(std::back_inserter(text_), "{}{{{}}} {}\n", name, labels, value);
+        }
+    }
+
+    void histogram(const std::string& name, const std::string& labels,
+                   const GrpcPerformanceMonitor::OperationMetrics& operation, double sum_seconds) {
+        static const std::vector<double> bounds_ns = [] {
+            std::vector<double> bounds;
+            for (double seconds : kLatencyBoundsSeconds) {
+                bounds.push_back(seconds * 1e9);
+            }
+            return bounds;
+        }();
+        const auto cumulative = operation.histogram().cumulativeCounts(bounds_ns);
+        const std::string prefix = labels.empty() ? "" : labels + ",";
+        for (size_t i = 0; i < kLatencyBoundsSeconds.size(); ++i) {
+            sample(name + "_bucket", fmt::format("{}le=\"{}\"", prefix, kLatencyBoundsSeconds[i]), cumulative[i]);
+        }
+        sample(name + "_bucket", prefix + "le=\"+Inf\"", cumulative.back());
+        sample(name + "_sum", labels, sum_seconds);
+        sample(name + "_count", labels, cumulative.back());
+    }
+
+    std::string take() { return std::move(text_); }
+
+private:
+    std::string text_;
+};
+
+struct Exported {
+    std::string label;  // Method or stage name after the prefix
+    const GrpcPerformanceMonitor::OperationMetrics* operation;
+    GrpcPerformanceMonitor::OperationStats stats;
+};
+
+} // namespace
+
+std::string MetricsExporter::prometheusText() const {
+    const std::string rpc_prefix = "Server.";
+    const std::string stage_prefix = "Stage.";
+    std::vector<Exported> rpcs;
+    std::vector<Exported> stages;
+    GrpcPerformanceMonitor& monitor = GrpcPerformanceMonitor::getInstance();
+    monitor.forEachOperation([&](const GrpcPerformanceMonitor::OperationMetrics& operation) {
+        const std::string& name = operation.name();
+        if (name.rfind(rpc_prefix, 0) == 0) {
+            rpcs.push_back({name.substr(rpc_prefix.size()), &operation, operation.snapshot()});
+        } else if (name.rfind(stage_prefix, 0) == 0) {
+            stages.push_back({name.substr(stage_prefix.size()), &operation, operation.snapshot()});
+        }
+    });
+
+    TextWriter out;
+    out.family("geometry_rpc_duration_seconds", "histogram", "Server-side RPC latency, start to final status");
+    for (const auto& rpc : rpcs) {
+        out.histogram("geometry_rpc_duration_seconds", "method=\"" + escapeLabel(rpc.label) + "\"",
+                      *rpc.operation, rpc.stats.total_time_ms / 1000.0);
+    }
+    out.family("geometry_rpc_requests_total", "counter", "Finished RPCs by outcome");
+    for (const auto& rpc : rpcs) {
+        const std::string method = "method=\"" + escapeLabel(rpc.label) + "\"";
+        out.sample("geometry_rpc_requests_total", method + ",outcome=\"ok\"", rpc.stats.success_count);
+        out.sample("geometry_rpc_requests_total", method + ",outcome=\"error\"", rpc.stats.error_count);
+    }
+    out.family("geometry_rpc_received_bytes_total", "counter", "Protobuf bytes of RPC requests");
+    for (const auto& rpc : rpcs) {
+        out.sample("geometry_rpc_received_bytes_total", "method=\"" + escapeLabel(rpc.label) + "\"",
+                   rpc.stats.total_bytes_received);
+    }
+    out.family("geometry_rpc_sent_bytes_total", "counter", "Protobuf bytes of RPC responses");
+    for (const auto& rpc : rpcs) {
+        out.sample("geometry_rpc_sent_bytes_total", "method=\"" + escapeLabel(rpc.label) + "\"",
+                   rpc.stats.total_bytes_sent);
+    }
+    out.family("geometry_stage_duration_seconds", "histogram", "Latency of server processing stages");
+    for (const auto& stage : stages) {
+        out.histogram("geometry_stage_duration_seconds", "stage=\"" + escapeLabel(stage.label) + "\"",
+                      *stage.operation, stage.stats.total_time_ms / 1000.0);
+    }
+
+    out.family("geometry_active_sessions", "gauge", "Client sessions");
+    out.sample("geometry_active_sessions", "", service_.getSessionCount());
+    out.family("geometry_shapes", "gauge", "Shapes across all sessions");
+    out.sample("geometry_shapes", "", service_.getShapeCount());
+    const auto memory = service_.getMemoryUsage();
+    out.family("geometry_accounted_memory_bytes", "gauge", "Estimated memory of shapes and cached meshes by kind");
+    out.sample("geometry_accounted_memory_bytes", "kind=\"brep\"", memory.brep_bytes);
+    out.sample("geometry_accounted_memory_bytes", "kind=\"triangulation\"", memory.triangulation_bytes);
+    out.sample("geometry_accounted_memory_bytes", "kind=\"mesh_cache\"", memory.mesh_cache_bytes);
+    out.family("geometry_memory_limit_bytes", "gauge", "Server-wide limit on accounted memory, 0 when unlimited");
+    out.sample("geometry_memory_limit_bytes", "", service_.memoryLimitBytes());
+
+    struct CacheStats {
+        const char* name;
+        uint64_t hits, misses, evictions, entries, bytes, budget_bytes;
+    };
+    const auto mesh_cache = service_.getMeshCacheStats();
+    const auto disk_cache = service_.getModelDiskCacheStats();
+    const CacheStats caches[] = {
+        {"mesh", mesh_cache.hits, mesh_cache.misses, mesh_cache.evictions, mesh_cache.entries, mesh_cache.bytes,
+         mesh_cache.budget_bytes},
+        {"model_disk", disk_cache.hits, disk_cache.misses, disk_cache.evictions, disk_cache.entries, disk_cache.bytes,
+         disk_cache.budget_bytes},
+    };
+    auto per_cache = [&](const char* name, const char* type, const char* help, auto value) {
+        out.family(name, type, help);
+        for (const auto& cache : caches) {
+            out.sample(name, fmt::format("cache=\"{}\"", cache.name), value(cache));
+        }
+    };
+    per_cache("geometry_cache_hits_total", "counter", "Cache lookups that found an entry",
+              [](const CacheStats& cache) { return cache.hits; });
+    per_cache("geometry_cache_misses_total", "counter", "Cache lookups that found nothing",
+              [](const CacheStats& cache) { return cache.misses; });
+    per_cache("geometry_cache_evictions_total", "counter", "Entries evicted to stay within budget",
+              [](const CacheStats& cache) { return cache.evictions; });
+    per_cache("geometry_cache_hit_ratio", "gauge", "Hits over lookups since start, 0 before any lookup",
+              [](const CacheStats& cache) {
+                  const uint64_t lookups = cache.hits + cache.misses;
+                  return lookups > 0 ? static_cast<double>(cache.hits) / lookups : 0.0;
+              });
+    per_cache("geometry_cache_entries", "gauge", "Entries held",
+              [](const CacheStats& cache) { return cache.entries; });
+    per_cache("geometry_cache_bytes", "gauge", "Bytes held",
+              [](const CacheStats& cache) { return cache.bytes; });
+    per_cache("geometry_cache_budget_bytes", "gauge", "Byte budget, 0 when the cache is disabled",
+              [](const CacheStats& cache) { return cache.budget_bytes; });
+
+    out.family("geometry_resident_memory_bytes", "gauge", "Server process resident set size, 0 where unsupported");
+    out.sample("geometry_resident_memory_bytes", "", residentMemoryBytes());
+    out.family("geometry_uptime_seconds", "gauge", "Seconds since the monitor was started or reset");
+    out.sample("geometry_uptime_seconds", "", monitor.getUptimeSeconds());
+    return out.take();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+class GeometryServiceImpl;
+
+// Server metrics in the Prometheus text exposition format: per-RPC latency
+// histograms, call counts by outcome and bytes each way (from the RPC metrics
+// interceptor), per-stage latency histograms (from StageSpan), and session,
+// shape and cache gauges read from the service at scrape time.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(const GeometryServiceImpl& service) : service_(service) {}
+
+    std::string prometheusText() const;
+
+private:
+    const GeometryServiceImpl& service_;
+};
@@ -0,0 +1,181 @@
+#include "metrics_http_server.h"
+
+#include <spdlog/spdlog.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+using socklen_t = int;
+#define CLOSE_SOCKET closesocket
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using socket_t = int;
+#define CLOSE_SOCKET close
+#endif
+
+namespace {
+
+constexpr size_t kMaxRequestBytes = 8192;
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;  // A scraper hanging up must not raise SIGPIPE
+#else
+constexpr int kSendFlags = 0;
+#endif
+constexpr int kPollIntervalMs = 200;  // How quickly stop() is noticed
+
+// Waits up to kPollIntervalMs for the socket to become readable
+bool waitReadable(socket_t socket) {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(socket, &readable);
+    timeval timeout{0, kPollIntervalMs * 1000};
+    return select(static_cast<int>(socket) + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+void sendAll(socket_t socket, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        const auto n = send(socket, data.data() + sent, static_cast<int>(data.size() - sent), kSendFlags);
+        if (n <= 0) {
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string response(const char* status, const std::string& content_type, const std::string& body) {
+    return std::string("HTTP/1.1 ") + status + "\r\nContent-Type: " + content_type +
+           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+MetricsHttpServer::~MetricsHttpServer() {
+    stop();
+}
+
+void MetricsHttpServer::addRoute(const std::string& path, const std::string& content_type, Handler handler) {
+    routes_[path] = Route{content_type, std::move(handler)};
+}
+
+bool MetricsHttpServer::start(const std::string& address) {
+#ifdef _WIN32
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        return false;
+    }
+#endif
+    const size_t colon = address.rfind(':');
+    const std::string host = colon == std::string::npos ? "0.0.0.0" : address.substr(0, colon);
+    const std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* resolved = nullptr;
+    if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &resolved) != 0 || !resolved) {
+        spdlog::error("MetricsHttpServer: Cannot resolve {}", address);
+        return false;
+    }
+
+    socket_t listener = socket(resolved->ai_family, resolved->ai_socktype, resolved->ai_protocol);
+    bool bound = false;
+    if (listener != static_cast<socket_t>(-1)) {
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        bound = bind(listener, resolved->ai_addr, static_cast<socklen_t>(resolved->ai_addrlen)) == 0 &&
+                listen(listener, 16) == 0;
+    }
+    freeaddrinfo(resolved);
+    if (!bound) {
+        if (listener != static_cast<socket_t>(-1)) {
+            CLOSE_SOCKET(listener);
+        }
+        spdlog::error("MetricsHttpServer: Cannot listen on {}", address);
+        return false;
+    }
+
+    sockaddr_in local{};
+    socklen_t length = sizeof(local);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&local), &length);
+    port_ = ntohs(local.sin_port);
+    listen_socket_ = static_cast<intptr_t>(listener);
+    running_ = true;
+    thread_ = std::thread(&MetricsHttpServer::serve, this);
+    return true;
+}
+
+void MetricsHttpServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    CLOSE_SOCKET(static_cast<socket_t>(listen_socket_));
+    listen_socket_ = -1;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void MetricsHttpServer::serve() {
+    const auto listener = static_cast<socket_t>(listen_socket_);
+    while (running_) {
+        if (!waitReadable(listener)) {
+            continue;
+        }
+        socket_t connection = accept(listener, nullptr, nullptr);
+        if (connection == static_cast<socket_t>(-1)) {
+            continue;
+        }
+        handleConnection(static_cast<intptr_t>(connection));
+        CLOSE_SOCKET(connection);
+    }
+}
+
+void MetricsHttpServer::handleConnection(intptr_t connection_handle) {
+    const auto connection = static_cast<socket_t>(connection_handle);
+
+    // Only the request line matters; read until the end of the headers
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        if (!waitReadable(connection)) {
+            return;  // Idle client
+        }
+        const auto n = recv(connection, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    const size_t method_end = request.find(' ');
+    const size_t path_end = method_end == std::string::npos ? std::string::npos : request.find(' ', method_end + 1);
+    if (path_end == std::string::npos || request.compare(0, method_end, "GET") != 0) {
+        sendAll(connection, response("405 Method Not Allowed", "text/plain", "Only GET is supported\n"));
+        return;
+    }
+    std::string path = request.substr(method_end + 1, path_end - method_end - 1);
+    path = path.substr(0, path.find('?'));
+
+    auto route = routes_.find(path);
+    if (route == routes_.end()) {
+        sendAll(connection, response("404 Not Found", "text/plain", "Not found\n"));
+        return;
+    }
+    try {
+        sendAll(connection, response("200 OK", route->second.content_type, route->second.handler()));
+    } catch (const std::exception& e) {
+        spdlog::error("MetricsHttpServer: Handler for {} failed: {}", path, e.what());
+        sendAll(connection, response("500 Internal Server Error", "text/plain", "Internal error\n"));
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+// Minimal HTTP/1.1 GET endpoint for metrics scrapers, on its own thread.
+// Connections are served one at a time and closed after the response, which
+// suits a scraper polling every few seconds; it is not a general web server.
+class MetricsHttpServer {
+public:
+    // Produces the response body; called on the server thread for every request
+    using Handler = std::function<std::string()>;
+
+    MetricsHttpServer() = default;
+    ~MetricsHttpServer();
+
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+    // Routes must be added before start(); other paths answer 404
+    void addRoute(const std::string& path, const std::string& content_type, Handler handler);
+
+    // Listens on "host:port"; port 0 picks a free one. False if the socket cannot be bound.
+    bool start(const std::string& address);
+    void stop();
+
+    uint16_t port() const { return port_; }
+
+private:
+    struct Route {
+        std::string content_type;
+        Handler handler;
+    };
+
+    void serve();
+    void handleConnection(intptr_t connection);
+
+    std::map<std::string, Route> routes_;
+    intptr_t listen_socket_{-1};
+    uint16_t port_{0};
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+};
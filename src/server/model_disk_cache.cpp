@@ -0,0 +1,368 @@
+#include "model_disk_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+
+#include <BRep_Builder.hxx>
+#include <BinTools.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <spdlog/spdlog.h>
+
+#include "common/utils.h"
+
+namespace fs = std::filesystem;
+using occt_imgui::common::Utils;
+
+namespace {
+
+constexpr const char* kManifestName = "manifest";
+constexpr const char* kManifestHeader = "occt-model-cache 2";
+constexpr const char* kShapesName = "shapes.brep";
+constexpr const char* kTempMarker = ".tmp-";
+
+// Unique sibling name for writing before the atomic rename into place
+fs::path tempPathFor(const fs::path& target) {
+    static std::atomic<uint64_t> counter{0};
+    return fs::path(target.string() + kTempMarker +
+                    std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + "_" +
+                    std::to_string(counter.fetch_add(1)));
+}
+
+uint64_t directorySize(const fs::path& directory) {
+    uint64_t bytes = 0;
+    std::error_code ec;
+    for (const auto& file : fs::directory_iterator(directory, ec)) {
+        if (file.is_regular_file(ec)) {
+            bytes += file.file_size(ec);
+        }
+    }
+    return bytes;
+}
+
+bool readFile(const fs::path& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+bool writeFile(const fs::path& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return file && file.write(data.data(), static_cast<std::streamsize>(data.size())) && file.flush();
+}
+
+} // namespace
+
+ModelDiskCache::ModelDiskCache(fs::path directory, uint64_t budget_bytes)
+    : directory_(std::move(directory))
+    , budget_bytes_(budget_bytes) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+    if (ec) {
+        spdlog::error("ModelDiskCache: Cannot create {}: {}", directory_.string(), ec.message());
+        return;
+    }
+
+    // Rebuild the LRU order from the manifest times; leftovers of interrupted writes are removed
+    std::vector<std::pair<fs::file_time_type, Entry>> found;
+    for (const auto& item : fs::directory_iterator(directory_, ec)) {
+        std::string name = item.path().filename().string();
+        if (name.find(kTempMarker) != std::string::npos) {
+            fs::remove_all(item.path(), ec);
+            continue;
+        }
+        auto manifest_time = fs::last_write_time(item.path() / kManifestName, ec);
+        if (ec || !item.is_directory()) {
+            continue;
+        }
+        found.push_back({manifest_time, Entry{name, directorySize(item.path())}});
+    }
+    std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [time, entry] : found) {
+        bytes_ += entry.bytes;
+        lru_.push_back(std::move(entry));
+        index_[lru_.back().key] = std::prev(lru_.end());
+    }
+    evictToBudget({});
+    spdlog::info("ModelDiskCache: {} entries ({} MB) in {}", index_.size(), bytes_ / (1024 * 1024),
+                directory_.string());
+}
+
+std::string ModelDiskCache::makeKey(const std::string& file_path, const std::string& format,
+                                    const geometry::ModelImportOptions& options) {
+    std::ifstream file(file_path, std::ios::binary);
+    if (!file) {
+        return {};
+    }
+
+    // Two independent content hashes make an accidental collision practically impossible
+    std::string buffer(1 << 20, '\0');
+    uint64_t content_hash = Utils::kFnv1a64Offset;
+    uint32_t content_crc = 0;
+    uint64_t size = 0;
+    while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0) {
+        size_t count = static_cast<size_t>(file.gcount());
+        content_hash = Utils::Fnv1a64(buffer.data(), count, content_hash);
+        content_crc = Utils::Crc32(buffer.data(), count, content_crc);
+        size += count;
+    }
+    if (file.bad()) {
+        return {};
+    }
+    return makeKey(content_hash, content_crc, size, format, options);
+}
+
+std::string ModelDiskCache::makeDataKey(const std::string& data, const std::string& format,
+                                        const geometry::ModelImportOptions& options) {
+    return makeKey(Utils::Fnv1a64(data.data(), data.size(), Utils::kFnv1a64Offset),
+                   Utils::Crc32(data.data(), data.size()), data.size(), format, options);
+}
+
+std::string ModelDiskCache::makeKey(uint64_t content_hash, uint32_t content_crc, uint64_t size,
+                                    const std::string& format, const geometry::ModelImportOptions& options) {
+    // Only the options that change the translated result
+    std::ostringstream settings;
+    settings << format << '|' << options.precision() << '|' << options.merge_shapes() << '|'
+             << options.import_colors() << '|' << options.import_names() << '|' << size;
+    const std::string settings_text = settings.str();
+    uint64_t settings_hash = Utils::Fnv1a64(settings_text.data(), settings_text.size());
+
+    char key[64];
+    std::snprintf(key, sizeof(key), "%016llx%08x-%016llx", static_cast<unsigned long long>(content_hash),
+                  content_crc, static_cast<unsigned long long>(settings_hash));
+    return key;
+}
+
+bool ModelDiskCache::loadShapes(const std::string& key, std::vector<CachedShape>& shapes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.find(key) == index_.end()) {
+            misses_++;
+            return false;
+        }
+    }
+
+    // Files are read without the lock; an entry evicted meanwhile reads as damaged
+    const fs::path entry = entryPath(key);
+    std::ifstream manifest(entry / kManifestName);
+    std::string header;
+    size_t count = 0;
+    std::string label;
+    bool ok = std::getline(manifest, header) && header == kManifestHeader &&
+              (manifest >> label >> count) && label == "shapes";
+
+    shapes.clear();
+    for (size_t i = 0; ok && i < count; ++i) {
+        CachedShape cached;
+        float r = 0.0f, g = 0.0f, b = 0.0f, a = 1.0f;
+        ok = static_cast<bool>(manifest >> r >> g >> b >> a);
+        cached.color.set_r(r);
+        cached.color.set_g(g);
+        cached.color.set_b(b);
+        cached.color.set_a(a);
+        shapes.push_back(std::move(cached));
+    }
+    
+    // All shapes are read from one compound, so parts they shared are shared again
+    TopoDS_Shape compound;
+    const std::string shapes_file = (entry / kShapesName).string();
+    ok = ok && BinTools::Read(compound, shapes_file.c_str()) && !compound.IsNull();
+    size_t read = 0;
+    for (TopoDS_Iterator it(compound); ok && it.More() && read < shapes.size(); it.Next()) {
+        shapes[read++].shape = it.Value();
+    }
+    ok = ok && read == count;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (!ok || count == 0) {
+        spdlog::warn("ModelDiskCache: Dropping damaged entry {}", key);
+        if (it != index_.end()) {
+            eraseEntry(it->second);
+        }
+        misses_++;
+        shapes.clear();
+        return false;
+    }
+    if (it != index_.end()) {
+        touch(it->second);
+    }
+    hits_++;
+    return true;
+}
+
+void ModelDiskCache::storeShapes(const std::string& key, const std::vector<CachedShape>& shapes) {
+    if (key.empty() || shapes.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.count(key)) {
+            return;
+        }
+    }
+
+    // Written into a temporary directory, then renamed into place in one step
+    const fs::path entry = entryPath(key);
+    const fs::path temp = tempPathFor(entry);
+    std::error_code ec;
+    fs::create_directories(temp, ec);
+    bool ok = !ec;
+
+    std::ostringstream manifest;
+    manifest << kManifestHeader << '\n' << "shapes " << shapes.size() << '\n';
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    for (const CachedShape& shape : shapes) {
+        builder.Add(compound, shape.shape);
+        const geometry::Color& color = shape.color;
+        manifest << color.r() << ' ' << color.g() << ' ' << color.b() << ' ' << color.a() << '\n';
+    }
+    // One file keeps parts shared between shapes written once. Triangulations are
+    // kept for mesh-only shapes (STL, OBJ); translated CAD shapes are not meshed yet
+    // at this point.
+    const std::string shapes_file = (temp / kShapesName).string();
+    ok = ok && BinTools::Write(compound, shapes_file.c_str(), Standard_True, Standard_False,
+                               BinTools_FormatVersion_CURRENT);
+    ok = ok && writeFile(temp / kManifestName, manifest.str());
+    if (ok) {
+        fs::rename(temp, entry, ec);
+        ok = !ec;
+    }
+    if (!ok) {
+        fs::remove_all(temp, ec);
+        spdlog::warn("ModelDiskCache: Could not store entry {}", key);
+        return;
+    }
+
+    uint64_t bytes = directorySize(entry);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.count(key)) {
+        return;
+    }
+    if (bytes > budget_bytes_) {
+        fs::remove_all(entry, ec);  // Larger than the whole budget
+        return;
+    }
+    lru_.push_front(Entry{key, bytes});
+    index_[key] = lru_.begin();
+    bytes_ += bytes;
+    evictToBudget(key);
+}
+
+bool ModelDiskCache::loadMesh(const std::string& key, size_t index, geometry::MeshEncoding encoding,
+                              bool include_normals, geometry::MeshData& mesh) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.find(key) == index_.end()) {
+            return false;
+        }
+    }
+
+    std::string data;
+    bool ok = readFile(entryPath(key) / meshFileName(index, encoding, include_normals), data) &&
+              mesh.ParseFromString(data);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (ok && it != index_.end()) {
+        touch(it->second);
+        hits_++;
+        return true;
+    }
+    misses_++;
+    return false;
+}
+
+void ModelDiskCache::storeMesh(const std::string& key, size_t index, geometry::MeshEncoding encoding,
+                               bool include_normals, const geometry::MeshData& mesh) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index_.find(key) == index_.end()) {
+            return;  // Evicted meanwhile
+        }
+    }
+
+    const fs::path target = entryPath(key) / meshFileName(index, encoding, include_normals);
+    const fs::path temp = tempPathFor(target);
+    const std::string data = mesh.SerializeAsString();
+    std::error_code ec;
+    if (!writeFile(temp, data)) {
+        fs::remove(temp, ec);
+        return;
+    }
+    bool existed = fs::exists(target, ec);
+    fs::rename(temp, target, ec);
+    if (ec) {
+        fs::remove(temp, ec);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end() && !existed) {
+        it->second->bytes += data.size();
+        bytes_ += data.size();
+        evictToBudget(key);
+    }
+}
+
+ModelDiskCache::Stats ModelDiskCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entries = index_.size();
+    stats.bytes = bytes_;
+    stats.budget_bytes = budget_bytes_;
+    return stats;
+}
+
+fs::path ModelDiskCache::entryPath(const std::string& key) const {
+    return directory_ / key;
+}
+
+std::string ModelDiskCache::meshFileName(size_t index, geometry::MeshEncoding encoding, bool include_normals) {
+    return "mesh_" + std::to_string(index) + "_" + std::to_string(static_cast<int>(encoding)) +
+           (include_normals ? "_n" : "") + ".pb";
+}
+
+void ModelDiskCache::touch(EntryList::iterator it) {
+    lru_.splice(lru_.begin(), lru_, it);
+    // The manifest time carries the LRU order across restarts
+    std::error_code ec;
+    fs::last_write_time(entryPath(it->key) / kManifestName, fs::file_time_type::clock::now(), ec);
+}
+
+void ModelDiskCache::evictToBudget(const std::string& keep) {
+    for (auto it = lru_.end(); bytes_ > budget_bytes_ && it != lru_.begin();) {
+        --it;
+        if (it->key == keep) {
+            continue;
+        }
+        auto victim = it++;
+        eraseEntry(victim);
+        evictions_++;
+    }
+}
+
+void ModelDiskCache::eraseEntry(EntryList::iterator it) {
+    std::error_code ec;
+    fs::remove_all(entryPath(it->key), ec);
+    bytes_ -= it->bytes;
+    index_.erase(it->key);
+    lru_.erase(it);
+}
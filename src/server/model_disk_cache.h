@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+
+#include "geometry_service.pb.h"
+#include "geometry_types.pb.h"
+
+// Content-addressed on-disk cache of imported models. An entry is keyed by the
+// hash of the source file plus the import options that affect the result, and
+// holds the translated shapes in OCCT binary BRep format and, once requested,
+// their full-quality packed meshes. Entries survive server restarts and are
+// evicted least recently used first when the directory exceeds its budget.
+class ModelDiskCache {
+public:
+    static constexpr uint64_t kDefaultBudgetBytes = 2ull * 1024 * 1024 * 1024;
+
+    struct CachedShape {
+        TopoDS_Shape shape;
+        geometry::Color color;
+    };
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t entries{0};
+        uint64_t bytes{0};
+        uint64_t budget_bytes{0};
+    };
+
+    // Picks up the entries already in directory
+    ModelDiskCache(std::filesystem::path directory, uint64_t budget_bytes = kDefaultBudgetBytes);
+
+    // Key for importing file_path as format with options; empty if the file cannot be read
+    static std::string makeKey(const std::string& file_path, const std::string& format,
+                               const geometry::ModelImportOptions& options);
+    // The same key for the file's content already in memory
+    static std::string makeDataKey(const std::string& data, const std::string& format,
+                                   const geometry::ModelImportOptions& options);
+
+    // Returns false on miss or a damaged entry, which is then dropped
+    bool loadShapes(const std::string& key, std::vector<CachedShape>& shapes);
+    void storeShapes(const std::string& key, const std::vector<CachedShape>& shapes);
+
+    // Full-quality mesh of shape index in an entry, stored per encoding and normals choice
+    bool loadMesh(const std::string& key, size_t index, geometry::MeshEncoding encoding,
+                  bool include_normals, geometry::MeshData& mesh);
+    void storeMesh(const std::string& key, size_t index, geometry::MeshEncoding encoding,
+                   bool include_normals, const geometry::MeshData& mesh);
+
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t bytes{0};
+    };
+    using EntryList = std::list<Entry>;
+
+    // Combines the content hashes with the settings that change the translated result
+    static std::string makeKey(uint64_t content_hash, uint32_t content_crc, uint64_t size,
+                               const std::string& format, const geometry::ModelImportOptions& options);
+    std::filesystem::path entryPath(const std::string& key) const;
+    static std::string meshFileName(size_t index, geometry::MeshEncoding encoding, bool include_normals);
+
+    // Must be called with mutex_ locked
+    void touch(EntryList::iterator it);
+    void evictToBudget(const std::string& keep);
+    void eraseEntry(EntryList::iterator it);
+
+    std::filesystem::path directory_;
+    uint64_t budget_bytes_;
+
+    mutable std::mutex mutex_;
+    EntryList lru_;  // Most recently used at the front
+    std::unordered_map<std::string, EntryList::iterator> index_;
+    uint64_t bytes_{0};
+    uint64_t hits_{0};
+    uint64_t misses_{0};
+    uint64_t evictions_{0};
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+// Resident set size of this process in bytes, 0 where it cannot be read
+uint64_t residentMemoryBytes();
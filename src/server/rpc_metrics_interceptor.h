@@ -0,0 +1,15 @@
+#pragma once
+
+#include <grpcpp/support/server_interceptor.h>
+
+// Records every RPC of a server in GrpcPerformanceMonitor as "Server.<Method>":
+// latency from the call's start to its completion, protobuf bytes each way and
+// whether the final status was OK. Response serialization is timed as the
+// "Serialize" stage (see StageSpan). Covers sync and callback services alike;
+// every service on the server must use protobuf messages (no ByteBuffer or
+// generic services), as message sizes are read through MessageLite.
+// Register with ServerBuilder::experimental().SetInterceptorCreators().
+class RpcMetricsInterceptorFactory : public grpc::experimental::ServerInterceptorFactoryInterface {
+public:
+    grpc::experimental::Interceptor* CreateServerInterceptor(grpc::experimental::ServerRpcInfo* info) override;
+};
@@ -0,0 +1,36 @@
+#include "scoped_temp_file.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+ScopedTempFile::ScopedTempFile(const std::string& filename) {
+    static std::atomic<uint64_t> counter{0};
+    const std::string unique = "occt_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+                               "_" + std::to_string(counter.fetch_add(1)) + "_" +
+                               std::filesystem::path(filename).filename().string();
+    path_ = std::filesystem::temp_directory_path() / unique;
+}
+
+ScopedTempFile::~ScopedTempFile() {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+}
+
+void ScopedTempFile::write(const std::string& data) const {
+    std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+        throw std::runtime_error("Failed to write temporary file: " + path_.string());
+    }
+}
+
+std::string ScopedTempFile::read() const {
+    std::ifstream file(path_, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to read temporary file: " + path_.string());
+    }
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
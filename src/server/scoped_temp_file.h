@@ -0,0 +1,26 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+// Uniquely named file in the system temp directory, removed on destruction.
+// Used for model readers/writers without a stream entry point and for
+// spooling chunked uploads to disk.
+class ScopedTempFile {
+public:
+    // Only the last path component of filename is kept, as a readable suffix
+    explicit ScopedTempFile(const std::string& filename);
+    ~ScopedTempFile();
+
+    ScopedTempFile(const ScopedTempFile&) = delete;
+    ScopedTempFile& operator=(const ScopedTempFile&) = delete;
+
+    std::string path() const { return path_.string(); }
+
+    // Replaces the file content; throws std::runtime_error on failure
+    void write(const std::string& data) const;
+    std::string read() const;
+
+private:
+    std::filesystem::path path_;
+};
@@ -0,0 +1,146 @@
+#include "shape_memory.h"
+
+#include <BRep_Tool.hxx>
+#include <Geom_BezierCurve.hxx>
+#include <Geom_BezierSurface.hxx>
+#include <Geom_BSplineCurve.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_RectangularTrimmedSurface.hxx>
+#include <Geom_TrimmedCurve.hxx>
+#include <Poly_Triangle.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Pnt2d.hxx>
+
+namespace {
+
+// Fixed cost of a topological entity with its TShape, representation lists and
+// handles, and of an analytic curve or surface (plane, cylinder, line, ...)
+constexpr uint64_t kVertexBytes = 160;
+constexpr uint64_t kEdgeBytes = 480;    // Including its two pcurves
+constexpr uint64_t kFaceBytes = 320;
+constexpr uint64_t kWireBytes = 96;     // Per wire, shell or solid and their child lists
+constexpr uint64_t kAnalyticGeometryBytes = 160;
+
+uint64_t poleBytes(int poles, bool rational) {
+    return static_cast<uint64_t>(poles) * (sizeof(gp_Pnt) + (rational ? sizeof(double) : 0));
+}
+
+uint64_t knotBytes(int knots) {
+    return static_cast<uint64_t>(knots) * (sizeof(double) + sizeof(int));
+}
+
+uint64_t curveBytes(const TopoDS_Edge& edge) {
+    TopLoc_Location location;
+    Standard_Real first = 0.0, last = 0.0;
+    Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, location, first, last);
+    Handle(Geom_TrimmedCurve) trimmed = Handle(Geom_TrimmedCurve)::DownCast(curve);
+    if (!trimmed.IsNull()) {
+        curve = trimmed->BasisCurve();
+    }
+    Handle(Geom_BSplineCurve) bspline = Handle(Geom_BSplineCurve)::DownCast(curve);
+    if (!bspline.IsNull()) {
+        return poleBytes(bspline->NbPoles(), bspline->IsRational()) + knotBytes(bspline->NbKnots());
+    }
+    Handle(Geom_BezierCurve) bezier = Handle(Geom_BezierCurve)::DownCast(curve);
+    if (!bezier.IsNull()) {
+        return poleBytes(bezier->NbPoles(), bezier->IsRational());
+    }
+    return curve.IsNull() ? 0 : kAnalyticGeometryBytes;
+}
+
+uint64_t surfaceBytes(const TopoDS_Face& face) {
+    TopLoc_Location location;
+    Handle(Geom_Surface) surface = BRep_Tool::Surface(face, location);
+    Handle(Geom_RectangularTrimmedSurface) trimmed = Handle(Geom_RectangularTrimmedSurface)::DownCast(surface);
+    if (!trimmed.IsNull()) {
+        surface = trimmed->BasisSurface();
+    }
+    Handle(Geom_BSplineSurface) bspline = Handle(Geom_BSplineSurface)::DownCast(surface);
+    if (!bspline.IsNull()) {
+        const bool rational = bspline->IsURational() || bspline->IsVRational();
+        return poleBytes(bspline->NbUPoles() * bspline->NbVPoles(), rational) +
+               knotBytes(bspline->NbUKnots()) + knotBytes(bspline->NbVKnots());
+    }
+    Handle(Geom_BezierSurface) bezier = Handle(Geom_BezierSurface)::DownCast(surface);
+    if (!bezier.IsNull()) {
+        const bool rational = bezier->IsURational() || bezier->IsVRational();
+        return poleBytes(bezier->NbUPoles() * bezier->NbVPoles(), rational);
+    }
+    return surface.IsNull() ? 0 : kAnalyticGeometryBytes;
+}
+
+uint64_t triangulationBytes(const TopoDS_Face& face) {
+    TopLoc_Location location;
+    const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(face, location);
+    if (triangulation.IsNull()) {
+        return 0;
+    }
+    const uint64_t nodes = static_cast<uint64_t>(triangulation->NbNodes());
+    uint64_t bytes = nodes * sizeof(gp_Pnt) +
+                     static_cast<uint64_t>(triangulation->NbTriangles()) * sizeof(Poly_Triangle);
+    if (triangulation->HasUVNodes()) {
+        bytes += nodes * sizeof(gp_Pnt2d);
+    }
+    if (triangulation->HasNormals()) {
+        bytes += nodes * 3 * sizeof(float);
+    }
+    return bytes;
+}
+
+// True the first time a sub-shape's TShape is seen
+bool firstSeen(TopTools_MapOfShape& counted, const TopoDS_Shape& sub_shape) {
+    return counted.Add(sub_shape.Located(TopLoc_Location()));
+}
+
+} // namespace
+
+ShapeMemory estimateShapeMemory(const TopoDS_Shape& shape, TopTools_MapOfShape* counted) {
+    ShapeMemory memory;
+    if (shape.IsNull()) {
+        return memory;
+    }
+    TopTools_MapOfShape local;
+    TopTools_MapOfShape& seen = counted ? *counted : local;
+
+    for (TopExp_Explorer explorer(shape, TopAbs_FACE); explorer.More(); explorer.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(explorer.Current());
+        if (firstSeen(seen, face)) {
+            memory.brep_bytes += kFaceBytes + surfaceBytes(face);
+            memory.triangulation_bytes += triangulationBytes(face);
+        }
+    }
+    for (TopExp_Explorer explorer(shape, TopAbs_EDGE); explorer.More(); explorer.Next()) {
+        const TopoDS_Edge& edge = TopoDS::Edge(explorer.Current());
+        if (firstSeen(seen, edge)) {
+            memory.brep_bytes += kEdgeBytes + curveBytes(edge);
+        }
+    }
+    for (TopExp_Explorer explorer(shape, TopAbs_VERTEX); explorer.More(); explorer.Next()) {
+        if (firstSeen(seen, explorer.Current())) {
+            memory.brep_bytes += kVertexBytes;
+        }
+    }
+    for (TopAbs_ShapeEnum type : {TopAbs_WIRE, TopAbs_SHELL, TopAbs_SOLID}) {
+        for (TopExp_Explorer explorer(shape, type); explorer.More(); explorer.Next()) {
+            if (firstSeen(seen, explorer.Current())) {
+                memory.brep_bytes += kWireBytes;
+            }
+        }
+    }
+    return memory;
+}
+
+uint64_t estimateTriangulationBytes(const TopoDS_Shape& shape) {
+    uint64_t bytes = 0;
+    TopTools_MapOfShape seen;
+    for (TopExp_Explorer explorer(shape, TopAbs_FACE); explorer.More(); explorer.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(explorer.Current());
+        if (firstSeen(seen, face)) {
+            bytes += triangulationBytes(face);
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include <TopTools_MapOfShape.hxx>
+#include <TopoDS_Shape.hxx>
+
+// Estimated heap footprint of a shape: the exact BRep (topology plus curve and
+// surface geometry) and the triangulations currently stored on its faces.
+// Estimates count poles, knots and nodes, not allocator overhead.
+struct ShapeMemory {
+    uint64_t brep_bytes{0};
+    uint64_t triangulation_bytes{0};
+
+    uint64_t total() const { return brep_bytes + triangulation_bytes; }
+};
+
+// Sub-shapes already in counted (by TShape, whatever their placement) are skipped
+// and the rest added to it, so parts shared by several shapes are counted once
+ShapeMemory estimateShapeMemory(const TopoDS_Shape& shape, TopTools_MapOfShape* counted = nullptr);
+
+// Just the triangulations, e.g. after meshing the shape in place
+uint64_t estimateTriangulationBytes(const TopoDS_Shape& shape);
@@ -0,0 +1,560 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr uint32_t kLeafSize = 4;
+
+double dot(const Vec3& a, const Vec3& b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+Vec3 subtract(const Vec3& a, const Vec3& b) {
+    return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+Vec3 cross(const Vec3& a, const Vec3& b) {
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+double center(const Aabb& box, int axis) {
+    return 0.5 * (box.min[axis] + box.max[axis]);
+}
+
+// Entry distance of the ray into box within [0, max_t]; axis-parallel rays are tested per slab
+bool rayEntersBox(const Aabb& box, const Vec3& origin, const Vec3& direction, double max_t, double& t_enter) {
+    if (box.empty()) {
+        return false;
+    }
+    double t0 = 0.0;
+    double t1 = max_t;
+    for (int i = 0; i < 3; ++i) {
+        if (direction[i] == 0.0) {
+            if (origin[i] < box.min[i] || origin[i] > box.max[i]) {
+                return false;
+            }
+            continue;
+        }
+        double t_near = (box.min[i] - origin[i]) / direction[i];
+        double t_far = (box.max[i] - origin[i]) / direction[i];
+        if (t_near > t_far) {
+            std::swap(t_near, t_far);
+        }
+        t0 = std::max(t0, t_near);
+        t1 = std::min(t1, t_far);
+        if (t0 > t1) {
+            return false;
+        }
+    }
+    t_enter = t0;
+    return true;
+}
+
+enum class Containment { Outside, Intersecting, Inside };
+
+Containment classify(const Aabb& box, const std::vector<Plane>& planes) {
+    if (box.empty()) {
+        return Containment::Outside;
+    }
+    Containment result = Containment::Inside;
+    for (const Plane& plane : planes) {
+        // Box corners furthest along and against the plane normal
+        Vec3 far_corner;
+        Vec3 near_corner;
+        for (int i = 0; i < 3; ++i) {
+            far_corner[i] = plane.normal[i] >= 0.0 ? box.max[i] : box.min[i];
+            near_corner[i] = plane.normal[i] >= 0.0 ? box.min[i] : box.max[i];
+        }
+        if (dot(plane.normal, far_corner) + plane.offset < 0.0) {
+            return Containment::Outside;
+        }
+        if (dot(plane.normal, near_corner) + plane.offset < 0.0) {
+            result = Containment::Intersecting;
+        }
+    }
+    return result;
+}
+
+// Two-sided Moller-Trumbore ray/triangle test
+bool rayHitsTriangle(const Vec3& origin, const Vec3& direction, const Vec3& a, const Vec3& b, const Vec3& c,
+                     double& t) {
+    const Vec3 edge1 = subtract(b, a);
+    const Vec3 edge2 = subtract(c, a);
+    const Vec3 p = cross(direction, edge2);
+    const double determinant = dot(edge1, p);
+    if (std::abs(determinant) < 1e-300) {
+        return false;
+    }
+    const double inverse = 1.0 / determinant;
+    const Vec3 s = subtract(origin, a);
+    const double u = dot(s, p) * inverse;
+    if (u < 0.0 || u > 1.0) {
+        return false;
+    }
+    const Vec3 q = cross(s, edge1);
+    const double v = dot(direction, q) * inverse;
+    if (v < 0.0 || u + v > 1.0) {
+        return false;
+    }
+    t = dot(edge2, q) * inverse;
+    return t >= 0.0;
+}
+
+} // namespace
+
+void Aabb::add(const Vec3& point) {
+    for (int i = 0; i < 3; ++i) {
+        min[i] = std::min(min[i], point[i]);
+        max[i] = std::max(max[i], point[i]);
+    }
+}
+
+void Aabb::add(const Aabb& box) {
+    if (!box.empty()) {
+        add(box.min);
+        add(box.max);
+    }
+}
+
+bool Aabb::overlaps(const Aabb& box) const {
+    if (empty() || box.empty()) {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (box.max[i] < min[i] || box.min[i] > max[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Aabb::contains(const Aabb& box) const {
+    if (empty() || box.empty()) {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (box.min[i] < min[i] || box.max[i] > max[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// Bvh
+// =============================================================================
+
+void Bvh::build(std::vector<Aabb> boxes) {
+    boxes_ = std::move(boxes);
+    nodes_.clear();
+    order_.resize(boxes_.size());
+    leaf_of_.assign(boxes_.size(), 0);
+    for (uint32_t i = 0; i < order_.size(); ++i) {
+        order_[i] = i;
+    }
+    if (boxes_.empty()) {
+        return;
+    }
+    nodes_.reserve(2 * boxes_.size() / kLeafSize + 1);
+    nodes_.emplace_back();
+    buildNode(0, static_cast<uint32_t>(boxes_.size()), 0);
+}
+
+uint32_t Bvh::buildNode(uint32_t begin, uint32_t end, uint32_t node) {
+    Aabb bounds;
+    Aabb centroids;
+    for (uint32_t i = begin; i < end; ++i) {
+        const Aabb& box = boxes_[order_[i]];
+        bounds.add(box);
+        if (!box.empty()) {
+            centroids.add(Vec3{center(box, 0), center(box, 1), center(box, 2)});
+        }
+    }
+    nodes_[node].box = bounds;
+
+    if (end - begin <= kLeafSize) {
+        nodes_[node].first = begin;
+        nodes_[node].count = end - begin;
+        for (uint32_t i = begin; i < end; ++i) {
+            leaf_of_[order_[i]] = node;
+        }
+        return node;
+    }
+
+    // Median split along the widest spread of box centers; empty boxes sort last
+    int axis = 0;
+    if (!centroids.empty()) {
+        Vec3 spread = subtract(centroids.max, centroids.min);
+        axis = spread[1] > spread[axis] ? 1 : axis;
+        axis = spread[2] > spread[axis] ? 2 : axis;
+    }
+    const uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+                     [&](uint32_t a, uint32_t b) {
+                         const Aabb& box_a = boxes_[a];
+                         const Aabb& box_b = boxes_[b];
+                         if (box_a.empty() != box_b.empty()) {
+                             return box_b.empty();
+                         }
+                         return !box_a.empty() && center(box_a, axis) < center(box_b, axis);
+                     });
+
+    const uint32_t left = static_cast<uint32_t>(nodes_.size());
+    nodes_.emplace_back();
+    nodes_.emplace_back();
+    nodes_[left].parent = node;
+    nodes_[left + 1].parent = node;
+    nodes_[node].first = left;
+    nodes_[node].count = 0;
+    buildNode(begin, middle, left);
+    buildNode(middle, end, left + 1);
+    return node;
+}
+
+void Bvh::refit(size_t primitive, const Aabb& box) {
+    boxes_[primitive] = box;
+    uint32_t node = leaf_of_[primitive];
+    Aabb leaf_box;
+    for (uint32_t i = 0; i < nodes_[node].count; ++i) {
+        leaf_box.add(boxes_[order_[nodes_[node].first + i]]);
+    }
+    nodes_[node].box = leaf_box;
+    while (node != 0) {
+        node = nodes_[node].parent;
+        Aabb inner_box = nodes_[nodes_[node].first].box;
+        inner_box.add(nodes_[nodes_[node].first + 1].box);
+        nodes_[node].box = inner_box;
+    }
+}
+
+void Bvh::traverseRay(const Vec3& origin, const Vec3& direction, double max_t,
+                      const std::function<double(size_t primitive, double max_t)>& visit) const {
+    double t_enter = 0.0;
+    if (nodes_.empty() || !rayEntersBox(nodes_[0].box, origin, direction, max_t, t_enter)) {
+        return;
+    }
+    std::vector<std::pair<uint32_t, double>> stack{{0, t_enter}};
+    while (!stack.empty()) {
+        auto [node_index, node_t] = stack.back();
+        stack.pop_back();
+        if (node_t > max_t) {
+            continue;  // A closer hit was found meanwhile
+        }
+        const Node& node = nodes_[node_index];
+        if (node.count > 0) {
+            for (uint32_t i = 0; i < node.count; ++i) {
+                uint32_t primitive = order_[node.first + i];
+                double t = 0.0;
+                if (rayEntersBox(boxes_[primitive], origin, direction, max_t, t)) {
+                    max_t = visit(primitive, max_t);
+                }
+            }
+            continue;
+        }
+        // Nearer child on top of the stack
+        double t_left = 0.0;
+        double t_right = 0.0;
+        bool hit_left = rayEntersBox(nodes_[node.first].box, origin, direction, max_t, t_left);
+        bool hit_right = rayEntersBox(nodes_[node.first + 1].box, origin, direction, max_t, t_right);
+        if (hit_left && hit_right && t_left <= t_right) {
+            stack.push_back({node.first + 1, t_right});
+            stack.push_back({node.first, t_left});
+        } else if (hit_left && hit_right) {
+            stack.push_back({node.first, t_left});
+            stack.push_back({node.first + 1, t_right});
+        } else if (hit_left) {
+            stack.push_back({node.first, t_left});
+        } else if (hit_right) {
+            stack.push_back({node.first + 1, t_right});
+        }
+    }
+}
+
+void Bvh::traverseBox(const Aabb& box, const std::function<void(size_t primitive)>& visit) const {
+    if (nodes_.empty()) {
+        return;
+    }
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+        if (!node.box.overlaps(box)) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1);
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            uint32_t primitive = order_[node.first + i];
+            if (boxes_[primitive].overlaps(box)) {
+                visit(primitive);
+            }
+        }
+    }
+}
+
+void Bvh::traverseFrustum(const std::vector<Plane>& planes,
+                          const std::function<void(size_t primitive, bool fully_inside)>& visit) const {
+    if (nodes_.empty()) {
+        return;
+    }
+    // Subtrees found fully inside are enumerated without further plane tests
+    std::vector<std::pair<uint32_t, bool>> stack{{0, false}};
+    while (!stack.empty()) {
+        auto [node_index, inside] = stack.back();
+        stack.pop_back();
+        const Node& node = nodes_[node_index];
+        if (!inside) {
+            Containment containment = classify(node.box, planes);
+            if (containment == Containment::Outside) {
+                continue;
+            }
+            inside = containment == Containment::Inside;
+        }
+        if (node.count == 0) {
+            stack.push_back({node.first, inside});
+            stack.push_back({node.first + 1, inside});
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; ++i) {
+            uint32_t primitive = order_[node.first + i];
+            const Aabb& box = boxes_[primitive];
+            if (box.empty()) {
+                continue;
+            }
+            Containment containment = inside ? Containment::Inside : classify(box, planes);
+            if (containment != Containment::Outside) {
+                visit(primitive, containment == Containment::Inside);
+            }
+        }
+    }
+}
+
+// =============================================================================
+// SceneSpatialIndex
+// =============================================================================
+
+void SceneSpatialIndex::upsert(const std::string& shape_id, const Aabb& box, uint64_t generation, bool visible) {
+    auto it = slot_of_.find(shape_id);
+    size_t index = 0;
+    if (it != slot_of_.end()) {
+        index = it->second;
+    } else if (!free_slots_.empty()) {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+        slot_of_[shape_id] = index;
+    } else {
+        index = slots_.size();
+        slots_.emplace_back();
+        slot_of_[shape_id] = index;
+        dirty_ = true;  // Not in the tree yet
+    }
+
+    Slot& slot = slots_[index];
+    slot.shape_id = shape_id;
+    slot.visible = visible;
+    if (slot.generation != generation) {
+        slot.generation = generation;
+        slot.mesh.reset();
+        slot.mesh_failed = false;
+    }
+    slot.box = box;
+    if (!dirty_) {
+        bvh_.refit(index, box);
+        refits_++;
+    }
+}
+
+void SceneSpatialIndex::remove(const std::string& shape_id) {
+    auto it = slot_of_.find(shape_id);
+    if (it == slot_of_.end()) {
+        return;
+    }
+    size_t index = it->second;
+    slot_of_.erase(it);
+    slots_[index] = Slot();
+    free_slots_.push_back(index);
+    if (!dirty_) {
+        bvh_.refit(index, Aabb());
+        refits_++;
+    }
+}
+
+void SceneSpatialIndex::clear() {
+    slots_.clear();
+    free_slots_.clear();
+    slot_of_.clear();
+    bvh_.build({});
+    dirty_ = true;
+    refits_ = 0;
+}
+
+const Aabb* SceneSpatialIndex::bounds(const std::string& shape_id) const {
+    auto it = slot_of_.find(shape_id);
+    return it == slot_of_.end() ? nullptr : &slots_[it->second].box;
+}
+
+void SceneSpatialIndex::ensureBuilt() {
+    if (!dirty_ && refits_ <= std::max<size_t>(64, slot_of_.size())) {
+        return;
+    }
+    std::vector<Aabb> boxes;
+    boxes.reserve(slots_.size());
+    for (const Slot& slot : slots_) {
+        boxes.push_back(slot.box);
+    }
+    bvh_.build(std::move(boxes));
+    dirty_ = false;
+    refits_ = 0;
+}
+
+bool SceneSpatialIndex::queryable(const Slot& slot, bool include_hidden) const {
+    return !slot.shape_id.empty() && (include_hidden || slot.visible);
+}
+
+const SceneSpatialIndex::ShapeMesh* SceneSpatialIndex::meshFor(Slot& slot, const MeshLoader& loader) {
+    if (slot.mesh || slot.mesh_failed) {
+        return slot.mesh.get();
+    }
+    auto mesh = std::make_shared<ShapeMesh>();
+    if (!loader || !loader(slot.shape_id, mesh->positions, mesh->indices) || mesh->indices.size() < 3) {
+        slot.mesh_failed = true;
+        return nullptr;
+    }
+
+    const size_t vertex_count = mesh->positions.size() / 3;
+    std::vector<Aabb> triangle_boxes(mesh->indices.size() / 3);
+    for (size_t t = 0; t < triangle_boxes.size(); ++t) {
+        for (int corner = 0; corner < 3; ++corner) {
+            uint32_t vertex = mesh->indices[3 * t + corner];
+            if (vertex >= vertex_count) {
+                triangle_boxes[t] = Aabb();  // Malformed triangle, never hit
+                break;
+            }
+            const float* p = mesh->positions.data() + 3 * vertex;
+            triangle_boxes[t].add(Vec3{p[0], p[1], p[2]});
+        }
+    }
+    mesh->bvh.build(std::move(triangle_boxes));
+    slot.mesh = std::move(mesh);
+    return slot.mesh.get();
+}
+
+std::vector<SceneSpatialIndex::Hit> SceneSpatialIndex::rayPick(const Vec3& origin, const Vec3& direction,
+                                                               double max_distance, size_t max_hits,
+                                                               bool include_hidden, const MeshLoader& loader) {
+    const double length = std::sqrt(dot(direction, direction));
+    if (!(length > 0.0)) {
+        return {};
+    }
+    const Vec3 unit{direction[0] / length, direction[1] / length, direction[2] / length};
+    const double max_t = max_distance > 0.0 ? max_distance : std::numeric_limits<double>::max();
+    max_hits = std::max<size_t>(1, max_hits);
+    ensureBuilt();
+
+    std::vector<Hit> hits;
+    bvh_.traverseRay(origin, unit, max_t, [&](size_t index, double limit) {
+        Slot& slot = slots_[index];
+        if (!queryable(slot, include_hidden)) {
+            return limit;
+        }
+        const ShapeMesh* mesh = meshFor(slot, loader);
+        if (!mesh) {
+            return limit;
+        }
+
+        // Closest triangle of this shape
+        double best = limit;
+        bool found = false;
+        uint32_t best_triangle = 0;
+        auto vertex = [&](uint32_t i) {
+            const float* p = mesh->positions.data() + 3 * mesh->indices[i];
+            return Vec3{p[0], p[1], p[2]};
+        };
+        mesh->bvh.traverseRay(origin, unit, best, [&](size_t triangle, double triangle_limit) {
+            double t = 0.0;
+            if (rayHitsTriangle(origin, unit, vertex(3 * triangle), vertex(3 * triangle + 1),
+                                vertex(3 * triangle + 2), t) && t <= triangle_limit) {
+                best = t;
+                best_triangle = static_cast<uint32_t>(triangle);
+                found = true;
+                return t;
+            }
+            return triangle_limit;
+        });
+        if (!found) {
+            return limit;
+        }
+
+        Hit hit;
+        hit.shape_id = slot.shape_id;
+        hit.distance = best;
+        hit.triangle = best_triangle;
+        for (int i = 0; i < 3; ++i) {
+            hit.point[i] = origin[i] + unit[i] * best;
+        }
+        Vec3 a = vertex(3 * best_triangle);
+        Vec3 normal = cross(subtract(vertex(3 * best_triangle + 1), a), subtract(vertex(3 * best_triangle + 2), a));
+        double normal_length = std::sqrt(dot(normal, normal));
+        if (normal_length > 0.0) {
+            hit.normal = {normal[0] / normal_length, normal[1] / normal_length, normal[2] / normal_length};
+        }
+        hits.push_back(std::move(hit));
+        return max_hits == 1 ? best : limit;  // Only the closest hit prunes the rest of the scene
+    });
+
+    std::sort(hits.begin(), hits.end(), [](const Hit& a, const Hit& b) { return a.distance < b.distance; });
+    if (hits.size() > max_hits) {
+        hits.resize(max_hits);
+    }
+    return hits;
+}
+
+std::vector<std::string> SceneSpatialIndex::boxQuery(const Aabb& box, bool fully_inside, bool include_hidden) {
+    ensureBuilt();
+    std::vector<std::string> shape_ids;
+    bvh_.traverseBox(box, [&](size_t index) {
+        const Slot& slot = slots_[index];
+        if (queryable(slot, include_hidden) && (!fully_inside || box.contains(slot.box))) {
+            shape_ids.push_back(slot.shape_id);
+        }
+    });
+    std::sort(shape_ids.begin(), shape_ids.end());
+    return shape_ids;
+}
+
+std::vector<std::string> SceneSpatialIndex::frustumCull(const std::vector<Plane>& planes, bool include_hidden) {
+    ensureBuilt();
+    std::vector<std::string> shape_ids;
+    bvh_.traverseFrustum(planes, [&](size_t index, bool) {
+        const Slot& slot = slots_[index];
+        if (queryable(slot, include_hidden)) {
+            shape_ids.push_back(slot.shape_id);
+        }
+    });
+    std::sort(shape_ids.begin(), shape_ids.end());
+    return shape_ids;
+}
+
+std::vector<Plane> SceneSpatialIndex::frustumPlanes(const std::array<double, 16>& m) {
+    // Gribb/Hartmann: each plane is the last row plus or minus one of the others
+    auto row = [&](int r) { return std::array<double, 4>{m[4 * r], m[4 * r + 1], m[4 * r + 2], m[4 * r + 3]}; };
+    const std::array<double, 4> w = row(3);
+    std::vector<Plane> planes;
+    for (int r = 0; r < 3; ++r) {
+        const std::array<double, 4> axis = row(r);
+        for (double sign : {1.0, -1.0}) {
+            Vec3 normal{w[0] + sign * axis[0], w[1] + sign * axis[1], w[2] + sign * axis[2]};
+            double offset = w[3] + sign * axis[3];
+            double length = std::sqrt(dot(normal, normal));
+            if (length > 0.0) {
+                planes.push_back({{normal[0] / length, normal[1] / length, normal[2] / length}, offset / length});
+            }
+        }
+    }
+    return planes;
+}
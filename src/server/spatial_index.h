@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using Vec3 = std::array<double, 3>;
+
+// Axis-aligned bounding box; default constructed boxes are empty
+struct Aabb {
+    Vec3 min{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+             std::numeric_limits<double>::max()};
+    Vec3 max{std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(),
+             std::numeric_limits<double>::lowest()};
+
+    bool empty() const { return min[0] > max[0] || min[1] > max[1] || min[2] > max[2]; }
+    void add(const Vec3& point);
+    void add(const Aabb& box);
+    bool overlaps(const Aabb& box) const;
+    bool contains(const Aabb& box) const;
+};
+
+// Points p with dot(normal, p) + offset >= 0 are on the inner side
+struct Plane {
+    Vec3 normal{0.0, 0.0, 1.0};
+    double offset{0.0};
+};
+
+// Bounding volume hierarchy over a fixed set of boxes, split at the median of
+// the widest axis. Boxes can be changed afterwards with refit(), which keeps
+// the tree valid at some cost in query speed until the next build().
+class Bvh {
+public:
+    void build(std::vector<Aabb> boxes);
+    void refit(size_t primitive, const Aabb& box);  // An empty box removes the primitive from queries
+    size_t size() const { return boxes_.size(); }
+    const Aabb& box(size_t primitive) const { return boxes_[primitive]; }
+
+    // Visits primitives whose box the ray (origin + t * direction) enters for t
+    // in [0, max_t]; visit returns the new max_t, so closest-hit queries can
+    // shrink it as they go
+    void traverseRay(const Vec3& origin, const Vec3& direction, double max_t,
+                     const std::function<double(size_t primitive, double max_t)>& visit) const;
+    void traverseBox(const Aabb& box, const std::function<void(size_t primitive)>& visit) const;
+    // Visits primitives not fully outside any plane; fully_inside is set when no test was needed
+    void traverseFrustum(const std::vector<Plane>& planes,
+                         const std::function<void(size_t primitive, bool fully_inside)>& visit) const;
+
+private:
+    struct Node {
+        Aabb box;
+        uint32_t first{0};   // Leaf: first entry in order_; inner node: left child (right is first + 1)
+        uint32_t count{0};   // Primitives of a leaf, 0 for inner nodes
+        uint32_t parent{0};
+    };
+
+    uint32_t buildNode(uint32_t begin, uint32_t end, uint32_t node);  // node is already allocated
+
+    std::vector<Aabb> boxes_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> order_;    // Primitive indices grouped by leaf
+    std::vector<uint32_t> leaf_of_;  // Leaf node of each primitive
+};
+
+// Spatial index of one session's scene: a BVH over shape bounding boxes and,
+// built the first time a ray reaches a shape, one over its mesh triangles.
+// Shapes are added, updated and removed one at a time; updates and removals
+// refit the tree in place, additions rebuild it on the next query. Not
+// thread-safe; callers serialize access.
+class SceneSpatialIndex {
+public:
+    struct Hit {
+        std::string shape_id;
+        double distance{0.0};  // Along the normalized ray direction
+        Vec3 point{};
+        Vec3 normal{};         // Unit geometric normal of the hit triangle
+        uint32_t triangle{0};  // Triangle index in the shape's mesh data
+    };
+
+    // Fills the world-space triangle mesh of a shape; false if it has none
+    using MeshLoader = std::function<bool(const std::string& shape_id, std::vector<float>& positions,
+                                          std::vector<uint32_t>& indices)>;
+
+    // A changed generation drops the shape's triangle BVH
+    void upsert(const std::string& shape_id, const Aabb& box, uint64_t generation, bool visible);
+    void remove(const std::string& shape_id);
+    void clear();
+    size_t size() const { return slot_of_.size(); }
+    const Aabb* bounds(const std::string& shape_id) const;  // Null for unknown shapes
+
+    // Nearest hit of each shape, closest first, at most max_hits (0 = 1) of them
+    std::vector<Hit> rayPick(const Vec3& origin, const Vec3& direction, double max_distance, size_t max_hits,
+                             bool include_hidden, const MeshLoader& loader);
+    // Shapes whose box overlaps (or, with fully_inside, lies within) the query box
+    std::vector<std::string> boxQuery(const Aabb& box, bool fully_inside, bool include_hidden);
+    // Shapes whose box is at least partly inside all planes
+    std::vector<std::string> frustumCull(const std::vector<Plane>& planes, bool include_hidden);
+
+    // Frustum planes of a row-major view-projection matrix with OpenGL clip space (-w..w)
+    static std::vector<Plane> frustumPlanes(const std::array<double, 16>& view_projection);
+
+private:
+    struct ShapeMesh {
+        std::vector<float> positions;
+        std::vector<uint32_t> indices;
+        Bvh bvh;
+    };
+
+    struct Slot {
+        std::string shape_id;  // Empty for a free slot
+        Aabb box;
+        uint64_t generation{0};
+        bool visible{true};
+        std::shared_ptr<const ShapeMesh> mesh;  // Null until a ray reaches the shape
+        bool mesh_failed{false};                // The shape had no triangles at this generation
+    };
+
+    void ensureBuilt();
+    const ShapeMesh* meshFor(Slot& slot, const MeshLoader& loader);
+    bool queryable(const Slot& slot, bool include_hidden) const;
+
+    std::vector<Slot> slots_;
+    std::vector<size_t> free_slots_;
+    std::unordered_map<std::string, size_t> slot_of_;
+    Bvh bvh_;
+    bool dirty_{true};
+    size_t refits_{0};  // Since the last build; many refits degrade the tree, so it is rebuilt
+};
@@ -0,0 +1,105 @@
+#include "stage_trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+
+#include <spdlog/fmt/fmt.h>
+
+namespace {
+
+std::atomic<uint64_t> next_span_id{1};
+std::atomic<uint64_t> next_thread_id{1};
+thread_local StageSpan* current_span = nullptr;
+
+const GrpcPerformanceMonitor::TimePoint& traceEpoch() {
+    static const GrpcPerformanceMonitor::TimePoint epoch = GrpcPerformanceMonitor::Clock::now();
+    return epoch;
+}
+
+uint64_t currentThreadId() {
+    thread_local const uint64_t id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+int64_t microseconds(GrpcPerformanceMonitor::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+} // namespace
+
+StageTrace& StageTrace::instance() {
+    static StageTrace trace;
+    return trace;
+}
+
+void StageTrace::setCapacity(size_t spans) {
+    traceEpoch();  // Span times count from the first configuration
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_.store(spans, std::memory_order_relaxed);
+    while (spans_.size() > spans) {
+        spans_.pop_front();
+    }
+}
+
+size_t StageTrace::capacity() const {
+    return capacity_.load(std::memory_order_relaxed);
+}
+
+std::vector<StageTrace::Span> StageTrace::recentSpans() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {spans_.begin(), spans_.end()};
+}
+
+std::string StageTrace::chromeTraceJson() const {
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const Span& span : recentSpans()) {
+        fmt::format_to(std::back_inserter(json),
+                       "{}{{\"name\":\"{}\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{},\"dur\":{},"
+                       "\"args\":{{\"trace_id\":{},\"span_id\":{},\"parent_id\":{}}}}}",
+                       first ? "" : ",", span.name, span.thread_id, span.start_us, span.duration_us,
+                       span.trace_id, span.span_id, span.parent_id);
+        first = false;
+    }
+    json += "]}";
+    return json;
+}
+
+void StageTrace::record(const Span& span) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t capacity = capacity_.load(std::memory_order_relaxed);
+    if (capacity == 0) {
+        return;
+    }
+    while (spans_.size() >= capacity) {
+        spans_.pop_front();
+    }
+    spans_.push_back(span);
+}
+
+StageSpan::StageSpan(const char* name, GrpcPerformanceMonitor::OperationMetrics& operation)
+    : operation_(operation)
+    , parent_(current_span)
+    , start_time_(GrpcPerformanceMonitor::Clock::now()) {
+    span_.name = name;
+    span_.span_id = next_span_id.fetch_add(1, std::memory_order_relaxed);
+    span_.parent_id = parent_ ? parent_->span_.span_id : 0;
+    span_.trace_id = parent_ ? parent_->span_.trace_id : span_.span_id;
+    current_span = this;
+}
+
+StageSpan::~StageSpan() {
+    current_span = parent_;
+    const auto duration = GrpcPerformanceMonitor::Clock::now() - start_time_;
+    GrpcPerformanceMonitor::getInstance().record(
+        operation_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+
+    StageTrace& trace = StageTrace::instance();
+    if (trace.capacity() > 0) {
+        span_.thread_id = currentThreadId();
+        span_.start_us = microseconds(start_time_ - traceEpoch());
+        span_.duration_us = microseconds(duration);
+        trace.record(span_);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common/grpc_performance_monitor.h"
+
+// Per-stage timing of server requests. Every StageSpan feeds the latency
+// histogram "Stage.<name>" in GrpcPerformanceMonitor; while the span log has
+// capacity, finished spans are also kept with their trace and parent so a
+// single slow request can be broken down. Spans nest per thread: one opened
+// while another is active on the same thread becomes its child, a span with
+// no parent starts a new trace.
+class StageTrace {
+public:
+    struct Span {
+        const char* name{nullptr};  // Static string, see STAGE_SPAN
+        uint64_t trace_id{0};
+        uint64_t span_id{0};
+        uint64_t parent_id{0};      // 0 for the root of a trace
+        uint64_t thread_id{0};
+        int64_t start_us{0};        // Since the process-wide trace epoch
+        int64_t duration_us{0};
+    };
+
+    static StageTrace& instance();
+
+    // Most recent spans kept in the log; 0 (the default) keeps none
+    void setCapacity(size_t spans);
+    size_t capacity() const;
+
+    std::vector<Span> recentSpans() const;
+    // The span log in Chrome trace event format, for chrome://tracing or Perfetto
+    std::string chromeTraceJson() const;
+
+    void record(const Span& span);
+
+private:
+    StageTrace() = default;
+
+    mutable std::mutex mutex_;
+    std::deque<Span> spans_;
+    std::atomic<size_t> capacity_{0};  // Read unlocked when a span ends
+};
+
+class StageSpan {
+public:
+    // name must outlive the process, usually a string literal
+    StageSpan(const char* name, GrpcPerformanceMonitor::OperationMetrics& operation);
+    ~StageSpan();
+
+    StageSpan(const StageSpan&) = delete;
+    StageSpan& operator=(const StageSpan&) = delete;
+
+private:
+    GrpcPerformanceMonitor::OperationMetrics& operation_;
+    StageTrace::Span span_;
+    StageSpan* parent_;
+    GrpcPerformanceMonitor::TimePoint start_time_;
+};
+
+// Opens span `var` for stage `name` (a string literal) until the end of the scope
+#define STAGE_SPAN(var, name)                                                                   \
+    static auto& var##_operation = GrpcPerformanceMonitor::getInstance().operation("Stage." name); \
+    StageSpan var(name, var##_operation)
@@ -0,0 +1,191 @@
+#include "view_camera.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kMinClipW = 1e-9;
+
+std::array<double, 16> multiply(const std::array<double, 16>& a, const std::array<double, 16>& b) {
+    std::array<double, 16> result{};
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            for (int k = 0; k < 4; ++k) {
+                result[4 * r + c] += a[4 * r + k] * b[4 * k + c];
+            }
+        }
+    }
+    return result;
+}
+
+// Gauss-Jordan elimination with partial pivoting; false for singular matrices
+bool invert(std::array<double, 16> m, std::array<double, 16>& inverse) {
+    inverse = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    for (int col = 0; col < 4; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < 4; ++r) {
+            if (std::abs(m[4 * r + col]) > std::abs(m[4 * pivot + col])) {
+                pivot = r;
+            }
+        }
+        if (std::abs(m[4 * pivot + col]) < 1e-300) {
+            return false;
+        }
+        for (int c = 0; c < 4; ++c) {
+            std::swap(m[4 * col + c], m[4 * pivot + c]);
+            std::swap(inverse[4 * col + c], inverse[4 * pivot + c]);
+        }
+        const double scale = 1.0 / m[4 * col + col];
+        for (int c = 0; c < 4; ++c) {
+            m[4 * col + c] *= scale;
+            inverse[4 * col + c] *= scale;
+        }
+        for (int r = 0; r < 4; ++r) {
+            const double factor = m[4 * r + col];
+            if (r == col || factor == 0.0) {
+                continue;
+            }
+            for (int c = 0; c < 4; ++c) {
+                m[4 * r + c] -= factor * m[4 * col + c];
+                inverse[4 * r + c] -= factor * inverse[4 * col + c];
+            }
+        }
+    }
+    return true;
+}
+
+Vec3 corner(const Aabb& box, int index) {
+    return {index & 1 ? box.max[0] : box.min[0], index & 2 ? box.max[1] : box.min[1],
+            index & 4 ? box.max[2] : box.min[2]};
+}
+
+Vec3 centre(const Aabb& box) {
+    return {(box.min[0] + box.max[0]) * 0.5, (box.min[1] + box.max[1]) * 0.5, (box.min[2] + box.max[2]) * 0.5};
+}
+
+// False when the box lies entirely outside one of the planes
+bool inView(const Aabb& box, const std::vector<Plane>& planes) {
+    if (box.empty()) {
+        return false;
+    }
+    for (const Plane& plane : planes) {
+        // The corner furthest along the plane normal
+        const Vec3 far_corner{plane.normal[0] >= 0.0 ? box.max[0] : box.min[0],
+                              plane.normal[1] >= 0.0 ? box.max[1] : box.min[1],
+                              plane.normal[2] >= 0.0 ? box.max[2] : box.min[2]};
+        const double distance = plane.normal[0] * far_corner[0] + plane.normal[1] * far_corner[1] +
+                                plane.normal[2] * far_corner[2] + plane.offset;
+        if (distance < 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::optional<ViewCamera> ViewCamera::create(const std::array<double, 16>& view,
+                                             const std::array<double, 16>& projection,
+                                             uint32_t viewport_width, uint32_t viewport_height) {
+    if (viewport_width == 0 || viewport_height == 0) {
+        return std::nullopt;
+    }
+    ViewCamera camera;
+    camera.view_projection_ = multiply(projection, view);
+    if (!invert(camera.view_projection_, camera.inverse_)) {
+        return std::nullopt;
+    }
+    camera.width_ = viewport_width;
+    camera.height_ = viewport_height;
+    camera.planes_ = SceneSpatialIndex::frustumPlanes(camera.view_projection_);
+    return camera;
+}
+
+std::array<double, 4> ViewCamera::toClip(const Vec3& point) const {
+    const auto& m = view_projection_;
+    std::array<double, 4> clip{};
+    for (int r = 0; r < 4; ++r) {
+        clip[r] = m[4 * r] * point[0] + m[4 * r + 1] * point[1] + m[4 * r + 2] * point[2] + m[4 * r + 3];
+    }
+    return clip;
+}
+
+double ViewCamera::screenArea(const Aabb& box) const {
+    if (!inView(box, planes_)) {
+        return 0.0;
+    }
+    double x_min = 1.0, x_max = -1.0, y_min = 1.0, y_max = -1.0;
+    for (int i = 0; i < 8; ++i) {
+        const auto clip = toClip(corner(box, i));
+        if (clip[3] <= kMinClipW) {
+            return width_ * height_;
+        }
+        x_min = std::min(x_min, clip[0] / clip[3]);
+        x_max = std::max(x_max, clip[0] / clip[3]);
+        y_min = std::min(y_min, clip[1] / clip[3]);
+        y_max = std::max(y_max, clip[1] / clip[3]);
+    }
+    x_min = std::max(x_min, -1.0);
+    x_max = std::min(x_max, 1.0);
+    y_min = std::max(y_min, -1.0);
+    y_max = std::min(y_max, 1.0);
+    if (x_max <= x_min || y_max <= y_min) {
+        return 0.0;
+    }
+    return (x_max - x_min) * 0.5 * width_ * (y_max - y_min) * 0.5 * height_;
+}
+
+double ViewCamera::depth(const Aabb& box) const {
+    return box.empty() ? 0.0 : toClip(centre(box))[3];
+}
+
+bool ViewCamera::sightLine(const Vec3& point, Vec3& origin, Vec3& direction, double& length) const {
+    const auto clip = toClip(point);
+    if (clip[3] <= kMinClipW) {
+        return false;
+    }
+    // Unproject the point's screen position at the near plane (z = -w)
+    const double x = clip[0] / clip[3], y = clip[1] / clip[3];
+    const auto& m = inverse_;
+    std::array<double, 4> near{};
+    for (int r = 0; r < 4; ++r) {
+        near[r] = m[4 * r] * x + m[4 * r + 1] * y - m[4 * r + 2] + m[4 * r + 3];
+    }
+    if (std::abs(near[3]) <= kMinClipW) {
+        return false;
+    }
+    origin = {near[0] / near[3], near[1] / near[3], near[2] / near[3]};
+    direction = {point[0] - origin[0], point[1] - origin[1], point[2] - origin[2]};
+    length = std::sqrt(direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2]);
+    return length > 0.0;
+}
+
+std::vector<size_t> ViewCamera::streamOrder(const std::vector<Aabb>& boxes, size_t& in_view) const {
+    struct Key {
+        size_t index;
+        double area;
+        double depth;
+    };
+    std::vector<Key> keys;
+    keys.reserve(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        keys.push_back({i, screenArea(boxes[i]), depth(boxes[i])});
+    }
+    auto visible_end = std::stable_partition(keys.begin(), keys.end(), [](const Key& key) { return key.area > 0.0; });
+    std::sort(keys.begin(), visible_end, [](const Key& a, const Key& b) {
+        return a.area != b.area ? a.area > b.area : a.depth < b.depth;
+    });
+    // Shapes behind the camera have negative depth; a turn of the head away is as near
+    std::sort(visible_end, keys.end(), [](const Key& a, const Key& b) {
+        return std::abs(a.depth) < std::abs(b.depth);
+    });
+
+    in_view = static_cast<size_t>(visible_end - keys.begin());
+    std::vector<size_t> order;
+    order.reserve(keys.size());
+    for (const Key& key : keys) {
+        order.push_back(key.index);
+    }
+    return order;
+}
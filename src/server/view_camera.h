@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "spatial_index.h"
+
+// A client's camera in model coordinates, used to send what it sees first.
+// Matrices are row-major and map to OpenGL clip space (-w..w on every axis).
+class ViewCamera {
+public:
+    // nullopt if the viewport is empty or view * projection is singular
+    static std::optional<ViewCamera> create(const std::array<double, 16>& view,
+                                            const std::array<double, 16>& projection,
+                                            uint32_t viewport_width, uint32_t viewport_height);
+
+    const std::vector<Plane>& planes() const { return planes_; }
+
+    // Pixels covered by the projected box, clipped to the viewport; the whole
+    // viewport when the box reaches behind the eye
+    double screenArea(const Aabb& box) const;
+    // Distance of the box centre from the near plane, in clip-space w (eye depth for perspective)
+    double depth(const Aabb& box) const;
+
+    // Segment from the near plane to point along the line of sight through it;
+    // false if the point is behind the eye
+    bool sightLine(const Vec3& point, Vec3& origin, Vec3& direction, double& length) const;
+
+    // Indices of boxes in streaming order: those in view largest on screen first
+    // (ties nearest first), then the culled ones nearest first. in_view is set
+    // to the number of boxes in view.
+    std::vector<size_t> streamOrder(const std::vector<Aabb>& boxes, size_t& in_view) const;
+
+private:
+    std::array<double, 4> toClip(const Vec3& point) const;
+
+    std::array<double, 16> view_projection_{};
+    std::array<double, 16> inverse_{};
+    double width_{0.0};
+    double height_{0.0};
+    std::vector<Plane> planes_;
+};
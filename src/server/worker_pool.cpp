@@ -0,0 +1,170 @@
+#include "worker_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+
+// Lane of the job running on this thread, so nested work of that lane does not wait on itself
+struct CurrentJob {
+    const WorkerPool* pool{nullptr};
+    size_t lane{0};
+};
+thread_local CurrentJob current_job;
+
+// Marks the thread as running a job of the lane until destroyed
+struct ScopedJob {
+    ScopedJob(const WorkerPool* pool, size_t lane) : previous(current_job) { current_job = {pool, lane}; }
+    ~ScopedJob() { current_job = previous; }
+    CurrentJob previous;
+};
+
+} // namespace
+
+WorkerPool::WorkerPool(size_t thread_count, std::vector<LaneLimits> lanes) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    lanes_.resize(lanes.size());
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        lanes_[i].limits = lanes[i];
+        lanes_[i].limits.max_running = std::max<size_t>(1, lanes[i].max_running);
+    }
+
+    threads_.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::submit(size_t lane, std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (lane >= lanes_.size()) {
+            return false;
+        }
+        Lane& target = lanes_[lane];
+        if (stopping_ || target.queue.size() >= target.limits.max_queued) {
+            target.rejected++;
+            return false;
+        }
+        target.queue.push_back(std::move(job));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void WorkerPool::runInline(size_t lane, const std::function<void()>& job) {
+    if (lane >= lanes_.size() || (current_job.pool == this && current_job.lane == lane)) {
+        job();
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Lane& target = lanes_[lane];
+        slot_cv_.wait(lock, [this, &target] { return stopping_ || target.running < target.limits.max_running; });
+        target.running++;
+    }
+
+    // Exceptions go to the caller once the slot is given back
+    struct SlotRelease {
+        WorkerPool* pool;
+        size_t lane;
+        ~SlotRelease() { pool->finishJob(lane); }
+    } release{this, lane};
+    ScopedJob scoped(this, lane);
+    job();
+}
+
+void WorkerPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    slot_cv_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+WorkerPool::LaneStats WorkerPool::laneStats(size_t lane) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LaneStats stats;
+    if (lane < lanes_.size()) {
+        stats.running = lanes_[lane].running;
+        stats.queued = lanes_[lane].queue.size();
+        stats.completed = lanes_[lane].completed;
+        stats.rejected = lanes_[lane].rejected;
+    }
+    return stats;
+}
+
+void WorkerPool::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        size_t lane = lanes_.size();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this, &lane] {
+                lane = nextRunnableLane();
+                return lane < lanes_.size() || (stopping_ && !hasQueuedJobs());
+            });
+            if (lane == lanes_.size()) {
+                return;
+            }
+            job = std::move(lanes_[lane].queue.front());
+            lanes_[lane].queue.pop_front();
+            lanes_[lane].running++;
+        }
+
+        try {
+            ScopedJob scoped(this, lane);
+            job();
+        } catch (const std::exception& e) {
+            spdlog::error("WorkerPool: Job in lane {} threw: {}", lane, e.what());
+        } catch (...) {
+            spdlog::error("WorkerPool: Job in lane {} threw an unknown exception", lane);
+        }
+        finishJob(lane);
+    }
+}
+
+void WorkerPool::finishJob(size_t lane) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lanes_[lane].running--;
+        lanes_[lane].completed++;
+    }
+    // A slot in this lane opened up; wake everyone since any waiter may be blocked on it
+    cv_.notify_all();
+    slot_cv_.notify_all();
+}
+
+size_t WorkerPool::nextRunnableLane() {
+    for (size_t i = 0; i < lanes_.size(); ++i) {
+        size_t lane = (next_lane_ + i) % lanes_.size();
+        if (!lanes_[lane].queue.empty() && lanes_[lane].running < lanes_[lane].limits.max_running) {
+            next_lane_ = (lane + 1) % lanes_.size();
+            return lane;
+        }
+    }
+    return lanes_.size();
+}
+
+bool WorkerPool::hasQueuedJobs() const {
+    return std::any_of(lanes_.begin(), lanes_.end(), [](const Lane& lane) { return !lane.queue.empty(); });
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bounded thread pool for heavy OCCT work. Jobs are submitted to a lane
+// (typically one per RPC type); each lane caps how many of its jobs run at
+// once and how many may wait, so a burst of imports can neither occupy every
+// worker nor queue without bound.
+class WorkerPool {
+public:
+    struct LaneLimits {
+        size_t max_running{1};
+        size_t max_queued{64};
+    };
+
+    struct LaneStats {
+        size_t running{0};
+        size_t queued{0};
+        uint64_t completed{0};
+        uint64_t rejected{0};
+    };
+
+    // A thread_count of 0 uses the hardware concurrency
+    WorkerPool(size_t thread_count, std::vector<LaneLimits> lanes);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Returns false without queuing the job if the lane is full or the pool is stopping
+    bool submit(size_t lane, std::function<void()> job);
+
+    // Runs job on the calling thread as one of the lane's running jobs, waiting for a
+    // free slot first, so synchronous handlers share the lane's concurrency limit.
+    // Called from a job of the same lane it runs at once; once stopping it no longer waits.
+    void runInline(size_t lane, const std::function<void()>& job);
+
+    // Stops accepting jobs, runs the ones already queued and joins the workers
+    void shutdown();
+
+    size_t threadCount() const { return threads_.size(); }
+    LaneStats laneStats(size_t lane) const;
+
+private:
+    struct Lane {
+        LaneLimits limits;
+        std::deque<std::function<void()>> queue;
+        size_t running{0};
+        uint64_t completed{0};
+        uint64_t rejected{0};
+    };
+
+    void workerLoop();
+    void finishJob(size_t lane);
+
+    // Must be called with mutex_ locked; returns lanes_.size() if nothing can run
+    size_t nextRunnableLane();
+    bool hasQueuedJobs() const;
+
+    std::vector<Lane> lanes_;
+    size_t next_lane_{0};  // Round-robin start so no lane starves the others
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable slot_cv_;  // runInline callers, kept apart so submit's notify_one reaches a worker
+};
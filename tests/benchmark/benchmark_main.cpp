@@ -0,0 +1,209 @@
+// Benchmark entry point: Google Benchmark's usual flags (--benchmark_filter,
+// --benchmark_out=FILE --benchmark_out_format=json, --benchmark_repetitions, ...)
+// plus a baseline comparison mode:
+//
+//   OcctImgui_Benchmarks --baseline=baseline.json [--max_regression=0.10]
+//
+// compares every benchmark against the same-named one in a JSON file written
+// earlier with --benchmark_out, by items/s when both report it and by real time
+// otherwise, using the median when run with repetitions. Exits with 1 when any
+// benchmark is slower than the baseline by more than max_regression.
+
+#include <benchmark/benchmark.h>
+#include <google/protobuf/struct.pb.h>
+#include <google/protobuf/util/json_util.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark_support.h"
+
+namespace {
+
+struct Measurement {
+    double real_seconds{0.0};                // Per iteration
+    std::optional<double> items_per_second;
+    bool from_median{false};
+};
+using Measurements = std::map<std::string, Measurement>;
+
+// Keeps iteration runs unless a median aggregate of the same run exists
+void keep(Measurements& measurements, const std::string& name, const Measurement& measurement) {
+    auto& slot = measurements[name];
+    if (measurement.from_median || !slot.from_median) {
+        slot = measurement;
+    }
+}
+
+double secondsPerUnit(const std::string& time_unit) {
+    if (time_unit == "ns") return 1e-9;
+    if (time_unit == "us") return 1e-6;
+    if (time_unit == "ms") return 1e-3;
+    return 1.0;
+}
+
+std::optional<Measurements> loadBaseline(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        spdlog::error("Cannot open baseline {}", path);
+        return std::nullopt;
+    }
+    std::stringstream json;
+    json << file.rdbuf();
+    google::protobuf::Struct root;
+    google::protobuf::util::JsonParseOptions options;
+    options.ignore_unknown_fields = true;
+    if (!google::protobuf::util::JsonStringToMessage(json.str(), &root, options).ok()) {
+        spdlog::error("Baseline {} is not valid JSON", path);
+        return std::nullopt;
+    }
+
+    Measurements measurements;
+    const auto benchmarks = root.fields().find("benchmarks");
+    if (benchmarks == root.fields().end()) {
+        spdlog::error("Baseline {} has no benchmarks; write it with --benchmark_out_format=json", path);
+        return std::nullopt;
+    }
+    for (const auto& value : benchmarks->second.list_value().values()) {
+        const auto& fields = value.struct_value().fields();
+        auto text = [&fields](const char* key) {
+            auto it = fields.find(key);
+            return it == fields.end() ? std::string() : it->second.string_value();
+        };
+        auto has = [&fields](const char* key) { return fields.count(key) > 0; };
+        if (has("error_occurred") && fields.at("error_occurred").bool_value()) {
+            continue;
+        }
+        const bool aggregate = text("run_type") == "aggregate";
+        if (aggregate && text("aggregate_name") != "median") {
+            continue;
+        }
+        if (!has("real_time")) {
+            continue;
+        }
+        Measurement measurement;
+        measurement.real_seconds = fields.at("real_time").number_value() * secondsPerUnit(text("time_unit"));
+        if (has("items_per_second")) {
+            measurement.items_per_second = fields.at("items_per_second").number_value();
+        }
+        measurement.from_median = aggregate;
+        keep(measurements, has("run_name") ? text("run_name") : text("name"), measurement);
+    }
+    return measurements;
+}
+
+// Prints as the console reporter does while collecting what will be compared
+class CollectingReporter : public benchmark::ConsoleReporter {
+public:
+    CollectingReporter() : ConsoleReporter(OO_Tabular) {}
+
+    void ReportRuns(const std::vector<Run>& runs) override {
+        ConsoleReporter::ReportRuns(runs);
+        for (const auto& run : runs) {
+            const bool aggregate = run.run_type == Run::RT_Aggregate;
+            if (run.error_occurred || (aggregate && run.aggregate_name != "median")) {
+                continue;
+            }
+            Measurement measurement;
+            measurement.real_seconds = run.GetAdjustedRealTime() / benchmark::GetTimeUnitMultiplier(run.time_unit);
+            auto items = run.counters.find("items_per_second");
+            if (items != run.counters.end()) {
+                measurement.items_per_second = items->second.value;
+            }
+            measurement.from_median = aggregate;
+            keep(measurements_, run.run_name.str(), measurement);
+        }
+    }
+
+    const Measurements& measurements() const { return measurements_; }
+
+private:
+    Measurements measurements_;
+};
+
+// Returns the number of regressions beyond max_regression
+int compare(const Measurements& baseline, const Measurements& current, double max_regression) {
+    int regressions = 0;
+    std::printf("\nComparison with baseline (regression threshold %.1f%%)\n", max_regression * 100.0);
+    std::printf("%-60s %14s %14s %9s\n", "Benchmark", "Baseline", "Current", "Change");
+    for (const auto& [name, now] : current) {
+        auto before = baseline.find(name);
+        if (before == baseline.end()) {
+            std::printf("%-60s %14s %14s %9s\n", name.c_str(), "-", "-", "new");
+            continue;
+        }
+        // Positive change is a slowdown in both metrics
+        const bool by_items = now.items_per_second && before->second.items_per_second &&
+                              *before->second.items_per_second > 0.0;
+        double old_value = by_items ? *before->second.items_per_second : before->second.real_seconds * 1e3;
+        double new_value = by_items ? *now.items_per_second : now.real_seconds * 1e3;
+        if (old_value <= 0.0) {
+            continue;
+        }
+        const double change = by_items ? (old_value - new_value) / old_value : (new_value - old_value) / old_value;
+        const bool regressed = change > max_regression;
+        regressions += regressed ? 1 : 0;
+        std::printf("%-60s %12.4g%-2s %12.4g%-2s %+8.1f%%%s\n", name.c_str(), old_value, by_items ? "/s" : "ms",
+                    new_value, by_items ? "/s" : "ms", change * 100.0, regressed ? "  REGRESSION" : "");
+    }
+    for (const auto& [name, measurement] : baseline) {
+        if (!current.count(name)) {
+            std::printf("%-60s %14s %14s %9s\n", name.c_str(), "-", "-", "not run");
+        }
+    }
+    std::printf("%d regression(s)\n", regressions);
+    return regressions;
+}
+
+// Takes --name=value out of argv, returning the value
+std::optional<std::string> takeFlag(int& argc, char** argv, const char* name) {
+    const std::string prefix = std::string("--") + name + "=";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], prefix.c_str(), prefix.size()) == 0) {
+            std::string value = argv[i] + prefix.size();
+            for (int j = i; j + 1 < argc; ++j) {
+                argv[j] = argv[j + 1];
+            }
+            --argc;
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::err);  // Service logging would dominate the timings
+
+    const auto baseline_path = takeFlag(argc, argv, "baseline");
+    const double max_regression = std::stod(takeFlag(argc, argv, "max_regression").value_or("0.10"));
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    int exit_code = 0;
+    if (baseline_path) {
+        const auto baseline = loadBaseline(*baseline_path);
+        if (!baseline) {
+            return 1;
+        }
+        CollectingReporter reporter;
+        benchmark::RunSpecifiedBenchmarks(&reporter);
+        exit_code = compare(*baseline, reporter.measurements(), max_regression) > 0 ? 1 : 0;
+    } else {
+        benchmark::RunSpecifiedBenchmarks();
+    }
+
+    bench::shutdownLoadServers();
+    benchmark::Shutdown();
+    return exit_code;
+}
@@ -0,0 +1,81 @@
+#include "benchmark_support.h"
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace bench {
+
+const std::vector<ModelCase>& modelCases() {
+    static const std::vector<ModelCase> cases{
+        {"bolt_stl", "bolt.stl"},
+        {"bearing_igs", "bearing.igs"},
+        {"synthetic_stp", "179_synthetic_case.stp"},
+    };
+    return cases;
+}
+
+std::string modelPath(const char* file) {
+    return std::string(BENCHMARK_MODELS_DIR) + "/" + file;
+}
+
+std::vector<std::string> importModel(GeometryServiceImpl& service, const char* file) {
+    grpc::ServerContext context;
+    geometry::ModelFileRequest request;
+    request.set_file_path(modelPath(file));
+    request.mutable_options()->set_auto_detect_format(true);
+    geometry::ModelImportResponse response;
+    auto status = service.ImportModelFile(&context, &request, &response);
+    if (!status.ok() || !response.success()) {
+        spdlog::error("Benchmark: Failed to import {}: {}", file, response.message());
+        return {};
+    }
+    return {response.shape_ids().begin(), response.shape_ids().end()};
+}
+
+const ImportedModel& importedModel(const char* file) {
+    static std::mutex mutex;
+    static std::map<std::string, ImportedModel> models;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = models.find(file);
+    if (it != models.end()) {
+        return it->second;
+    }
+
+    GeometryServiceOptions options;
+    options.mesh_cache_budget_bytes = 0;
+    ImportedModel model;
+    model.service = std::make_unique<GeometryServiceImpl>(options);
+    model.shape_ids = importModel(*model.service, file);
+    if (model.shape_ids.empty()) {
+        throw std::runtime_error(std::string("Cannot import benchmark model ") + file);
+    }
+    for (const auto& mesh : meshModel(model, geometry::MESH_ENCODING_PACKED_FLOAT32)) {
+        model.triangles += triangleCount(mesh);
+    }
+    return models.emplace(file, std::move(model)).first->second;
+}
+
+std::vector<geometry::MeshData> meshModel(const ImportedModel& model, geometry::MeshEncoding encoding) {
+    std::vector<geometry::MeshData> meshes;
+    meshes.reserve(model.shape_ids.size());
+    for (const auto& shape_id : model.shape_ids) {
+        grpc::ServerContext context;
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+        request.mutable_mesh_options()->set_encoding(encoding);
+        geometry::MeshData mesh;
+        if (model.service->GetMeshData(&context, &request, &mesh).ok()) {
+            meshes.push_back(std::move(mesh));
+        }
+    }
+    return meshes;
+}
+
+uint64_t triangleCount(const geometry::MeshData& mesh) {
+    return mesh.has_packed() ? mesh.packed().triangle_count() : static_cast<uint64_t>(mesh.indices_size() / 3);
+}
+
+} // namespace bench
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "server/geometry_service_impl.h"
+#include "geometry_service.pb.h"
+
+namespace bench {
+
+// Models under tests/test_data/models the mesh benchmarks run on
+struct ModelCase {
+    const char* label;  // Benchmark name component
+    const char* file;
+};
+const std::vector<ModelCase>& modelCases();
+std::string modelPath(const char* file);
+
+// A model imported once into its own service with the mesh cache disabled, so
+// GetMeshData reaches the extraction path on every call
+struct ImportedModel {
+    std::unique_ptr<GeometryServiceImpl> service;
+    std::vector<std::string> shape_ids;
+    uint64_t triangles{0};  // Across all shapes, full quality
+};
+const ImportedModel& importedModel(const char* file);
+
+// Imports file into service; returns the new shape ids, empty on failure
+std::vector<std::string> importModel(GeometryServiceImpl& service, const char* file);
+
+// GetMeshData for every shape of the model in the given encoding
+std::vector<geometry::MeshData> meshModel(const ImportedModel& model, geometry::MeshEncoding encoding);
+
+uint64_t triangleCount(const geometry::MeshData& mesh);
+
+// Stops the in-process servers the load benchmarks started; called before exit
+void shutdownLoadServers();
+
+} // namespace bench
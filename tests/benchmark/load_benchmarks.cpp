@@ -0,0 +1,147 @@
+#include <benchmark/benchmark.h>
+#include <grpcpp/grpcpp.h>
+#include <spdlog/fmt/fmt.h>
+#include <mutex>
+
+#include "benchmark_support.h"
+#include "client/grpc/geometry_client.h"
+#include "common/grpc_performance_monitor.h"
+#include "server/async_geometry_service.h"
+#include "server/rpc_metrics_interceptor.h"
+
+// End-to-end load over loopback gRPC: every benchmark thread is a separate
+// client with its own session, swept over 1-16 concurrent clients against the
+// synchronous and the async server. Items are RPCs; the p50/p99 counters are
+// server-side latencies from the RPC metrics interceptor.
+
+namespace {
+
+struct LoadServer {
+    std::unique_ptr<GeometryServiceImpl> service;
+    std::unique_ptr<AsyncGeometryService> async_service;
+    std::unique_ptr<grpc::Server> server;
+    std::string address;
+};
+
+std::mutex servers_mutex;
+std::unique_ptr<LoadServer> servers[2];  // Indexed by async mode
+
+const std::string& loadServerAddress(bool async) {
+    std::lock_guard<std::mutex> lock(servers_mutex);
+    auto& slot = servers[async ? 1 : 0];
+    if (!slot) {
+        GeometryServiceOptions options;
+        options.async_server = async;
+        slot = std::make_unique<LoadServer>();
+        slot->service = std::make_unique<GeometryServiceImpl>(options);
+
+        int port = 0;
+        grpc::ServerBuilder builder;
+        builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+        std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>> interceptors;
+        interceptors.push_back(std::make_unique<RpcMetricsInterceptorFactory>());
+        builder.experimental().SetInterceptorCreators(std::move(interceptors));
+        if (async) {
+            slot->async_service = std::make_unique<AsyncGeometryService>(*slot->service, options);
+            builder.RegisterService(slot->async_service.get());
+        } else {
+            builder.RegisterService(slot->service.get());
+        }
+        slot->server = builder.BuildAndStart();
+        slot->address = "127.0.0.1:" + std::to_string(port);
+    }
+    return slot->address;
+}
+
+std::unique_ptr<GeometryClient> connectClient(const benchmark::State& state, const char* scenario) {
+    const bool async = state.range(0) != 0;
+    auto client = std::make_unique<GeometryClient>(
+        loadServerAddress(async),
+        fmt::format("bench-{}-{}-{}", scenario, async ? "async" : "sync", state.thread_index()));
+    if (!client->Connect()) {
+        return nullptr;
+    }
+    client->ClearAll();
+    return client;
+}
+
+// Thread 0 clears the operation's samples before the run and reports its
+// percentiles after; the other threads wait at the loop's start and end barriers
+void resetServerLatency(const benchmark::State& state, const char* method) {
+    if (state.thread_index() == 0) {
+        GrpcPerformanceMonitor::getInstance().operation(std::string("Server.") + method).reset();
+    }
+}
+
+void reportServerLatency(benchmark::State& state, const char* method) {
+    if (state.thread_index() == 0) {
+        const auto stats = GrpcPerformanceMonitor::getInstance().getOperationStats(std::string("Server.") + method);
+        state.counters["p50_ms"] = stats.p50_time_ms;
+        state.counters["p99_ms"] = stats.p99_time_ms;
+        state.counters["errors"] = static_cast<double>(stats.error_count);
+    }
+}
+
+// Read-heavy: every client streams the meshes of its demo scene
+void BM_LoadGetAllMeshes(benchmark::State& state) {
+    auto client = connectClient(state, "meshes");
+    if (!client || !client->CreateDemoScene()) {
+        state.SkipWithError("Cannot connect or build the demo scene");
+        return;
+    }
+    resetServerLatency(state, "GetAllMeshes");
+    for (auto _ : state) {
+        auto meshes = client->GetAllMeshes();
+        benchmark::DoNotOptimize(meshes.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportServerLatency(state, "GetAllMeshes");
+}
+
+// Write-heavy: create a shape, fetch its mesh, delete it
+void BM_LoadCreateMeshDelete(benchmark::State& state) {
+    auto client = connectClient(state, "churn");
+    if (!client) {
+        state.SkipWithError("Cannot connect");
+        return;
+    }
+    resetServerLatency(state, "GetMeshData");
+    for (auto _ : state) {
+        const std::string shape_id = client->CreateBox(0, 0, 0, 10, 10, 10);
+        auto mesh = client->GetMeshData(shape_id);
+        benchmark::DoNotOptimize(mesh.vertices.data());
+        client->DeleteShape(shape_id);
+    }
+    state.SetItemsProcessed(state.iterations() * 3);
+    reportServerLatency(state, "GetMeshData");
+}
+
+BENCHMARK(BM_LoadGetAllMeshes)
+    ->ArgName("async")
+    ->DenseRange(0, 1)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LoadCreateMeshDelete)
+    ->ArgName("async")
+    ->DenseRange(0, 1)
+    ->ThreadRange(1, 16)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+
+namespace bench {
+
+void shutdownLoadServers() {
+    std::lock_guard<std::mutex> lock(servers_mutex);
+    for (auto& slot : servers) {
+        if (slot) {
+            slot->server->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(1));
+            slot.reset();
+        }
+    }
+}
+
+} // namespace bench
@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+
+#include "benchmark_support.h"
+#include "client/grpc/geometry_client.h"
+#include "client/occt/OcctRenderClient.h"
+
+// Micro-benchmarks of the mesh path a shape takes from the server's B-rep to a
+// client AIS object: extraction, protobuf encode and decode, client conversion
+// and AIS construction. Items are triangles, bytes are serialized message bytes.
+
+namespace {
+
+using bench::ImportedModel;
+
+const char* encodingLabel(geometry::MeshEncoding encoding) {
+    return encoding == geometry::MESH_ENCODING_LEGACY ? "legacy" : "packed_float32";
+}
+
+uint64_t serializedBytes(const std::vector<geometry::MeshData>& meshes) {
+    uint64_t bytes = 0;
+    for (const auto& mesh : meshes) {
+        bytes += mesh.ByteSizeLong();
+    }
+    return bytes;
+}
+
+// GetMeshData with the mesh cache off: triangulation extraction and message
+// building on shapes already tessellated by an earlier call
+void BM_ExtractMesh(benchmark::State& state, const char* file, geometry::MeshEncoding encoding) {
+    const ImportedModel& model = bench::importedModel(file);
+    geometry::ShapeRequest request;
+    request.mutable_mesh_options()->set_encoding(encoding);
+    geometry::MeshData mesh;
+    for (auto _ : state) {
+        for (const auto& shape_id : model.shape_ids) {
+            grpc::ServerContext context;
+            request.set_shape_id(shape_id);
+            mesh.Clear();
+            model.service->GetMeshData(&context, &request, &mesh);
+            benchmark::DoNotOptimize(mesh);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * model.triangles);
+}
+
+// Tessellation plus extraction on freshly imported shapes; the import itself is untimed
+void BM_TessellateModel(benchmark::State& state, const char* file) {
+    GeometryServiceOptions options;
+    options.mesh_cache_budget_bytes = 0;
+    GeometryServiceImpl service(options);
+    geometry::ShapeRequest request;
+    request.mutable_mesh_options()->set_encoding(geometry::MESH_ENCODING_PACKED_FLOAT32);
+    geometry::MeshData mesh;
+    uint64_t triangles = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        grpc::ServerContext clear_context;
+        geometry::EmptyRequest clear_request;
+        geometry::StatusResponse clear_response;
+        service.ClearAll(&clear_context, &clear_request, &clear_response);
+        const auto shape_ids = bench::importModel(service, file);
+        state.ResumeTiming();
+
+        for (const auto& shape_id : shape_ids) {
+            grpc::ServerContext context;
+            request.set_shape_id(shape_id);
+            mesh.Clear();
+            service.GetMeshData(&context, &request, &mesh);
+            triangles += bench::triangleCount(mesh);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(triangles));
+}
+
+void BM_MeshDataSerialize(benchmark::State& state, const char* file, geometry::MeshEncoding encoding) {
+    const auto meshes = bench::meshModel(bench::importedModel(file), encoding);
+    std::string buffer;
+    for (auto _ : state) {
+        for (const auto& mesh : meshes) {
+            mesh.SerializeToString(&buffer);
+            benchmark::DoNotOptimize(buffer.data());
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * serializedBytes(meshes));
+    state.SetItemsProcessed(state.iterations() * bench::importedModel(file).triangles);
+}
+
+void BM_MeshDataParse(benchmark::State& state, const char* file, geometry::MeshEncoding encoding) {
+    const auto meshes = bench::meshModel(bench::importedModel(file), encoding);
+    std::vector<std::string> wire;
+    for (const auto& mesh : meshes) {
+        wire.push_back(mesh.SerializeAsString());
+    }
+    geometry::MeshData parsed;
+    for (auto _ : state) {
+        for (const auto& bytes : wire) {
+            parsed.ParseFromString(bytes);
+            benchmark::DoNotOptimize(parsed);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * serializedBytes(meshes));
+    state.SetItemsProcessed(state.iterations() * bench::importedModel(file).triangles);
+}
+
+void BM_ConvertProtoMesh(benchmark::State& state, const char* file, geometry::MeshEncoding encoding) {
+    const auto meshes = bench::meshModel(bench::importedModel(file), encoding);
+    for (auto _ : state) {
+        for (const auto& mesh : meshes) {
+            auto converted = GeometryClient::ConvertProtoMesh(mesh);
+            benchmark::DoNotOptimize(converted.vertices.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * bench::importedModel(file).triangles);
+}
+
+// The MeshPresentation construction half of addMeshPresentation; displaying needs a GL context
+void BM_BuildMeshPresentation(benchmark::State& state, const char* file) {
+    std::vector<GeometryClient::MeshData> meshes;
+    for (const auto& mesh : bench::meshModel(bench::importedModel(file), geometry::MESH_ENCODING_PACKED_FLOAT32)) {
+        meshes.push_back(GeometryClient::ConvertProtoMesh(mesh));
+    }
+    for (auto _ : state) {
+        for (const auto& mesh : meshes) {
+            Handle(MeshPresentation) presentation = OcctRenderClient::buildMeshPresentation(mesh);
+            benchmark::DoNotOptimize(presentation.get());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * bench::importedModel(file).triangles);
+}
+
+const bool registered = [] {
+    const geometry::MeshEncoding encodings[] = {geometry::MESH_ENCODING_LEGACY,
+                                                geometry::MESH_ENCODING_PACKED_FLOAT32};
+    for (const auto& model : bench::modelCases()) {
+        const std::string label = model.label;
+        for (auto encoding : encodings) {
+            const std::string suffix = label + "/" + encodingLabel(encoding);
+            benchmark::RegisterBenchmark(("ExtractMesh/" + suffix).c_str(), BM_ExtractMesh, model.file, encoding)
+                ->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("MeshDataSerialize/" + suffix).c_str(), BM_MeshDataSerialize,
+                                         model.file, encoding)
+                ->Unit(benchmark::kMicrosecond);
+            benchmark::RegisterBenchmark(("MeshDataParse/" + suffix).c_str(), BM_MeshDataParse, model.file,
+                                         encoding)
+                ->Unit(benchmark::kMicrosecond);
+            benchmark::RegisterBenchmark(("ConvertProtoMesh/" + suffix).c_str(), BM_ConvertProtoMesh, model.file,
+                                         encoding)
+                ->Unit(benchmark::kMicrosecond);
+        }
+        benchmark::RegisterBenchmark(("TessellateModel/" + label).c_str(), BM_TessellateModel, model.file)
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(("BuildMeshPresentation/" + label).c_str(), BM_BuildMeshPresentation,
+                                     model.file)
+            ->Unit(benchmark::kMillisecond);
+    }
+    return true;
+}();
+
+} // namespace
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <grpcpp/grpcpp.h>
+
+#include "server/scoped_temp_file.h"
+#include "server/worker_pool.h"
+#include "loopback_server.h"
+
+// Tests for the bounded worker pool itself
+TEST(WorkerPoolTest, RespectsLaneConcurrencyLimit) {
+    WorkerPool pool(4, {{1, 16}, {4, 16}});
+
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::atomic<int> done{0};
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(pool.submit(0, [&] {
+            int now = ++running;
+            int expected = peak.load();
+            while (now > expected && !peak.compare_exchange_weak(expected, now)) {}
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            --running;
+            ++done;
+        }));
+    }
+    pool.shutdown();
+
+    EXPECT_EQ(done.load(), 8);
+    EXPECT_EQ(peak.load(), 1);
+    EXPECT_EQ(pool.laneStats(0).completed, 8u);
+}
+
+TEST(WorkerPoolTest, FullLaneRejectsWithoutBlockingOthers) {
+    WorkerPool pool(2, {{1, 1}, {1, 4}});
+
+    // Occupy lane 0's only slot, then fill its one-entry queue
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    ASSERT_TRUE(pool.submit(0, [&] {
+        started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(pool.submit(0, [] {}));
+    EXPECT_FALSE(pool.submit(0, [] {}));
+    EXPECT_EQ(pool.laneStats(0).rejected, 1u);
+
+    // Lane 1 still runs while lane 0 is saturated
+    std::atomic<bool> light_done{false};
+    ASSERT_TRUE(pool.submit(1, [&] { light_done = true; }));
+    for (int i = 0; i < 1000 && !light_done; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(light_done);
+
+    release = true;
+    pool.shutdown();
+    EXPECT_EQ(pool.laneStats(0).completed, 2u);
+    EXPECT_FALSE(pool.submit(1, [] {}));
+}
+
+TEST(WorkerPoolTest, InlineWorkSharesTheLaneLimit) {
+    WorkerPool pool(2, {{1, 16}});
+
+    // Hold the lane's only slot from the calling thread while a queued job waits
+    std::atomic<bool> queued_ran{false};
+    std::atomic<bool> nested_ran{false};
+    pool.runInline(0, [&] {
+        ASSERT_TRUE(pool.submit(0, [&] { queued_ran = true; }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_FALSE(queued_ran);
+        pool.runInline(0, [&] { nested_ran = true; });  // Same lane: runs at once
+    });
+    EXPECT_TRUE(nested_ran);
+
+    // A job of the lane running inline work of that lane does not wait on itself
+    std::atomic<bool> inner_ran{false};
+    ASSERT_TRUE(pool.submit(0, [&] { pool.runInline(0, [&] { inner_ran = true; }); }));
+    pool.shutdown();
+    EXPECT_TRUE(queued_ran);
+    EXPECT_TRUE(inner_ran);
+    EXPECT_EQ(pool.laneStats(0).completed, 3u);
+}
+
+// End-to-end tests for the async server front end
+class AsyncServerTest : public ::testing::Test {
+protected:
+    void StartServer(GeometryServiceOptions options) {
+        options.async_server = true;
+        ASSERT_NO_FATAL_FAILURE(server_.start(options));
+    }
+
+    LoopbackServer server_;
+};
+
+TEST_F(AsyncServerTest, HeavyAndLightRpcsWork) {
+    ASSERT_NO_FATAL_FAILURE(StartServer(GeometryServiceOptions()));
+
+    GeometryClient client(server_.address(), "async-test");
+    ASSERT_TRUE(client.Connect());
+
+    std::string shape_id = client.CreateBox(0, 0, 0, 10, 10, 10);
+    ASSERT_FALSE(shape_id.empty());
+
+    auto mesh = client.GetMeshData(shape_id);
+    EXPECT_EQ(mesh.shape_id, shape_id);
+    EXPECT_FALSE(mesh.vertices.empty());
+
+    auto exported = client.ExportModelFile({shape_id});
+    EXPECT_TRUE(exported.success) << exported.message;
+    EXPECT_FALSE(exported.model_data.empty());
+
+    EXPECT_EQ(client.GetSystemInfo().active_shapes, 1);
+    EXPECT_EQ(server_.asyncService().getLaneStats(RpcLane::Mesh).completed, 1u);
+    EXPECT_EQ(server_.asyncService().getLaneStats(RpcLane::Export).completed, 1u);
+    client.Disconnect();
+}
+
+TEST_F(AsyncServerTest, CompressedChannelCarriesQuantizedMeshes) {
+    GeometryServiceOptions options;
+    options.grpc_compression = GRPC_COMPRESS_GZIP;
+    ASSERT_NO_FATAL_FAILURE(StartServer(options));
+
+    GeometryClient client(server_.address(), "async-test");
+    client.SetChannelCompression(GRPC_COMPRESS_GZIP);
+    client.SetMeshEncoding(geometry::MESH_ENCODING_QUANTIZED);
+    ASSERT_TRUE(client.Connect());
+
+    std::string shape_id = client.CreateBox(0, 0, 0, 10, 20, 30);
+    ASSERT_FALSE(shape_id.empty());
+
+    auto mesh = client.GetMeshData(shape_id);
+    ASSERT_EQ(mesh.vertices.size(), 24u * 3);
+    EXPECT_EQ(mesh.normals.size(), mesh.vertices.size());
+    EXPECT_EQ(mesh.indices.size(), 36u);
+    // The box is its own quantization box, so corners decode exactly
+    for (size_t i = 0; i < mesh.vertices.size(); i += 3) {
+        EXPECT_TRUE(mesh.vertices[i] == 0.0f || mesh.vertices[i] == 10.0f);
+        EXPECT_TRUE(mesh.vertices[i + 1] == 0.0f || mesh.vertices[i + 1] == 20.0f);
+        EXPECT_TRUE(mesh.vertices[i + 2] == 0.0f || mesh.vertices[i + 2] == 30.0f);
+    }
+    client.Disconnect();
+}
+
+TEST_F(AsyncServerTest, FullLaneFailsWithResourceExhausted) {
+    GeometryServiceOptions options;
+    options.max_queued_per_rpc = 0;  // Every heavy request is rejected
+    ASSERT_NO_FATAL_FAILURE(StartServer(options));
+
+    GeometryClient client(server_.address(), "async-test");
+    ASSERT_TRUE(client.Connect());
+    std::string shape_id = client.CreateBox(0, 0, 0, 10, 10, 10);
+    ASSERT_FALSE(shape_id.empty());
+
+    auto stub = server_.newStub();
+    grpc::ClientContext context;
+    context.AddMetadata("client-id", "async-test");
+    geometry::ShapeRequest request;
+    request.set_shape_id(shape_id);
+    geometry::MeshData response;
+    grpc::Status status = stub->GetMeshData(&context, request, &response);
+
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED);
+    EXPECT_EQ(server_.asyncService().getLaneStats(RpcLane::Mesh).rejected, 1u);
+
+    // Light calls are unaffected
+    EXPECT_EQ(client.GetSystemInfo().active_shapes, 1);
+    client.Disconnect();
+}
+
+TEST_F(AsyncServerTest, BulkImportReadsFilesOnImportLane) {
+    GeometryServiceOptions options;
+    options.max_concurrent_imports = 3;
+    ASSERT_NO_FATAL_FAILURE(StartServer(options));
+
+    GeometryClient client(server_.address(), "async-test");
+    ASSERT_TRUE(client.Connect());
+    std::string box_id = client.CreateBox(0, 0, 0, 10, 10, 10);
+    ASSERT_FALSE(box_id.empty());
+    auto exported = client.ExportModelFile({box_id});
+    ASSERT_TRUE(exported.success) << exported.message;
+    ScopedTempFile file("box.step");
+    file.write(exported.model_data);
+
+    std::vector<std::string> paths(8, file.path());
+    paths.push_back("missing.step");
+    auto result = client.ImportModelFiles(paths);
+
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.imported_files, 8);
+    ASSERT_EQ(result.files.size(), paths.size());
+    EXPECT_FALSE(result.files.back().success);
+    size_t shapes = 0;
+    for (size_t i = 0; i + 1 < result.files.size(); ++i) {
+        EXPECT_TRUE(result.files[i].success) << result.files[i].message;
+        EXPECT_EQ(result.files[i].detected_format, "STEP");
+        shapes += result.files[i].shape_ids.size();
+    }
+    EXPECT_EQ(client.GetSystemInfo().active_shapes, static_cast<int>(1 + shapes));
+    EXPECT_GE(server_.asyncService().getLaneStats(RpcLane::Import).completed, 3u);
+    client.Disconnect();
+}
+
+TEST_F(AsyncServerTest, StreamsAndBatchesRunOnTheMeshLane) {
+    ASSERT_NO_FATAL_FAILURE(StartServer(GeometryServiceOptions()));
+
+    GeometryClient client(server_.address(), "async-test");
+    ASSERT_TRUE(client.Connect());
+    GeometryClient::Batch batch;
+    batch.CreateBox(0, 0, 0, 10, 10, 10).CreateBox(20, 0, 0, 10, 10, 10).CreateBox(40, 0, 0, 10, 10, 10);
+    auto created = client.ExecuteBatch(batch);
+    ASSERT_TRUE(created.success) << created.message;
+    EXPECT_EQ(client.GetSystemInfo().active_shapes, 3);
+    EXPECT_EQ(server_.asyncService().getLaneStats(RpcLane::Mesh).completed, 1u);
+
+    // Each shape meshed by the sync stream takes a Mesh lane slot; cache hits do not
+    EXPECT_EQ(client.GetAllMeshes().size(), 3u);
+    EXPECT_EQ(server_.asyncService().getLaneStats(RpcLane::Mesh).completed, 4u);
+    EXPECT_EQ(client.GetAllMeshes().size(), 3u);
+    EXPECT_EQ(server_.asyncService().getLaneStats(RpcLane::Mesh).completed, 4u);
+    client.Disconnect();
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include "loopback_server.h"
+
+// Tests for the ExecuteBatch RPC
+class BatchOperationsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "batch-client"));
+    }
+
+    static constexpr std::array<double, 16> kTranslateX{1, 0, 0, 10,
+                                                        0, 1, 0, 0,
+                                                        0, 0, 1, 0,
+                                                        0, 0, 0, 1};
+
+    LoopbackServer server_;
+};
+
+TEST_F(BatchOperationsTest, CreatesManyPrimitivesInOneCall) {
+    GeometryClient::Batch batch;
+    for (int i = 0; i < 250; ++i) {
+        batch.CreateBox(i * 5.0, 0, 0, 2, 2, 2);
+    }
+    batch.CreateCone(0, 10, 0, 3, 1, 5).CreateSphere(0, 20, 0, 2).CreateCylinder(0, 30, 0, 1, 4);
+
+    auto result = server_.client().ExecuteBatch(batch);
+    ASSERT_TRUE(result.success) << result.message;
+    EXPECT_TRUE(result.applied);
+    ASSERT_EQ(result.operations.size(), batch.size());
+    for (const auto& op : result.operations) {
+        EXPECT_TRUE(op.success) << op.message;
+        EXPECT_FALSE(op.shape_id.empty());
+    }
+    EXPECT_EQ(server_.client().GetSystemInfo().active_shapes, static_cast<int>(batch.size()));
+
+    auto delta = server_.client().SyncScene(0);
+    ASSERT_TRUE(delta.success);
+    EXPECT_EQ(delta.changed.size(), batch.size());
+}
+
+TEST_F(BatchOperationsTest, MixedOperationsOnExistingShapes) {
+    std::string keep_id = server_.client().CreateBox(0, 0, 0, 10, 10, 10);
+    std::string drop_id = server_.client().CreateSphere(50, 0, 0, 5);
+    ASSERT_FALSE(keep_id.empty());
+    ASSERT_FALSE(drop_id.empty());
+    auto before = server_.client().SyncScene(0);
+    ASSERT_TRUE(before.success);
+
+    GeometryClient::Batch batch;
+    batch.Transform(keep_id, kTranslateX).SetColor(keep_id, 0.1, 0.2, 0.3).Delete(drop_id);
+    auto result = server_.client().ExecuteBatch(batch);
+    ASSERT_TRUE(result.success) << result.message;
+    EXPECT_EQ(server_.client().GetSystemInfo().active_shapes, 1);
+
+    // One record per shape, whatever the number of operations on it
+    auto delta = server_.client().SyncScene(before.scene_version);
+    ASSERT_TRUE(delta.success);
+    ASSERT_EQ(delta.changed.size(), 1u);
+    EXPECT_EQ(delta.changed[0].shape_id, keep_id);
+    EXPECT_NEAR(delta.changed[0].color[2], 0.3f, 1e-5f);
+    ASSERT_EQ(delta.deleted_shape_ids.size(), 1u);
+    EXPECT_EQ(delta.deleted_shape_ids[0], drop_id);
+}
+
+TEST_F(BatchOperationsTest, FailedOperationDoesNotStopNonTransactionalBatch) {
+    GeometryClient::Batch batch;
+    batch.CreateBox(0, 0, 0, 1, 1, 1).Delete("no_such_shape").CreateBox(5, 0, 0, 1, 1, 1);
+
+    auto result = server_.client().ExecuteBatch(batch);
+    EXPECT_FALSE(result.success);
+    EXPECT_TRUE(result.applied);
+    ASSERT_EQ(result.operations.size(), 3u);
+    EXPECT_TRUE(result.operations[0].success);
+    EXPECT_FALSE(result.operations[1].success);
+    EXPECT_TRUE(result.operations[2].success);
+    EXPECT_EQ(server_.client().GetSystemInfo().active_shapes, 2);
+}
+
+TEST_F(BatchOperationsTest, TransactionalBatchRollsBackOnFailure) {
+    std::string box_id = server_.client().CreateBox(0, 0, 0, 10, 10, 10);
+    ASSERT_FALSE(box_id.empty());
+    auto before = server_.client().SyncScene(0);
+    ASSERT_TRUE(before.success);
+
+    GeometryClient::Batch batch;
+    batch.CreateSphere(0, 0, 0, 5)
+         .Delete(box_id)
+         .Transform(box_id, kTranslateX)  // Fails: deleted earlier in the batch
+         .CreateBox(5, 0, 0, 1, 1, 1);
+
+    auto result = server_.client().ExecuteBatch(batch, true);
+    EXPECT_FALSE(result.success);
+    EXPECT_FALSE(result.applied);
+    ASSERT_EQ(result.operations.size(), 4u);
+    EXPECT_TRUE(result.operations[0].shape_id.empty());
+    EXPECT_FALSE(result.operations[2].success);
+    EXPECT_FALSE(result.operations[3].success);
+
+    // Session untouched
+    EXPECT_EQ(server_.client().GetSystemInfo().active_shapes, 1);
+    auto delta = server_.client().SyncScene(before.scene_version);
+    ASSERT_TRUE(delta.success);
+    EXPECT_TRUE(delta.changed.empty());
+    EXPECT_TRUE(delta.deleted_shape_ids.empty());
+}
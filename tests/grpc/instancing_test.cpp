@@ -0,0 +1,234 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <STEPCAFControl_Writer.hxx>
+#include <TDocStd_Document.hxx>
+#include <XCAFApp_Application.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+#include <gp_Trsf.hxx>
+#include <grpcpp/grpcpp.h>
+
+#include "server/scoped_temp_file.h"
+#include "loopback_server.h"
+
+namespace {
+
+constexpr int kCopies = 3;
+constexpr double kSpacing = 30.0;
+
+// An assembly placing the same 10 mm box kCopies times along x
+void WriteRepeatedPartAssembly(const std::string& path) {
+    // Standalone, so the shared application keeps no reference to it
+    Handle(TDocStd_Document) doc = new TDocStd_Document("MDTV-XCAF");
+    XCAFApp_Application::GetApplication()->InitDocument(doc);
+    Handle(XCAFDoc_ShapeTool) shapes = XCAFDoc_DocumentTool::ShapeTool(doc->Main());
+    TDF_Label part = shapes->AddShape(BRepPrimAPI_MakeBox(10, 10, 10).Shape(), Standard_False);
+    TDF_Label assembly = shapes->NewShape();
+    for (int i = 0; i < kCopies; ++i) {
+        gp_Trsf placement;
+        placement.SetTranslation(gp_Vec(kSpacing * i, 0, 0));
+        shapes->AddComponent(assembly, part, TopLoc_Location(placement));
+    }
+    shapes->UpdateAssemblies();
+
+    STEPCAFControl_Writer writer;
+    ASSERT_TRUE(writer.Transfer(doc, STEPControl_AsIs));
+    ASSERT_EQ(writer.Write(path.c_str()), IFSelect_RetDone);
+}
+
+float MinX(const GeometryClient::MeshData& mesh) {
+    float min_x = mesh.vertices.at(0);
+    for (size_t i = 0; i < mesh.vertices.size(); i += 3) {
+        min_x = std::min(min_x, mesh.vertices[i]);
+    }
+    return min_x;
+}
+
+} // namespace
+
+class InstancingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "instancing-client"));
+
+        ScopedTempFile file("assembly.step");
+        WriteRepeatedPartAssembly(file.path());
+        auto result = server_.client().UploadModelFile(file.path());
+        ASSERT_TRUE(result.success) << result.message;
+        shape_ids_ = result.shape_ids;
+        ASSERT_EQ(shape_ids_.size(), static_cast<size_t>(kCopies));
+    }
+
+    LoopbackServer server_;
+    std::vector<std::string> shape_ids_;
+};
+
+TEST_F(InstancingTest, RepeatedPartIsSentOnceWithPerShapeTransforms) {
+    server_.client().SetMeshInstancing(true);
+    auto meshes = server_.client().GetAllMeshes();
+    ASSERT_EQ(meshes.size(), static_cast<size_t>(kCopies));
+
+    size_t with_geometry = 0;
+    std::vector<double> offsets;
+    for (const auto& mesh : meshes) {
+        EXPECT_FALSE(mesh.prototype_id.empty());
+        EXPECT_EQ(mesh.prototype_id, meshes[0].prototype_id);
+        if (!mesh.vertices.empty()) {
+            ++with_geometry;
+            EXPECT_NEAR(MinX(mesh), 0.0f, 1e-4f);  // In the part's own coordinates
+        }
+        offsets.push_back(mesh.instance_transform[3]);
+    }
+    EXPECT_EQ(with_geometry, 1u);
+    EXPECT_FALSE(meshes[0].vertices.empty());  // Geometry comes before the shapes reusing it
+
+    std::sort(offsets.begin(), offsets.end());
+    for (int i = 0; i < kCopies; ++i) {
+        EXPECT_NEAR(offsets[i], kSpacing * i, 1e-9);
+    }
+}
+
+TEST_F(InstancingTest, ClientsWithoutInstancingGetPlacedMeshes) {
+    std::vector<float> min_x;
+    for (const auto& mesh : server_.client().GetAllMeshes()) {
+        EXPECT_TRUE(mesh.prototype_id.empty());
+        ASSERT_FALSE(mesh.vertices.empty());
+        min_x.push_back(MinX(mesh));
+    }
+    ASSERT_EQ(min_x.size(), static_cast<size_t>(kCopies));
+    std::sort(min_x.begin(), min_x.end());
+    for (int i = 0; i < kCopies; ++i) {
+        EXPECT_NEAR(min_x[i], kSpacing * i, 1e-4);
+    }
+
+    auto single = server_.client().GetMeshData(shape_ids_[1]);
+    EXPECT_EQ(single.shape_id, shape_ids_[1]);
+    EXPECT_TRUE(single.prototype_id.empty());
+    EXPECT_FALSE(single.vertices.empty());
+}
+
+TEST_F(InstancingTest, TransformedInstanceStaysShared) {
+    GeometryClient::Batch batch;
+    batch.Transform(shape_ids_[0], {1, 0, 0, 0, 0, 1, 0, 100, 0, 0, 1, 0, 0, 0, 0, 1});
+    ASSERT_TRUE(server_.client().ExecuteBatch(batch).success);
+
+    server_.client().SetMeshInstancing(true);
+    auto meshes = server_.client().GetAllMeshes();
+    ASSERT_EQ(meshes.size(), static_cast<size_t>(kCopies));
+    size_t with_geometry = 0;
+    for (const auto& mesh : meshes) {
+        EXPECT_EQ(mesh.prototype_id, meshes[0].prototype_id);
+        with_geometry += mesh.vertices.empty() ? 0 : 1;
+        if (mesh.shape_id == shape_ids_[0]) {
+            EXPECT_NEAR(mesh.instance_transform[7], 100.0, 1e-9);
+        }
+    }
+    EXPECT_EQ(with_geometry, 1u);
+}
+
+TEST_F(InstancingTest, RefilledMeshesDropStaleGeometry) {
+    std::vector<GeometryClient::MeshData> meshes;
+    ASSERT_TRUE(server_.client().GetAllMeshes(meshes));
+    ASSERT_EQ(meshes.size(), static_cast<size_t>(kCopies));
+    const float* reused = meshes[0].vertices.data();
+
+    // The same vector refilled with instances: copies after the first carry no geometry
+    server_.client().SetMeshInstancing(true);
+    ASSERT_TRUE(server_.client().GetAllMeshes(meshes));
+    ASSERT_EQ(meshes.size(), static_cast<size_t>(kCopies));
+    EXPECT_EQ(meshes[0].vertices.data(), reused);  // Same part, so the buffer fits as is
+    for (size_t i = 1; i < meshes.size(); ++i) {
+        EXPECT_EQ(meshes[i].prototype_id, meshes[0].prototype_id);
+        EXPECT_TRUE(meshes[i].vertices.empty());
+        EXPECT_TRUE(meshes[i].indices.empty());
+    }
+
+    // And back: placed meshes again, with identity instance transforms
+    server_.client().SetMeshInstancing(false);
+    ASSERT_TRUE(server_.client().GetAllMeshes(meshes));
+    for (const auto& mesh : meshes) {
+        EXPECT_TRUE(mesh.prototype_id.empty());
+        EXPECT_FALSE(mesh.vertices.empty());
+        EXPECT_DOUBLE_EQ(mesh.instance_transform[3], 0.0);
+    }
+}
+
+TEST_F(InstancingTest, RepeatedStepImportsLeaveNoDocumentsOpen) {
+    ScopedTempFile file("assembly.step");
+    WriteRepeatedPartAssembly(file.path());
+    const std::string step_data = file.read();
+    Handle(XCAFApp_Application) app = XCAFApp_Application::GetApplication();
+    const int documents = app->NbDocuments();
+
+    // Uploads import from memory, ImportModelFile from the file, some of them concurrently
+    for (int i = 0; i < 3; ++i) {
+        auto uploaded = server_.client().UploadModelFile(file.path());
+        ASSERT_TRUE(uploaded.success) << uploaded.message;
+        EXPECT_EQ(uploaded.shape_ids.size(), static_cast<size_t>(kCopies));
+
+        grpc::ServerContext ctx;
+        geometry::ModelFileRequest request;
+        request.set_file_path(file.path());
+        geometry::ModelImportResponse response;
+        server_.service().ImportModelFile(&ctx, &request, &response);
+        ASSERT_TRUE(response.success()) << response.message();
+        EXPECT_EQ(response.shape_ids_size(), kCopies);
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([this, &step_data] {
+            for (int i = 0; i < 3; ++i) {
+                auto shape_ids = server_.service().importModelData("instancing-client", step_data, "assembly.step", {});
+                EXPECT_EQ(shape_ids.size(), static_cast<size_t>(kCopies));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(app->NbDocuments(), documents);
+}
+
+TEST_F(InstancingTest, ScaledInstanceMustFitTheSessionQuota) {
+    // The part is accounted once for all its instances; scaling one copies it
+    const uint64_t assembly_bytes = server_.service().getSessionMemoryUsage("instancing-client").brep_bytes;
+    ASSERT_GT(assembly_bytes, 0u);
+    GeometryServiceOptions options;
+    options.session_memory_quota_bytes = assembly_bytes * 3 / 2;
+    ASSERT_NO_FATAL_FAILURE(server_.start(options, "instancing-client"));
+    ScopedTempFile file("assembly.step");
+    WriteRepeatedPartAssembly(file.path());
+    auto result = server_.client().UploadModelFile(file.path());
+    ASSERT_TRUE(result.success) << result.message;
+    ASSERT_EQ(result.shape_ids.size(), static_cast<size_t>(kCopies));
+
+    auto transform = [this](const std::string& shape_id, double scale, double offset) {
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "instancing-client");
+        geometry::TransformRequest request;
+        request.set_shape_id(shape_id);
+        for (double value : {scale, 0.0, 0.0, offset, 0.0, scale, 0.0, 0.0, 0.0, 0.0, scale, 0.0, 0.0, 0.0, 0.0, 1.0}) {
+            request.mutable_transform()->add_matrix(value);
+        }
+        geometry::ShapeResponse response;
+        return server_.newStub()->TransformShape(&context, request, &response);
+    };
+    grpc::Status status = transform(result.shape_ids[1], 2.0, 0.0);
+    EXPECT_EQ(status.error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED);
+    EXPECT_NE(status.error_message().find("Session memory quota exceeded"), std::string::npos)
+        << status.error_message();
+    EXPECT_EQ(server_.service().getSessionMemoryUsage("instancing-client").brep_bytes, assembly_bytes);
+
+    // Batched transforms are held to the same quota; moving an instance still works
+    GeometryClient::Batch batch;
+    batch.Transform(result.shape_ids[1], {2, 0, 0, 0, 0, 2, 0, 0, 0, 0, 2, 0, 0, 0, 0, 1});
+    auto batched = server_.client().ExecuteBatch(batch);
+    ASSERT_EQ(batched.operations.size(), 1u);
+    EXPECT_FALSE(batched.operations[0].success);
+    EXPECT_TRUE(transform(result.shape_ids[1], 1.0, 100.0).ok());
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <grpcpp/grpcpp.h>
+
+#include "server/async_geometry_service.h"
+#include "server/geometry_service_impl.h"
+#include "server/rpc_metrics_interceptor.h"
+#include "client/grpc/geometry_client.h"
+
+// A GeometryServiceImpl served on a free 127.0.0.1 port for end-to-end tests,
+// assembled like the geometry_server app: options.async_server puts the async
+// front end in front of it and options.grpc_compression is the channel default.
+class LoopbackServer {
+public:
+    LoopbackServer() = default;
+    ~LoopbackServer() { stop(); }
+
+    LoopbackServer(const LoopbackServer&) = delete;
+    LoopbackServer& operator=(const LoopbackServer&) = delete;
+
+    // Stops any running server first. Unless client_id is empty, a client
+    // connected under that id is ready afterwards. With time_rpcs every RPC
+    // goes through RpcMetricsInterceptorFactory. Assertion failures only
+    // return from here, so callers wrap it in ASSERT_NO_FATAL_FAILURE.
+    void start(const GeometryServiceOptions& options = GeometryServiceOptions(),
+               const std::string& client_id = "", bool time_rpcs = false) {
+        stop();
+        spdlog::set_level(spdlog::level::warn);
+        service_ = std::make_unique<GeometryServiceImpl>(options);
+
+        int port = 0;
+        grpc::ServerBuilder builder;
+        builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(), &port);
+        if (options.grpc_compression != GRPC_COMPRESS_NONE) {
+            builder.SetDefaultCompressionAlgorithm(options.grpc_compression);
+        }
+        if (time_rpcs) {
+            std::vector<std::unique_ptr<grpc::experimental::ServerInterceptorFactoryInterface>> interceptors;
+            interceptors.push_back(std::make_unique<RpcMetricsInterceptorFactory>());
+            builder.experimental().SetInterceptorCreators(std::move(interceptors));
+        }
+        if (options.async_server) {
+            async_service_ = std::make_unique<AsyncGeometryService>(*service_, options);
+            builder.RegisterService(async_service_.get());
+        } else {
+            builder.RegisterService(service_.get());
+        }
+        server_ = builder.BuildAndStart();
+        ASSERT_TRUE(server_);
+        ASSERT_GT(port, 0);
+        address_ = "127.0.0.1:" + std::to_string(port);
+
+        if (!client_id.empty()) {
+            client_ = std::make_unique<GeometryClient>(address_, client_id);
+            ASSERT_TRUE(client_->Connect());
+        }
+    }
+
+    // Disconnects the client, then shuts the server down within a second
+    void stop() {
+        client_.reset();
+        if (server_) {
+            server_->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(1));
+            server_.reset();
+        }
+        if (async_service_) {
+            async_service_->shutdown();
+            async_service_.reset();
+        }
+        service_.reset();
+    }
+
+    GeometryServiceImpl& service() { return *service_; }
+    AsyncGeometryService& asyncService() { return *async_service_; }
+    GeometryClient& client() { return *client_; }
+    const std::string& address() const { return address_; }
+
+    // A raw stub on its own channel, for requests GeometryClient does not expose
+    std::unique_ptr<geometry::GeometryService::Stub> newStub() const {
+        return geometry::GeometryService::NewStub(
+            grpc::CreateChannel(address_, grpc::InsecureChannelCredentials()));
+    }
+
+private:
+    std::unique_ptr<GeometryServiceImpl> service_;
+    std::unique_ptr<AsyncGeometryService> async_service_;
+    std::unique_ptr<grpc::Server> server_;
+    std::unique_ptr<GeometryClient> client_;
+    std::string address_;
+};
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+#include <thread>
+#include <vector>
+
+#include "server/geometry_service_impl.h"
+#include "geometry_service.pb.h"
+
+namespace {
+
+// Direct calls use a plain ServerContext, which maps to this client ID
+const std::string kClientId = "Unknown";
+
+std::string CreateBox(GeometryServiceImpl& service, std::string* message = nullptr) {
+    grpc::ServerContext ctx;
+    geometry::BoxRequest request;
+    request.set_width(10);
+    request.set_height(10);
+    request.set_depth(10);
+
+    geometry::ShapeResponse response;
+    service.CreateBox(&ctx, &request, &response);
+    if (message) {
+        *message = response.message();
+    }
+    return response.success() ? response.shape_id() : std::string();
+}
+
+geometry::MeshData GetMesh(GeometryServiceImpl& service, const std::string& shape_id, uint32_t lod = 0) {
+    grpc::ServerContext ctx;
+    geometry::ShapeRequest request;
+    request.set_shape_id(shape_id);
+    request.mutable_mesh_options()->set_lod(lod);
+
+    geometry::MeshData response;
+    auto status = service.GetMeshData(&ctx, &request, &response);
+    EXPECT_TRUE(status.ok()) << status.error_message();
+    return response;
+}
+
+geometry::SystemInfoResponse GetSystemInfo(GeometryServiceImpl& service) {
+    grpc::ServerContext ctx;
+    geometry::EmptyRequest request;
+    geometry::SystemInfoResponse response;
+    service.GetSystemInfo(&ctx, &request, &response);
+    return response;
+}
+
+// Estimates for one 10x10x10 box on an unlimited server
+struct BoxFootprint {
+    uint64_t brep_bytes{0};
+    uint64_t meshed_bytes{0};  // BRep plus the triangulation left by a full-quality mesh
+    uint64_t mesh_bytes{0};    // One cached mesh
+};
+
+BoxFootprint MeasureBox() {
+    GeometryServiceImpl service;
+    BoxFootprint footprint;
+    std::string shape_id = CreateBox(service);
+    footprint.brep_bytes = service.getSessionMemoryUsage(kClientId).brep_bytes;
+    GetMesh(service, shape_id);
+    auto usage = service.getSessionMemoryUsage(kClientId);
+    footprint.meshed_bytes = usage.brep_bytes + usage.triangulation_bytes;
+    footprint.mesh_bytes = usage.mesh_cache_bytes;
+    return footprint;
+}
+
+} // namespace
+
+class MemoryQuotaTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        spdlog::set_level(spdlog::level::warn);
+        box_ = MeasureBox();
+        ASSERT_GT(box_.brep_bytes, 0u);
+        ASSERT_GT(box_.meshed_bytes, box_.brep_bytes);
+        ASSERT_GT(box_.mesh_bytes, 0u);
+    }
+
+    BoxFootprint box_;
+};
+
+TEST_F(MemoryQuotaTest, AccountsShapesAndMeshesPerSession) {
+    GeometryServiceImpl service;
+    std::string shape_id = CreateBox(service);
+    ASSERT_FALSE(shape_id.empty());
+    GetMesh(service, shape_id);
+
+    auto usage = service.getSessionMemoryUsage(kClientId);
+    EXPECT_EQ(usage.brep_bytes + usage.triangulation_bytes, box_.meshed_bytes);
+    EXPECT_EQ(usage.mesh_cache_bytes, service.getMeshCacheStats().bytes);
+    EXPECT_EQ(service.getMemoryUsage().total(), usage.total());
+
+    auto info = GetSystemInfo(service);
+    EXPECT_EQ(info.session_brep_bytes(), usage.brep_bytes);
+    EXPECT_EQ(info.session_triangulation_bytes(), usage.triangulation_bytes);
+    EXPECT_EQ(info.session_mesh_cache_bytes(), usage.mesh_cache_bytes);
+    EXPECT_EQ(info.accounted_memory_bytes(), usage.total());
+    EXPECT_EQ(info.session_memory_quota_bytes(), 0u);
+    EXPECT_EQ(info.memory_limit_bytes(), 0u);
+
+    grpc::ServerContext ctx;
+    geometry::ShapeRequest request;
+    request.set_shape_id(shape_id);
+    geometry::StatusResponse response;
+    service.DeleteShape(&ctx, &request, &response);
+    ASSERT_TRUE(response.success());
+    EXPECT_EQ(service.getSessionMemoryUsage(kClientId).total(), 0u);
+}
+
+TEST_F(MemoryQuotaTest, SessionQuotaRefusesShapesThatDoNotFit) {
+    GeometryServiceOptions options;
+    options.session_memory_quota_bytes = box_.brep_bytes * 3 / 2;
+    GeometryServiceImpl service(options);
+
+    ASSERT_FALSE(CreateBox(service).empty());
+    std::string message;
+    EXPECT_TRUE(CreateBox(service, &message).empty());
+    EXPECT_NE(message.find("Session memory quota exceeded"), std::string::npos) << message;
+
+    // Batched creations count against the same quota
+    grpc::ServerContext ctx;
+    geometry::BatchRequest batch;
+    auto* box = batch.add_operations()->mutable_create_box();
+    box->set_width(10);
+    box->set_height(10);
+    box->set_depth(10);
+    geometry::BatchResponse batch_response;
+    service.ExecuteBatch(&ctx, &batch, &batch_response);
+    ASSERT_EQ(batch_response.results_size(), 1);
+    EXPECT_FALSE(batch_response.results(0).success());
+
+    EXPECT_EQ(service.getShapeCount(), 1u);
+    EXPECT_EQ(GetSystemInfo(service).session_memory_quota_bytes(), options.session_memory_quota_bytes);
+}
+
+TEST_F(MemoryQuotaTest, ConcurrentCreatesStayWithinTheLimits) {
+    // Room for three boxes under either limit; many racing creates must not squeeze in a fourth
+    auto create_concurrently = [](GeometryServiceImpl& service) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&service] {
+                for (int i = 0; i < 4; ++i) {
+                    CreateBox(service);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+
+    GeometryServiceOptions quota_options;
+    quota_options.session_memory_quota_bytes = box_.brep_bytes * 7 / 2;
+    GeometryServiceImpl quota_service(quota_options);
+    create_concurrently(quota_service);
+    EXPECT_EQ(quota_service.getShapeCount(), 3u);
+    EXPECT_LE(quota_service.getSessionMemoryUsage(kClientId).total(), quota_options.session_memory_quota_bytes);
+
+    GeometryServiceOptions limit_options;
+    limit_options.memory_limit_bytes = box_.brep_bytes * 7 / 2;
+    GeometryServiceImpl limit_service(limit_options);
+    create_concurrently(limit_service);
+    EXPECT_EQ(limit_service.getShapeCount(), 3u);
+    EXPECT_LE(limit_service.getMemoryUsage().total(), limit_options.memory_limit_bytes);
+}
+
+TEST_F(MemoryQuotaTest, SessionQuotaEvictsCachedMeshesFirst) {
+    // Room for the meshed box and one and a half cached meshes
+    GeometryServiceOptions options;
+    options.session_memory_quota_bytes = box_.meshed_bytes + box_.mesh_bytes * 3 / 2;
+    GeometryServiceImpl service(options);
+
+    std::string shape_id = CreateBox(service);
+    ASSERT_FALSE(shape_id.empty());
+    GetMesh(service, shape_id, 0);
+    EXPECT_EQ(service.getMeshCacheStats().evictions, 0u);
+
+    // A box tessellates the same at every LOD, so the second mesh pushes out the first
+    geometry::MeshData coarse = GetMesh(service, shape_id, 1);
+    EXPECT_GT(coarse.indices_size() + coarse.vertices_size(), 0);
+    EXPECT_EQ(service.getMeshCacheStats().entries, 1u);
+    EXPECT_EQ(service.getMeshCacheStats().evictions, 1u);
+    EXPECT_LE(service.getSessionMemoryUsage(kClientId).total(), options.session_memory_quota_bytes);
+    EXPECT_EQ(service.getShapeCount(), 1u);
+}
+
+TEST_F(MemoryQuotaTest, MemoryLimitEvictsLeastRecentlyUsedMeshes) {
+    GeometryServiceOptions options;
+    options.memory_limit_bytes = 2 * box_.meshed_bytes + box_.mesh_bytes * 3 / 2;
+    GeometryServiceImpl service(options);
+
+    std::string first = CreateBox(service);
+    std::string second = CreateBox(service);
+    ASSERT_FALSE(first.empty());
+    ASSERT_FALSE(second.empty());
+    GetMesh(service, first);
+    GetMesh(service, second);
+
+    EXPECT_EQ(service.getMeshCacheStats().entries, 1u);
+    EXPECT_LE(service.getMemoryUsage().total(), options.memory_limit_bytes);
+
+    // The first mesh was the one evicted
+    const uint64_t misses = service.getMeshCacheStats().misses;
+    GetMesh(service, first);
+    EXPECT_EQ(service.getMeshCacheStats().misses, misses + 1);
+    EXPECT_EQ(GetSystemInfo(service).memory_limit_bytes(), options.memory_limit_bytes);
+
+    // With both boxes meshed a third no longer fits
+    ASSERT_GT(box_.brep_bytes, box_.mesh_bytes * 3 / 2);
+    std::string message;
+    EXPECT_TRUE(CreateBox(service, &message).empty());
+    EXPECT_NE(message.find("Server memory limit exceeded"), std::string::npos) << message;
+}
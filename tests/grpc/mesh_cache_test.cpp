@@ -0,0 +1,292 @@
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+#include "server/geometry_service_impl.h"
+#include "server/mesh_cache.h"
+#include "geometry_service.pb.h"
+
+namespace {
+
+MeshCacheKey MakeKey(const std::string& client_id, const std::string& shape_id, uint64_t generation = 1) {
+    MeshCacheKey key;
+    key.client_id = client_id;
+    key.shape_id = shape_id;
+    key.generation = generation;
+    key.linear_deflection = 0.1;
+    key.angular_deflection = 0.5;
+    return key;
+}
+
+std::shared_ptr<const geometry::MeshData> MakeMesh(const std::string& shape_id, int index_count) {
+    auto mesh = std::make_shared<geometry::MeshData>();
+    mesh->set_shape_id(shape_id);
+    for (int i = 0; i < index_count; ++i) {
+        mesh->add_indices(i);
+    }
+    return mesh;
+}
+
+} // namespace
+
+// Tests for the LRU tessellation cache itself
+TEST(MeshCacheTest, FindReturnsInsertedMesh) {
+    MeshCache cache;
+    auto mesh = MakeMesh("shape_0", 30);
+    cache.insert(MakeKey("client", "shape_0"), mesh);
+
+    EXPECT_EQ(cache.find(MakeKey("client", "shape_0")), mesh);
+    EXPECT_EQ(cache.find(MakeKey("client", "shape_0", 2)), nullptr);
+    EXPECT_EQ(cache.find(MakeKey("other", "shape_0")), nullptr);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.bytes, mesh->ByteSizeLong());
+}
+
+TEST(MeshCacheTest, EvictsLeastRecentlyUsed) {
+    auto mesh_a = MakeMesh("a", 100);
+    auto mesh_b = MakeMesh("b", 100);
+    auto mesh_c = MakeMesh("c", 100);
+
+    // Room for two meshes only
+    MeshCache cache(mesh_a->ByteSizeLong() * 2 + 1);
+    cache.insert(MakeKey("client", "a"), mesh_a);
+    cache.insert(MakeKey("client", "b"), mesh_b);
+
+    // Touch "a" so "b" becomes the eviction candidate
+    ASSERT_NE(cache.find(MakeKey("client", "a")), nullptr);
+    cache.insert(MakeKey("client", "c"), mesh_c);
+
+    EXPECT_NE(cache.find(MakeKey("client", "a")), nullptr);
+    EXPECT_EQ(cache.find(MakeKey("client", "b")), nullptr);
+    EXPECT_NE(cache.find(MakeKey("client", "c")), nullptr);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+TEST(MeshCacheTest, InvalidateShapeAndClient) {
+    MeshCache cache;
+    cache.insert(MakeKey("client1", "shape_0"), MakeMesh("shape_0", 3));
+    cache.insert(MakeKey("client1", "shape_1"), MakeMesh("shape_1", 3));
+    cache.insert(MakeKey("client2", "shape_0"), MakeMesh("shape_0", 3));
+
+    cache.invalidateShape("client1", "shape_0");
+    EXPECT_EQ(cache.find(MakeKey("client1", "shape_0")), nullptr);
+    EXPECT_NE(cache.find(MakeKey("client1", "shape_1")), nullptr);
+    EXPECT_NE(cache.find(MakeKey("client2", "shape_0")), nullptr);
+
+    cache.invalidateClient("client1");
+    EXPECT_EQ(cache.find(MakeKey("client1", "shape_1")), nullptr);
+    EXPECT_NE(cache.find(MakeKey("client2", "shape_0")), nullptr);
+    EXPECT_EQ(cache.stats().entries, 1u);
+}
+
+TEST(MeshCacheTest, InvalidateShapesDropsEveryLevelAndKeepsAccounting) {
+    auto mesh = MakeMesh("a", 10);
+    const size_t bytes = mesh->ByteSizeLong();
+    MeshCache cache;
+    for (uint32_t lod = 0; lod < 3; ++lod) {
+        MeshCacheKey key = MakeKey("client1", "a");
+        key.lod = lod;
+        cache.insert(key, MakeMesh("a", 10));
+    }
+    cache.insert(MakeKey("client1", "b"), MakeMesh("b", 10));
+    cache.insert(MakeKey("client1", "c"), MakeMesh("c", 10));
+    cache.insert(MakeKey("client2", "a"), MakeMesh("a", 10));
+
+    cache.invalidateShapes("client1", {"a", "b", "missing"});
+    EXPECT_EQ(cache.stats().entries, 2u);
+    EXPECT_EQ(cache.clientBytes("client1"), bytes);
+    EXPECT_NE(cache.find(MakeKey("client1", "c")), nullptr);
+    EXPECT_NE(cache.find(MakeKey("client2", "a")), nullptr);
+
+    // Reinserting a key replaces its entry in the per-shape index too
+    cache.insert(MakeKey("client1", "c"), MakeMesh("c", 10));
+    cache.invalidateShape("client1", "c");
+    EXPECT_EQ(cache.clientBytes("client1"), 0u);
+    EXPECT_EQ(cache.stats().bytes, bytes);
+}
+
+TEST(MeshCacheTest, ZeroBudgetDisablesCaching) {
+    MeshCache cache(0);
+    cache.insert(MakeKey("client", "shape_0"), MakeMesh("shape_0", 3));
+    EXPECT_EQ(cache.find(MakeKey("client", "shape_0")), nullptr);
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST(MeshCacheTest, EvictClientDropsOnlyItsOldestEntries) {
+    auto mesh = MakeMesh("a", 100);
+    const size_t bytes = mesh->ByteSizeLong();
+    MeshCache cache;
+    cache.insert(MakeKey("client1", "a"), MakeMesh("a", 100));
+    cache.insert(MakeKey("client2", "a"), MakeMesh("a", 100));
+    cache.insert(MakeKey("client1", "b"), MakeMesh("b", 100));
+    cache.insert(MakeKey("client1", "c"), MakeMesh("c", 100));
+    EXPECT_EQ(cache.clientBytes("client1"), 3 * bytes);
+
+    // Down to one entry: "a" and "b" are the least recently used of client1
+    EXPECT_EQ(cache.evictClient("client1", bytes), 2 * bytes);
+    EXPECT_EQ(cache.find(MakeKey("client1", "a")), nullptr);
+    EXPECT_EQ(cache.find(MakeKey("client1", "b")), nullptr);
+    EXPECT_NE(cache.find(MakeKey("client1", "c")), nullptr);
+    EXPECT_NE(cache.find(MakeKey("client2", "a")), nullptr);
+    EXPECT_EQ(cache.clientBytes("client1"), bytes);
+    EXPECT_EQ(cache.clientBytes("client2"), bytes);
+    EXPECT_EQ(cache.stats().evictions, 2u);
+
+    EXPECT_EQ(cache.evictClient("client1", bytes), 0u);
+    cache.invalidateClient("client1");
+    EXPECT_EQ(cache.clientBytes("client1"), 0u);
+}
+
+TEST(MeshCacheTest, ShrinkToEvictsLeastRecentlyUsed) {
+    auto mesh = MakeMesh("a", 100);
+    const size_t bytes = mesh->ByteSizeLong();
+    MeshCache cache;
+    cache.insert(MakeKey("client1", "a"), MakeMesh("a", 100));
+    cache.insert(MakeKey("client2", "b"), MakeMesh("b", 100));
+    cache.insert(MakeKey("client1", "c"), MakeMesh("c", 100));
+    ASSERT_NE(cache.find(MakeKey("client1", "a")), nullptr);
+
+    EXPECT_EQ(cache.shrinkTo(bytes), 2 * bytes);
+    EXPECT_NE(cache.find(MakeKey("client1", "a")), nullptr);
+    EXPECT_EQ(cache.stats().entries, 1u);
+    EXPECT_EQ(cache.clientBytes("client2"), 0u);
+    EXPECT_EQ(cache.shrinkTo(bytes), 0u);
+}
+
+// Tests for cache integration in GeometryServiceImpl
+class MeshCacheServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        service_ = std::make_unique<GeometryServiceImpl>();
+        spdlog::set_level(spdlog::level::warn);
+    }
+
+    std::string CreateTestBox() {
+        grpc::ServerContext ctx;
+        geometry::BoxRequest request;
+        request.set_width(10);
+        request.set_height(10);
+        request.set_depth(10);
+
+        geometry::ShapeResponse response;
+        service_->CreateBox(&ctx, &request, &response);
+        return response.shape_id();
+    }
+
+    geometry::MeshData GetMesh(const std::string& shape_id) {
+        grpc::ServerContext ctx;
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+
+        geometry::MeshData response;
+        auto status = service_->GetMeshData(&ctx, &request, &response);
+        EXPECT_TRUE(status.ok()) << status.error_message();
+        return response;
+    }
+
+    std::unique_ptr<GeometryServiceImpl> service_;
+};
+
+TEST_F(MeshCacheServiceTest, RepeatedRequestsHitCache) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+
+    geometry::MeshData first = GetMesh(shape_id);
+    geometry::MeshData second = GetMesh(shape_id);
+
+    EXPECT_EQ(first.SerializeAsString(), second.SerializeAsString());
+    EXPECT_EQ(service_->getMeshCacheStats().hits, 1u);
+    EXPECT_EQ(service_->getMeshCacheStats().misses, 1u);
+}
+
+TEST_F(MeshCacheServiceTest, SetShapeColorInvalidatesCache) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+    GetMesh(shape_id);
+
+    grpc::ServerContext ctx;
+    geometry::ColorRequest request;
+    request.set_shape_id(shape_id);
+    request.mutable_color()->set_r(1.0);
+    request.mutable_color()->set_a(1.0);
+    geometry::StatusResponse response;
+    service_->SetShapeColor(&ctx, &request, &response);
+    ASSERT_TRUE(response.success()) << response.message();
+
+    geometry::MeshData mesh = GetMesh(shape_id);
+    EXPECT_DOUBLE_EQ(mesh.color().r(), 1.0);
+    EXPECT_EQ(service_->getMeshCacheStats().hits, 0u);
+    EXPECT_EQ(service_->getMeshCacheStats().misses, 2u);
+}
+
+TEST_F(MeshCacheServiceTest, TransformShapeInvalidatesCache) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+    geometry::MeshData before = GetMesh(shape_id);
+
+    // Translate by (100, 0, 0)
+    grpc::ServerContext ctx;
+    geometry::TransformRequest request;
+    request.set_shape_id(shape_id);
+    const double matrix[16] = {1, 0, 0, 100,
+                               0, 1, 0, 0,
+                               0, 0, 1, 0,
+                               0, 0, 0, 1};
+    for (double value : matrix) {
+        request.mutable_transform()->add_matrix(value);
+    }
+    geometry::ShapeResponse response;
+    service_->TransformShape(&ctx, &request, &response);
+    ASSERT_TRUE(response.success()) << response.message();
+
+    geometry::MeshData after = GetMesh(shape_id);
+    EXPECT_NEAR(after.bounding_box().min().x(), before.bounding_box().min().x() + 100, 1e-6);
+    EXPECT_EQ(service_->getMeshCacheStats().hits, 0u);
+}
+
+TEST_F(MeshCacheServiceTest, DeleteShapeDropsCachedMesh) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+    GetMesh(shape_id);
+    ASSERT_EQ(service_->getMeshCacheStats().entries, 1u);
+
+    grpc::ServerContext ctx;
+    geometry::ShapeRequest request;
+    request.set_shape_id(shape_id);
+    geometry::StatusResponse response;
+    service_->DeleteShape(&ctx, &request, &response);
+    ASSERT_TRUE(response.success());
+
+    EXPECT_EQ(service_->getMeshCacheStats().entries, 0u);
+}
+
+TEST_F(MeshCacheServiceTest, ConcurrentRequestsForOneShapeAgree) {
+    grpc::ServerContext create_ctx;
+    geometry::SphereRequest sphere;
+    sphere.set_radius(25);
+    geometry::ShapeResponse created;
+    service_->CreateSphere(&create_ctx, &sphere, &created);
+    ASSERT_TRUE(created.success()) << created.message();
+
+    // Every thread misses the cache and meshes the same shape in place
+    constexpr int kThreads = 8;
+    std::vector<geometry::MeshData> meshes(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&, i] { meshes[i] = GetMesh(created.shape_id()); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_GT(meshes[0].indices_size(), 0);
+    ASSERT_EQ(meshes[0].normals_size(), meshes[0].vertices_size());
+    for (int i = 1; i < kThreads; ++i) {
+        EXPECT_EQ(meshes[i].SerializeAsString(), meshes[0].SerializeAsString()) << i;
+    }
+}
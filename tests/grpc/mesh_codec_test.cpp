@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/mesh_codec.h"
+
+using occt_imgui::common::MeshCodec;
+
+namespace {
+
+// Points on a unit-radius grid over a sphere, normals pointing outward
+void MakeSphere(int rings, int segments, std::vector<float>& positions, std::vector<float>& normals,
+                std::vector<uint32_t>& indices) {
+    const double pi = std::acos(-1.0);
+    for (int ring = 0; ring <= rings; ++ring) {
+        const double theta = pi * ring / rings;
+        for (int segment = 0; segment <= segments; ++segment) {
+            const double phi = 2 * pi * segment / segments;
+            const double n[3] = {std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta)};
+            for (int axis = 0; axis < 3; ++axis) {
+                normals.push_back(static_cast<float>(n[axis]));
+                positions.push_back(static_cast<float>(100.0 + 40.0 * n[axis]));
+            }
+        }
+    }
+    for (int ring = 0; ring < rings; ++ring) {
+        for (int segment = 0; segment < segments; ++segment) {
+            const uint32_t a = ring * (segments + 1) + segment;
+            const uint32_t b = a + segments + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+}
+
+} // namespace
+
+TEST(MeshCodecTest, PositionsRoundTripWithinOneStep) {
+    std::vector<float> positions, normals;
+    std::vector<uint32_t> indices;
+    MakeSphere(32, 64, positions, normals, indices);
+    const size_t vertex_count = positions.size() / 3;
+
+    MeshCodec::QuantizationBox box = MeshCodec::Bounds(positions.data(), vertex_count);
+    EXPECT_NEAR(box.origin[0], 60.0, 1e-3);
+    EXPECT_NEAR(box.extent[2], 80.0, 1e-3);
+
+    std::string encoded;
+    MeshCodec::EncodePositions(positions.data(), vertex_count, box, encoded);
+    EXPECT_LT(encoded.size(), positions.size() * sizeof(float) / 2);
+
+    std::vector<float> decoded;
+    ASSERT_TRUE(MeshCodec::DecodePositions(encoded, vertex_count, box, decoded));
+    ASSERT_EQ(decoded.size(), positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        EXPECT_NEAR(decoded[i], positions[i], 80.0 / 65535) << i;
+    }
+}
+
+TEST(MeshCodecTest, NormalsRoundTripAsUnitVectors) {
+    std::vector<float> positions, normals;
+    std::vector<uint32_t> indices;
+    MakeSphere(16, 32, positions, normals, indices);
+    // Axis directions and a zero vector, which decodes as +Z
+    normals.insert(normals.end(), {1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0});
+    const size_t vertex_count = normals.size() / 3;
+
+    std::string encoded;
+    MeshCodec::EncodeNormals(normals.data(), vertex_count, encoded);
+    EXPECT_LT(encoded.size(), normals.size() * sizeof(float) / 2);
+
+    std::vector<float> decoded;
+    ASSERT_TRUE(MeshCodec::DecodeNormals(encoded, vertex_count, decoded));
+    ASSERT_EQ(decoded.size(), normals.size());
+    for (size_t i = 0; i + 1 < vertex_count; ++i) {
+        const float* n = &decoded[i * 3];
+        EXPECT_NEAR(n[0] * n[0] + n[1] * n[1] + n[2] * n[2], 1.0, 1e-5);
+        for (int axis = 0; axis < 3; ++axis) {
+            EXPECT_NEAR(n[axis], normals[i * 3 + axis], 1e-4) << i;
+        }
+    }
+    EXPECT_FLOAT_EQ(decoded[(vertex_count - 1) * 3 + 2], 1.0f);
+}
+
+TEST(MeshCodecTest, IndicesRoundTripCompactly) {
+    std::vector<float> positions, normals;
+    std::vector<uint32_t> indices;
+    MakeSphere(32, 64, positions, normals, indices);
+    const size_t vertex_count = positions.size() / 3;
+
+    std::string encoded;
+    MeshCodec::EncodeIndices(indices.data(), indices.size(), encoded);
+    EXPECT_LT(encoded.size(), indices.size() * sizeof(uint32_t) / 2);
+
+    std::vector<uint32_t> decoded(indices.size());
+    ASSERT_TRUE(MeshCodec::DecodeIndices(encoded, decoded.size(), vertex_count, decoded.data()));
+    EXPECT_EQ(decoded, indices);
+}
+
+TEST(MeshCodecTest, DegenerateBoxDecodesToOrigin) {
+    const std::vector<float> positions = {5, 1, -2, 5, 3, -2};
+    MeshCodec::QuantizationBox box = MeshCodec::Bounds(positions.data(), 2);
+    EXPECT_EQ(box.extent[0], 0.0);
+    EXPECT_EQ(box.extent[2], 0.0);
+
+    std::string encoded;
+    MeshCodec::EncodePositions(positions.data(), 2, box, encoded);
+    std::vector<float> decoded;
+    ASSERT_TRUE(MeshCodec::DecodePositions(encoded, 2, box, decoded));
+    EXPECT_EQ(decoded, positions);
+}
+
+TEST(MeshCodecTest, RejectsMalformedStreams) {
+    const std::vector<uint32_t> indices = {0, 1, 2, 2, 1, 3};
+    std::string encoded;
+    MeshCodec::EncodeIndices(indices.data(), indices.size(), encoded);
+
+    std::vector<uint32_t> decoded(indices.size());
+    EXPECT_FALSE(MeshCodec::DecodeIndices(encoded, indices.size(), 3, decoded.data()));  // Index 3 out of range
+    EXPECT_FALSE(MeshCodec::DecodeIndices(encoded.substr(0, encoded.size() - 1), indices.size(), 4,
+                                          decoded.data()));
+    EXPECT_FALSE(MeshCodec::DecodeIndices(encoded + '\0', indices.size(), 4, decoded.data()));
+    EXPECT_FALSE(MeshCodec::DecodeIndices(std::string(6, '\xff'), 1, 4, decoded.data()));
+
+    const std::vector<float> positions = {0, 0, 0, 1, 1, 1};
+    MeshCodec::QuantizationBox box = MeshCodec::Bounds(positions.data(), 2);
+    MeshCodec::EncodePositions(positions.data(), 2, box, encoded);
+    std::vector<float> decoded_positions;
+    EXPECT_FALSE(MeshCodec::DecodePositions(encoded, 3, box, decoded_positions));
+    EXPECT_FALSE(MeshCodec::DecodeNormals(std::string("\xff\xff\x7f", 3), 1, decoded_positions));
+}
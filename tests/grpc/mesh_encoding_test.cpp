@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "client/grpc/geometry_client.h"
+#include "server/geometry_service_impl.h"
+#include "geometry_service.pb.h"
+
+// Tests for legacy vs packed MeshData wire encodings
+class MeshEncodingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        service_ = std::make_unique<GeometryServiceImpl>();
+        spdlog::set_level(spdlog::level::warn);
+    }
+
+    std::string CreateTestBox() {
+        grpc::ServerContext ctx;
+        geometry::BoxRequest request;
+        request.mutable_position()->set_x(1);
+        request.mutable_position()->set_y(2);
+        request.mutable_position()->set_z(3);
+        request.set_width(10);
+        request.set_height(20);
+        request.set_depth(30);
+
+        geometry::ShapeResponse response;
+        service_->CreateBox(&ctx, &request, &response);
+        return response.shape_id();
+    }
+
+    geometry::MeshData GetMesh(const std::string& shape_id, geometry::MeshEncoding encoding) {
+        grpc::ServerContext ctx;
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+        request.mutable_mesh_options()->set_encoding(encoding);
+
+        geometry::MeshData response;
+        auto status = service_->GetMeshData(&ctx, &request, &response);
+        EXPECT_TRUE(status.ok()) << status.error_message();
+        return response;
+    }
+
+    template<typename T>
+    static std::vector<T> Unpack(const std::string& bytes) {
+        std::vector<T> values(bytes.size() / sizeof(T));
+        std::memcpy(values.data(), bytes.data(), values.size() * sizeof(T));
+        return values;
+    }
+
+    static int VertexCount(const geometry::MeshData& mesh) {
+        return mesh.has_packed() ? static_cast<int>(mesh.packed().vertex_count()) : mesh.vertices_size();
+    }
+
+    std::unique_ptr<GeometryServiceImpl> service_;
+};
+
+TEST_F(MeshEncodingTest, LegacyEncodingIsDefault) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+
+    geometry::MeshData mesh = GetMesh(shape_id, geometry::MESH_ENCODING_LEGACY);
+
+    EXPECT_FALSE(mesh.has_packed());
+    EXPECT_GT(mesh.vertices_size(), 0);
+    EXPECT_GT(mesh.indices_size(), 0);
+}
+
+TEST_F(MeshEncodingTest, PackedFloat32MatchesLegacy) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+
+    geometry::MeshData legacy = GetMesh(shape_id, geometry::MESH_ENCODING_LEGACY);
+    geometry::MeshData packed = GetMesh(shape_id, geometry::MESH_ENCODING_PACKED_FLOAT32);
+
+    ASSERT_TRUE(packed.has_packed());
+    EXPECT_EQ(packed.vertices_size(), 0);
+    EXPECT_EQ(packed.indices_size(), 0);
+
+    const auto& buffers = packed.packed();
+    EXPECT_EQ(buffers.encoding(), geometry::MESH_ENCODING_PACKED_FLOAT32);
+    ASSERT_EQ(static_cast<int>(buffers.vertex_count()), legacy.vertices_size());
+    ASSERT_EQ(static_cast<int>(buffers.triangle_count()) * 3, legacy.indices_size());
+
+    auto positions = Unpack<float>(buffers.positions());
+    ASSERT_EQ(positions.size(), buffers.vertex_count() * 3u);
+    for (int i = 0; i < legacy.vertices_size(); ++i) {
+        EXPECT_NEAR(positions[i * 3 + 0], legacy.vertices(i).x(), 1e-4);
+        EXPECT_NEAR(positions[i * 3 + 1], legacy.vertices(i).y(), 1e-4);
+        EXPECT_NEAR(positions[i * 3 + 2], legacy.vertices(i).z(), 1e-4);
+    }
+
+    auto indices = Unpack<uint32_t>(buffers.indices());
+    ASSERT_EQ(static_cast<int>(indices.size()), legacy.indices_size());
+    for (int i = 0; i < legacy.indices_size(); ++i) {
+        EXPECT_EQ(static_cast<int>(indices[i]), legacy.indices(i));
+    }
+
+    // Packed payload must be markedly smaller than nested submessages
+    EXPECT_LT(packed.ByteSizeLong(), legacy.ByteSizeLong());
+}
+
+TEST_F(MeshEncodingTest, PackedFloat64PreservesPrecision) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+
+    geometry::MeshData legacy = GetMesh(shape_id, geometry::MESH_ENCODING_LEGACY);
+    geometry::MeshData packed = GetMesh(shape_id, geometry::MESH_ENCODING_PACKED_FLOAT64);
+
+    ASSERT_TRUE(packed.has_packed());
+    EXPECT_EQ(packed.packed().encoding(), geometry::MESH_ENCODING_PACKED_FLOAT64);
+
+    auto positions = Unpack<double>(packed.packed().positions());
+    ASSERT_EQ(static_cast<int>(positions.size()), legacy.vertices_size() * 3);
+    for (int i = 0; i < legacy.vertices_size(); ++i) {
+        EXPECT_DOUBLE_EQ(positions[i * 3 + 0], legacy.vertices(i).x());
+        EXPECT_DOUBLE_EQ(positions[i * 3 + 1], legacy.vertices(i).y());
+        EXPECT_DOUBLE_EQ(positions[i * 3 + 2], legacy.vertices(i).z());
+    }
+}
+
+TEST_F(MeshEncodingTest, QuantizedMatchesLegacyWithinQuantizationError) {
+    grpc::ServerContext create_ctx;
+    geometry::SphereRequest sphere_request;
+    sphere_request.set_radius(25);
+    geometry::ShapeResponse sphere_response;
+    service_->CreateSphere(&create_ctx, &sphere_request, &sphere_response);
+    ASSERT_TRUE(sphere_response.success());
+
+    geometry::MeshData legacy = GetMesh(sphere_response.shape_id(), geometry::MESH_ENCODING_LEGACY);
+    geometry::MeshData packed = GetMesh(sphere_response.shape_id(), geometry::MESH_ENCODING_PACKED_FLOAT32);
+    geometry::MeshData quantized = GetMesh(sphere_response.shape_id(), geometry::MESH_ENCODING_QUANTIZED);
+
+    ASSERT_TRUE(quantized.has_packed());
+    EXPECT_EQ(quantized.packed().encoding(), geometry::MESH_ENCODING_QUANTIZED);
+    EXPECT_EQ(VertexCount(quantized), legacy.vertices_size());
+
+    // Decoded the way clients do
+    GeometryClient::MeshData decoded = GeometryClient::ConvertProtoMesh(quantized);
+    ASSERT_EQ(static_cast<int>(decoded.vertices.size()), legacy.vertices_size() * 3);
+    ASSERT_EQ(decoded.normals.size(), decoded.vertices.size());
+    const double step = 50.0 / 65535;  // Sphere diameter over the 16-bit range
+    for (int i = 0; i < legacy.vertices_size(); ++i) {
+        EXPECT_NEAR(decoded.vertices[i * 3 + 0], legacy.vertices(i).x(), step);
+        EXPECT_NEAR(decoded.vertices[i * 3 + 1], legacy.vertices(i).y(), step);
+        EXPECT_NEAR(decoded.vertices[i * 3 + 2], legacy.vertices(i).z(), step);
+        EXPECT_NEAR(decoded.normals[i * 3 + 0], legacy.normals(i).x(), 1e-3);
+        EXPECT_NEAR(decoded.normals[i * 3 + 1], legacy.normals(i).y(), 1e-3);
+        EXPECT_NEAR(decoded.normals[i * 3 + 2], legacy.normals(i).z(), 1e-3);
+    }
+    ASSERT_EQ(static_cast<int>(decoded.indices.size()), legacy.indices_size());
+    for (int i = 0; i < legacy.indices_size(); ++i) {
+        EXPECT_EQ(decoded.indices[i], legacy.indices(i));
+    }
+
+    EXPECT_LT(quantized.ByteSizeLong() * 2, packed.ByteSizeLong());
+}
+
+TEST_F(MeshEncodingTest, ParallelAndSerialExtractionMatch) {
+    GeometryServiceOptions serial_options;
+    serial_options.parallel_meshing = false;
+    GeometryServiceImpl serial_service(serial_options);
+
+    geometry::SphereRequest sphere_request;
+    sphere_request.set_radius(25);
+
+    auto extract = [&](GeometryServiceImpl& service) {
+        grpc::ServerContext create_ctx;
+        geometry::ShapeResponse shape_response;
+        service.CreateSphere(&create_ctx, &sphere_request, &shape_response);
+        EXPECT_TRUE(shape_response.success());
+
+        grpc::ServerContext mesh_ctx;
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_response.shape_id());
+        request.mutable_mesh_options()->set_encoding(geometry::MESH_ENCODING_PACKED_FLOAT32);
+        geometry::MeshData mesh;
+        EXPECT_TRUE(service.GetMeshData(&mesh_ctx, &request, &mesh).ok());
+        return mesh;
+    };
+
+    geometry::MeshData parallel_mesh = extract(*service_);
+    geometry::MeshData serial_mesh = extract(serial_service);
+
+    ASSERT_GT(parallel_mesh.packed().triangle_count(), 0u);
+    EXPECT_EQ(parallel_mesh.packed().vertex_count(), serial_mesh.packed().vertex_count());
+    EXPECT_EQ(parallel_mesh.packed().triangle_count(), serial_mesh.packed().triangle_count());
+    EXPECT_EQ(parallel_mesh.packed().positions(), serial_mesh.packed().positions());
+    EXPECT_EQ(parallel_mesh.packed().indices(), serial_mesh.packed().indices());
+}
+
+TEST_F(MeshEncodingTest, NormalsAreUnitAndOutwardFacing) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+
+    geometry::MeshData mesh = GetMesh(shape_id, geometry::MESH_ENCODING_LEGACY);
+    ASSERT_EQ(mesh.normals_size(), mesh.vertices_size());
+
+    // Box from (1,2,3) with size 10x20x30
+    const double cx = 1 + 5, cy = 2 + 10, cz = 3 + 15;
+    for (int i = 0; i < mesh.normals_size(); ++i) {
+        const auto& n = mesh.normals(i);
+        const auto& v = mesh.vertices(i);
+        EXPECT_NEAR(n.x() * n.x() + n.y() * n.y() + n.z() * n.z(), 1.0, 1e-6);
+        EXPECT_GT(n.x() * (v.x() - cx) + n.y() * (v.y() - cy) + n.z() * (v.z() - cz), 0.0);
+    }
+}
+
+TEST_F(MeshEncodingTest, OmitNormalsDropsNormalBuffers) {
+    std::string shape_id = CreateTestBox();
+    ASSERT_FALSE(shape_id.empty());
+
+    for (auto encoding : {geometry::MESH_ENCODING_LEGACY, geometry::MESH_ENCODING_PACKED_FLOAT32}) {
+        grpc::ServerContext ctx;
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+        request.mutable_mesh_options()->set_encoding(encoding);
+        request.mutable_mesh_options()->set_omit_normals(true);
+
+        geometry::MeshData mesh;
+        ASSERT_TRUE(service_->GetMeshData(&ctx, &request, &mesh).ok());
+        EXPECT_EQ(mesh.normals_size(), 0);
+        EXPECT_TRUE(mesh.packed().normals().empty());
+        EXPECT_GT(VertexCount(mesh), 0);
+    }
+}
+
+TEST_F(MeshEncodingTest, SmallMeshAfterLargeOneHasNoStaleData) {
+    // Meshing scratch is reused per thread; a sphere first leaves it much larger than a box needs
+    grpc::ServerContext sphere_ctx;
+    geometry::SphereRequest sphere_request;
+    sphere_request.set_radius(25);
+    geometry::ShapeResponse sphere_response;
+    service_->CreateSphere(&sphere_ctx, &sphere_request, &sphere_response);
+    ASSERT_TRUE(sphere_response.success());
+    geometry::MeshData sphere = GetMesh(sphere_response.shape_id(), geometry::MESH_ENCODING_LEGACY);
+
+    std::string box_id = CreateTestBox();
+    ASSERT_FALSE(box_id.empty());
+    geometry::MeshData box = GetMesh(box_id, geometry::MESH_ENCODING_LEGACY);
+
+    ASSERT_GT(sphere.vertices_size(), box.vertices_size());
+    EXPECT_EQ(box.vertices_size(), 24);  // Four corners on each of the six planar faces
+    EXPECT_EQ(box.indices_size(), 36);
+    ASSERT_EQ(box.normals_size(), box.vertices_size());
+    for (const auto& n : box.normals()) {
+        EXPECT_NEAR(std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z()), 1.0, 1e-9);  // Axis-aligned
+    }
+    for (int index : box.indices()) {
+        EXPECT_LT(index, box.vertices_size());
+    }
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <map>
+
+#include <grpcpp/grpcpp.h>
+
+#include "loopback_server.h"
+
+namespace {
+
+uint32_t triangleCount(const geometry::MeshData& mesh) {
+    return mesh.has_packed() ? mesh.packed().triangle_count() : static_cast<uint32_t>(mesh.indices_size() / 3);
+}
+
+} // namespace
+
+// Tests for progressive level-of-detail mesh streaming
+class MeshLodTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        GeometryServiceOptions options;
+        options.mesh_cache_budget_bytes = 0;  // Every request tessellates again
+        ASSERT_NO_FATAL_FAILURE(server_.start(options, "lod-client"));
+        stub_ = server_.newStub();
+    }
+
+    std::vector<geometry::MeshData> StreamLods(const geometry::MeshLodRequest& request) {
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "lod-client");
+        auto reader = stub_->StreamMeshLods(&context, request);
+        std::vector<geometry::MeshData> meshes;
+        geometry::MeshData mesh;
+        while (reader->Read(&mesh)) {
+            meshes.push_back(mesh);
+        }
+        EXPECT_TRUE(reader->Finish().ok());
+        return meshes;
+    }
+
+    geometry::MeshData GetMesh(const std::string& shape_id, uint32_t lod) {
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "lod-client");
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+        request.mutable_mesh_options()->set_lod(lod);
+        geometry::MeshData mesh;
+        EXPECT_TRUE(stub_->GetMeshData(&context, request, &mesh).ok());
+        return mesh;
+    }
+
+    LoopbackServer server_;
+    std::unique_ptr<geometry::GeometryService::Stub> stub_;
+};
+
+TEST_F(MeshLodTest, CoarseLevelsDoNotAffectFullQualityMesh) {
+    std::string sphere_id = server_.client().CreateSphere(0, 0, 0, 50);
+    ASSERT_FALSE(sphere_id.empty());
+
+    uint32_t full_before = triangleCount(GetMesh(sphere_id, 0));
+    geometry::MeshData coarse = GetMesh(sphere_id, 100);  // Clamped to the coarsest level
+    uint32_t full_after = triangleCount(GetMesh(sphere_id, 0));
+
+    EXPECT_EQ(coarse.lod(), GeometryServiceImpl::kMeshLodCount - 1);
+    EXPECT_LT(triangleCount(coarse), full_before);
+    EXPECT_EQ(full_after, full_before);
+}
+
+TEST_F(MeshLodTest, StreamsCoarseSceneFirstThenRefines) {
+    std::string big_id = server_.client().CreateSphere(0, 0, 0, 100);
+    std::string small_id = server_.client().CreateSphere(500, 0, 0, 20);
+    ASSERT_FALSE(big_id.empty());
+    ASSERT_FALSE(small_id.empty());
+
+    auto meshes = StreamLods(geometry::MeshLodRequest());
+    ASSERT_GE(meshes.size(), 2u);
+
+    // Every shape is shown before any refinement, the biggest first
+    EXPECT_EQ(meshes[0].shape_id(), big_id);
+    EXPECT_EQ(meshes[1].shape_id(), small_id);
+    EXPECT_GT(meshes[0].lod(), 0u);
+
+    // Levels only get finer and every shape ends at full quality
+    std::map<std::string, const geometry::MeshData*> last;
+    for (const auto& mesh : meshes) {
+        auto it = last.find(mesh.shape_id());
+        if (it != last.end()) {
+            EXPECT_LT(mesh.lod(), it->second->lod());
+            EXPECT_GT(triangleCount(mesh), triangleCount(*it->second));
+        }
+        last[mesh.shape_id()] = &mesh;
+    }
+    ASSERT_EQ(last.size(), 2u);
+    EXPECT_EQ(last[big_id]->lod(), 0u);
+    EXPECT_EQ(last[small_id]->lod(), 0u);
+}
+
+TEST_F(MeshLodTest, TargetsRefineFromCurrentLevelByScreenSize) {
+    std::string a_id = server_.client().CreateSphere(0, 0, 0, 50);
+    std::string b_id = server_.client().CreateSphere(500, 0, 0, 50);
+    std::string done_id = server_.client().CreateSphere(-500, 0, 0, 50);
+
+    geometry::MeshLodRequest request;
+    auto* a = request.add_targets();
+    a->set_shape_id(a_id);
+    a->set_screen_size(20.0f);
+    a->set_has_mesh(true);
+    a->set_current_lod(1);
+    auto* b = request.add_targets();
+    b->set_shape_id(b_id);
+    b->set_screen_size(400.0f);
+    b->set_has_mesh(true);
+    b->set_current_lod(1);
+    auto* done = request.add_targets();
+    done->set_shape_id(done_id);
+    done->set_has_mesh(true);
+    done->set_current_lod(0);
+
+    auto meshes = StreamLods(request);
+    ASSERT_EQ(meshes.size(), 2u);
+    EXPECT_EQ(meshes[0].shape_id(), b_id);  // Larger on screen, refined first
+    EXPECT_EQ(meshes[1].shape_id(), a_id);
+    EXPECT_EQ(meshes[0].lod(), 0u);
+    EXPECT_EQ(meshes[1].lod(), 0u);
+}
+
+TEST_F(MeshLodTest, CoarseSyncThenClientRefinement) {
+    std::string sphere_id = server_.client().CreateSphere(0, 0, 0, 50);
+    ASSERT_FALSE(sphere_id.empty());
+
+    auto delta = server_.client().SyncScene(0, GeometryServiceImpl::kMeshLodCount - 1);
+    ASSERT_TRUE(delta.success);
+    ASSERT_EQ(delta.changed.size(), 1u);
+    uint32_t coarse_lod = delta.changed[0].lod;
+    EXPECT_GT(coarse_lod, 0u);
+
+    std::vector<GeometryClient::MeshData> refined;
+    ASSERT_TRUE(server_.client().StreamMeshLods({{sphere_id, 100.0f, true, coarse_lod}},
+                                        [&](GeometryClient::MeshData&& mesh) {
+                                            refined.push_back(std::move(mesh));
+                                            return true;
+                                        }));
+    ASSERT_FALSE(refined.empty());
+    EXPECT_EQ(refined.back().lod, 0u);
+    EXPECT_GT(refined.back().indices.size(), delta.changed[0].indices.size());
+}
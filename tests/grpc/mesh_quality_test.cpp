@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <grpcpp/grpcpp.h>
+
+#include "server/scoped_temp_file.h"
+#include "loopback_server.h"
+
+namespace {
+
+uint32_t triangleCount(const geometry::MeshData& mesh) {
+    return mesh.has_packed() ? mesh.packed().triangle_count() : static_cast<uint32_t>(mesh.indices_size() / 3);
+}
+
+} // namespace
+
+// Tests for per-request tessellation quality and the GetAllMeshes triangle budget
+class MeshQualityTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "quality-client"));
+        stub_ = server_.newStub();
+    }
+
+    geometry::MeshData GetMesh(const std::string& shape_id,
+                               const geometry::MeshOptions& options = geometry::MeshOptions()) {
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "quality-client");
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+        *request.mutable_mesh_options() = options;
+        geometry::MeshData mesh;
+        EXPECT_TRUE(stub_->GetMeshData(&context, request, &mesh).ok());
+        return mesh;
+    }
+
+    uint64_t TotalTriangles(uint64_t triangle_budget, size_t* mesh_count = nullptr) {
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "quality-client");
+        geometry::MeshRequest request;
+        request.set_triangle_budget(triangle_budget);
+        auto reader = stub_->GetAllMeshes(&context, request);
+        uint64_t total = 0;
+        size_t count = 0;
+        geometry::MeshData mesh;
+        while (reader->Read(&mesh)) {
+            EXPECT_GT(triangleCount(mesh), 0u);
+            total += triangleCount(mesh);
+            ++count;
+        }
+        EXPECT_TRUE(reader->Finish().ok());
+        if (mesh_count) {
+            *mesh_count = count;
+        }
+        return total;
+    }
+
+    LoopbackServer server_;
+    std::unique_ptr<geometry::GeometryService::Stub> stub_;
+};
+
+TEST_F(MeshQualityTest, RequestedDeflectionDoesNotReplaceDefaultMesh) {
+    std::string sphere_id = server_.client().CreateSphere(0, 0, 0, 50);
+    ASSERT_FALSE(sphere_id.empty());
+
+    geometry::MeshData default_before = GetMesh(sphere_id);
+    geometry::MeshOptions fine;
+    fine.set_linear_deflection(0.02);
+    geometry::MeshData fine_mesh = GetMesh(sphere_id, fine);
+    geometry::MeshData default_after = GetMesh(sphere_id);
+
+    EXPECT_DOUBLE_EQ(fine_mesh.linear_deflection(), 0.02);
+    EXPECT_GT(default_before.linear_deflection(), fine_mesh.linear_deflection());
+    EXPECT_GT(triangleCount(fine_mesh), triangleCount(default_before));
+    EXPECT_EQ(triangleCount(default_after), triangleCount(default_before));
+}
+
+TEST_F(MeshQualityTest, RelativeDeflectionFollowsShapeSize) {
+    std::string small_id = server_.client().CreateSphere(0, 0, 0, 10);
+    std::string large_id = server_.client().CreateSphere(500, 0, 0, 100);
+    ASSERT_FALSE(small_id.empty());
+    ASSERT_FALSE(large_id.empty());
+
+    geometry::MeshOptions options;
+    options.set_relative_deflection(0.005);
+    geometry::MeshData small_mesh = GetMesh(small_id, options);
+    geometry::MeshData large_mesh = GetMesh(large_id, options);
+
+    EXPECT_NEAR(large_mesh.linear_deflection() / small_mesh.linear_deflection(), 10.0, 0.01);
+    EXPECT_NEAR(static_cast<double>(triangleCount(large_mesh)), triangleCount(small_mesh),
+                0.2 * triangleCount(small_mesh));
+}
+
+TEST_F(MeshQualityTest, TriangleBudgetIsSharedAcrossShapes) {
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_FALSE(server_.client().CreateSphere(i * 200.0, 0, 0, 20.0 + i * 20.0).empty());
+    }
+    ASSERT_FALSE(server_.client().CreateBox(-200, 0, 0, 10, 10, 10).empty());
+
+    size_t unlimited_count = 0;
+    uint64_t unlimited = TotalTriangles(0, &unlimited_count);
+    ASSERT_EQ(unlimited_count, 5u);
+
+    size_t budget_count = 0;
+    uint64_t budget = unlimited / 4;
+    EXPECT_LE(TotalTriangles(budget, &budget_count), budget);
+    EXPECT_EQ(budget_count, unlimited_count);
+
+    // A generous budget leaves the requested quality alone
+    EXPECT_EQ(TotalTriangles(unlimited * 2), unlimited);
+}
+
+TEST_F(MeshQualityTest, ImportPrecisionIsDefaultDeflection) {
+    std::string sphere_id = server_.client().CreateSphere(0, 0, 0, 50);
+    ASSERT_FALSE(sphere_id.empty());
+    auto exported = server_.client().ExportModelFile({sphere_id});
+    ASSERT_TRUE(exported.success) << exported.message;
+    ScopedTempFile file("sphere.step");
+    file.write(exported.model_data);
+
+    GeometryClient::ModelImportOptions coarse_options;
+    coarse_options.precision = 1.0;
+    auto coarse = server_.client().UploadModelFile(file.path(), coarse_options);
+    ASSERT_TRUE(coarse.success) << coarse.message;
+    GeometryClient::ModelImportOptions fine_options;
+    fine_options.precision = 0.05;
+    auto fine = server_.client().UploadModelFile(file.path(), fine_options);
+    ASSERT_TRUE(fine.success) << fine.message;
+    ASSERT_FALSE(coarse.shape_ids.empty());
+    ASSERT_FALSE(fine.shape_ids.empty());
+
+    geometry::MeshData coarse_mesh = GetMesh(coarse.shape_ids[0]);
+    geometry::MeshData fine_mesh = GetMesh(fine.shape_ids[0]);
+    EXPECT_DOUBLE_EQ(coarse_mesh.linear_deflection(), 1.0);
+    EXPECT_DOUBLE_EQ(fine_mesh.linear_deflection(), 0.05);
+    EXPECT_LT(triangleCount(coarse_mesh), triangleCount(fine_mesh));
+}
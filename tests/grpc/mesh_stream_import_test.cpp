@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+
+#include "server/mesh_stream_importer.h"
+#include "server/scoped_temp_file.h"
+#include "loopback_server.h"
+
+namespace {
+
+// Flat n x n grid of unit quads, two triangles each, as binary STL
+void WriteGridStl(const std::string& path, int n) {
+    std::ofstream file(path, std::ios::binary);
+    char header[80] = {};
+    file.write(header, sizeof(header));
+    uint32_t count = 2u * n * n;
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    auto triangle = [&](float ax, float ay, float bx, float by, float cx, float cy) {
+        const float record[12] = {0, 0, 1, ax, ay, 0, bx, by, 0, cx, cy, 0};
+        const uint16_t attributes = 0;
+        file.write(reinterpret_cast<const char*>(record), sizeof(record));
+        file.write(reinterpret_cast<const char*>(&attributes), sizeof(attributes));
+    };
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) {
+            float x = static_cast<float>(i), y = static_cast<float>(j);
+            triangle(x, y, x + 1, y, x + 1, y + 1);
+            triangle(x, y, x + 1, y + 1, x, y + 1);
+        }
+    }
+}
+
+struct ChunkSummary {
+    size_t triangles{0};
+    size_t nodes{0};
+    size_t chunks{0};
+    size_t largest_chunk{0};
+    double largest_extent{0.0};  // Widest chunk bounding box along x or y
+};
+
+ChunkSummary Import(const std::string& path, const std::string& format, size_t chunk_triangles) {
+    MeshStreamImporter::Options options;
+    options.max_chunk_triangles = chunk_triangles;
+    ChunkSummary summary;
+    MeshStreamImporter::importFile(path, format, options, [&](const Handle(Poly_Triangulation)& chunk) {
+        summary.triangles += chunk->NbTriangles();
+        summary.nodes += chunk->NbNodes();
+        summary.chunks++;
+        summary.largest_chunk = std::max<size_t>(summary.largest_chunk, chunk->NbTriangles());
+        double min_x = 1e30, max_x = -1e30, min_y = 1e30, max_y = -1e30;
+        for (int i = 1; i <= chunk->NbNodes(); ++i) {
+            gp_Pnt p = chunk->Node(i);
+            min_x = std::min(min_x, p.X());
+            max_x = std::max(max_x, p.X());
+            min_y = std::min(min_y, p.Y());
+            max_y = std::max(max_y, p.Y());
+        }
+        summary.largest_extent = std::max({summary.largest_extent, max_x - min_x, max_y - min_y});
+    });
+    return summary;
+}
+
+} // namespace
+
+// Tests for the bounded-memory STL/OBJ/PLY reader
+TEST(MeshStreamImporterTest, BinaryStlIsSplitIntoWeldedSpatialChunks) {
+    ScopedTempFile file("grid.stl");
+    WriteGridStl(file.path(), 100);  // 20000 triangles
+
+    ChunkSummary summary = Import(file.path(), "STL", 2000);
+    EXPECT_EQ(summary.triangles, 20000u);
+    EXPECT_GE(summary.chunks, 10u);
+    EXPECT_LE(summary.largest_chunk, 2000u);
+    EXPECT_LT(summary.nodes, 3u * 20000u / 4);  // Shared corners merged instead of three per triangle
+    EXPECT_LT(summary.largest_extent, 100.0);   // Grid cells, not strips across the whole model
+}
+
+TEST(MeshStreamImporterTest, SmallFileStaysOneChunk) {
+    ScopedTempFile file("grid.stl");
+    WriteGridStl(file.path(), 10);
+
+    ChunkSummary summary = Import(file.path(), "STL", MeshStreamImporter::kDefaultChunkTriangles);
+    EXPECT_EQ(summary.chunks, 1u);
+    EXPECT_EQ(summary.triangles, 200u);
+    EXPECT_EQ(summary.nodes, 121u);
+}
+
+TEST(MeshStreamImporterTest, ReadsAsciiStlObjAndPly) {
+    ScopedTempFile stl("part.stl");
+    stl.write("solid part\n facet normal 0 0 1\n  outer loop\n   vertex 0 0 0\n   vertex 1 0 0\n"
+              "   vertex 0 1 0\n  endloop\n endfacet\nendsolid part\n");
+    EXPECT_EQ(Import(stl.path(), "STL", 100).triangles, 1u);
+
+    // A quad, and a triangle using negative and slash-separated indices
+    ScopedTempFile obj("part.obj");
+    obj.write("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\nv 0 0 1\nf -5/1/1 -4//2 -1\n");
+    ChunkSummary obj_summary = Import(obj.path(), "OBJ", 100);
+    EXPECT_EQ(obj_summary.triangles, 3u);
+    EXPECT_EQ(obj_summary.nodes, 5u);
+
+    ScopedTempFile ply("part.ply");
+    ply.write("ply\nformat ascii 1.0\nelement vertex 4\nproperty float x\nproperty float y\nproperty float z\n"
+              "property uchar red\nelement face 1\nproperty list uchar int vertex_indices\nend_header\n"
+              "0 0 0 9\n1 0 0 9\n1 1 0 9\n0 1 1 9\n4 0 1 2 3\n");
+    EXPECT_EQ(Import(ply.path(), "PLY", 100).triangles, 2u);
+
+    std::string binary = "ply\nformat binary_little_endian 1.0\nelement vertex 3\nproperty double x\n"
+                         "property double y\nproperty double z\nelement face 1\n"
+                         "property list uchar uint vertex_index\nend_header\n";
+    const double vertices[9] = {0, 0, 0, 2, 0, 0, 0, 2, 0};
+    const uint8_t corners = 3;
+    const uint32_t indices[3] = {0, 1, 2};
+    binary.append(reinterpret_cast<const char*>(vertices), sizeof(vertices));
+    binary.append(reinterpret_cast<const char*>(&corners), sizeof(corners));
+    binary.append(reinterpret_cast<const char*>(indices), sizeof(indices));
+    ScopedTempFile binary_ply("binary.ply");
+    binary_ply.write(binary);
+    EXPECT_EQ(Import(binary_ply.path(), "PLY", 100).triangles, 1u);
+}
+
+TEST(MeshStreamImporterTest, RejectsBadInput) {
+    ScopedTempFile obj("bad.obj");
+    obj.write("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 7\n");
+    EXPECT_THROW(Import(obj.path(), "OBJ", 100), std::runtime_error);
+
+    ScopedTempFile empty("empty.stl");
+    empty.write("solid empty\nendsolid empty\n");
+    EXPECT_THROW(Import(empty.path(), "STL", 100), std::runtime_error);
+}
+
+// End-to-end: sub-meshes become separate shapes of the importing session
+class MeshStreamImportServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        GeometryServiceOptions options;
+        options.import_chunk_triangles = 1000;
+        ASSERT_NO_FATAL_FAILURE(server_.start(options, "stream-client"));
+    }
+
+    LoopbackServer server_;
+};
+
+TEST_F(MeshStreamImportServiceTest, LargeMeshBecomesSeveralShapes) {
+    ScopedTempFile file("scan.stl");
+    WriteGridStl(file.path(), 60);  // 7200 triangles
+
+    auto result = server_.client().ImportModelFile(file.path());
+    ASSERT_TRUE(result.success) << result.message;
+    EXPECT_GE(result.shape_ids.size(), 8u);
+
+    size_t triangles = 0;
+    for (const auto& mesh : server_.client().GetAllMeshes()) {
+        EXPECT_LE(mesh.indices.size() / 3, 1000u);
+        triangles += mesh.indices.size() / 3;
+    }
+    EXPECT_EQ(triangles, 7200u);
+}
+
+TEST_F(MeshStreamImportServiceTest, FailedImportRemovesStreamedPieces) {
+    // Enough faces to stream a few pieces before the bad index at the end
+    std::string obj;
+    for (int i = 0; i <= 60; ++i) {
+        obj += "v " + std::to_string(i) + " 0 0\nv " + std::to_string(i) + " 1 0\n";
+    }
+    for (int i = 0; i < 60; ++i) {
+        for (int copy = 0; copy < 100; ++copy) {
+            obj += "f " + std::to_string(2 * i + 1) + " " + std::to_string(2 * i + 3) + " " +
+                   std::to_string(2 * i + 2) + "\n";
+        }
+    }
+    obj += "f 1 2 999\n";
+    ScopedTempFile file("broken.obj");
+    file.write(obj);
+
+    auto result = server_.client().ImportModelFile(file.path());
+    EXPECT_FALSE(result.success);
+    EXPECT_TRUE(server_.client().GetAllMeshes().empty());
+}
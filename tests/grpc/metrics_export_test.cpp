@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "server/metrics_exporter.h"
+#include "server/metrics_http_server.h"
+#include "server/rpc_metrics_interceptor.h"
+#include "server/stage_trace.h"
+#include "loopback_server.h"
+
+namespace {
+
+bool Contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+#ifndef _WIN32
+// Plain GET against 127.0.0.1:port, returning the raw response
+std::string HttpGet(uint16_t port, const std::string& path) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return {};
+    }
+    const std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(n));
+    }
+    close(fd);
+    return response;
+}
+#endif
+
+} // namespace
+
+// Tests for stage spans and the span log
+class StageTraceTest : public ::testing::Test {
+protected:
+    void SetUp() override { StageTrace::instance().setCapacity(16); }
+    void TearDown() override { StageTrace::instance().setCapacity(0); }
+};
+
+TEST_F(StageTraceTest, NestedSpansShareTheirTrace) {
+    {
+        STAGE_SPAN(outer, "TestOuter");
+        {
+            STAGE_SPAN(inner, "TestInner");
+        }
+    }
+    {
+        STAGE_SPAN(next, "TestOuter");
+    }
+
+    auto spans = StageTrace::instance().recentSpans();
+    ASSERT_GE(spans.size(), 3u);
+    const auto& inner = spans[spans.size() - 3];  // Spans are logged as they finish
+    const auto& outer = spans[spans.size() - 2];
+    const auto& next = spans.back();
+    EXPECT_STREQ(inner.name, "TestInner");
+    EXPECT_EQ(inner.parent_id, outer.span_id);
+    EXPECT_EQ(inner.trace_id, outer.trace_id);
+    EXPECT_EQ(outer.parent_id, 0u);
+    EXPECT_NE(next.trace_id, outer.trace_id);
+    EXPECT_GE(outer.duration_us, inner.duration_us);
+
+    EXPECT_EQ(GrpcPerformanceMonitor::getInstance().getOperationStats("Stage.TestInner").call_count, 1u);
+    EXPECT_TRUE(Contains(StageTrace::instance().chromeTraceJson(), "\"name\":\"TestInner\""));
+}
+
+TEST_F(StageTraceTest, LogKeepsOnlyTheMostRecentSpans) {
+    for (int i = 0; i < 40; ++i) {
+        STAGE_SPAN(span, "TestLoop");
+    }
+    EXPECT_EQ(StageTrace::instance().recentSpans().size(), 16u);
+
+    StageTrace::instance().setCapacity(0);
+    {
+        STAGE_SPAN(span, "TestLoop");
+    }
+    EXPECT_TRUE(StageTrace::instance().recentSpans().empty());
+    EXPECT_EQ(GrpcPerformanceMonitor::getInstance().getOperationStats("Stage.TestLoop").call_count, 41u);
+}
+
+// End-to-end: a scrape reflects the RPCs, stages and state of the server
+class MetricsExportTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        GrpcPerformanceMonitor::getInstance().reset();
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "export-client", true));
+    }
+
+    // Interceptors record as their call is torn down, just after the client has the reply
+    std::string ScrapeOnceRecorded(const MetricsExporter& exporter, const std::string& expected) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        std::string text = exporter.prometheusText();
+        while (!Contains(text, expected) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            text = exporter.prometheusText();
+        }
+        return text;
+    }
+
+    LoopbackServer server_;
+};
+
+TEST_F(MetricsExportTest, PrometheusTextCoversRpcsStagesAndGauges) {
+    ASSERT_FALSE(server_.client().CreateSphere(0, 0, 0, 10).empty());
+    ASSERT_EQ(server_.client().GetAllMeshes().size(), 1u);
+    ASSERT_EQ(server_.client().GetAllMeshes().size(), 1u);  // From the mesh cache
+
+    MetricsExporter exporter(server_.service());
+    const std::string text = ScrapeOnceRecorded(
+        exporter, "geometry_rpc_duration_seconds_count{method=\"GetAllMeshes\"} 2");
+
+    EXPECT_TRUE(Contains(text, "# TYPE geometry_rpc_duration_seconds histogram\n"));
+    EXPECT_TRUE(Contains(text, "geometry_rpc_duration_seconds_bucket{method=\"CreateSphere\",le=\"+Inf\"} 1\n"));
+    EXPECT_TRUE(Contains(text, "geometry_rpc_duration_seconds_count{method=\"GetAllMeshes\"} 2\n"));
+    EXPECT_TRUE(Contains(text, "geometry_rpc_requests_total{method=\"CreateSphere\",outcome=\"ok\"} 1\n"));
+    EXPECT_TRUE(Contains(text, "geometry_rpc_sent_bytes_total{method=\"GetAllMeshes\"}"));
+    for (const char* stage : {"Tessellate", "ExtractTriangulation", "Serialize", "StreamWrite", "GetAllMeshes"}) {
+        EXPECT_TRUE(Contains(text, std::string("geometry_stage_duration_seconds_count{stage=\"") + stage + "\"}"))
+            << stage;
+    }
+    EXPECT_TRUE(Contains(text, "geometry_stage_duration_seconds_count{stage=\"Tessellate\"} 1\n"));
+    EXPECT_TRUE(Contains(text, "geometry_active_sessions 1\n"));
+    EXPECT_TRUE(Contains(text, "geometry_shapes 1\n"));
+    EXPECT_TRUE(Contains(text, "# TYPE geometry_resident_memory_bytes gauge\n"));
+    EXPECT_TRUE(Contains(text, "geometry_accounted_memory_bytes{kind=\"brep\"} "));
+    EXPECT_TRUE(Contains(text, "geometry_memory_limit_bytes 0\n"));
+    EXPECT_FALSE(Contains(text, "geometry_cache_hits_total{cache=\"mesh\"} 0\n"));
+    EXPECT_TRUE(Contains(text, "geometry_cache_hit_ratio{cache=\"mesh\"} "));
+}
+
+#ifndef _WIN32
+TEST_F(MetricsExportTest, HttpEndpointServesMetricsAndTraces) {
+    MetricsExporter exporter(server_.service());
+    MetricsHttpServer http;
+    http.addRoute("/metrics", "text/plain; version=0.0.4", [&exporter] { return exporter.prometheusText(); });
+    http.addRoute("/traces", "application/json", [] { return StageTrace::instance().chromeTraceJson(); });
+    ASSERT_TRUE(http.start("127.0.0.1:0"));
+    ASSERT_NE(http.port(), 0);
+
+    StageTrace::instance().setCapacity(64);
+    ASSERT_FALSE(server_.client().CreateBox(0, 0, 0, 1, 1, 1).empty());
+    server_.client().GetAllMeshes();
+
+    std::string metrics = HttpGet(http.port(), "/metrics");
+    EXPECT_EQ(metrics.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_TRUE(Contains(metrics, "Content-Type: text/plain; version=0.0.4"));
+    EXPECT_TRUE(Contains(metrics, "geometry_shapes 1\n"));
+
+    std::string traces = HttpGet(http.port(), "/traces?limit=1");
+    EXPECT_EQ(traces.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_TRUE(Contains(traces, "\"name\":\"Tessellate\""));
+
+    EXPECT_EQ(HttpGet(http.port(), "/other").rfind("HTTP/1.1 404", 0), 0u);
+    http.stop();
+    StageTrace::instance().setCapacity(0);
+}
+#endif
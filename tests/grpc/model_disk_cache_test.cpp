@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include <BRepPrimAPI_MakeBox.hxx>
+
+#include "server/model_disk_cache.h"
+#include "server/scoped_temp_file.h"
+#include "loopback_server.h"
+
+namespace {
+
+std::filesystem::path UniqueCacheDir() {
+    return std::filesystem::temp_directory_path() /
+           ("occt_model_cache_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+}
+
+ModelDiskCache::CachedShape MakeBox(double size) {
+    ModelDiskCache::CachedShape cached;
+    cached.shape = BRepPrimAPI_MakeBox(size, size, size).Shape();
+    cached.color.set_r(0.2f);
+    cached.color.set_g(0.4f);
+    cached.color.set_b(0.6f);
+    cached.color.set_a(1.0f);
+    return cached;
+}
+
+} // namespace
+
+// Tests for the on-disk model cache itself
+class ModelDiskCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        spdlog::set_level(spdlog::level::warn);
+        dir_ = UniqueCacheDir();
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+    std::filesystem::path dir_;
+};
+
+TEST_F(ModelDiskCacheTest, KeysFollowContentAndOptions) {
+    ScopedTempFile a("a.step");
+    ScopedTempFile b("b.step");
+    a.write("same content");
+    b.write("same content");
+
+    geometry::ModelImportOptions options;
+    std::string key = ModelDiskCache::makeKey(a.path(), "STEP", options);
+    ASSERT_FALSE(key.empty());
+    EXPECT_EQ(ModelDiskCache::makeKey(b.path(), "STEP", options), key);  // Named differently, same content
+
+    options.set_precision(0.5);
+    EXPECT_NE(ModelDiskCache::makeKey(a.path(), "STEP", options), key);
+    b.write("other content");
+    EXPECT_NE(ModelDiskCache::makeKey(b.path(), "STEP", geometry::ModelImportOptions()), key);
+    EXPECT_TRUE(ModelDiskCache::makeKey("missing.step", "STEP", options).empty());
+}
+
+TEST_F(ModelDiskCacheTest, EntriesSurviveRestart) {
+    {
+        ModelDiskCache cache(dir_);
+        cache.storeShapes("entry", {MakeBox(10), MakeBox(20)});
+        geometry::MeshData mesh;
+        mesh.add_indices(1);
+        cache.storeMesh("entry", 1, geometry::MESH_ENCODING_PACKED_FLOAT32, true, mesh);
+    }
+
+    ModelDiskCache cache(dir_);
+    EXPECT_EQ(cache.stats().entries, 1u);
+    std::vector<ModelDiskCache::CachedShape> shapes;
+    ASSERT_TRUE(cache.loadShapes("entry", shapes));
+    ASSERT_EQ(shapes.size(), 2u);
+    EXPECT_FALSE(shapes[1].shape.IsNull());
+    EXPECT_FLOAT_EQ(shapes[0].color.b(), 0.6f);
+
+    geometry::MeshData mesh;
+    EXPECT_TRUE(cache.loadMesh("entry", 1, geometry::MESH_ENCODING_PACKED_FLOAT32, true, mesh));
+    EXPECT_EQ(mesh.indices_size(), 1);
+    EXPECT_FALSE(cache.loadMesh("entry", 1, geometry::MESH_ENCODING_PACKED_FLOAT32, false, mesh));
+    EXPECT_FALSE(cache.loadShapes("other", shapes));
+}
+
+TEST_F(ModelDiskCacheTest, EvictsLeastRecentlyUsedOverBudget) {
+    uint64_t entry_bytes = 0;
+    {
+        ModelDiskCache probe(dir_ / "probe");
+        probe.storeShapes("box", {MakeBox(10)});
+        entry_bytes = probe.stats().bytes;
+        ASSERT_GT(entry_bytes, 0u);
+    }
+
+    ModelDiskCache cache(dir_ / "budget", entry_bytes * 2 + entry_bytes / 2);
+    cache.storeShapes("a", {MakeBox(10)});
+    cache.storeShapes("b", {MakeBox(10)});
+    std::vector<ModelDiskCache::CachedShape> shapes;
+    ASSERT_TRUE(cache.loadShapes("a", shapes));  // b becomes the oldest
+    cache.storeShapes("c", {MakeBox(10)});
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_LE(stats.bytes, stats.budget_bytes);
+    EXPECT_TRUE(cache.loadShapes("a", shapes));
+    EXPECT_FALSE(cache.loadShapes("b", shapes));
+    EXPECT_FALSE(std::filesystem::exists(dir_ / "budget" / "b"));
+}
+
+// End-to-end: a restarted server imports and meshes from the disk cache
+class ModelDiskCacheServiceTest : public ModelDiskCacheTest {
+protected:
+    // Replaces any running server with a new one over the same cache directory
+    void StartServer() {
+        GeometryServiceOptions options;
+        options.model_cache_dir = dir_.string();
+        ASSERT_NO_FATAL_FAILURE(server_.start(options, "cache-client"));
+    }
+
+    void TearDown() override {
+        server_.stop();  // Before the cache directory goes
+        ModelDiskCacheTest::TearDown();
+    }
+
+    LoopbackServer server_;
+};
+
+TEST_F(ModelDiskCacheServiceTest, RestartedServerImportsFromCache) {
+    ASSERT_NO_FATAL_FAILURE(StartServer());
+    std::string sphere_id = server_.client().CreateSphere(0, 0, 0, 25);
+    ASSERT_FALSE(sphere_id.empty());
+    auto exported = server_.client().ExportModelFile({sphere_id});
+    ASSERT_TRUE(exported.success) << exported.message;
+    ScopedTempFile file("part.step");
+    file.write(exported.model_data);
+
+    auto first = server_.client().UploadModelFile(file.path());
+    ASSERT_TRUE(first.success) << first.message;
+    ASSERT_FALSE(first.shape_ids.empty());
+    auto first_mesh = server_.client().GetMeshData(first.shape_ids[0]);
+    EXPECT_EQ(server_.service().getModelDiskCacheStats().entries, 1u);
+    EXPECT_EQ(server_.service().getModelDiskCacheStats().hits, 0u);
+
+    ASSERT_NO_FATAL_FAILURE(StartServer());
+    auto second = server_.client().UploadModelFile(file.path());
+    ASSERT_TRUE(second.success) << second.message;
+    ASSERT_EQ(second.shape_ids.size(), first.shape_ids.size());
+    auto second_mesh = server_.client().GetMeshData(second.shape_ids[0]);
+
+    auto stats = server_.service().getModelDiskCacheStats();
+    EXPECT_EQ(stats.hits, 2u);  // Shapes, then the mesh
+    EXPECT_EQ(second_mesh.shape_id, second.shape_ids[0]);
+    EXPECT_EQ(second_mesh.indices, first_mesh.indices);
+    EXPECT_EQ(second_mesh.vertices, first_mesh.vertices);
+
+    // A changed shape no longer uses the cached mesh
+    ASSERT_TRUE(server_.client().SetShapeColor(second.shape_ids[0], 1.0, 0.0, 0.0));
+    server_.client().GetMeshData(second.shape_ids[0]);
+    EXPECT_EQ(server_.service().getModelDiskCacheStats().hits, 2u);
+}
@@ -189,6 +189,101 @@ TEST_F(ModelImportTest, ExportImportedModel) {
     EXPECT_EQ(export_response.file_info().format(), "STEP");
 }
 
+// STEP export is serialized in memory, so concurrent exports cannot clobber each other
+TEST_F(ModelImportTest, ConcurrentStepExportsStayIndependent) {
+    auto create_box = [this](double width) {
+        grpc::ServerContext ctx;
+        geometry::BoxRequest request;
+        request.set_width(width);
+        request.set_height(width);
+        request.set_depth(width);
+        geometry::ShapeResponse response;
+        service_->CreateBox(&ctx, &request, &response);
+        return response.shape_id();
+    };
+    const std::string small_id = create_box(12.25);
+    const std::string large_id = create_box(37.5);
+    ASSERT_FALSE(small_id.empty());
+    ASSERT_FALSE(large_id.empty());
+    
+    std::vector<std::future<std::string>> futures;
+    for (int i = 0; i < 8; ++i) {
+        const std::string shape_id = (i % 2 == 0) ? small_id : large_id;
+        futures.push_back(std::async(std::launch::async, [this, shape_id]() {
+            grpc::ServerContext ctx;
+            geometry::ModelExportRequest request;
+            request.add_shape_ids(shape_id);
+            request.mutable_options()->set_format("STEP");
+            geometry::ModelFileResponse response;
+            service_->ExportModelFile(&ctx, &request, &response);
+            return response.success() ? response.model_data() : std::string();
+        }));
+    }
+    
+    for (int i = 0; i < static_cast<int>(futures.size()); ++i) {
+        std::string data = futures[i].get();
+        ASSERT_FALSE(data.empty());
+        EXPECT_NE(data.find("ISO-10303-21"), std::string::npos);
+        const bool small = (i % 2 == 0);
+        EXPECT_EQ(data.find("12.25") != std::string::npos, small);
+        EXPECT_EQ(data.find("37.5") != std::string::npos, !small);
+    }
+    
+    // No scratch file left behind in the working directory
+    EXPECT_FALSE(std::ifstream("temp_export.step").good());
+}
+
+// STEP and BREP bytes are parsed from memory with the same readers as files
+TEST_F(ModelImportTest, ImportsStepAndBrepDataInMemory) {
+    grpc::ServerContext create_ctx;
+    geometry::BoxRequest box;
+    box.set_width(10);
+    box.set_height(20);
+    box.set_depth(30);
+    geometry::ShapeResponse created;
+    service_->CreateBox(&create_ctx, &box, &created);
+    ASSERT_TRUE(created.success());
+    
+    auto export_as = [this, &created](const std::string& format) {
+        grpc::ServerContext ctx;
+        geometry::ModelExportRequest request;
+        request.add_shape_ids(created.shape_id());
+        request.mutable_options()->set_format(format);
+        geometry::ModelFileResponse response;
+        service_->ExportModelFile(&ctx, &request, &response);
+        EXPECT_TRUE(response.success()) << response.message();
+        return response.model_data();
+    };
+    const std::string step_data = export_as("STEP");
+    const std::string brep_data = export_as("BREP");
+    ASSERT_FALSE(step_data.empty());
+    ASSERT_FALSE(brep_data.empty());
+    
+    const std::string client_id = "Unknown";  // Plain ServerContext
+    std::vector<std::string> step_ids = service_->importModelData(client_id, step_data, "box.step", {});
+    std::vector<std::string> brep_ids = service_->importModelData(client_id, brep_data, "box.brep", {});
+    ASSERT_EQ(step_ids.size(), 1u);
+    ASSERT_EQ(brep_ids.size(), 1u);
+    EXPECT_NE(step_ids[0], brep_ids[0]);
+    EXPECT_NE(step_ids[0], created.shape_id());
+    EXPECT_NE(brep_ids[0], created.shape_id());
+    EXPECT_EQ(service_->getShapeCount(), 3u);
+    
+    // Both are shapes of the session, meshed like any other
+    for (const std::string& shape_id : {step_ids[0], brep_ids[0]}) {
+        grpc::ServerContext ctx;
+        geometry::ShapeRequest request;
+        request.set_shape_id(shape_id);
+        geometry::MeshData mesh;
+        ASSERT_TRUE(service_->GetMeshData(&ctx, &request, &mesh).ok());
+        EXPECT_EQ(mesh.shape_id(), shape_id);
+        EXPECT_FALSE(mesh.vertices().empty());
+    }
+    
+    EXPECT_ANY_THROW(service_->importModelData(client_id, "not a model", "broken.step", {}));
+    EXPECT_EQ(service_->getShapeCount(), 3u);
+}
+
 // Test mesh precision option
 TEST_F(ModelImportTest, ImportWithCustomPrecision) {
     geometry::ModelFileRequest request;
@@ -214,4 +309,39 @@ TEST_F(ModelImportTest, ImportWithCustomPrecision) {
         EXPECT_TRUE(mesh_status.ok());
         EXPECT_FALSE(mesh_response.vertices().empty());
     }
-}
\ No newline at end of file
+}
+
+// Test bulk import with per-file results
+TEST_F(ModelImportTest, BulkImportReportsEachFile) {
+    geometry::ImportModelFilesRequest request;
+    request.add_file_paths("test_models/test.stl");
+    request.add_file_paths("test_models/nonexistent.step");
+    request.add_file_paths("test_models/test.obj");
+    request.add_file_paths("test_models/test.stl");
+    
+    geometry::ImportModelFilesResponse response;
+    auto status = service_->ImportModelFiles(&context_, &request, &response);
+    
+    ASSERT_TRUE(status.ok());
+    EXPECT_FALSE(response.success());
+    EXPECT_EQ(response.imported_files(), 3u);
+    ASSERT_EQ(response.results_size(), 4);
+    
+    int shape_count = 0;
+    for (int i = 0; i < response.results_size(); ++i) {
+        const auto& result = response.results(i);
+        EXPECT_EQ(result.file_path(), request.file_paths(i));
+        EXPECT_EQ(result.success(), i != 1);
+        EXPECT_EQ(result.shape_ids().empty(), i == 1);
+        shape_count += result.shape_ids_size();
+    }
+    EXPECT_FALSE(response.results(1).message().empty());
+    EXPECT_EQ(response.results(0).detected_format(), "STL");
+    EXPECT_EQ(response.results(2).detected_format(), "OBJ");
+    EXPECT_EQ(response.shape_count(), static_cast<uint32_t>(shape_count));
+    
+    geometry::EmptyRequest info_request;
+    geometry::SystemInfoResponse info;
+    ASSERT_TRUE(service_->GetSystemInfo(&context_, &info_request, &info).ok());
+    EXPECT_EQ(info.active_shapes(), shape_count);
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <grpcpp/grpcpp.h>
+
+#include "server/scoped_temp_file.h"
+#include "loopback_server.h"
+#include "common/utils.h"
+
+using occt_imgui::common::Utils;
+
+// Tests for chunked UploadModel/DownloadModel transfers
+class ModelTransferTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "transfer-client"));
+        box_id_ = server_.client().CreateBox(0, 0, 0, 10, 20, 30);
+        ASSERT_FALSE(box_id_.empty());
+
+        auto exported = server_.client().ExportModelFile({box_id_});
+        ASSERT_TRUE(exported.success) << exported.message;
+        step_data_ = exported.model_data;
+        ASSERT_GT(step_data_.size(), 3 * kChunkSize);
+
+        stub_ = server_.newStub();
+    }
+
+    geometry::ModelChunk MakeChunk(uint64_t offset, size_t size) const {
+        geometry::ModelChunk chunk;
+        chunk.set_offset(offset);
+        chunk.set_data(step_data_.substr(offset, size));
+        chunk.set_crc32(Utils::Crc32(chunk.data().data(), chunk.data().size()));
+        return chunk;
+    }
+
+    static constexpr size_t kChunkSize = 4096;
+
+    LoopbackServer server_;
+    std::unique_ptr<geometry::GeometryService::Stub> stub_;
+    std::string box_id_;
+    std::string step_data_;
+};
+
+TEST_F(ModelTransferTest, UploadInSmallChunksImportsModel) {
+    ScopedTempFile file("box.step");
+    file.write(step_data_);
+
+    auto result = server_.client().UploadModelFile(file.path(), {}, kChunkSize);
+    ASSERT_TRUE(result.success) << result.message;
+    EXPECT_EQ(result.detected_format, "STEP");
+    EXPECT_FALSE(result.shape_ids.empty());
+    EXPECT_EQ(result.file_size, static_cast<int64_t>(step_data_.size()));
+    EXPECT_EQ(server_.client().GetSystemInfo().active_shapes, 1 + static_cast<int>(result.shape_ids.size()));
+}
+
+TEST_F(ModelTransferTest, CorruptChunkIsRejected) {
+    grpc::ClientContext context;
+    context.AddMetadata("client-id", "transfer-client");
+    geometry::UploadModelResponse response;
+    auto writer = stub_->UploadModel(&context, &response);
+
+    geometry::ModelChunk chunk = MakeChunk(0, step_data_.size());
+    chunk.set_filename("box.step");
+    chunk.set_total_size(step_data_.size());
+    chunk.set_crc32(chunk.crc32() ^ 1);
+    chunk.set_last(true);
+    writer->Write(chunk);
+    writer->WritesDone();
+    ASSERT_TRUE(writer->Finish().ok());
+
+    EXPECT_FALSE(response.success());
+    EXPECT_FALSE(response.complete());
+    EXPECT_EQ(response.committed_offset(), 0u);
+    EXPECT_EQ(server_.client().GetSystemInfo().active_shapes, 1);
+}
+
+TEST_F(ModelTransferTest, InterruptedUploadResumesFromCommittedOffset) {
+    const size_t half = step_data_.size() / 2;
+    std::string transfer_id;
+    {
+        // First stream ends before the last chunk
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "transfer-client");
+        geometry::UploadModelResponse response;
+        auto writer = stub_->UploadModel(&context, &response);
+        geometry::ModelChunk chunk = MakeChunk(0, half);
+        chunk.set_filename("box.step");
+        chunk.set_total_size(step_data_.size());
+        writer->Write(chunk);
+        writer->WritesDone();
+        ASSERT_TRUE(writer->Finish().ok());
+
+        ASSERT_TRUE(response.success()) << response.message();
+        EXPECT_FALSE(response.complete());
+        EXPECT_EQ(response.committed_offset(), half);
+        transfer_id = response.transfer_id();
+        ASSERT_FALSE(transfer_id.empty());
+    }
+    {
+        // Resume with a chunk overlapping the committed range
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "transfer-client");
+        geometry::UploadModelResponse response;
+        auto writer = stub_->UploadModel(&context, &response);
+        geometry::ModelChunk chunk = MakeChunk(half - 100, step_data_.size());
+        chunk.set_transfer_id(transfer_id);
+        chunk.set_last(true);
+        chunk.set_file_crc32(Utils::Crc32(step_data_.data(), step_data_.size()));
+        writer->Write(chunk);
+        writer->WritesDone();
+        ASSERT_TRUE(writer->Finish().ok());
+
+        ASSERT_TRUE(response.success()) << response.message();
+        EXPECT_TRUE(response.complete());
+        EXPECT_EQ(response.committed_offset(), step_data_.size());
+        EXPECT_TRUE(response.import_result().success());
+        EXPECT_GT(response.import_result().shape_ids_size(), 0);
+    }
+}
+
+TEST_F(ModelTransferTest, BufferedUploadsCountAgainstTheSessionQuota) {
+    GeometryServiceOptions options;
+    options.session_memory_quota_bytes = step_data_.size() + step_data_.size() / 2;  // One buffer fits, not two
+    ASSERT_NO_FATAL_FAILURE(server_.start(options, "transfer-client"));
+    stub_ = server_.newStub();
+
+    auto send = [this](geometry::ModelChunk chunk) {
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "transfer-client");
+        geometry::UploadModelResponse response;
+        auto writer = stub_->UploadModel(&context, &response);
+        writer->Write(chunk);
+        writer->WritesDone();
+        EXPECT_TRUE(writer->Finish().ok());
+        return response;
+    };
+    auto first_half = [this] {
+        geometry::ModelChunk chunk = MakeChunk(0, step_data_.size() / 2);
+        chunk.set_filename("box.step");
+        chunk.set_total_size(step_data_.size());
+        return chunk;
+    };
+
+    // The pending upload holds its announced size until it ends
+    auto pending = send(first_half());
+    ASSERT_TRUE(pending.success()) << pending.message();
+    auto refused = send(first_half());
+    EXPECT_FALSE(refused.success());
+    EXPECT_NE(refused.message().find("Session memory quota exceeded"), std::string::npos) << refused.message();
+
+    // Discarding it gives the reservation back
+    geometry::ModelChunk rest = MakeChunk(pending.committed_offset(), step_data_.size());
+    rest.set_transfer_id(pending.transfer_id());
+    rest.set_last(true);
+    rest.set_file_crc32(Utils::Crc32(step_data_.data(), step_data_.size()) ^ 1);
+    auto discarded = send(rest);
+    EXPECT_FALSE(discarded.success());
+    EXPECT_EQ(discarded.message(), "File CRC mismatch, upload discarded");
+
+    auto accepted = send(first_half());
+    EXPECT_TRUE(accepted.success()) << accepted.message();
+}
+
+TEST_F(ModelTransferTest, DownloadInChunksAndResume) {
+    geometry::DownloadModelRequest request;
+    request.add_shape_ids(box_id_);
+    request.mutable_options()->set_format("STEP");
+    request.set_chunk_size(kChunkSize);
+
+    std::string received;
+    uint64_t total_size = 0;
+    uint32_t file_crc = 0;
+    {
+        // Take one chunk, then drop the stream
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "transfer-client");
+        auto reader = stub_->DownloadModel(&context, request);
+        geometry::ModelChunk chunk;
+        ASSERT_TRUE(reader->Read(&chunk));
+        EXPECT_EQ(chunk.offset(), 0u);
+        EXPECT_EQ(chunk.data().size(), kChunkSize);
+        EXPECT_EQ(Utils::Crc32(chunk.data().data(), chunk.data().size()), chunk.crc32());
+        EXPECT_FALSE(chunk.last());
+        total_size = chunk.total_size();
+        file_crc = chunk.file_crc32();
+        received = chunk.data();
+        request.set_transfer_id(chunk.transfer_id());
+        context.TryCancel();
+        reader->Finish();
+    }
+
+    request.set_offset(received.size());
+    grpc::ClientContext context;
+    context.AddMetadata("client-id", "transfer-client");
+    auto reader = stub_->DownloadModel(&context, request);
+    geometry::ModelChunk chunk;
+    while (reader->Read(&chunk)) {
+        ASSERT_EQ(chunk.offset(), received.size());
+        EXPECT_LE(chunk.data().size(), kChunkSize);
+        received += chunk.data();
+    }
+    ASSERT_TRUE(reader->Finish().ok());
+    EXPECT_TRUE(chunk.last());
+    EXPECT_EQ(received.size(), total_size);
+    EXPECT_EQ(Utils::Crc32(received.data(), received.size()), file_crc);
+
+    // The client helper verifies and writes the same kind of file
+    ScopedTempFile file("download.step");
+    auto result = server_.client().DownloadModelFile({box_id_}, file.path(), {}, kChunkSize);
+    ASSERT_TRUE(result.success) << result.message;
+    EXPECT_EQ(file.read().size(), static_cast<size_t>(result.file_size));
+}
@@ -230,6 +230,25 @@ TEST_F(PerformanceBenchmarkTest, BatchOperationsBenchmark) {
               << creation_time << " ms" << std::endl;
     std::cout << "  Average per shape: " << creation_time / batch_size << " ms" << std::endl;
     
+    // Same shapes through a single ExecuteBatch call
+    geometry::BatchRequest batch_request;
+    for (int i = 0; i < batch_size; ++i) {
+        auto* box = batch_request.add_operations()->mutable_create_box();
+        box->mutable_position()->set_x(i * 5);
+        box->set_width(2);
+        box->set_height(2);
+        box->set_depth(2);
+    }
+    geometry::BatchResponse batch_response;
+    double execute_batch_time = MeasureTime([this, &batch_request, &batch_response]() {
+        grpc::ServerContext ctx;
+        service_->ExecuteBatch(&ctx, &batch_request, &batch_response);
+    });
+    EXPECT_TRUE(batch_response.success());
+    
+    std::cout << "ExecuteBatch (" << batch_size << " shapes): " 
+              << execute_batch_time << " ms" << std::endl;
+    
     // Benchmark ClearAll
     double clear_time = MeasureTime([this]() {
         grpc::ServerContext ctx;
@@ -238,7 +257,7 @@ TEST_F(PerformanceBenchmarkTest, BatchOperationsBenchmark) {
         service_->ClearAll(&ctx, &request, &response);
     });
     
-    std::cout << "\nClearAll (" << batch_size << " shapes): " 
+    std::cout << "\nClearAll (" << 2 * batch_size << " shapes): " 
               << clear_time << " ms" << std::endl;
     
     EXPECT_LT(creation_time / batch_size, 5.0); // Less than 5ms per shape
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#include "common/grpc_performance_monitor.h"
+#include "server/rpc_metrics_interceptor.h"
+#include "loopback_server.h"
+
+namespace {
+
+constexpr uint64_t kNsPerUs = 1000;
+
+} // namespace
+
+// Tests for the lock-free monitor itself; each test uses its own operation names
+TEST(GrpcPerformanceMonitorTest, HistogramPercentilesStayWithinBucketPrecision) {
+    auto& monitor = GrpcPerformanceMonitor::getInstance();
+    auto& operation = monitor.operation("Test.Percentiles");
+    for (uint64_t us = 1; us <= 10000; ++us) {
+        monitor.record(operation, us * kNsPerUs);
+    }
+
+    auto stats = monitor.getOperationStats("Test.Percentiles");
+    EXPECT_EQ(stats.call_count, 10000u);
+    EXPECT_EQ(stats.success_count, 10000u);
+    EXPECT_NEAR(stats.min_time_ms, 0.001, 1e-9);
+    EXPECT_NEAR(stats.max_time_ms, 10.0, 1e-9);
+    EXPECT_NEAR(stats.avg_time_ms, 5.0005, 1e-6);
+    EXPECT_NEAR(stats.p50_time_ms, 5.0, 5.0 * 0.02);
+    EXPECT_NEAR(stats.p90_time_ms, 9.0, 9.0 * 0.02);
+    EXPECT_NEAR(stats.p99_time_ms, 9.9, 9.9 * 0.02);
+    EXPECT_NEAR(stats.p999_time_ms, 9.99, 9.99 * 0.02);
+    EXPECT_LE(stats.p999_time_ms, stats.max_time_ms);
+}
+
+TEST(GrpcPerformanceMonitorTest, BucketsCoverEveryValue) {
+    using Histogram = GrpcPerformanceMonitor::LatencyHistogram;
+    size_t previous = 0;
+    for (uint64_t value : {0ull, 1ull, 31ull, 32ull, 33ull, 1000ull, 123456789ull, 1ull << 42, ~0ull}) {
+        size_t index = Histogram::bucketIndex(value);
+        ASSERT_LT(index, Histogram::kBucketCount);
+        EXPECT_GE(index, previous);
+        previous = index;
+        if (value < (1ull << 42)) {
+            EXPECT_NEAR(Histogram::bucketMidpoint(index), static_cast<double>(value), value * 0.02 + 0.5);
+        }
+    }
+}
+
+TEST(GrpcPerformanceMonitorTest, ConcurrentRecordingLosesNoSamples) {
+    auto& monitor = GrpcPerformanceMonitor::getInstance();
+    constexpr int kThreads = 8;
+    constexpr int kCallsPerThread = 20000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&monitor, t] {
+            for (int i = 0; i < kCallsPerThread; ++i) {
+                monitor.recordOperation("Test.Concurrent", 0.5, 10, 20, (i + t) % 4 != 0);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto stats = monitor.getOperationStats("Test.Concurrent");
+    EXPECT_EQ(stats.call_count, static_cast<size_t>(kThreads * kCallsPerThread));
+    EXPECT_EQ(stats.success_count + stats.error_count, stats.call_count);
+    EXPECT_EQ(stats.error_count, stats.call_count / 4);
+    EXPECT_EQ(stats.total_bytes_sent, stats.call_count * 10);
+    EXPECT_EQ(stats.total_bytes_received, stats.call_count * 20);
+    EXPECT_NEAR(stats.total_time_ms, stats.call_count * 0.5, 1e-6 * stats.call_count);
+}
+
+TEST(GrpcPerformanceMonitorTest, RecentTimesKeepTheLatestSamplesInOrder) {
+    auto& monitor = GrpcPerformanceMonitor::getInstance();
+    auto& operation = monitor.operation("Test.Recent");
+    const size_t total = GrpcPerformanceMonitor::kRecentSamples + 50;
+    for (uint64_t i = 1; i <= total; ++i) {
+        monitor.record(operation, i * kNsPerUs);
+    }
+
+    auto stats = monitor.getOperationStats("Test.Recent");
+    ASSERT_EQ(stats.recent_times.size(), GrpcPerformanceMonitor::kRecentSamples);
+    EXPECT_NEAR(stats.recent_times.front(), 0.051, 1e-9);
+    EXPECT_NEAR(stats.recent_times.back(), total * 1e-3, 1e-9);
+    EXPECT_GT(stats.getStandardDeviation(), 0.0);
+}
+
+TEST(GrpcPerformanceMonitorTest, TimersRecordThroughResolvedOperations) {
+    auto& monitor = GrpcPerformanceMonitor::getInstance();
+    auto& operation = monitor.operation("Test.Timer");
+    EXPECT_EQ(&monitor.operation("Test.Timer"), &operation);  // Registered once
+    {
+        auto timer = monitor.createTimer("Test.Timer", 100);
+        timer.setSuccess(false);
+        timer.setBytesReceived(7);
+    }
+    auto stats = monitor.getOperationStats("Test.Timer");
+    EXPECT_EQ(stats.call_count, 1u);
+    EXPECT_EQ(stats.error_count, 1u);
+    EXPECT_EQ(stats.total_bytes_sent, 100u);
+    EXPECT_EQ(stats.total_bytes_received, 7u);
+
+    operation.reset();
+    EXPECT_EQ(monitor.getOperationStats("Test.Timer").call_count, 0u);
+    EXPECT_EQ(monitor.getAllStats().count("Test.Timer"), 0u);  // Idle operations are left out
+    monitor.record(operation, 1);
+    EXPECT_EQ(monitor.getOperationStats("Test.Timer").call_count, 1u);  // Still live after reset
+}
+
+// End-to-end: the server interceptor times every RPC
+class RpcMetricsInterceptorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "metrics-client", true));
+    }
+
+    static GrpcPerformanceMonitor::OperationStats ServerStats(const std::string& method) {
+        // The interceptor records once the call is torn down, just after the client sees the reply
+        auto& monitor = GrpcPerformanceMonitor::getInstance();
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        auto stats = monitor.getOperationStats("Server." + method);
+        while (stats.call_count == 0 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            stats = monitor.getOperationStats("Server." + method);
+        }
+        return stats;
+    }
+
+    LoopbackServer server_;
+};
+
+TEST_F(RpcMetricsInterceptorTest, RecordsLatencyBytesAndStatusPerMethod) {
+    GrpcPerformanceMonitor::getInstance().reset();
+    ASSERT_FALSE(server_.client().CreateSphere(0, 0, 0, 10).empty());
+    ASSERT_EQ(server_.client().GetAllMeshes().size(), 1u);
+    server_.client().GetMeshData("missing-shape");
+
+    auto create = ServerStats("CreateSphere");
+    EXPECT_EQ(create.call_count, 1u);
+    EXPECT_EQ(create.success_count, 1u);
+    EXPECT_GT(create.total_bytes_received, 0u);
+    EXPECT_GT(create.total_bytes_sent, 0u);
+    EXPECT_GT(create.max_time_ms, 0.0);
+
+    auto meshes = ServerStats("GetAllMeshes");
+    EXPECT_EQ(meshes.call_count, 1u);
+    EXPECT_GT(meshes.total_bytes_sent, create.total_bytes_sent);  // The streamed mesh
+
+    auto missing = ServerStats("GetMeshData");
+    EXPECT_EQ(missing.call_count, 1u);
+    EXPECT_EQ(missing.error_count, 1u);  // NOT_FOUND
+
+    EXPECT_GE(GrpcPerformanceMonitor::getInstance().getOperationStats("Stage.ExtractMesh").call_count, 1u);
+}
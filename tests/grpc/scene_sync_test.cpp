@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+#include "loopback_server.h"
+
+// End-to-end tests for incremental scene sync over a local server
+class SceneSyncTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "sync-test"));
+    }
+
+    static bool Contains(const std::vector<std::string>& ids, const std::string& id) {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+
+    LoopbackServer server_;
+};
+
+TEST_F(SceneSyncTest, InitialSyncReturnsFullScene) {
+    ASSERT_FALSE(server_.client().CreateBox(0, 0, 0, 10, 10, 10).empty());
+    ASSERT_FALSE(server_.client().CreateBox(20, 0, 0, 10, 10, 10).empty());
+
+    auto delta = server_.client().SyncScene(0);
+    ASSERT_TRUE(delta.success);
+    EXPECT_TRUE(delta.reset);
+    EXPECT_EQ(delta.changed.size(), 2u);
+    EXPECT_GT(delta.scene_version, 0u);
+}
+
+TEST_F(SceneSyncTest, DeltaContainsOnlyNewShape) {
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_FALSE(server_.client().CreateBox(i * 20.0, 0, 0, 10, 10, 10).empty());
+    }
+    auto initial = server_.client().SyncScene(0);
+    ASSERT_TRUE(initial.success);
+
+    // Nothing changed: nothing streamed, version unchanged
+    auto idle = server_.client().SyncScene(initial.scene_version);
+    ASSERT_TRUE(idle.success);
+    EXPECT_FALSE(idle.reset);
+    EXPECT_TRUE(idle.changed.empty());
+    EXPECT_EQ(idle.scene_version, initial.scene_version);
+
+    std::string new_id = server_.client().CreateBox(200, 0, 0, 10, 10, 10);
+    ASSERT_FALSE(new_id.empty());
+
+    auto delta = server_.client().SyncScene(initial.scene_version);
+    ASSERT_TRUE(delta.success);
+    EXPECT_FALSE(delta.reset);
+    ASSERT_EQ(delta.changed.size(), 1u);
+    EXPECT_EQ(delta.changed[0].shape_id, new_id);
+    EXPECT_FALSE(delta.changed[0].vertices.empty());
+    EXPECT_GT(delta.scene_version, initial.scene_version);
+}
+
+TEST_F(SceneSyncTest, DeltaReportsUpdatesAndDeletions) {
+    std::string keep_id = server_.client().CreateBox(0, 0, 0, 10, 10, 10);
+    std::string delete_id = server_.client().CreateBox(20, 0, 0, 10, 10, 10);
+    auto initial = server_.client().SyncScene(0);
+    ASSERT_TRUE(initial.success);
+
+    ASSERT_TRUE(server_.client().SetShapeColor(keep_id, 1.0, 0.0, 0.0));
+    ASSERT_TRUE(server_.client().DeleteShape(delete_id));
+
+    auto delta = server_.client().SyncScene(initial.scene_version);
+    ASSERT_TRUE(delta.success);
+    EXPECT_FALSE(delta.reset);
+    ASSERT_EQ(delta.changed.size(), 1u);
+    EXPECT_EQ(delta.changed[0].shape_id, keep_id);
+    EXPECT_FLOAT_EQ(delta.changed[0].color[0], 1.0f);
+    EXPECT_TRUE(Contains(delta.deleted_shape_ids, delete_id));
+}
+
+TEST_F(SceneSyncTest, ClearAllForcesReset) {
+    ASSERT_FALSE(server_.client().CreateBox(0, 0, 0, 10, 10, 10).empty());
+    auto initial = server_.client().SyncScene(0);
+    ASSERT_TRUE(initial.success);
+
+    ASSERT_TRUE(server_.client().ClearAll());
+
+    auto delta = server_.client().SyncScene(initial.scene_version);
+    ASSERT_TRUE(delta.success);
+    EXPECT_TRUE(delta.reset);
+    EXPECT_TRUE(delta.changed.empty());
+}
+
+TEST_F(SceneSyncTest, SubscriptionPushesShapeEvents) {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::pair<std::string, size_t>> events;  // shape_id, vertex floats
+
+    server_.client().SetShapeUpdateCallback([&](const std::string& shape_id, const GeometryClient::MeshData& mesh) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.emplace_back(shape_id, mesh.vertices.size());
+        cv.notify_all();
+    });
+    ASSERT_TRUE(server_.client().StartSceneSubscription(true));
+
+    // A second client on the same session drives the changes
+    GeometryClient other(server_.address(), "sync-test");
+    ASSERT_TRUE(other.Connect());
+
+    auto waitForEvents = [&](size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::seconds(5), [&] { return events.size() >= count; });
+    };
+
+    // The subscription is registered asynchronously; retry the first change until it is seen
+    std::string box_id;
+    for (int attempt = 0; attempt < 20 && box_id.empty(); ++attempt) {
+        std::string id = other.CreateBox(0, 0, 0, 10, 10, 10);
+        if (waitForEvents(1)) {
+            box_id = id;
+        }
+    }
+    ASSERT_FALSE(box_id.empty());
+
+    size_t seen = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen = events.size();
+        EXPECT_GT(events.back().second, 0u);  // Inline mesh attached
+    }
+
+    ASSERT_TRUE(other.DeleteShape(box_id));
+    ASSERT_TRUE(waitForEvents(seen + 1));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        EXPECT_EQ(events.back().first, box_id);
+        EXPECT_EQ(events.back().second, 0u);
+    }
+
+    server_.client().StopSceneSubscription();
+    EXPECT_FALSE(server_.client().IsSceneSubscriptionActive());
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#include "loopback_server.h"
+
+// Tests for the sharded session registry and background idle eviction
+class SessionRegistryTest : public ::testing::Test {
+protected:
+    // Polls until the registry holds the expected number of sessions
+    bool WaitForSessionCount(size_t expected, std::chrono::milliseconds timeout = std::chrono::seconds(3)) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (server_.service().getSessionCount() == expected) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return server_.service().getSessionCount() == expected;
+    }
+
+    LoopbackServer server_;
+};
+
+TEST_F(SessionRegistryTest, ClientsGetIsolatedSessions) {
+    ASSERT_NO_FATAL_FAILURE(server_.start());
+
+    std::vector<std::unique_ptr<GeometryClient>> clients;
+    for (int i = 0; i < 24; ++i) {
+        auto client = std::make_unique<GeometryClient>(server_.address(), "registry-client-" + std::to_string(i));
+        ASSERT_TRUE(client->Connect());
+        ASSERT_FALSE(client->CreateBox(0, 0, 0, 10, 10, 10).empty());
+        clients.push_back(std::move(client));
+    }
+
+    EXPECT_EQ(server_.service().getSessionCount(), clients.size());
+    for (auto& client : clients) {
+        auto info = client->GetSystemInfo();
+        EXPECT_EQ(info.active_shapes, 1);
+        EXPECT_EQ(info.active_sessions, clients.size());
+        EXPECT_EQ(info.total_shapes, clients.size());
+    }
+
+    ASSERT_TRUE(clients.front()->DisconnectFromServer());
+    EXPECT_EQ(server_.service().getSessionCount(), clients.size() - 1);
+    auto info = clients.back()->GetSystemInfo();
+    EXPECT_EQ(info.active_sessions, clients.size() - 1);
+    EXPECT_EQ(info.total_shapes, clients.size() - 1);  // The session's shapes went with it
+}
+
+TEST_F(SessionRegistryTest, IdleSessionsAreEvictedInBackground) {
+    GeometryServiceOptions options;
+    options.session_idle_timeout = std::chrono::milliseconds(100);
+    options.session_sweep_interval = std::chrono::milliseconds(10);
+    ASSERT_NO_FATAL_FAILURE(server_.start(options));
+
+    GeometryClient client(server_.address(), "idle-client");
+    ASSERT_TRUE(client.Connect());
+    ASSERT_FALSE(client.CreateBox(0, 0, 0, 10, 10, 10).empty());
+    EXPECT_EQ(server_.service().getSessionCount(), 1u);
+
+    // No request needed to trigger the sweep
+    EXPECT_TRUE(WaitForSessionCount(0));
+}
+
+TEST_F(SessionRegistryTest, SubscribedSessionIsNotEvicted) {
+    GeometryServiceOptions options;
+    options.session_idle_timeout = std::chrono::milliseconds(100);
+    options.session_sweep_interval = std::chrono::milliseconds(10);
+    ASSERT_NO_FATAL_FAILURE(server_.start(options));
+
+    GeometryClient client(server_.address(), "subscribed-client");
+    ASSERT_TRUE(client.Connect());
+    ASSERT_TRUE(client.StartSceneSubscription());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    EXPECT_EQ(server_.service().getSessionCount(), 1u);
+
+    client.StopSceneSubscription();
+    EXPECT_TRUE(WaitForSessionCount(0));
+}
@@ -45,6 +45,10 @@ TEST_F(SimpleGrpcTest, SystemInfoShouldWork) {
     EXPECT_FALSE(response.version().empty());
     EXPECT_FALSE(response.occt_version().empty());
     EXPECT_GE(response.active_shapes(), 0);
+    EXPECT_GE(response.active_sessions(), 1u);
+#if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
+    EXPECT_GT(response.resident_memory_bytes(), 0u);
+#endif
 }
 
 TEST_F(SimpleGrpcTest, ModelExportShouldWork) {
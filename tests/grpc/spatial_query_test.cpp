@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+
+#include <grpcpp/grpcpp.h>
+
+#include "server/spatial_index.h"
+#include "loopback_server.h"
+
+namespace {
+
+// Unit cube with its lower corner at (x, 0, 0)
+Aabb Cube(double x) {
+    Aabb box;
+    box.add(Vec3{x, 0.0, 0.0});
+    box.add(Vec3{x + 1.0, 1.0, 1.0});
+    return box;
+}
+
+// Meshes each shape "s<i>" as the quad on the x = 3i face of its cube
+bool QuadLoader(const std::string& shape_id, std::vector<float>& positions, std::vector<uint32_t>& indices) {
+    const float x = 3.0f * std::stoi(shape_id.substr(1));
+    positions = {x, 0, 0, x, 1, 0, x, 1, 1, x, 0, 1};
+    indices = {0, 1, 2, 0, 2, 3};
+    return true;
+}
+
+std::vector<std::string> Sorted(std::vector<std::string> ids) {
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+} // namespace
+
+// Tests for the BVH-backed scene index
+class SceneSpatialIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int i = 0; i < 100; ++i) {
+            index_.upsert("s" + std::to_string(i), Cube(3.0 * i), 1, true);
+        }
+    }
+
+    SceneSpatialIndex index_;
+};
+
+TEST_F(SceneSpatialIndexTest, RayPickReturnsClosestHitsFirst) {
+    auto hits = index_.rayPick({-5, 0.5, 0.5}, {2, 0, 0}, 0.0, 1, false, QuadLoader);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].shape_id, "s0");
+    EXPECT_NEAR(hits[0].distance, 5.0, 1e-6);  // Along the normalized direction
+    EXPECT_NEAR(std::abs(hits[0].normal[0]), 1.0, 1e-6);
+
+    hits = index_.rayPick({-5, 0.5, 0.5}, {1, 0, 0}, 0.0, 5, false, QuadLoader);
+    ASSERT_EQ(hits.size(), 5u);
+    EXPECT_EQ(hits.back().shape_id, "s4");
+    EXPECT_NEAR(hits.back().distance, 17.0, 1e-6);
+
+    EXPECT_TRUE(index_.rayPick({-5, 0.5, 0.5}, {1, 0, 0}, 4.0, 1, false, QuadLoader).empty());
+    EXPECT_TRUE(index_.rayPick({-5, 5.0, 0.5}, {1, 0, 0}, 0.0, 1, false, QuadLoader).empty());
+}
+
+TEST_F(SceneSpatialIndexTest, UpdatesAndRemovalsApplyIncrementally) {
+    index_.remove("s0");
+    index_.upsert("s1", Cube(1000.0), 2, true);  // Moved away; its old triangles must not be hit
+
+    auto hits = index_.rayPick({-5, 0.5, 0.5}, {1, 0, 0}, 0.0, 1, false, QuadLoader);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].shape_id, "s2");
+    EXPECT_EQ(index_.size(), 99u);
+}
+
+TEST_F(SceneSpatialIndexTest, BoxAndFrustumQueries) {
+    Aabb query;
+    query.add(Vec3{2.5, -1, -1});
+    query.add(Vec3{9.5, 2, 2});
+    EXPECT_EQ(Sorted(index_.boxQuery(query, false, false)), (std::vector<std::string>{"s1", "s2", "s3"}));
+    EXPECT_EQ(Sorted(index_.boxQuery(query, true, false)), (std::vector<std::string>{"s1", "s2"}));
+
+    // Orthographic projection of x in [0, 20], y and z in [-10, 10]
+    const std::array<double, 16> ortho{0.1, 0, 0, -1, 0, 0.1, 0, 0, 0, 0, 0.1, 0, 0, 0, 0, 1};
+    EXPECT_EQ(index_.frustumCull(SceneSpatialIndex::frustumPlanes(ortho), false).size(), 7u);
+}
+
+TEST_F(SceneSpatialIndexTest, HiddenShapesAreSkippedUnlessRequested) {
+    for (int i = 0; i < 100; ++i) {
+        index_.upsert("s" + std::to_string(i), Cube(3.0 * i), 1, i != 0);
+    }
+    auto hits = index_.rayPick({-5, 0.5, 0.5}, {1, 0, 0}, 0.0, 1, false, QuadLoader);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].shape_id, "s1");
+    hits = index_.rayPick({-5, 0.5, 0.5}, {1, 0, 0}, 0.0, 1, true, QuadLoader);
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].shape_id, "s0");
+}
+
+// End-to-end: queries follow the session's scene as it changes
+class SpatialQueryServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "spatial-client"));
+
+        // Spheres of radius 5 centred on the x axis
+        for (double x : {0.0, 30.0, 60.0}) {
+            ids_.push_back(server_.client().CreateSphere(x, 0, 0, 5));
+            ASSERT_FALSE(ids_.back().empty());
+        }
+    }
+
+    LoopbackServer server_;
+    std::vector<std::string> ids_;
+};
+
+TEST_F(SpatialQueryServiceTest, RayPickHitsTheNearestSurface) {
+    auto hits = server_.client().RayPick({-50, 0, 0}, {1, 0, 0}, 3);
+    ASSERT_EQ(hits.size(), 3u);
+    EXPECT_EQ(hits[0].shape_id, ids_[0]);
+    EXPECT_EQ(hits[1].shape_id, ids_[1]);
+    EXPECT_EQ(hits[2].shape_id, ids_[2]);
+    EXPECT_NEAR(hits[0].distance, 45.0, 0.5);  // Within the tessellation tolerance
+    EXPECT_NEAR(hits[0].point[0], -5.0, 0.5);
+
+    EXPECT_TRUE(server_.client().RayPick({-50, 20, 0}, {1, 0, 0}).empty());
+    EXPECT_TRUE(server_.client().RayPick({-50, 0, 0}, {1, 0, 0}, 1, 40.0).empty());
+}
+
+TEST_F(SpatialQueryServiceTest, QueriesFollowTransformsAndDeletes) {
+    ASSERT_EQ(server_.client().RayPick({-50, 0, 0}, {1, 0, 0}).at(0).shape_id, ids_[0]);
+
+    ASSERT_TRUE(server_.client().DeleteShape(ids_[0]));
+    GeometryClient::Batch batch;
+    batch.Transform(ids_[1], {1, 0, 0, 0, 0, 1, 0, 100, 0, 0, 1, 0, 0, 0, 0, 1});  // Out of the ray's way
+    ASSERT_TRUE(server_.client().ExecuteBatch(batch).success);
+
+    auto hits = server_.client().RayPick({-50, 0, 0}, {1, 0, 0});
+    ASSERT_EQ(hits.size(), 1u);
+    EXPECT_EQ(hits[0].shape_id, ids_[2]);
+    EXPECT_EQ(server_.client().BoxQuery({20, 90, -10}, {40, 110, 10}), std::vector<std::string>{ids_[1]});
+
+    ASSERT_TRUE(server_.client().ClearAll());
+    EXPECT_TRUE(server_.client().RayPick({-50, 0, 0}, {1, 0, 0}).empty());
+}
+
+TEST_F(SpatialQueryServiceTest, BoxQueryAndFrustumCull) {
+    EXPECT_EQ(Sorted(server_.client().BoxQuery({-10, -10, -10}, {40, 10, 10})), Sorted({ids_[0], ids_[1]}));
+    EXPECT_EQ(server_.client().BoxQuery({-10, -10, -10}, {32, 10, 10}, true), std::vector<std::string>{ids_[0]});
+
+    // Orthographic view of x in [20, 80]
+    const std::array<double, 16> ortho{1.0 / 30, 0, 0, -50.0 / 30, 0, 0.1, 0, 0, 0, 0, 0.1, 0, 0, 0, 0, 1};
+    EXPECT_EQ(Sorted(server_.client().FrustumCull(ortho)), Sorted({ids_[1], ids_[2]}));
+}
+
+TEST_F(SpatialQueryServiceTest, SessionsAreIsolatedAndBadInputIsRejected) {
+    GeometryClient other(server_.address(), "spatial-other");
+    ASSERT_TRUE(other.Connect());
+    EXPECT_TRUE(other.RayPick({-50, 0, 0}, {1, 0, 0}).empty());
+
+    auto stub = server_.newStub();
+    grpc::ClientContext context;
+    context.AddMetadata("client-id", "spatial-client");
+    geometry::RayPickRequest request;
+    geometry::RayPickResponse response;
+    ASSERT_TRUE(stub->RayPick(&context, request, &response).ok());
+    EXPECT_FALSE(response.success());
+
+    grpc::ClientContext cull_context;
+    cull_context.AddMetadata("client-id", "spatial-client");
+    geometry::FrustumCullRequest cull_request;
+    cull_request.add_view_projection(1.0);
+    geometry::ShapeQueryResponse cull_response;
+    ASSERT_TRUE(stub->FrustumCull(&cull_context, cull_request, &cull_response).ok());
+    EXPECT_FALSE(cull_response.success());
+}
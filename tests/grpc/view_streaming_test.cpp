@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+
+#include <grpcpp/grpcpp.h>
+
+#include "server/view_camera.h"
+#include "loopback_server.h"
+
+namespace {
+
+// Eye at (0, 0, eye_z) looking down -z
+std::array<double, 16> ViewFrom(double eye_z) {
+    return {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, -eye_z, 0, 0, 0, 1};
+}
+
+// 90 degree symmetric perspective frustum
+std::array<double, 16> Perspective(double near_plane, double far_plane) {
+    return {1, 0, 0, 0,
+            0, 1, 0, 0,
+            0, 0, -(far_plane + near_plane) / (far_plane - near_plane),
+            -2 * far_plane * near_plane / (far_plane - near_plane),
+            0, 0, -1, 0};
+}
+
+Aabb Cube(double x, double y, double z, double half_size) {
+    Aabb box;
+    box.add(Vec3{x - half_size, y - half_size, z - half_size});
+    box.add(Vec3{x + half_size, y + half_size, z + half_size});
+    return box;
+}
+
+geometry::ViewCamera ProtoCamera(double eye_z) {
+    geometry::ViewCamera camera;
+    const auto view = ViewFrom(eye_z);
+    const auto projection = Perspective(1.0, 1000.0);
+    camera.mutable_view()->Add(view.begin(), view.end());
+    camera.mutable_projection()->Add(projection.begin(), projection.end());
+    camera.set_viewport_width(800);
+    camera.set_viewport_height(600);
+    return camera;
+}
+
+} // namespace
+
+// Tests for the camera math behind view-ordered streaming
+TEST(ViewCameraTest, OrdersVisibleBoxesBySizeOnScreen) {
+    auto camera = ViewCamera::create(ViewFrom(0.0), Perspective(1.0, 100.0), 800, 600);
+    ASSERT_TRUE(camera);
+
+    std::vector<Aabb> boxes{Cube(0, 0, -50, 1), Cube(0, 0, -10, 1), Cube(0, 0, 10, 1),
+                            Cube(50, 0, -30, 1), Cube(0, 0, -20, 1)};
+    size_t in_view = 0;
+    auto order = camera->streamOrder(boxes, in_view);
+    ASSERT_EQ(in_view, 3u);
+    EXPECT_EQ(order, (std::vector<size_t>{1, 4, 0, 2, 3}));  // Culled ones nearest first
+    EXPECT_EQ(camera->screenArea(boxes[2]), 0.0);  // Behind the eye
+    EXPECT_GT(camera->screenArea(boxes[1]), camera->screenArea(boxes[4]));
+}
+
+TEST(ViewCameraTest, SightLineStartsAtTheNearPlane) {
+    auto camera = ViewCamera::create(ViewFrom(0.0), Perspective(1.0, 100.0), 800, 600);
+    ASSERT_TRUE(camera);
+
+    Vec3 origin, direction;
+    double length = 0.0;
+    ASSERT_TRUE(camera->sightLine({2, 1, -20}, origin, direction, length));
+    EXPECT_NEAR(origin[0], 0.1, 1e-9);
+    EXPECT_NEAR(origin[1], 0.05, 1e-9);
+    EXPECT_NEAR(origin[2], -1.0, 1e-9);
+    EXPECT_FALSE(camera->sightLine({0, 0, 5}, origin, direction, length));
+}
+
+TEST(ViewCameraTest, RejectsDegenerateCameras) {
+    std::array<double, 16> zero{};
+    EXPECT_FALSE(ViewCamera::create(ViewFrom(0.0), zero, 800, 600));
+    EXPECT_FALSE(ViewCamera::create(ViewFrom(0.0), Perspective(1.0, 100.0), 0, 600));
+}
+
+// End-to-end: mesh streams follow the client's camera
+class ViewStreamingTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_NO_FATAL_FAILURE(server_.start(GeometryServiceOptions(), "view-client"));
+
+        // Seen from (0, 0, 100): a large sphere in front, a sphere hidden
+        // behind it, a small one off to the side, one behind the eye and one
+        // far outside the field of view
+        front_ = server_.client().CreateSphere(0, 0, 0, 10);
+        hidden_ = server_.client().CreateSphere(0, 0, -50, 5);
+        side_ = server_.client().CreateSphere(30, 0, 0, 3);
+        behind_ = server_.client().CreateSphere(0, 0, 200, 3);
+        outside_ = server_.client().CreateSphere(500, 0, 0, 3);
+        for (const auto* id : {&front_, &hidden_, &side_, &behind_, &outside_}) {
+            ASSERT_FALSE(id->empty());
+        }
+    }
+
+    std::vector<std::string> StreamAllMeshes(const geometry::MeshRequest& request) {
+        auto stub = server_.newStub();
+        grpc::ClientContext context;
+        context.AddMetadata("client-id", "view-client");
+        auto reader = stub->GetAllMeshes(&context, request);
+        std::vector<std::string> order;
+        geometry::MeshData mesh;
+        while (reader->Read(&mesh)) {
+            order.push_back(mesh.shape_id());
+        }
+        last_status_ = reader->Finish();
+        return order;
+    }
+
+    LoopbackServer server_;
+    grpc::Status last_status_;
+    std::string front_, hidden_, side_, behind_, outside_;
+};
+
+TEST_F(ViewStreamingTest, VisibleShapesComeFirstAndOccludedOnesAfterThem) {
+    geometry::MeshRequest request;
+    *request.mutable_camera() = ProtoCamera(100.0);
+
+    auto order = StreamAllMeshes(request);
+    ASSERT_TRUE(last_status_.ok()) << last_status_.error_message();
+    ASSERT_EQ(order.size(), 5u);
+    EXPECT_EQ(order[0], front_);
+    EXPECT_EQ(order[1], side_);
+    EXPECT_EQ(order[2], hidden_);  // Larger on screen than side_, but behind front_
+    std::vector<std::string> culled(order.begin() + 3, order.end());
+    std::sort(culled.begin(), culled.end());
+    std::vector<std::string> expected{behind_, outside_};
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(culled, expected);
+}
+
+TEST_F(ViewStreamingTest, SkipCulledLeavesOutShapesOutsideTheView) {
+    geometry::MeshRequest request;
+    *request.mutable_camera() = ProtoCamera(100.0);
+    request.set_skip_culled(true);
+
+    auto order = StreamAllMeshes(request);
+    ASSERT_TRUE(last_status_.ok());
+    EXPECT_EQ(order, (std::vector<std::string>{front_, side_, hidden_}));
+}
+
+TEST_F(ViewStreamingTest, SessionCameraOrdersSceneSync) {
+    GeometryClient::ViewCamera camera;
+    camera.view = ViewFrom(100.0);
+    camera.projection = Perspective(1.0, 1000.0);
+    camera.viewport_width = 800;
+    camera.viewport_height = 600;
+    ASSERT_TRUE(server_.client().UpdateCamera(camera));
+
+    auto delta = server_.client().SyncScene(0);
+    ASSERT_TRUE(delta.success);
+    ASSERT_EQ(delta.changed.size(), 5u);
+    EXPECT_EQ(delta.changed[0].shape_id, front_);
+    EXPECT_EQ(delta.changed[1].shape_id, side_);
+
+    // Stepping back past the sphere that was behind the eye puts it in front
+    camera.view = ViewFrom(220.0);
+    ASSERT_TRUE(server_.client().UpdateCamera(camera));
+    delta = server_.client().SyncScene(0);
+    ASSERT_TRUE(delta.success);
+    ASSERT_FALSE(delta.changed.empty());
+    EXPECT_EQ(delta.changed[0].shape_id, behind_);
+
+    ASSERT_TRUE(server_.client().ClearCamera());
+    EXPECT_EQ(server_.client().SyncScene(0).changed.size(), 5u);
+}
+
+TEST_F(ViewStreamingTest, InvalidCamerasAreRejected) {
+    geometry::MeshRequest request;
+    request.mutable_camera()->add_view(1.0);
+    StreamAllMeshes(request);
+    EXPECT_EQ(last_status_.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
+
+    GeometryClient::ViewCamera camera;  // Zero matrices and viewport
+    EXPECT_FALSE(server_.client().UpdateCamera(camera));
+}